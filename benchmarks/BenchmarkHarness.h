@@ -0,0 +1,145 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#include <unistd.h>
+#endif
+
+// Minimal benchmark runner: each benchmark is a callable that performs one pass over its
+// workload and returns how many operations (bars, fills, timestamps, ...) it processed.
+// Passes repeat until min_seconds have elapsed; both the average and the best pass are kept.
+namespace Bench {
+
+    struct Result {
+        std::string name;
+        std::string unit;            // What one "op" is (bar, fill, row, ...)
+        std::uint64_t ops = 0;       // Total over all passes
+        double seconds = 0.0;        // Total over all passes
+        size_t passes = 0;
+        double best_ns_per_op = 0.0; // Fastest single pass
+
+        double ns_per_op() const { return ops ? seconds * 1e9 / static_cast<double>(ops) : 0.0; }
+        double ops_per_sec() const { return seconds > 0.0 ? static_cast<double>(ops) / seconds : 0.0; }
+    };
+
+    // Keeps the optimizer from discarding a benchmark's result
+    template <class T>
+    inline void do_not_optimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+        asm volatile("" : : "g"(&value) : "memory");
+#else
+        static volatile const void* sink;
+        sink = &value;
+#endif
+    }
+
+    // Resident set size of this process in bytes (from /proc/self/statm; 0 where unavailable)
+    inline std::uint64_t resident_bytes() {
+#if defined(__linux__)
+        std::ifstream statm("/proc/self/statm");
+        std::uint64_t total_pages = 0, resident_pages = 0;
+        if (statm >> total_pages >> resident_pages) {
+            return resident_pages * static_cast<std::uint64_t>(sysconf(_SC_PAGESIZE));
+        }
+#endif
+        return 0;
+    }
+
+    // Silences std::cout for its lifetime (components that print progress while being timed)
+    class QuietStdout {
+    public:
+        QuietStdout() : previous_(std::cout.rdbuf(nullptr)) {}
+        ~QuietStdout() { std::cout.rdbuf(previous_); std::cout.clear(); }
+        QuietStdout(const QuietStdout&) = delete;
+        QuietStdout& operator=(const QuietStdout&) = delete;
+    private:
+        std::streambuf* previous_;
+    };
+
+    class Runner {
+    public:
+        Runner(std::string filter, double min_seconds) : filter_(std::move(filter)), min_seconds_(min_seconds) {}
+
+        bool enabled(const std::string& name) const {
+            return filter_.empty() || name.find(filter_) != std::string::npos;
+        }
+
+        // 'pass' returns the number of ops it performed; 'setup' (optional) runs untimed before each pass
+        template <class Pass, class Setup>
+        void run(const std::string& name, const std::string& unit, Pass&& pass, Setup&& setup) {
+            if (!enabled(name)) return;
+            Result result;
+            result.name = name;
+            result.unit = unit;
+            result.best_ns_per_op = 0.0;
+            do {
+                setup();
+                auto start = std::chrono::steady_clock::now();
+                std::uint64_t ops = pass();
+                double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                result.ops += ops;
+                result.seconds += elapsed;
+                result.passes++;
+                if (ops > 0) {
+                    double ns = elapsed * 1e9 / static_cast<double>(ops);
+                    if (result.best_ns_per_op == 0.0 || ns < result.best_ns_per_op) result.best_ns_per_op = ns;
+                }
+            } while (result.seconds < min_seconds_);
+            print_row(std::cout, result);
+            results_.push_back(std::move(result));
+        }
+
+        template <class Pass>
+        void run(const std::string& name, const std::string& unit, Pass&& pass) {
+            run(name, unit, std::forward<Pass>(pass), []() {});
+        }
+
+        void print_header(std::ostream& out) const {
+            out << std::left << std::setw(40) << "Benchmark" << std::right
+                << std::setw(14) << "ns/op" << std::setw(14) << "best ns/op"
+                << std::setw(16) << "ops/sec" << std::setw(14) << "ops" << std::setw(8) << "passes"
+                << "  unit" << std::endl;
+        }
+
+        // JSON array with one object per benchmark (machine-readable output)
+        void write_json(const std::string& path) const {
+            std::ofstream out(path);
+            if (!out) throw std::runtime_error("Bench: cannot open '" + path + "' for writing");
+            out << std::setprecision(10) << "[\n";
+            for (size_t i = 0; i < results_.size(); ++i) {
+                const Result& r = results_[i];
+                out << "  {\"name\":\"" << r.name << "\",\"unit\":\"" << r.unit << "\",\"ops\":" << r.ops
+                    << ",\"seconds\":" << r.seconds << ",\"passes\":" << r.passes
+                    << ",\"ns_per_op\":" << r.ns_per_op() << ",\"best_ns_per_op\":" << r.best_ns_per_op
+                    << ",\"ops_per_sec\":" << r.ops_per_sec() << "}" << (i + 1 < results_.size() ? ",\n" : "\n");
+            }
+            out << "]\n";
+        }
+
+        const std::vector<Result>& results() const { return results_; }
+
+    private:
+        std::string filter_;
+        double min_seconds_;
+        std::vector<Result> results_;
+
+        static void print_row(std::ostream& out, const Result& r) {
+            std::ios_base::fmtflags flags = out.flags();
+            out << std::left << std::setw(40) << r.name << std::right << std::fixed
+                << std::setprecision(1) << std::setw(14) << r.ns_per_op() << std::setw(14) << r.best_ns_per_op
+                << std::setprecision(0) << std::setw(16) << r.ops_per_sec()
+                << std::setw(14) << r.ops << std::setw(8) << r.passes << "  " << r.unit << std::endl;
+            out.flags(flags);
+        }
+    };
+
+} // namespace Bench
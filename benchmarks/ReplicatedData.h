@@ -0,0 +1,245 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "backtester/DataManager.h"
+#include "common/Event.h"
+
+// Benchmark inputs built from the small data/stocks_april sample: its bars are replicated
+// across synthetic symbols and shifted forward in time to reach any size, without ever
+// materializing the scaled data set (unless a runner asks for get_all_events()).
+namespace Bench {
+
+    using Backtester::Common::MarketEvent;
+    using Backtester::Common::DataSnapshot;
+
+    namespace detail {
+        // Days since 1970-01-01 for a proleptic Gregorian date (H. Hinnant's algorithm)
+        inline std::int64_t days_from_civil(std::int64_t y, unsigned m, unsigned d) {
+            y -= m <= 2;
+            const std::int64_t era = (y >= 0 ? y : y - 399) / 400;
+            const unsigned yoe = static_cast<unsigned>(y - era * 400);
+            const unsigned doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+            const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+            return era * 146097 + static_cast<std::int64_t>(doe) - 719468;
+        }
+
+        inline std::vector<std::string> split(const std::string& line, char delimiter) {
+            std::vector<std::string> cells;
+            std::string cell;
+            std::istringstream stream(line);
+            while (std::getline(stream, cell, delimiter)) cells.push_back(cell);
+            return cells;
+        }
+    } // namespace detail
+
+    // Loads every "*.csv" in 'dir' in the layout of data/stocks_april: comma separated,
+    // numeric columns plus date_only (YYYY-MM-DD) and time_only (HH:MM:SS), UTC.
+    // The symbol is the file stem. Returns the events sorted by timestamp.
+    inline std::vector<MarketEvent> load_source_events(const std::string& dir) {
+        namespace fs = std::filesystem;
+        if (!fs::is_directory(dir)) throw std::runtime_error("Bench: data directory '" + dir + "' not found");
+
+        std::vector<fs::path> files;
+        for (const auto& entry : fs::directory_iterator(dir)) {
+            if (entry.is_regular_file() && entry.path().extension() == ".csv") files.push_back(entry.path());
+        }
+        std::sort(files.begin(), files.end()); // Deterministic symbol order
+
+        std::vector<MarketEvent> events;
+        for (const auto& file : files) {
+            std::ifstream in(file);
+            std::string line;
+            if (!std::getline(in, line)) continue;
+            std::vector<std::string> header = detail::split(line, ',');
+            auto date_it = std::find(header.begin(), header.end(), "date_only");
+            auto time_it = std::find(header.begin(), header.end(), "time_only");
+            if (date_it == header.end() || time_it == header.end()) {
+                throw std::runtime_error("Bench: '" + file.string() + "' lacks date_only/time_only columns");
+            }
+            const size_t date_idx = static_cast<size_t>(date_it - header.begin());
+            const size_t time_idx = static_cast<size_t>(time_it - header.begin());
+            const std::string symbol = file.stem().string();
+
+            while (std::getline(in, line)) {
+                std::vector<std::string> cells = detail::split(line, ',');
+                if (cells.size() != header.size()) continue;
+                int y = 0, mo = 0, d = 0, h = 0, mi = 0, s = 0;
+                if (std::sscanf(cells[date_idx].c_str(), "%d-%d-%d", &y, &mo, &d) != 3 ||
+                    std::sscanf(cells[time_idx].c_str(), "%d:%d:%d", &h, &mi, &s) != 3) continue;
+                std::int64_t seconds = detail::days_from_civil(y, static_cast<unsigned>(mo), static_cast<unsigned>(d)) * 86400
+                                       + h * 3600 + mi * 60 + s;
+                DataSnapshot snapshot;
+                for (size_t i = 0; i < header.size(); ++i) {
+                    if (i == date_idx || i == time_idx) continue;
+                    snapshot[header[i]] = std::strtod(cells[i].c_str(), nullptr);
+                }
+                events.emplace_back(std::chrono::system_clock::time_point(std::chrono::seconds(seconds)),
+                                    symbol, std::move(snapshot));
+            }
+        }
+        std::stable_sort(events.begin(), events.end(),
+                         [](const MarketEvent& a, const MarketEvent& b) { return a.timestamp < b.timestamp; });
+        return events;
+    }
+
+    // Streams 'base' scaled up: every base bar is emitted for 'symbol_replicas' symbols
+    // (replica 0 keeps the original name, replica k is "<symbol>_r<k>" with prices scaled by
+    // 1 + k*1e-4), and the whole timeline repeats 'time_copies' times, each copy shifted by
+    // whole days past the previous one. Output stays sorted by timestamp.
+    class ReplicatedDataManager : public Backtester::DataManager {
+    public:
+        ReplicatedDataManager(std::vector<MarketEvent> base, size_t symbol_replicas, size_t time_copies,
+                              std::uint64_t max_bars = 0)
+            : base_(std::move(base)), replicas_(std::max<size_t>(1, symbol_replicas)),
+              copies_(std::max<size_t>(1, time_copies)) {
+            if (base_.empty()) throw std::invalid_argument("ReplicatedDataManager: empty base data");
+            // Symbol table: one name per (base symbol, replica)
+            for (const auto& event : base_) {
+                if (base_symbol_ids_.emplace(event.symbol, base_symbol_ids_.size()).second) base_symbols_.push_back(event.symbol);
+            }
+            base_symbol_index_.reserve(base_.size());
+            for (const auto& event : base_) base_symbol_index_.push_back(base_symbol_ids_.at(event.symbol));
+            names_.reserve(base_symbols_.size() * replicas_);
+            for (const auto& symbol : base_symbols_) {
+                for (size_t r = 0; r < replicas_; ++r) names_.push_back(r == 0 ? symbol : symbol + "_r" + std::to_string(r));
+            }
+            const auto span = base_.back().timestamp - base_.front().timestamp;
+            const auto day = std::chrono::hours(24);
+            shift_ = (std::chrono::duration_cast<std::chrono::hours>(span) / day + 1) * day;
+            total_ = static_cast<std::uint64_t>(base_.size()) * replicas_ * copies_;
+            if (max_bars > 0) total_ = std::min(total_, max_bars);
+        }
+
+        bool load_data(const std::string& source) override { (void)source; return total_ > 0; }
+
+        std::optional<MarketEvent> get_next_bar() override {
+            if (cursor_ >= total_) return std::nullopt;
+            return make_event(cursor_++);
+        }
+
+        // Rebuilds one reused event in place: once its symbol and map have grown to fit,
+        // streaming bars allocates nothing
+        const MarketEvent* get_next_bar_ref() override {
+            if (cursor_ >= total_) return nullptr;
+            fill_event(cursor_++, current_);
+            return &current_;
+        }
+        size_t remaining_bars() const override { return static_cast<size_t>(total_ - std::min(cursor_, total_)); }
+
+        void reset() override { cursor_ = 0; }
+
+        // Materializes the scaled data set on first use (memory grows with the scale!)
+        const std::vector<MarketEvent>& get_all_events() const override {
+            if (materialized_.size() != total_) {
+                materialized_.clear();
+                materialized_.reserve(static_cast<size_t>(total_));
+                for (std::uint64_t i = 0; i < total_; ++i) materialized_.push_back(make_event(i));
+            }
+            return materialized_;
+        }
+
+        size_t get_cursor() const override { return static_cast<size_t>(cursor_); }
+        void seek(size_t cursor) override {
+            if (cursor > total_) throw std::out_of_range("ReplicatedDataManager: seek beyond end");
+            cursor_ = cursor;
+        }
+
+        std::uint64_t size() const { return total_; }
+        size_t num_symbols() const { return names_.size(); }
+        const std::vector<std::string>& base_symbols() const { return base_symbols_; }
+
+    private:
+        std::vector<MarketEvent> base_;
+        size_t replicas_;
+        size_t copies_;
+        std::unordered_map<std::string, size_t> base_symbol_ids_;
+        std::vector<std::string> base_symbols_;
+        std::vector<size_t> base_symbol_index_;
+        std::vector<std::string> names_;
+        std::chrono::system_clock::duration shift_{};
+        std::uint64_t total_ = 0;
+        std::uint64_t cursor_ = 0;
+        mutable std::vector<MarketEvent> materialized_;
+        MarketEvent current_{{}, {}, {}}; // Backing store for get_next_bar_ref
+
+        void fill_event(std::uint64_t index, MarketEvent& event) const {
+            const std::uint64_t per_copy = static_cast<std::uint64_t>(base_.size()) * replicas_;
+            const std::uint64_t copy = index / per_copy;
+            const std::uint64_t within = index % per_copy;
+            const size_t base_index = static_cast<size_t>(within / replicas_);
+            const size_t replica = static_cast<size_t>(within % replicas_);
+            const MarketEvent& source = base_[base_index];
+
+            event.timestamp = source.timestamp + shift_ * static_cast<long long>(copy);
+            event.symbol = names_[base_symbol_index_[base_index] * replicas_ + replica];
+            event.marketData = source.marketData;
+            if (replica > 0) {
+                const double scale = 1.0 + static_cast<double>(replica) * 1e-4;
+                for (auto& field : event.marketData) {
+                    if (field.first != "volume" && field.first != "Volume") field.second *= scale;
+                }
+            }
+        }
+
+        MarketEvent make_event(std::uint64_t index) const {
+            MarketEvent event({}, {}, {});
+            fill_event(index, event);
+            return event;
+        }
+    };
+
+    // Writes 'num_files' symbol files in the layout CsvDataManager reads (tab separated,
+    // date_only as MM/DD/YY, time_only as HH:MM:SS) so CSV parsing can be benchmarked at scale.
+    // File k replays base symbol (k % n) under the name "<symbol>_f<k>".
+    inline std::uint64_t write_csv_dataset(const std::vector<MarketEvent>& base, const std::string& out_dir, size_t num_files) {
+        namespace fs = std::filesystem;
+        fs::create_directories(out_dir);
+        std::vector<std::string> symbols;
+        for (const auto& event : base) {
+            if (std::find(symbols.begin(), symbols.end(), event.symbol) == symbols.end()) symbols.push_back(event.symbol);
+        }
+        const char* columns[] = {"open", "high", "low", "close", "volume"};
+        std::uint64_t rows = 0;
+        for (size_t f = 0; f < num_files; ++f) {
+            const std::string& symbol = symbols[f % symbols.size()];
+            std::ofstream out(fs::path(out_dir) / (symbol + "_f" + std::to_string(f) + ".csv"));
+            if (!out) throw std::runtime_error("Bench: cannot write CSV files to '" + out_dir + "'");
+            out << "open\thigh\tlow\tclose\tvolume\tdate_only\ttime_only\n";
+            char line[256];
+            for (const auto& event : base) {
+                if (event.symbol != symbol) continue;
+                double values[5] = {};
+                for (int c = 0; c < 5; ++c) {
+                    auto it = event.marketData.find(columns[c]);
+                    values[c] = it != event.marketData.end() ? it->second : 0.0;
+                }
+                std::int64_t secs = std::chrono::duration_cast<std::chrono::seconds>(event.timestamp.time_since_epoch()).count();
+                std::int64_t days = secs / 86400, sod = secs % 86400;
+                // Civil date from days (inverse of days_from_civil)
+                std::int64_t z = days + 719468, era = (z >= 0 ? z : z - 146096) / 146097;
+                std::int64_t doe = z - era * 146097, yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+                std::int64_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100), mp = (5 * doy + 2) / 153;
+                std::int64_t d = doy - (153 * mp + 2) / 5 + 1, m = mp < 10 ? mp + 3 : mp - 9, y = yoe + era * 400 + (m <= 2);
+                int length = std::snprintf(line, sizeof(line), "%.4f\t%.4f\t%.4f\t%.4f\t%.0f\t%02d/%02d/%02d\t%02d:%02d:%02d\n",
+                                           values[0], values[1], values[2], values[3], values[4],
+                                           static_cast<int>(m), static_cast<int>(d), static_cast<int>(y % 100),
+                                           static_cast<int>(sod / 3600), static_cast<int>(sod / 60 % 60), static_cast<int>(sod % 60));
+                out.write(line, length);
+                rows++;
+            }
+        }
+        return rows;
+    }
+
+} // namespace Bench
@@ -0,0 +1,824 @@
+// Benchmark suite for the engine stages: CSV/timestamp parsing, data iteration, each
+// strategy's handle_market_event, Portfolio updates, the trade ledger, resting-order matching,
+// order execution under the default and sweep cost models, rolling-window indicators, the
+// SIMD kernels at every supported level, the universe-wide lead-lag and pairs engines, pair screening, the delayed-order scheduler,
+// vectorized research runs next to their event-driven counterparts, the multi-symbol strategies
+// with and without slice delivery, and end-to-end runs.
+//
+//   backtester_bench [--data DIR] [--symbols N] [--copies N] [--max-bars N] [--csv-files N]
+//                    [--strategy-bars N] [--filter SUBSTR] [--min-time SEC] [--json FILE]
+//                    [--alloc-warmup N] [--sweep-runs N] [--sweep-bars N]
+//
+// --symbols / --copies scale data/stocks_april up by replicating its bars across synthetic
+// symbols and shifting whole copies of the timeline forward in time (e.g. --symbols 10000
+// --copies 10 streams ~200M bars without holding them in memory).
+//
+// In a -DBACKTESTER_ALLOC_ACCOUNTING=ON build the alloc/ gate replays every strategy and
+// fails (exit code 3) if any steady-state bar -- past the warm-up (default: a quarter of
+// the bars) and not writing a checkpoint, order bars included -- performed a heap allocation.
+//
+// The check/ gate fails (exit code 4) if the multi-symbol strategies' fills under slice
+// delivery differ from their per-bar fills in time, symbol, side or quantity (prices may
+// differ: see the gate), or if a day-sharded replay of an intraday-flat strategy differs
+// from its sequential run.
+//
+// The sweep/ benchmarks replay --sweep-runs short backtests (--sweep-bars each) per pass,
+// once with per-run state on the heap and once in a per-run Common::RunArena, and report
+// the process RSS before and after so allocator cost and memory growth can be compared.
+//
+// The simd/ benchmarks run each kernel once per level the CPU supports; every other benchmark
+// runs at the active level, which BACKTESTER_SIMD=scalar|avx2|avx512 caps for comparisons.
+
+#include "BenchmarkHarness.h"
+#include "ReplicatedData.h"
+
+#include "backtester/Backtester.h"
+#include "backtester/ShardedBacktester.h"
+#include "backtester/Portfolio.h"
+#include "backtester/ExecutionSimulator.h"
+#include "backtester/DataManager.h"
+#include "backtester/TradeLedger.h"
+#include "backtester/RestingOrderBook.h"
+#include "backtester/OrderScheduler.h"
+#include "backtester/OrderLatencyModel.h"
+#include "backtester/LeadLagEngine.h"
+#include "backtester/PairsEngine.h"
+#include "backtester/PairScreener.h"
+#include "backtester/ColumnarData.h"
+#include "backtester/VectorizedBacktester.h"
+#include "common/Logger.h"
+#include "common/AllocationCounter.h"
+#include "common/Utils.h"
+#include "common/RunArena.h"
+#include "common/RollingStats.h"
+#include "common/SimdKernels.h"
+#include "strategies/MovingAverageCrossover.h"
+#include "strategies/VWAPReversion.h"
+#include "strategies/OpeningRangeBreakout.h"
+#include "strategies/MomentumIgnition.h"
+#include "strategies/PairsTrading.h"
+#include "strategies/LeadLagStrategy.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace {
+
+    struct Options {
+        std::string data_dir = "../data/stocks_april";
+        size_t symbols = 0;                 // 0 = the symbols in data_dir, unreplicated
+        size_t copies = 1;
+        std::uint64_t max_bars = 0;         // 0 = no cap
+        size_t csv_files = 3;
+        std::uint64_t strategy_bars = 200000;
+        std::string filter;
+        double min_time = 0.5;
+        std::string json_path;
+        std::uint64_t alloc_warmup = 0;     // 0 = a quarter of the bars
+        size_t sweep_runs = 10000;
+        size_t sweep_bars = 200;
+    };
+
+    Options parse_options(int argc, char* argv[]) {
+        Options options;
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            auto value = [&]() -> std::string {
+                if (i + 1 >= argc) throw std::invalid_argument("Missing value for " + arg);
+                return argv[++i];
+            };
+            if (arg == "--data") options.data_dir = value();
+            else if (arg == "--symbols") options.symbols = std::stoul(value());
+            else if (arg == "--copies") options.copies = std::stoul(value());
+            else if (arg == "--max-bars") options.max_bars = std::stoull(value());
+            else if (arg == "--csv-files") options.csv_files = std::stoul(value());
+            else if (arg == "--strategy-bars") options.strategy_bars = std::stoull(value());
+            else if (arg == "--filter") options.filter = value();
+            else if (arg == "--min-time") options.min_time = std::stod(value());
+            else if (arg == "--json") options.json_path = value();
+            else if (arg == "--alloc-warmup") options.alloc_warmup = std::stoull(value());
+            else if (arg == "--sweep-runs") options.sweep_runs = std::stoul(value());
+            else if (arg == "--sweep-bars") options.sweep_bars = std::stoul(value());
+            else throw std::invalid_argument("Unknown option " + arg);
+        }
+        return options;
+    }
+
+    struct StrategySpec {
+        std::string name;
+        std::function<std::unique_ptr<Backtester::StrategyBase>(std::pmr::memory_resource*)> factory;
+        std::optional<Backtester::VectorStrategy> vectorized{}; // The research-mode equivalent, if any
+        bool cross_sectional = false; // Reads several symbols per timestamp (benched with slice delivery)
+        bool intraday_flat = false;   // Ends every session flat (checked against a day-sharded replay)
+    };
+
+    // ORB closes out at 19:55, before the datasets' sessions end at 20:00
+    constexpr int kOrbSessionClose = 19 * 60 + 55;
+
+    std::vector<StrategySpec> strategy_specs(const std::vector<std::string>& symbols) {
+        std::vector<StrategySpec> specs = {
+            {"MACrossover_5_20", [](std::pmr::memory_resource* r) { return std::make_unique<Backtester::MovingAverageCrossover>(5, 20, r); },
+             Backtester::MACrossoverParams{5, 20}},
+            {"VWAP_2.0", [](std::pmr::memory_resource* r) { return std::make_unique<Backtester::VWAPReversion>(2.0, r); },
+             Backtester::VWAPReversionParams{2.0}},
+            {"ORB_30", [](std::pmr::memory_resource* r) { return std::make_unique<Backtester::OpeningRangeBreakout>(30, kOrbSessionClose, r); },
+             Backtester::OpeningRangeBreakoutParams{30, kOrbSessionClose}, false, true},
+            {"Momentum_5_10_2_3", [](std::pmr::memory_resource* r) { return std::make_unique<Backtester::MomentumIgnition>(5, 10, 2.0, 3, r); },
+             Backtester::MomentumIgnitionParams{5, 10, 2.0, 3}},
+        };
+        if (symbols.size() >= 2) {
+            const std::string a = symbols[0], b = symbols[1];
+            specs.push_back({"Pairs", [a, b](std::pmr::memory_resource* r) { return std::make_unique<Backtester::PairsTrading>(a, b, 60, 2.0, 0.5, 10000.0, r); },
+                             Backtester::PairsTradingParams{a, b, 60, 2.0, 0.5, 1.0}, true});
+            specs.push_back({"LeadLag", [a, b](std::pmr::memory_resource* r) { return std::make_unique<Backtester::LeadLagStrategy>(a, b, 30, 1, 0.5, 0.0002, r); },
+                             std::nullopt, true});
+        }
+        return specs;
+    }
+
+    // --- check/ gate helpers ---
+    struct RecordedFill {
+        std::int64_t timestamp_ns;
+        std::string symbol;
+        std::uint8_t direction;
+        double quantity;
+        double price;
+    };
+
+    // Replays 'data' through a fresh 'spec' strategy and returns its fills in order
+    std::vector<RecordedFill> record_fills(const StrategySpec& spec, Backtester::DataManager& data, bool sliced) {
+        data.reset();
+        std::unique_ptr<Backtester::StrategyBase> strategy = spec.factory(std::pmr::get_default_resource());
+        Backtester::Portfolio portfolio(100000.0);
+        Backtester::ExecutionSimulator execution_simulator;
+        Backtester::TradeLedger ledger;
+        portfolio.set_trade_ledger(&ledger);
+        Backtester::Backtester backtester(data, *strategy, portfolio, execution_simulator);
+        backtester.set_verbose(false);
+        backtester.set_latency_profiling(false);
+        backtester.set_slice_delivery(sliced);
+        backtester.run();
+        std::vector<RecordedFill> fills;
+        for (const Backtester::LedgerBlock& block : ledger.blocks()) {
+            for (size_t i = 0; i < block.count; ++i) {
+                fills.push_back({block.timestamp_ns[i], ledger.symbols()[block.symbol_id[i]], block.direction[i],
+                                 block.quantity[i], block.price[i]});
+            }
+        }
+        return fills;
+    }
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    try {
+        options = parse_options(argc, argv);
+    } catch (const std::exception& e) {
+        std::cerr << "ERROR: " << e.what() << std::endl;
+        return 2;
+    }
+    // Console logging would dominate every measurement
+    Backtester::Log::Logger::instance().set_level(Backtester::Log::Level::OFF);
+
+    std::vector<Backtester::Common::MarketEvent> base;
+    try {
+        base = Bench::load_source_events(options.data_dir);
+    } catch (const std::exception& e) {
+        std::cerr << "ERROR: " << e.what() << std::endl;
+        return 1;
+    }
+    if (base.empty()) { std::cerr << "ERROR: no bars loaded from " << options.data_dir << std::endl; return 1; }
+
+    Bench::ReplicatedDataManager probe(base, 1, 1);
+    const size_t base_symbols = probe.base_symbols().size();
+    const size_t replicas = options.symbols == 0 ? 1 : (options.symbols + base_symbols - 1) / base_symbols;
+    Bench::ReplicatedDataManager scaled(base, replicas, options.copies, options.max_bars);
+
+    std::cout << "Source: " << base.size() << " bars, " << base_symbols << " symbols from " << options.data_dir << std::endl;
+    std::cout << "Scaled: " << scaled.size() << " bars, " << scaled.num_symbols() << " symbols, "
+              << options.copies << " time copies" << std::endl;
+    std::cout << "SIMD: " << Backtester::Common::Simd::level_name(Backtester::Common::Simd::active_level()) << " (supported: "
+              << Backtester::Common::Simd::level_name(Backtester::Common::Simd::supported_level()) << ")" << std::endl << std::endl;
+
+    Bench::Runner runner(options.filter, options.min_time);
+    runner.print_header(std::cout);
+
+    // --- Parsing ---
+    const std::string csv_dir = (std::filesystem::temp_directory_path() / "backtester_bench_csv").string();
+    if (runner.enabled("parse/")) {
+        std::filesystem::remove_all(csv_dir);
+        Bench::write_csv_dataset(base, csv_dir, options.csv_files);
+        runner.run("parse/csv_load_and_sort", "row", [&]() -> std::uint64_t {
+            Bench::QuietStdout quiet; // CsvDataManager reports every file
+            std::unique_ptr<Backtester::DataManager> dm = Backtester::create_csv_data_manager();
+            if (!dm->load_data(csv_dir)) throw std::runtime_error("CsvDataManager failed to load benchmark CSVs");
+            return dm->get_all_events().size();
+        });
+    }
+    runner.run("format/timestamp_utc", "timestamp", [&]() -> std::uint64_t {
+        char buf[32];
+        const std::int64_t start = 1743465600; // 2025-04-01
+        size_t total = 0;
+        for (std::int64_t i = 0; i < 1000000; ++i) total += Backtester::Utils::formatTimestampUTC(buf, start + i * 61);
+        Bench::do_not_optimize(total);
+        return 1000000;
+    });
+
+    // --- Data iteration ---
+    runner.run("data/get_next_bar_replicated", "bar", [&]() -> std::uint64_t {
+        std::uint64_t bars = 0;
+        while (auto event = scaled.get_next_bar()) { Bench::do_not_optimize(event); bars++; }
+        return bars;
+    }, [&]() { scaled.reset(); });
+    {
+        std::unique_ptr<Backtester::DataManager> slice = Backtester::create_slice_data_manager(base, 0, base.size());
+        runner.run("data/get_next_bar_slice", "bar", [&]() -> std::uint64_t {
+            std::uint64_t bars = 0;
+            while (auto event = slice->get_next_bar()) { Bench::do_not_optimize(event); bars++; }
+            return bars;
+        }, [&]() { slice->reset(); });
+    }
+
+    // --- Strategy kernels (handle_market_event only, over a materialized prefix) ---
+    const std::vector<StrategySpec> specs = strategy_specs(probe.base_symbols());
+    if (runner.enabled("strategy/") || runner.enabled("portfolio/")) {
+        Bench::ReplicatedDataManager prefix_source(base, replicas, options.copies,
+                                                   std::min<std::uint64_t>(scaled.size(), options.strategy_bars));
+        const std::vector<Backtester::Common::MarketEvent>& prefix = prefix_source.get_all_events();
+
+        for (const auto& spec : specs) {
+            std::unique_ptr<Backtester::StrategyBase> strategy;
+            std::unique_ptr<Backtester::Portfolio> portfolio;
+            runner.run("strategy/" + spec.name, "bar", [&]() -> std::uint64_t {
+                for (const auto& event : prefix) {
+                    strategy->handle_market_event(event, *portfolio);
+                    if (portfolio->has_pending_orders()) portfolio->take_pending_orders(); // Orders are not executed here
+                }
+                return prefix.size();
+            }, [&]() {
+                strategy = spec.factory(std::pmr::get_default_resource());
+                portfolio = std::make_unique<Backtester::Portfolio>(100000.0);
+            });
+        }
+
+        // --- Portfolio ---
+        std::unique_ptr<Backtester::Portfolio> portfolio;
+        runner.run("portfolio/update_market_value", "bar", [&]() -> std::uint64_t {
+            for (const auto& event : prefix) portfolio->update_market_value(event);
+            return prefix.size();
+        }, [&]() {
+            // Open a position in every symbol so each update marks something to market
+            portfolio = std::make_unique<Backtester::Portfolio>(1e12);
+            for (const auto& event : prefix) {
+                if (portfolio->get_position(event.symbol).quantity() != 0.0) continue;
+                portfolio->update_fill(Backtester::Common::FillDetails(event.timestamp, 0, event.symbol,
+                                                                       Backtester::Common::OrderDirection::BUY, 100.0, 100.0, 1.0));
+            }
+        });
+        runner.run("portfolio/update_fill", "fill", [&]() -> std::uint64_t {
+            std::uint64_t fills = 0;
+            for (const auto& event : prefix) {
+                auto direction = (fills % 2 == 0) ? Backtester::Common::OrderDirection::BUY : Backtester::Common::OrderDirection::SELL;
+                portfolio->update_fill(Backtester::Common::FillDetails(event.timestamp, static_cast<long long>(fills), event.symbol,
+                                                                       direction, 100.0, 100.0 + static_cast<double>(fills % 7), 1.0));
+                fills++;
+            }
+            return fills;
+        }, [&]() { portfolio = std::make_unique<Backtester::Portfolio>(1e12); });
+    }
+
+    // --- Trade ledger (append with spilling to disk, then a mapped read-back) ---
+    if (runner.enabled("ledger/append") || runner.enabled("ledger/read_mapped")) {
+        const std::uint64_t ledger_fills = 1000000;
+        const std::string ledger_path = (std::filesystem::temp_directory_path() / "backtester_bench.ledger").string();
+        const Backtester::Common::FillDetails fill(std::chrono::system_clock::time_point(std::chrono::seconds(1743465600)), 1, "SYM",
+                                                   Backtester::Common::OrderDirection::BUY, 100.0, 100.0, 1.0);
+        std::unique_ptr<Backtester::TradeLedger> ledger;
+        auto open_ledger = [&]() {
+            ledger = std::make_unique<Backtester::TradeLedger>();
+            ledger->spill_to(ledger_path);
+        };
+        auto write_fills = [&]() -> std::uint64_t {
+            for (std::uint64_t i = 0; i < ledger_fills; ++i) {
+                ledger->append(fill, static_cast<Backtester::Common::SymbolId>(i % 8), 100.0, 100.0, static_cast<double>(i), 1e6);
+            }
+            ledger->close();
+            return ledger_fills;
+        };
+        runner.run("ledger/append", "fill", write_fills, open_ledger);
+        if (!std::filesystem::exists(ledger_path)) { open_ledger(); write_fills(); } // Read-only filter
+        ledger.reset();
+        runner.run("ledger/read_mapped", "fill", [&]() -> std::uint64_t {
+            Backtester::LedgerReader reader(ledger_path);
+            double realized = 0.0;
+            for (const auto& block : reader.blocks()) {
+                for (size_t i = 0; i < block.count; ++i) realized += block.realized_pnl[i];
+            }
+            Bench::do_not_optimize(realized);
+            return reader.size();
+        });
+        std::filesystem::remove(ledger_path);
+    }
+
+    // --- Resting order book (bars matched against 100k resting limit/stop orders) ---
+    if (runner.enabled("orders/resting_match")) {
+        using Backtester::Common::OrderDirection;
+        const auto ts = std::chrono::system_clock::time_point(std::chrono::seconds(1743465600));
+        const size_t resting = 100000;
+        const std::uint64_t bars = 1000000;
+        std::unique_ptr<Backtester::RestingOrderBook> book;
+        std::vector<Backtester::BookExecution> executions;
+        runner.run("orders/resting_match", "bar", [&]() -> std::uint64_t {
+            // Bars oscillate around 100; every 1000th spikes through the nearest orders
+            for (std::uint64_t k = 0; k < bars; ++k) {
+                Backtester::BarQuote bar;
+                bar.open = bar.close = 100.0;
+                bar.high = (k % 1000 == 999) ? 101.0 : 100.0 + static_cast<double>(k % 7) * 0.05;
+                bar.low = 100.0 - static_cast<double>(k % 5) * 0.05;
+                book->match("SYM", bar, executions);
+            }
+            Bench::do_not_optimize(executions.size());
+            return bars;
+        }, [&]() {
+            // Buy limits below 99.5 and sell limits / buy stops from 100.5 up, 0.001 apart
+            book = std::make_unique<Backtester::RestingOrderBook>();
+            executions.clear();
+            for (size_t i = 0; i < resting; ++i) {
+                const double offset = 0.5 + 0.001 * static_cast<double>(i / 3);
+                Backtester::Common::OrderRequest order =
+                    i % 3 == 0 ? Backtester::Common::OrderRequest(ts, "SYM", OrderDirection::BUY, 10.0, 100.0 - offset)
+                  : i % 3 == 1 ? Backtester::Common::OrderRequest(ts, "SYM", OrderDirection::SELL, 10.0, 100.0 + offset)
+                               : Backtester::Common::OrderRequest::stop(ts, "SYM", OrderDirection::BUY, 10.0, 100.0 + offset);
+                order.order_id = static_cast<long long>(i + 1);
+                book->add(order);
+            }
+        });
+    }
+
+    // --- Market order execution: default cost model vs. the runtime-configurable policies ---
+    {
+        const auto ts = std::chrono::system_clock::time_point(std::chrono::seconds(1743465600));
+        const Backtester::Common::DataSnapshot snapshot{
+            {"open", 100.0}, {"high", 100.5}, {"low", 99.5}, {"close", 100.2}, {"volume", 50000.0}};
+        const Backtester::Common::OrderRequest order(ts, "SYM", Backtester::Common::OrderDirection::BUY, 100.0);
+        const std::uint64_t orders = 1000000;
+        Backtester::ExecutionSimulator default_simulator;
+        Backtester::SweepExecutionSimulator sweep_simulator;
+        sweep_simulator.slippage().bps = 2.0;
+        sweep_simulator.slippage().impact_coefficient = 0.1;
+        sweep_simulator.commission().per_share = 0.005;
+        sweep_simulator.commission().minimum = 1.0;
+        auto simulate = [&](Backtester::ExecutionSimulator& simulator) {
+            return [&, simulator_ptr = &simulator]() -> std::uint64_t {
+                double total = 0.0;
+                Backtester::Common::FillDetails fill(ts, 0, std::string(), Backtester::Common::OrderDirection::BUY, 0.0, 0.0, 0.0);
+                for (std::uint64_t i = 0; i < orders; ++i) {
+                    simulator_ptr->simulate_order(order, snapshot, ts, fill);
+                    total += fill.fill_price;
+                }
+                Bench::do_not_optimize(total);
+                return orders;
+            };
+        };
+        runner.run("execution/simulate_default", "order", simulate(default_simulator));
+        runner.run("execution/simulate_sweep", "order", simulate(sweep_simulator));
+    }
+
+    // --- Rolling-window indicators (cost per push is independent of the window) ---
+    for (size_t window : {size_t{20}, size_t{5000}}) {
+        const std::string suffix = "_" + std::to_string(window);
+        const std::uint64_t pushes = 1000000;
+        auto price = [](std::uint64_t i) { return 100.0 + static_cast<double>(i % 97) * 0.01 - static_cast<double>(i % 13) * 0.03; };
+        runner.run("indicators/rolling_variance" + suffix, "push", [&]() -> std::uint64_t {
+            Backtester::Common::RollingVariance stats(window);
+            double total = 0.0;
+            for (std::uint64_t i = 0; i < pushes; ++i) {
+                stats.push(price(i));
+                total += stats.stddev();
+            }
+            Bench::do_not_optimize(total);
+            return pushes;
+        });
+        runner.run("indicators/rolling_max" + suffix, "push", [&]() -> std::uint64_t {
+            Backtester::Common::RollingMax high(window);
+            double total = 0.0;
+            for (std::uint64_t i = 0; i < pushes; ++i) {
+                high.push(price(i));
+                total += high.value();
+            }
+            Bench::do_not_optimize(total);
+            return pushes;
+        });
+    }
+
+    // --- SIMD kernels (4096 lanes per call, at each level the CPU supports) ---
+    {
+        namespace Simd = Backtester::Common::Simd;
+        const size_t lanes = 4096;
+        const std::uint64_t calls = 1000;
+        std::vector<double> high(lanes), low(lanes), close(lanes), volume(lanes), x(lanes), y(lanes);
+        for (size_t j = 0; j < lanes; ++j) {
+            close[j] = 100.0 + static_cast<double>(j % 97) * 0.01;
+            high[j] = close[j] + static_cast<double>(j % 7) * 0.02;
+            low[j] = close[j] - static_cast<double>(j % 5) * 0.02;
+            volume[j] = 1000.0 + static_cast<double>(j % 31);
+        }
+        auto kernel = [&](const std::string& name, auto&& call) {
+            runner.run("simd/" + name, "lane", [&]() -> std::uint64_t {
+                for (std::uint64_t k = 0; k < calls; ++k) call();
+                Bench::do_not_optimize(x[lanes / 2] + y[lanes / 2]);
+                return calls * lanes;
+            });
+        };
+        const Simd::Level active = Simd::active_level();
+        for (const Simd::Level level : {Simd::Level::SCALAR, Simd::Level::AVX2, Simd::Level::AVX512}) {
+            if (level > Simd::supported_level()) continue;
+            Simd::set_level(level);
+            const std::string suffix = std::string("_") + Simd::level_name(level);
+            std::fill(x.begin(), x.end(), 0.0);
+            std::fill(y.begin(), y.end(), 0.0);
+            kernel("window_sums" + suffix, [&] { Simd::window_sums(x.data(), y.data(), high.data(), low.data(), lanes); });
+            kernel("window_cross" + suffix, [&] { Simd::window_cross(x.data(), 0.01, high.data(), -0.02, low.data(), lanes); });
+            kernel("spread_window_replace" + suffix, [&] {
+                Simd::spread_window_replace(x.data(), y.data(), 4.6, close.data(), 4.61, high.data(), 1.0 / 60.0, lanes);
+            });
+            kernel("zscores" + suffix, [&] { Simd::zscores(close.data(), low.data(), volume.data(), 59.0, lanes, x.data()); });
+            kernel("returns" + suffix, [&] { Simd::returns(close.data(), high.data(), lanes, x.data()); });
+            kernel("true_range" + suffix, [&] { Simd::true_range(high.data(), low.data(), close.data(), lanes, x.data()); });
+            kernel("typical_prices" + suffix, [&] {
+                Simd::typical_prices(high.data(), low.data(), close.data(), volume.data(), lanes, x.data(), y.data());
+            });
+        }
+        Simd::set_level(active);
+    }
+
+    // --- Lead-lag engine (all pairs of a 500-symbol universe, lags 1..5, one step per timestamp) ---
+    if (runner.enabled("leadlag/engine_500x5")) {
+        const size_t universe_size = 500;
+        const std::uint64_t steps = 200;
+        std::vector<std::string> universe;
+        std::vector<Backtester::Common::MarketEvent> bars;
+        for (size_t i = 0; i < universe_size; ++i) {
+            universe.push_back("SYM" + std::to_string(i));
+            bars.emplace_back(std::chrono::system_clock::time_point{}, universe.back(),
+                              Backtester::Common::DataSnapshot{{"close", 100.0}});
+        }
+        Backtester::LeadLagEngine engine(universe, 30, 5);
+        std::uint64_t step = 0;
+        runner.run("leadlag/engine_500x5", "step", [&]() -> std::uint64_t {
+            for (std::uint64_t k = 0; k < steps; ++k, ++step) {
+                for (size_t i = 0; i < universe_size; ++i) {
+                    auto& bar = bars[i];
+                    bar.timestamp = std::chrono::system_clock::time_point(std::chrono::minutes(step));
+                    bar.marketData["close"] = 100.0 + static_cast<double>((step * 7 + i * 13) % 101) * 0.01;
+                    engine.on_bar(bar);
+                }
+            }
+            Bench::do_not_optimize(engine.best_leaders(0, 5).size());
+            return steps;
+        });
+    }
+
+    // --- Pairs engine (all 499500 pairs of a 1000-symbol universe, one step per timestamp) ---
+    // Once on the calling thread and once on every hardware thread
+    for (const unsigned threads : {1u, 0u}) {
+        const std::string name = threads == 1 ? "pairs/engine_1000" : "pairs/engine_1000_mt";
+        if (!runner.enabled(name)) continue;
+        const size_t universe_size = 1000;
+        const std::uint64_t steps = 50;
+        std::vector<std::string> universe;
+        std::vector<Backtester::Common::MarketEvent> bars;
+        for (size_t i = 0; i < universe_size; ++i) {
+            universe.push_back("SYM" + std::to_string(i));
+            bars.emplace_back(std::chrono::system_clock::time_point{}, universe.back(),
+                              Backtester::Common::DataSnapshot{{"close", 100.0}});
+        }
+        Backtester::PairsEngine engine(universe, 60, 2.0, 0.5, threads);
+        engine.select_all();
+        std::uint64_t step = 0;
+        std::uint64_t crossings = 0;
+        runner.run(name, "step", [&]() -> std::uint64_t {
+            for (std::uint64_t k = 0; k < steps; ++k, ++step) {
+                for (size_t i = 0; i < universe_size; ++i) {
+                    auto& bar = bars[i];
+                    bar.timestamp = std::chrono::system_clock::time_point(std::chrono::minutes(step));
+                    bar.marketData["close"] = 100.0 + static_cast<double>((step * 7 + i * 13) % 101) * 0.01;
+                    if (engine.on_bar(bar)) crossings += engine.crossings().size();
+                }
+            }
+            Bench::do_not_optimize(crossings);
+            return steps;
+        });
+    }
+
+    // --- Pair screen (all 4950 pairs of 100 symbols over a month of minute bars) ---
+    if (runner.enabled("pairs/screen_100")) {
+        const size_t universe_size = 100;
+        const size_t steps = 20 * 390;
+        std::vector<Backtester::Common::MarketEvent> bars;
+        bars.reserve(universe_size * steps);
+        std::vector<double> log_price(universe_size, 4.0);
+        std::uint64_t state = 88172645463325252ULL; // xorshift: a reproducible walk per symbol
+        for (size_t t = 0; t < steps; ++t) {
+            for (size_t i = 0; i < universe_size; ++i) {
+                state ^= state << 13; state ^= state >> 7; state ^= state << 17;
+                log_price[i] += (static_cast<double>(state % 2001) - 1000.0) * 1e-6;
+                bars.emplace_back(std::chrono::system_clock::time_point(std::chrono::minutes(t)), "SYM" + std::to_string(i),
+                                  Backtester::Common::DataSnapshot{{"Close", std::exp(log_price[i])}});
+            }
+        }
+        Backtester::PairScreener screener;
+        screener.load(bars);
+        runner.run("pairs/screen_100", "screen", [&]() -> std::uint64_t {
+            Bench::do_not_optimize(screener.screen().size());
+            return 1;
+        });
+    }
+
+    // --- Delayed orders (1M in flight at once, released in arrival order) ---
+    if (runner.enabled("orders/scheduler_1M")) {
+        const auto ts = std::chrono::system_clock::time_point(std::chrono::seconds(1743465600));
+        const std::uint64_t in_flight = 1000000;
+        const Backtester::OrderLatencyModel latency(
+            Backtester::LatencyDistribution::lognormal(std::chrono::milliseconds(50), 1.0));
+        Backtester::OrderScheduler scheduler;
+        std::pmr::vector<Backtester::Common::OrderRequest> arrived;
+        runner.run("orders/scheduler_1M", "order", [&]() -> std::uint64_t {
+            Backtester::Common::OrderRequest order(ts, "SYM", Backtester::Common::OrderDirection::BUY, 1.0);
+            for (std::uint64_t i = 0; i < in_flight; ++i) {
+                order.order_id = static_cast<long long>(i);
+                scheduler.schedule(order, ts + latency.sample(order.symbol, i));
+            }
+            std::uint64_t released = 0;
+            for (auto now = ts; !scheduler.empty(); now += std::chrono::milliseconds(1)) {
+                arrived.clear();
+                scheduler.release("SYM", now, arrived);
+                released += arrived.size();
+            }
+            return released;
+        }, [&]() { scheduler.clear(); });
+    }
+
+    // --- Vectorized research mode vs the event loop (the source bars, a whole run each) ---
+    bool research = runner.enabled("research/columnar_load");
+    for (const auto& spec : specs) {
+        research = research || (spec.vectorized && (runner.enabled("research/vectorized_" + spec.name) || runner.enabled("research/event_" + spec.name)));
+    }
+    if (research) {
+        runner.run("research/columnar_load", "bar", [&]() -> std::uint64_t {
+            Backtester::ColumnarData data(base);
+            return data.events();
+        });
+        const Backtester::ColumnarData data(base);
+        const Backtester::VectorizedBacktester research(data, 100000.0);
+        std::unique_ptr<Backtester::DataManager> replay = Backtester::create_slice_data_manager(base, 0, base.size());
+        for (const auto& spec : specs) {
+            if (!spec.vectorized) continue;
+            runner.run("research/vectorized_" + spec.name, "bar", [&]() -> std::uint64_t {
+                Bench::do_not_optimize(research.run(*spec.vectorized).result.final_equity);
+                return base.size();
+            });
+            runner.run("research/event_" + spec.name, "bar", [&]() -> std::uint64_t {
+                std::unique_ptr<Backtester::StrategyBase> strategy = spec.factory(std::pmr::get_default_resource());
+                Backtester::Portfolio portfolio(100000.0);
+                Backtester::ExecutionSimulator execution_simulator;
+                Backtester::Backtester backtester(*replay, *strategy, portfolio, execution_simulator);
+                backtester.set_verbose(false);
+                backtester.set_latency_profiling(false);
+                backtester.run();
+                return static_cast<std::uint64_t>(backtester.get_bar_count());
+            }, [&]() { replay->reset(); });
+        }
+    }
+
+    // --- Slice delivery vs bar by bar (full event loop over the materialized timeline) ---
+    for (const auto& spec : specs) {
+        if (!spec.cross_sectional) continue;
+        if (!runner.enabled("slices/" + spec.name + "_per_bar") && !runner.enabled("slices/" + spec.name + "_sliced")) continue;
+        // Slice delivery holds a timestamp's bars in place, which the streaming replay cannot
+        const std::uint64_t slice_limit = 20000000;
+        if (scaled.size() > slice_limit) {
+            std::cout << "(skipping slices/" << spec.name << ": " << scaled.size() << " bars exceeds " << slice_limit << ")" << std::endl;
+            continue;
+        }
+        const std::vector<Backtester::Common::MarketEvent>& timeline = scaled.get_all_events();
+        std::unique_ptr<Backtester::DataManager> replay = Backtester::create_slice_data_manager(timeline, 0, timeline.size());
+        for (const bool sliced : {false, true}) {
+            runner.run("slices/" + spec.name + (sliced ? "_sliced" : "_per_bar"), "bar", [&]() -> std::uint64_t {
+                Backtester::Common::RunArena arena;
+                std::unique_ptr<Backtester::StrategyBase> strategy = spec.factory(arena.resource());
+                Backtester::Portfolio portfolio(100000.0, arena.resource());
+                Backtester::ExecutionSimulator execution_simulator;
+                Backtester::Backtester backtester(*replay, *strategy, portfolio, execution_simulator, arena.resource());
+                backtester.set_verbose(false);
+                backtester.set_slice_delivery(sliced);
+                backtester.run();
+                return static_cast<std::uint64_t>(backtester.get_bar_count());
+            }, [&]() { replay->reset(); });
+        }
+    }
+
+    // --- End to end (full event loop incl. execution, at the requested scale) ---
+    for (const auto& spec : specs) {
+        runner.run("e2e/" + spec.name, "bar", [&]() -> std::uint64_t {
+            Backtester::Common::RunArena arena;
+            std::unique_ptr<Backtester::StrategyBase> strategy = spec.factory(arena.resource());
+            Backtester::Portfolio portfolio(100000.0, arena.resource());
+            Backtester::ExecutionSimulator execution_simulator;
+            Backtester::Backtester backtester(scaled, *strategy, portfolio, execution_simulator, arena.resource());
+            backtester.set_verbose(false);
+            backtester.run();
+            return static_cast<std::uint64_t>(backtester.get_bar_count());
+        }, [&]() { scaled.reset(); });
+    }
+    if (runner.enabled("e2e/sharded_ORB_30")) {
+        // ORB ends every session flat, so the sharded results match the sequential ones (see
+        // check/sharded_ORB_30)
+        // Sharded replay needs the materialized timeline; keep it to sizes that fit in memory
+        const std::uint64_t sharded_limit = 20000000;
+        if (scaled.size() > sharded_limit) {
+            std::cout << "(skipping e2e/sharded_ORB_30: " << scaled.size() << " bars exceeds " << sharded_limit << ")" << std::endl;
+        } else {
+            scaled.get_all_events(); // Materialize outside the timed region
+            runner.run("e2e/sharded_ORB_30", "bar", [&]() -> std::uint64_t {
+                Bench::QuietStdout quiet;
+                Backtester::ShardedBacktester sharded(scaled, [](std::pmr::memory_resource* r) { return std::make_unique<Backtester::OpeningRangeBreakout>(30, kOrbSessionClose, r); }, 100000.0);
+                sharded.run();
+                return scaled.size();
+            });
+        }
+    }
+
+    // --- Run sweeps (parameter-sweep shape: many short runs back to back) ---
+    if (options.sweep_runs > 0) {
+        std::unique_ptr<Backtester::DataManager> window =
+            Backtester::create_slice_data_manager(base, 0, std::min(base.size(), options.sweep_bars));
+        for (const bool use_arena : {false, true}) {
+            for (const auto& spec : specs) {
+                const std::string name = "sweep/" + spec.name + (use_arena ? "/arena" : "/heap");
+                if (!runner.enabled(name)) continue;
+                const std::uint64_t rss_before = Bench::resident_bytes();
+                runner.run(name, "run", [&]() -> std::uint64_t {
+                    for (size_t run = 0; run < options.sweep_runs; ++run) {
+                        window->reset();
+                        std::optional<Backtester::Common::RunArena> arena;
+                        std::pmr::memory_resource* resource = std::pmr::get_default_resource();
+                        if (use_arena) resource = arena.emplace().resource();
+                        std::unique_ptr<Backtester::StrategyBase> strategy = spec.factory(resource);
+                        Backtester::Portfolio portfolio(100000.0, resource);
+                        Backtester::ExecutionSimulator execution_simulator;
+                        Backtester::Backtester backtester(*window, *strategy, portfolio, execution_simulator, resource);
+                        backtester.set_verbose(false);
+                        backtester.set_latency_profiling(false);
+                        backtester.run();
+                        Bench::do_not_optimize(portfolio.get_equity());
+                    }
+                    return options.sweep_runs;
+                });
+                const std::uint64_t rss_after = Bench::resident_bytes();
+                std::cout << std::left << std::setw(40) << "" << std::right << "  RSS " << rss_before / 1024 << " KiB -> "
+                          << rss_after / 1024 << " KiB" << std::endl;
+            }
+        }
+    }
+
+    // --- check/ gate: delivery modes and replays that must trade the same way ---
+    size_t check_failures = 0;
+    bool checks = false;
+    for (const auto& spec : specs) {
+        checks = checks || (spec.cross_sectional && runner.enabled("check/slices_" + spec.name)) ||
+                 (spec.intraday_flat && runner.enabled("check/sharded_" + spec.name));
+    }
+    if (checks) {
+        std::cout << "\n" << std::left << std::setw(40) << "Consistency checks" << std::right
+                  << std::setw(14) << "fills" << std::setw(14) << "mismatched" << std::setw(14) << "other price"
+                  << "  result" << std::endl;
+        std::unique_ptr<Backtester::DataManager> replay = Backtester::create_slice_data_manager(base, 0, base.size());
+        // Slice delivery must produce the per-bar fills (time, symbol, side, quantity). Their
+        // prices may differ: orders route after the whole slice, so a leg whose bar comes later
+        // in the timestamp fills against that bar instead of its previous one.
+        for (const auto& spec : specs) {
+            if (!spec.cross_sectional || !runner.enabled("check/slices_" + spec.name)) continue;
+            const std::vector<RecordedFill> per_bar = record_fills(spec, *replay, false);
+            const std::vector<RecordedFill> sliced = record_fills(spec, *replay, true);
+            size_t mismatched = per_bar.size() > sliced.size() ? per_bar.size() - sliced.size() : sliced.size() - per_bar.size();
+            size_t other_price = 0;
+            for (size_t i = 0; i < std::min(per_bar.size(), sliced.size()); ++i) {
+                const RecordedFill& x = per_bar[i];
+                const RecordedFill& y = sliced[i];
+                if (x.timestamp_ns != y.timestamp_ns || x.symbol != y.symbol || x.direction != y.direction || x.quantity != y.quantity) {
+                    ++mismatched;
+                } else if (x.price != y.price) {
+                    ++other_price;
+                }
+            }
+            const bool passed = mismatched == 0;
+            if (!passed) check_failures++;
+            std::cout << std::left << std::setw(40) << ("check/slices_" + spec.name) << std::right
+                      << std::setw(14) << per_bar.size() << std::setw(14) << mismatched << std::setw(14) << other_price
+                      << "  " << (passed ? "PASS" : "FAIL") << std::endl;
+        }
+        // A day-sharded replay of an intraday-flat strategy must reproduce the sequential run:
+        // the same fills, and the same equity, realized P&L and commission up to summation
+        // order. A session left open also fails (its P&L would carry into the next one).
+        for (const auto& spec : specs) {
+            if (!spec.intraday_flat || !runner.enabled("check/sharded_" + spec.name)) continue;
+            replay->reset();
+            std::unique_ptr<Backtester::StrategyBase> strategy = spec.factory(std::pmr::get_default_resource());
+            Backtester::Portfolio portfolio(100000.0);
+            Backtester::ExecutionSimulator execution_simulator;
+            Backtester::Backtester backtester(*replay, *strategy, portfolio, execution_simulator);
+            backtester.set_verbose(false);
+            backtester.set_latency_profiling(false);
+            backtester.run();
+            const Backtester::StrategyResult sequential = portfolio.get_results_summary();
+
+            Backtester::ShardedBacktester sharded(*replay, spec.factory, 100000.0);
+            {
+                Bench::QuietStdout quiet;
+                sharded.run();
+            }
+            const Backtester::StrategyResult stitched = sharded.get_results_summary();
+            auto close_enough = [](double x, double y) { return std::abs(x - y) <= 1e-9 * std::max(1.0, std::abs(x)); };
+            size_t mismatched = static_cast<size_t>(sequential.num_fills != stitched.num_fills) +
+                                static_cast<size_t>(!close_enough(sequential.final_equity, stitched.final_equity)) +
+                                static_cast<size_t>(!close_enough(sequential.realized_pnl, stitched.realized_pnl)) +
+                                static_cast<size_t>(!close_enough(sequential.total_commission, stitched.total_commission));
+            for (const Backtester::SessionResult& session : sharded.get_session_results()) mismatched += !session.ended_flat;
+            const bool passed = mismatched == 0;
+            if (!passed) check_failures++;
+            std::cout << std::left << std::setw(40) << ("check/sharded_" + spec.name) << std::right
+                      << std::setw(14) << sequential.num_fills << std::setw(14) << mismatched << std::setw(14) << "-"
+                      << "  " << (passed ? "PASS" : "FAIL") << std::endl;
+        }
+    }
+
+    // --- Allocation gate: steady-state bars of the full loop must not touch the heap ---
+    size_t allocation_failures = 0;
+    const bool allocation_gate = std::any_of(specs.begin(), specs.end(),
+                                             [&](const StrategySpec& spec) { return runner.enabled("alloc/" + spec.name); });
+    if (allocation_gate) {
+        if (!Backtester::Common::kAllocationAccounting) {
+            std::cout << "\n(alloc/ gate skipped: configure with -DBACKTESTER_ALLOC_ACCOUNTING=ON)" << std::endl;
+        } else {
+            const std::uint64_t warmup = options.alloc_warmup > 0 ? options.alloc_warmup
+                                                                  : std::max<std::uint64_t>(1000, scaled.size() / 4);
+            std::cout << "\n" << std::left << std::setw(40) << "Allocation gate" << std::right
+                      << std::setw(14) << "bars" << std::setw(14) << "steady bars" << std::setw(14) << "allocating"
+                      << std::setw(14) << "allocs/bar" << "  result (warm-up " << warmup << " bars)" << std::endl;
+            for (const auto& spec : specs) {
+                if (!runner.enabled("alloc/" + spec.name)) continue;
+                scaled.reset();
+                Backtester::Common::RunArena arena;
+                std::unique_ptr<Backtester::StrategyBase> strategy = spec.factory(arena.resource());
+                Backtester::Portfolio portfolio(100000.0, arena.resource());
+                Backtester::ExecutionSimulator execution_simulator;
+                Backtester::Backtester backtester(scaled, *strategy, portfolio, execution_simulator, arena.resource());
+                backtester.set_verbose(false);
+                backtester.set_allocation_warmup(static_cast<long>(warmup));
+                backtester.run();
+
+                const Backtester::AllocationProfile& profile = backtester.get_allocation_profile();
+                std::uint64_t total = 0;
+                for (size_t i = 0; i < static_cast<size_t>(Backtester::Stage::COUNT); ++i) {
+                    total += profile.get_stage(static_cast<Backtester::Stage>(i)).allocations;
+                }
+                const bool passed = profile.steady_state_violations() == 0 && profile.steady_state_bars() > 0;
+                if (!passed) allocation_failures++;
+                std::cout << std::left << std::setw(40) << ("alloc/" + spec.name) << std::right
+                          << std::setw(14) << profile.bars() << std::setw(14) << profile.steady_state_bars()
+                          << std::setw(14) << profile.steady_state_violations() << std::fixed << std::setprecision(4)
+                          << std::setw(14) << (profile.bars() ? static_cast<double>(total) / static_cast<double>(profile.bars()) : 0.0)
+                          << "  " << (passed ? "PASS" : "FAIL");
+                if (profile.first_violation_bar() >= 0) std::cout << " (first at bar " << profile.first_violation_bar() << ")";
+                if (profile.steady_state_bars() == 0) std::cout << " (no steady-state bars; lower --alloc-warmup)";
+                std::cout << std::defaultfloat << std::endl;
+                if (!passed) profile.print(std::cout);
+            }
+        }
+    }
+
+    std::filesystem::remove_all(csv_dir);
+    if (!options.json_path.empty()) {
+        runner.write_json(options.json_path);
+        std::cout << "\nResults written to " << options.json_path << std::endl;
+    }
+    if (allocation_failures > 0) {
+        std::cerr << "ERROR: " << allocation_failures << " strategies allocated on steady-state bars" << std::endl;
+        return 3;
+    }
+    if (check_failures > 0) {
+        std::cerr << "ERROR: " << check_failures << " consistency checks failed" << std::endl;
+        return 4;
+    }
+    return 0;
+}
@@ -0,0 +1,92 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <algorithm>
+
+#include "LatencyProfile.h"             // Stage
+#include "../common/AllocationCounter.h"
+
+namespace Backtester {
+
+    // Heap allocations per Backtester::run stage and per bar (BACKTESTER_ALLOC_ACCOUNTING
+    // builds; empty otherwise). "Steady-state" bars are those past the warm-up that wrote no
+    // checkpoint, whether or not they routed or filled orders: the engine and built-in
+    // strategies are expected to allocate nothing on them, and every one that does counts as
+    // a violation.
+    class AllocationProfile {
+    public:
+        struct StageCount {
+            std::uint64_t allocations = 0;
+            std::uint64_t bytes = 0;
+        };
+
+        static constexpr long kDefaultWarmupBars = 10000;
+        void set_warmup_bars(long bars) { warmup_bars_ = bars; }
+        long get_warmup_bars() const { return warmup_bars_; }
+
+        // Charges the calling thread's allocations since 'since' to 'stage' and to the
+        // current bar; returns the current count (the next stage's 'since')
+        Common::AllocationCount charge(Stage stage, const Common::AllocationCount& since) {
+            Common::AllocationCount now = Common::thread_allocations();
+            StageCount& count = stages_[static_cast<size_t>(stage)];
+            count.allocations += now.allocations - since.allocations;
+            count.bytes += now.bytes - since.bytes;
+            bar_allocations_ += now.allocations - since.allocations;
+            bar_bytes_ += now.bytes - since.bytes;
+            return now;
+        }
+
+        // Closes bar number 'bar'; 'quiet' = no checkpoint written
+        void end_bar(long bar, bool quiet) {
+            bars_++;
+            if (bar_allocations_ > 0) {
+                bars_with_allocations_++;
+                max_bar_allocations_ = std::max(max_bar_allocations_, bar_allocations_);
+            }
+            if (quiet && bar > warmup_bars_) {
+                steady_bars_++;
+                if (bar_allocations_ > 0) {
+                    steady_violations_++;
+                    steady_allocations_ += bar_allocations_;
+                    steady_bytes_ += bar_bytes_;
+                    if (first_violation_bar_ < 0) first_violation_bar_ = bar;
+                }
+            }
+            bar_allocations_ = 0;
+            bar_bytes_ = 0;
+        }
+
+        const StageCount& get_stage(Stage stage) const { return stages_[static_cast<size_t>(stage)]; }
+        std::uint64_t bars() const { return bars_; }
+        std::uint64_t bars_with_allocations() const { return bars_with_allocations_; }
+        std::uint64_t max_bar_allocations() const { return max_bar_allocations_; }
+        std::uint64_t steady_state_bars() const { return steady_bars_; }
+        std::uint64_t steady_state_violations() const { return steady_violations_; }
+        std::uint64_t steady_state_allocations() const { return steady_allocations_; }
+        std::uint64_t steady_state_bytes() const { return steady_bytes_; }
+        long first_violation_bar() const { return first_violation_bar_; } // -1 if none
+
+        void merge(const AllocationProfile& other);
+        void reset();
+
+        // Allocations / bytes per stage plus the per-bar and steady-state summary
+        void print(std::ostream& out) const;
+
+    private:
+        long warmup_bars_ = kDefaultWarmupBars;
+        std::array<StageCount, static_cast<size_t>(Stage::COUNT)> stages_{};
+        std::uint64_t bar_allocations_ = 0;  // Running tally of the open bar
+        std::uint64_t bar_bytes_ = 0;
+        std::uint64_t bars_ = 0;
+        std::uint64_t bars_with_allocations_ = 0;
+        std::uint64_t max_bar_allocations_ = 0;
+        std::uint64_t steady_bars_ = 0;
+        std::uint64_t steady_violations_ = 0;
+        std::uint64_t steady_allocations_ = 0;
+        std::uint64_t steady_bytes_ = 0;
+        long first_violation_bar_ = -1;
+    };
+
+} // namespace Backtester
@@ -1,16 +1,25 @@
 #pragma once
 #include <vector>
 #include <memory>
+#include <memory_resource>
 #include <iostream>
 #include <chrono>
+#include <cstdint>
 #include <string>
+#include <unordered_map>
 
 // --- Include FULL definitions needed for members/constructor ---
 #include "DataManager.h"
 #include "Strategy.h"
 #include "Portfolio.h"          // <<< Include full Portfolio definition
 #include "ExecutionSimulator.h"
+#include "LatencyProfile.h"
+#include "AllocationProfile.h"
+#include "OrderLatencyModel.h"
+#include "OrderScheduler.h"
+#include "CrossSection.h"
 #include "../common/Event.h"    // For potential future use
+#include "../common/RunContext.h"
 
 namespace Backtester {
     // --- Forward declare components ONLY if they are just pointers/references ---
@@ -27,14 +36,108 @@ namespace Backtester {
             DataManager& dataManager,
             StrategyBase& strategy,
             Portfolio& portfolio,           // Needs Portfolio definition
-            ExecutionSimulator& executionSimulator
+            ExecutionSimulator& executionSimulator,
+            std::pmr::memory_resource* resource = std::pmr::get_default_resource() // Per-run engine state
         );
+        ~Backtester();
+        Backtester(const Backtester&) = delete;            // The components are bound to run_context_
+        Backtester& operator=(const Backtester&) = delete;
         void run();
 
+        // Disable progress/summary printing (e.g. when many runs execute concurrently)
+        void set_verbose(bool verbose) { verbose_ = verbose; }
+
+        // --- Slice delivery ---
+        // Hands the strategy every bar of a timestamp in one StrategyBase::handle_slice call
+        // (made with the timestamp's last bar) instead of one handle_market_event per bar.
+        // Market values, resting orders and delayed arrivals are still processed bar by bar;
+        // orders the slice raises are routed after it, and periodic checkpoints wait for the
+        // slice to end. Call before run().
+        void set_slice_delivery(bool enabled) { slice_delivery_ = enabled; }
+        bool get_slice_delivery() const { return slice_delivery_; }
+
+        // --- Checkpointing ---
+        // A checkpoint captures the data cursor, Portfolio, ExecutionSimulator, strategy
+        // state (StrategyBase::serialize) and the run context. Resuming with
+        // load_checkpoint() + run() produces results bit-identical to an uninterrupted run.
+        // Both throw std::runtime_error on I/O or format errors.
+        void save_checkpoint(const std::string& path) const;
+        void load_checkpoint(const std::string& path);
+        // Automatically save a checkpoint to 'path' every 'bars' bars during run() (0 disables)
+        void set_checkpoint_interval(long bars, const std::string& path) {
+            checkpoint_interval_ = bars;
+            checkpoint_path_ = path;
+        }
+        long get_bar_count() const { return bar_count_; }
+
+        // --- Order latency ---
+        // Delay between the strategy raising an order and its arrival at the simulator. With a
+        // model enabled, each order is scheduled at (bar time + sampled delay) and executes
+        // against the first bar of its symbol at or after that time; cancels and replaces
+        // still apply immediately. Call before run(); orders in flight are checkpointed.
+        void set_order_latency(OrderLatencyModel model) {
+            order_latency_ = std::move(model);
+            order_latency_enabled_ = order_latency_.enabled();
+        }
+        size_t get_orders_in_flight() const { return order_scheduler_.in_flight(); }
+
+        // --- Run context ---
+        // The run's order/fill id sequences, simulated clock and RNG seed, shared with the
+        // Portfolio and ExecutionSimulator for the Backtester's lifetime. Ids start at 1 in
+        // every run; the seed keys the order latency draws (set it before run()).
+        void set_seed(std::uint64_t seed) { run_context_.set_seed(seed); }
+        Common::RunContext& get_run_context() { return run_context_; }
+        const Common::RunContext& get_run_context() const { return run_context_; }
+
+        // --- Stage latency profiling (on by default) ---
+        // Each run() stage feeds a log-linear histogram; the table is printed with the
+        // summary and the profile can be exported with get_latency_profile().write_json().
+        // Per-bar stages are timed on every 'sample_every'-th bar to bound the timer overhead.
+        static constexpr long kDefaultLatencySampleInterval = 8;
+        void set_latency_profiling(bool enabled, long sample_every = kDefaultLatencySampleInterval) {
+            profile_latency_ = enabled;
+            latency_sample_interval_ = sample_every;
+        }
+        void set_latency_label(const std::string& label) { latency_profile_.set_label(label); }
+        const LatencyProfile& get_latency_profile() const { return latency_profile_; }
+
+        // --- Heap allocation accounting (BACKTESTER_ALLOC_ACCOUNTING builds) ---
+        // Allocations are charged to run() stages and bars; bars after the first 'bars'
+        // that route no orders are expected to allocate nothing (see AllocationProfile).
+        void set_allocation_warmup(long bars) { allocation_profile_.set_warmup_bars(bars); }
+        const AllocationProfile& get_allocation_profile() const { return allocation_profile_; }
+
     private:
         DataManager& data_manager_;
         StrategyBase& strategy_;
         Portfolio& portfolio_;          // Member needs Portfolio definition
-        ExecutionSimulator& execution_simulator_; // Warning: Unused (can ignore for now)
+        ExecutionSimulator& execution_simulator_;
+        bool verbose_ = true;
+        long bar_count_ = 0;              // Bars consumed so far (restored by load_checkpoint)
+        long checkpoint_interval_ = 0;
+        std::string checkpoint_path_;
+        bool profile_latency_ = true;
+        long latency_sample_interval_ = kDefaultLatencySampleInterval;
+        LatencyProfile latency_profile_;
+        AllocationProfile allocation_profile_;
+        // Latest snapshot seen per symbol, so orders on other symbols (pairs, lead-lag)
+        // execute against that symbol's own prices
+        std::pmr::unordered_map<std::string, Common::DataSnapshot> latest_market_data_;
+
+        Common::RunContext run_context_;
+        std::vector<Common::FillDetails> resting_fills_; // Scratch for execute_resting_orders
+        OrderLatencyModel order_latency_;
+        bool order_latency_enabled_ = false;
+        OrderScheduler order_scheduler_;                  // Orders in flight under order_latency_
+        std::pmr::vector<Common::OrderRequest> arrived_orders_; // Scratch for execute_arrived_orders
+        bool slice_delivery_ = false;
+        CrossSection slice_;                              // Bars of the current timestamp under slice delivery
+        Common::FillDetails fill_;                        // Scratch for execute_order (reuses its symbol's storage)
+
+        void route_pending_orders(const Common::MarketEvent& market_event);
+        void execute_resting_orders(const Common::MarketEvent& market_event);
+        void execute_arrived_orders(const Common::MarketEvent& market_event);
+        void execute_order(const Common::OrderRequest& order, const Common::DataSnapshot& market_data,
+                           std::chrono::system_clock::time_point timestamp);
     };
 } // namespace Backtester
\ No newline at end of file
@@ -0,0 +1,68 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../common/Event.h"
+#include "../common/RunArena.h" // SymbolMap
+#include "ExecutionPolicies.h"  // BarQuote
+
+namespace Backtester {
+
+    // --- Columnar bar store ---
+    // A loaded event stream rearranged for whole-series work: one column per field per symbol
+    // (time, open, high, low, close, volume), plus, per event, its symbol and that bar's row,
+    // so kernels can walk one symbol's history as plain arrays and still put each result
+    // back at its place in the original stream.
+    //
+    // Only bars with a close enter a series (every strategy needs one); a missing open, high,
+    // low or volume is stored as NaN. Fields are read "Close" first, then "close", as the
+    // strategies read them. Symbols are numbered in name order.
+    class ColumnarData {
+    public:
+        static constexpr std::uint32_t kNoRow = 0xffffffffu; // Row of an event without a close
+
+        struct Series {
+            std::vector<std::int64_t> time_ns;   // Bar time, ns since the epoch
+            std::vector<double> open, high, low, close, volume;
+            std::vector<std::uint32_t> event;    // Index of the bar in the event stream
+            size_t size() const { return close.size(); }
+        };
+
+        ColumnarData() = default;
+        explicit ColumnarData(const std::vector<Common::MarketEvent>& events) { load(events); }
+
+        // Replaces the store with the given (time-sorted) events
+        void load(const std::vector<Common::MarketEvent>& events);
+
+        // --- Symbols ---
+        size_t symbols() const { return symbols_.size(); }
+        const std::string& symbol(size_t id) const { return symbols_.at(id); }
+        // Id of 'symbol', or symbols() if it is not in the stream
+        size_t symbol_id(std::string_view symbol) const;
+        const Series& series(size_t id) const { return series_.at(id); }
+
+        // --- Events ---
+        size_t events() const { return event_time_ns_.size(); }
+        std::int64_t event_time_ns(size_t event) const { return event_time_ns_[event]; }
+        std::uint32_t event_symbol(size_t event) const { return event_symbol_[event]; }
+        std::uint32_t event_row(size_t event) const { return event_row_[event]; }
+        const std::vector<std::int64_t>& event_times() const { return event_time_ns_; }
+        const std::vector<std::uint32_t>& event_symbols() const { return event_symbol_; }
+        const std::vector<std::uint32_t>& event_rows() const { return event_row_; }
+
+        // The bar at 'row' of symbol 'id' as the ExecutionSimulator reads it
+        BarQuote quote(size_t id, size_t row) const;
+
+    private:
+        std::vector<std::string> symbols_;
+        Common::SymbolMap<size_t> ids_;
+        std::vector<Series> series_;
+        std::vector<std::int64_t> event_time_ns_;
+        std::vector<std::uint32_t> event_symbol_;
+        std::vector<std::uint32_t> event_row_;    // kNoRow for events without a close
+    };
+
+} // namespace Backtester
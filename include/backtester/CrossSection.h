@@ -0,0 +1,155 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "../common/Event.h"
+#include "../common/PositionBook.h" // SymbolId
+
+namespace Backtester {
+
+    // --- Cross-sectional slice ---
+    // Every bar of one timestamp, delivered to StrategyBase::handle_slice in one call when the
+    // Backtester runs with slice delivery. Columns are indexed by a dense symbol id (0, 1, 2,
+    // ... in the order the run first saw each symbol); ids are fixed for the Backtester's
+    // lifetime, so a strategy can resolve its symbols with find() once (see SliceSymbol) and
+    // then read arrays.
+    //
+    // Only the ids in members() have a bar in the slice: the columns of the others hold
+    // whatever their last slice left there. A symbol with several bars at one timestamp keeps
+    // the last.
+    class CrossSection {
+    public:
+        explicit CrossSection(std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+            : id_space_(next_id_space()), symbols_(resource), ids_(resource), members_(resource),
+              reported_(resource), close_(resource), bars_(resource) {}
+
+        // The bars point into the data manager's event set
+        CrossSection(const CrossSection&) = delete;
+        CrossSection& operator=(const CrossSection&) = delete;
+
+        std::chrono::system_clock::time_point timestamp() const { return timestamp_; }
+        // Symbols seen so far in the run (the extent of the columns)
+        size_t universe() const { return symbols_.size(); }
+        // kNoSymbol until the run has seen 'symbol'
+        Common::SymbolId find(std::string_view symbol) const {
+            auto it = ids_.find(symbol);
+            return it != ids_.end() ? it->second : Common::kNoSymbol;
+        }
+        std::string_view symbol(Common::SymbolId id) const { return symbols_[id]; }
+        // Unique to this slice's id assignment: ids cached from a slice stay valid for every
+        // slice with the same id_space() (i.e. the rest of the run)
+        std::uint64_t id_space() const { return id_space_; }
+
+        // Ids with a bar in this slice, in arrival order
+        const std::pmr::vector<Common::SymbolId>& members() const { return members_; }
+        bool empty() const { return members_.empty(); }
+        // Bars added to the slice (members().size() unless a symbol repeated)
+        size_t bar_count() const { return bar_count_; }
+        bool has_bar(Common::SymbolId id) const { return id < reported_.size() && reported_[id] != 0; }
+
+        // --- Columns (valid where has_bar) ---
+        // The bar's close ("Close" or "close"), NaN if it has none
+        double close(Common::SymbolId id) const { return close_[id]; }
+        const double* closes() const { return close_.data(); }
+        // The bar itself, for the fields without a column
+        const Common::MarketEvent& bar(Common::SymbolId id) const { return *bars_[id]; }
+
+        // --- Built by the Backtester ---
+        // Adds a bar of the slice's timestamp (the first one sets it); 'event' must stay valid
+        // until clear(). Returns the bar's symbol id.
+        Common::SymbolId add(const Common::MarketEvent& event) {
+            const Common::SymbolId id = intern(event.symbol);
+            if (members_.empty()) timestamp_ = event.timestamp;
+            if (!reported_[id]) {
+                reported_[id] = 1;
+                members_.push_back(id);
+            }
+            auto it = event.marketData.find("Close");
+            if (it == event.marketData.end()) it = event.marketData.find("close");
+            close_[id] = it != event.marketData.end() ? it->second : std::numeric_limits<double>::quiet_NaN();
+            bars_[id] = &event;
+            ++bar_count_;
+            return id;
+        }
+        // Empties the slice for the next timestamp (ids are kept)
+        void clear() {
+            for (Common::SymbolId id : members_) reported_[id] = 0;
+            members_.clear();
+            bar_count_ = 0;
+        }
+
+    private:
+        std::uint64_t id_space_;
+        std::pmr::deque<std::pmr::string> symbols_; // id -> name (a deque, so the index's views stay valid)
+        std::pmr::unordered_map<std::string_view, Common::SymbolId> ids_; // Views into symbols_
+        std::chrono::system_clock::time_point timestamp_{};
+        std::pmr::vector<Common::SymbolId> members_;
+        size_t bar_count_ = 0;
+        std::pmr::vector<std::uint8_t> reported_;
+        std::pmr::vector<double> close_;
+        std::pmr::vector<const Common::MarketEvent*> bars_;
+
+        static std::uint64_t next_id_space() {
+            static std::atomic<std::uint64_t> next{1};
+            return next.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        Common::SymbolId intern(std::string_view symbol) {
+            auto it = ids_.find(symbol);
+            if (it != ids_.end()) return it->second;
+            const Common::SymbolId id = static_cast<Common::SymbolId>(symbols_.size());
+            symbols_.emplace_back(symbol);
+            ids_.emplace(std::string_view(symbols_.back()), id);
+            reported_.push_back(0);
+            close_.push_back(0.0);
+            bars_.push_back(nullptr);
+            return id;
+        }
+    };
+
+    // A strategy's symbol, resolved to its slice id once per run (kNoSymbol until the run has
+    // seen it, which has_bar() treats as absent)
+    struct SliceSymbol {
+        Common::SymbolId id = Common::kNoSymbol;
+        std::uint64_t id_space = 0;
+
+        Common::SymbolId resolve(const CrossSection& slice, std::string_view symbol) {
+            if (id == Common::kNoSymbol || id_space != slice.id_space()) {
+                id = slice.find(symbol);
+                id_space = slice.id_space();
+            }
+            return id;
+        }
+    };
+
+    // Slice ids mapped onto another index (e.g. an engine's universe), extended as the run
+    // sees new symbols and rebuilt for a new id space
+    class SliceIdMap {
+    public:
+        explicit SliceIdMap(std::pmr::memory_resource* resource = std::pmr::get_default_resource()) : ids_(resource) {}
+
+        // lookup(symbol) gives the index of a symbol not mapped yet
+        template <class Lookup>
+        size_t map(const CrossSection& slice, Common::SymbolId id, Lookup&& lookup) {
+            if (id_space_ != slice.id_space()) {
+                ids_.clear();
+                id_space_ = slice.id_space();
+            }
+            while (ids_.size() <= id) ids_.push_back(lookup(slice.symbol(static_cast<Common::SymbolId>(ids_.size()))));
+            return ids_[id];
+        }
+
+    private:
+        std::pmr::vector<size_t> ids_;
+        std::uint64_t id_space_ = 0;
+    };
+
+} // namespace Backtester
@@ -2,6 +2,8 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include <optional>
+#include <algorithm>
 #include "../common/Event.h" // Needs MarketEvent
 
 namespace Backtester {
@@ -11,8 +13,39 @@ namespace Backtester {
         virtual bool load_data(const std::string& source) = 0;
         // Changed return type for better memory safety if MarketEvent contains complex data
         virtual std::optional<Common::MarketEvent> get_next_bar() = 0; // Use optional
+        // Copy-free variant used by the Backtester loop: the returned event stays valid until
+        // the next call (nullptr at the end). Managers that hold their events in memory return
+        // them in place; the default keeps the last get_next_bar() result.
+        virtual const Common::MarketEvent* get_next_bar_ref() {
+            last_bar_ = get_next_bar();
+            return last_bar_ ? &*last_bar_ : nullptr;
+        }
         virtual void reset() = 0;
+        // Read-only view of the full, time-sorted event set backing this manager
+        // (used by runners that split the timeline, e.g. ShardedBacktester)
+        virtual const std::vector<Common::MarketEvent>& get_all_events() const = 0;
+        // Index (into get_all_events()) of the next event get_next_bar will return;
+        // seek() repositions the stream there, e.g. when resuming from a checkpoint
+        virtual size_t get_cursor() const = 0;
+        virtual void seek(size_t cursor) = 0;
+        // Bars left before the end of the stream (used to pre-size per-bar buffers)
+        virtual size_t remaining_bars() const {
+            const size_t total = get_all_events().size();
+            return total - std::min(get_cursor(), total);
+        }
+        // The event the next get_next_bar() returns, read in place from get_all_events()
+        // (nullptr at the end)
+        const Common::MarketEvent* peek_next_bar() const {
+            return remaining_bars() > 0 ? &get_all_events()[get_cursor()] : nullptr;
+        }
+
+    private:
+        std::optional<Common::MarketEvent> last_bar_; // Backing store for the default get_next_bar_ref
     };
     // Factory function declaration
     std::unique_ptr<DataManager> create_csv_data_manager();
+    // Replays events[begin, end) of an already loaded, sorted event set without copying it.
+    // The referenced vector must outlive the returned manager.
+    std::unique_ptr<DataManager> create_slice_data_manager(
+        const std::vector<Common::MarketEvent>& events, size_t begin, size_t end);
 }
\ No newline at end of file
@@ -0,0 +1,159 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+#include "../common/Event.h"      // DataSnapshot
+#include "../common/OrderTypes.h"
+
+namespace Backtester {
+
+    // The bar an order executes against, read out of its DataSnapshot once. Missing
+    // open/high/low fall back to the close; a missing volume leaves has_volume false.
+    struct BarQuote {
+        double open = 0.0;
+        double high = 0.0;
+        double low = 0.0;
+        double close = 0.0;
+        double volume = 0.0;
+        bool has_volume = false;
+        bool valid = false;        // false without a close price
+
+        static BarQuote from(const Common::DataSnapshot& data) {
+            // Field names follow the CSV header: all lower case or all capitalized
+            static const std::string kLower[] = {"close", "open", "high", "low", "volume"};
+            static const std::string kUpper[] = {"Close", "Open", "High", "Low", "Volume"};
+            BarQuote q;
+            const std::string* keys = kLower;
+            auto it = data.find(kLower[0]);
+            if (it == data.end()) {
+                keys = kUpper;
+                it = data.find(kUpper[0]);
+                if (it == data.end()) return q;
+            }
+            q.valid = true;
+            q.close = it->second;
+            auto field = [&](const std::string& key, double fallback) {
+                auto found = data.find(key);
+                return found != data.end() ? found->second : fallback;
+            };
+            q.open = field(keys[1], q.close);
+            q.high = std::max(field(keys[2], std::max(q.open, q.close)), q.open);
+            q.low = std::min(field(keys[3], std::min(q.open, q.close)), q.open);
+            auto volume = data.find(keys[4]);
+            q.has_volume = volume != data.end();
+            if (q.has_volume) q.volume = volume->second;
+            return q;
+        }
+    };
+
+    // What a slippage policy sees for one execution
+    struct FillContext {
+        const BarQuote& bar;
+        Common::OrderDirection direction;
+        double quantity;   // Unsigned
+        double price;      // Reference price before slippage
+    };
+
+    // --- Execution policies ---
+    // PolicyExecutionSimulator is a template over three small function objects, so the cost model
+    // of each instantiation compiles inline into the order path:
+    //   FillPrice   double operator()(const BarQuote&) const        reference price of a market order
+    //   Slippage    double operator()(const FillContext&) const     per-unit concession (>= 0): buys pay
+    //                                                               more, sells receive less
+    //   Commission  double operator()(double quantity, double price) const
+    //               double minimum                                  per order: the partial fills of
+    //                                                               a resting order share one minimum
+    // The Configurable* policies read their parameters at run time (parameter sweeps) and
+    // are still plain structs: no virtual dispatch per order.
+    namespace ExecutionPolicies {
+
+        // --- Fill price ---
+        struct ClosePrice {
+            double operator()(const BarQuote& bar) const { return bar.close; }
+        };
+        struct OpenPrice {
+            double operator()(const BarQuote& bar) const { return bar.open; }
+        };
+        struct MidRangePrice {
+            double operator()(const BarQuote& bar) const { return 0.5 * (bar.high + bar.low); }
+        };
+
+        // --- Slippage ---
+        struct NoSlippage {
+            double operator()(const FillContext&) const { return 0.0; }
+        };
+        struct FixedCents {
+            double per_unit = 0.01;
+            double operator()(const FillContext&) const { return per_unit; }
+        };
+        struct BpsSlippage {
+            double bps = 1.0;
+            double operator()(const FillContext& c) const { return c.price * bps * 1e-4; }
+        };
+        // Pays 'fraction' of half the bar's high-low range, a proxy for the quoted spread
+        struct HalfSpread {
+            double fraction = 1.0;
+            double operator()(const FillContext& c) const { return fraction * 0.5 * (c.bar.high - c.bar.low); }
+        };
+        // Square-root market impact: price * coefficient * sqrt(quantity / bar volume)
+        // (coefficient = the fractional impact of trading the whole bar's volume)
+        struct SquareRootImpact {
+            double coefficient = 0.1;
+            double operator()(const FillContext& c) const {
+                if (!c.bar.has_volume || c.bar.volume <= 0.0) return 0.0;
+                return c.price * coefficient * std::sqrt(c.quantity / c.bar.volume);
+            }
+        };
+
+        // --- Commission ---
+        struct PerShareCommission {
+            double per_share = 0.005;
+            double minimum = 1.0;
+            double operator()(double quantity, double) const { return std::max(minimum, std::abs(quantity) * per_share); }
+        };
+        struct BpsCommission {
+            double bps = 1.0;
+            double minimum = 0.0;
+            double operator()(double quantity, double price) const { return std::max(minimum, std::abs(quantity) * price * bps * 1e-4); }
+        };
+
+        // --- Runtime-configurable (sweeps) ---
+        // Sum of every slippage model above; zeroed terms drop out
+        struct ConfigurableSlippage {
+            double per_unit = 0.0;
+            double bps = 0.0;
+            double spread_fraction = 0.0;
+            double impact_coefficient = 0.0;
+            double operator()(const FillContext& c) const {
+                double slip = per_unit + c.price * bps * 1e-4 + spread_fraction * 0.5 * (c.bar.high - c.bar.low);
+                if (impact_coefficient != 0.0 && c.bar.has_volume && c.bar.volume > 0.0) {
+                    slip += c.price * impact_coefficient * std::sqrt(c.quantity / c.bar.volume);
+                }
+                return slip;
+            }
+        };
+        struct ConfigurableCommission {
+            double per_share = 0.0;
+            double bps = 0.0;
+            double minimum = 0.0;
+            double operator()(double quantity, double price) const {
+                return std::max(minimum, std::abs(quantity) * (per_share + price * bps * 1e-4));
+            }
+        };
+        struct ConfigurablePrice {
+            enum class Reference { CLOSE, OPEN, MID_RANGE };
+            Reference reference = Reference::CLOSE;
+            double operator()(const BarQuote& bar) const {
+                switch (reference) {
+                    case Reference::OPEN: return bar.open;
+                    case Reference::MID_RANGE: return 0.5 * (bar.high + bar.low);
+                    case Reference::CLOSE: break;
+                }
+                return bar.close;
+            }
+        };
+
+    } // namespace ExecutionPolicies
+
+} // namespace Backtester
@@ -1,18 +1,218 @@
 #pragma once
+#include <algorithm>
 #include <vector>
+#include <chrono>
 #include <stdexcept>
-#include <optional> // For optional return if order doesn't fill
 #include "../common/Event.h"
 #include "../common/OrderRequest.h"
 #include "../common/FillEvent.h" // Needs FillDetails
+#include "../common/Serialization.h" // Checkpoint hooks
+#include "../common/Logger.h" // BT_LOG_* macros (execution templates below)
+#include "../common/RunContext.h" // Per-run fill ids
+#include "ExecutionPolicies.h"
+#include "RestingOrderBook.h"
 
 namespace Backtester {
+    // Executes orders with the default cost model: market orders at the close plus one cent
+    // of slippage, commission $0.005/share with a $1 minimum. PolicyExecutionSimulator
+    // (below) swaps in other fill-price, slippage and commission policies.
     class ExecutionSimulator {
     public:
         virtual ~ExecutionSimulator() = default;
-        // Changed return type to optional for unfilled orders
-        virtual std::optional<Common::FillDetails> simulate_order(
+        // Returns whether the order filled, writing the fill to 'fill' field by field (a reused
+        // FillDetails keeps its symbol's storage, so routing an order allocates nothing).
+        // fill_timestamp is the event time of the bar the order executes against
+        virtual bool simulate_order(
             const Common::OrderRequest& order,
-            const Common::DataSnapshot& current_market_data); // Define in .cpp
+            const Common::DataSnapshot& current_market_data,
+            std::chrono::system_clock::time_point fill_timestamp,
+            Common::FillDetails& fill); // Define in .cpp
+
+        // --- Resting orders ---
+        // A LIMIT order that is not marketable when routed, or a STOP order whose stop has not
+        // traded, rests in the simulator's RestingOrderBook instead of being dropped. on_bar()
+        // executes the resting orders each new bar reaches (appending their fills to 'fills');
+        // the Backtester calls it for every bar while orders rest.
+        virtual void on_bar(const Common::MarketEvent& event, std::vector<Common::FillDetails>& fills); // Define in .cpp
+        bool has_resting_orders() const { return !resting_orders_.empty(); }
+        bool cancel_order(long long order_id) { return resting_orders_.cancel(order_id); }
+        bool replace_order(long long order_id, double new_price, double new_quantity) {
+            return resting_orders_.replace(order_id, new_price, new_quantity);
+        }
+        RestingOrderBook& resting_orders() { return resting_orders_; }
+        const RestingOrderBook& resting_orders() const { return resting_orders_; }
+
+        // Fills are numbered from 'context' (not owned; the Backtester binds its own). Without
+        // one the simulator numbers them from a context of its own.
+        void set_run_context(Common::RunContext* context) { run_context_ = context; }
+        Common::RunContext& get_run_context() { return run_context_ ? *run_context_ : own_run_context_; }
+
+        // Checkpoint hooks: the resting orders (the participation rate is configuration)
+        virtual void serialize(Common::BinaryWriter& writer) const { resting_orders_.serialize(writer); }
+        virtual void deserialize(Common::BinaryReader& reader) { resting_orders_.deserialize(reader); }
+
+    protected:
+        // The order paths shared by every cost model; the policies are inlined into each
+        // instantiation (see ExecutionPolicies.h)
+        template <class FillPrice, class Slippage, class Commission>
+        bool execute_order(const Common::OrderRequest& order, const BarQuote& bar,
+                           std::chrono::system_clock::time_point fill_timestamp,
+                           const FillPrice& fill_price_policy, const Slippage& slippage,
+                           const Commission& commission_policy, Common::FillDetails& fill);
+        template <class Slippage, class Commission>
+        void execute_resting_orders(const Common::MarketEvent& event, std::vector<Common::FillDetails>& fills,
+                                    const Slippage& slippage, const Commission& commission_policy);
+
+    private:
+        RestingOrderBook resting_orders_;
+        std::vector<BookExecution> executions_; // Scratch for on_bar
+        Common::RunContext* run_context_ = nullptr;
+        Common::RunContext own_run_context_;
+
+        template <class Slippage>
+        static double slipped(const BarQuote& bar, Common::OrderDirection direction, double quantity, double price,
+                              const Slippage& slippage) {
+            // Buy higher, sell lower; never negative
+            const double slip = slippage(FillContext{bar, direction, quantity, price});
+            return std::max(0.0, direction == Common::OrderDirection::BUY ? price + slip : price - slip);
+        }
+    };
+
+    // ExecutionSimulator over compile-time policies: the cost model inlines into the order path
+    // and the policies' parameters can be changed between runs (slippage(), commission()).
+    template <class FillPrice = ExecutionPolicies::ClosePrice,
+              class Slippage = ExecutionPolicies::FixedCents,
+              class Commission = ExecutionPolicies::PerShareCommission>
+    class PolicyExecutionSimulator : public ExecutionSimulator {
+    public:
+        PolicyExecutionSimulator() = default;
+        PolicyExecutionSimulator(FillPrice fill_price, Slippage slippage, Commission commission)
+            : fill_price_(fill_price), slippage_(slippage), commission_(commission) {}
+
+        bool simulate_order(
+            const Common::OrderRequest& order,
+            const Common::DataSnapshot& current_market_data,
+            std::chrono::system_clock::time_point fill_timestamp,
+            Common::FillDetails& fill) final {
+            return execute_order(order, BarQuote::from(current_market_data), fill_timestamp, fill_price_, slippage_, commission_, fill);
+        }
+        void on_bar(const Common::MarketEvent& event, std::vector<Common::FillDetails>& fills) final {
+            if (!has_resting_orders()) return;
+            execute_resting_orders(event, fills, slippage_, commission_);
+        }
+
+        FillPrice& fill_price() { return fill_price_; }
+        Slippage& slippage() { return slippage_; }
+        Commission& commission() { return commission_; }
+
+    private:
+        FillPrice fill_price_;
+        Slippage slippage_;
+        Commission commission_;
     };
-}
\ No newline at end of file
+
+    // Every cost parameter set at run time, for sweeps over cost assumptions
+    using SweepExecutionSimulator = PolicyExecutionSimulator<ExecutionPolicies::ConfigurablePrice,
+                                                             ExecutionPolicies::ConfigurableSlippage,
+                                                             ExecutionPolicies::ConfigurableCommission>;
+
+    // --- Execution templates ---
+    template <class FillPrice, class Slippage, class Commission>
+    bool ExecutionSimulator::execute_order(
+        const Common::OrderRequest& order, const BarQuote& bar, std::chrono::system_clock::time_point fill_timestamp,
+        const FillPrice& fill_price_policy, const Slippage& slippage, const Commission& commission_policy,
+        Common::FillDetails& fill)
+    {
+        if (!bar.valid) {
+            BT_LOG_ERROR("ExecutionSimulator Error: Market data missing 'Close' price for {}", order.symbol);
+            return false; // Cannot simulate without price
+        }
+        const double market_price = bar.close; // Limit and stop orders are checked against the close
+
+        // --- Determine Fill Price ---
+        double fill_price = 0.0;
+        if (order.order_type == Common::OrderType::MARKET) {
+            fill_price = slipped(bar, order.direction, order.quantity, fill_price_policy(bar), slippage);
+
+        } else if (order.order_type == Common::OrderType::LIMIT) {
+            if (!order.limit_price.has_value()) {
+                 BT_LOG_ERROR("ExecutionSimulator Error: Limit order for {} has no limit price.", order.symbol);
+                 return false;
+            }
+            double limit = order.limit_price.value();
+            // Marketable limits fill at the limit price (no slippage)
+            bool marketable = (order.direction == Common::OrderDirection::BUY) ? market_price <= limit : market_price >= limit;
+            if (!marketable) {
+                // Rest until a later bar reaches the limit
+                if (!resting_orders_.add(order)) return false;
+                BT_LOG_INFO("ExecutionSimulator Info: Limit order {} for {} resting (Market: {}, Limit: {})",
+                            order.order_id, order.symbol, market_price, limit);
+                return false;
+            }
+            fill_price = limit;
+
+        } else if (order.order_type == Common::OrderType::STOP) {
+            if (!order.stop_price.has_value()) {
+                 BT_LOG_ERROR("ExecutionSimulator Error: Stop order for {} has no stop price.", order.symbol);
+                 return false;
+            }
+            double stop = order.stop_price.value();
+            bool triggered = (order.direction == Common::OrderDirection::BUY) ? market_price >= stop : market_price <= stop;
+            if (!triggered) {
+                if (!resting_orders_.add(order)) return false;
+                BT_LOG_INFO("ExecutionSimulator Info: Stop order {} for {} resting (Market: {}, Stop: {})",
+                            order.order_id, order.symbol, market_price, stop);
+                return false;
+            }
+            fill_price = slipped(bar, order.direction, order.quantity, fill_price_policy(bar), slippage); // Now a market order
+
+        } else {
+            BT_LOG_ERROR("ExecutionSimulator Error: Unsupported order type for {}", order.symbol);
+            return false;
+        }
+
+        const double commission = commission_policy(order.quantity, fill_price);
+        BT_LOG_INFO("ExecutionSimulator: Simulating fill for OrderID {} ({} {} {}) at price {} (Market was {}), Comm: {}",
+                    order.order_id, Common::to_string(order.direction), order.quantity, order.symbol,
+                    fill_price, market_price, commission);
+
+        // Stamped with the event time of the bar the order executed against (passed by the Backtester)
+        fill.fill_id = get_run_context().next_fill_id();
+        fill.timestamp = fill_timestamp;
+        fill.order_id = order.order_id;
+        fill.symbol.assign(order.symbol);
+        fill.direction = order.direction;
+        fill.quantity = order.quantity; // Assume full fill
+        fill.fill_price = fill_price;
+        fill.commission = commission;
+        return true;
+    }
+
+    template <class Slippage, class Commission>
+    void ExecutionSimulator::execute_resting_orders(const Common::MarketEvent& event, std::vector<Common::FillDetails>& fills,
+                                                    const Slippage& slippage, const Commission& commission_policy) {
+        const BarQuote bar = BarQuote::from(event.marketData);
+        if (!bar.valid) return; // Nothing to match against
+        executions_.clear();
+        resting_orders_.match(event.symbol, bar, executions_);
+        // The minimum is charged once per order: the first partial fill pays at least the
+        // minimum, later ones what they add to the order's accrued commission above it
+        Commission uncapped = commission_policy;
+        uncapped.minimum = 0.0;
+        const double minimum = commission_policy.minimum;
+        for (const BookExecution& execution : executions_) {
+            const double fill_price = execution.market
+                ? slipped(bar, execution.direction, execution.quantity, execution.price, slippage)
+                : execution.price;
+            const double accrued = execution.commission.value_or(0.0) + uncapped(execution.quantity, fill_price);
+            const double commission = std::max(minimum, accrued) -
+                                      (execution.commission ? std::max(minimum, *execution.commission) : 0.0);
+            resting_orders_.set_commission(execution.order_id, accrued); // No-op once the order has filled
+            BT_LOG_INFO("ExecutionSimulator: Resting OrderID {} filled {} {} {} at price {} (Bar {}-{}), Comm: {}",
+                        execution.order_id, Common::to_string(execution.direction), execution.quantity, event.symbol,
+                        fill_price, bar.low, bar.high, commission);
+            fills.emplace_back(get_run_context().next_fill_id(), event.timestamp, execution.order_id, event.symbol,
+                               execution.direction, execution.quantity, fill_price, commission);
+        }
+    }
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <utility>
+
+#include "../common/LatencyHistogram.h"
+
+namespace Backtester {
+
+    // Stages of one Backtester::run iteration that are timed separately
+    enum class Stage : size_t {
+        GET_NEXT_BAR = 0,      // DataManager::get_next_bar
+        UPDATE_MARKET_VALUE,   // Latest-price cache + Portfolio::update_market_value
+        STRATEGY,              // StrategyBase::handle_market_event
+        ORDER_ROUTING,         // Execution simulation + fills (only bars that raised orders)
+        CHECKPOINT,            // Periodic save_checkpoint
+        COUNT
+    };
+    const char* to_string(Stage stage);
+
+    // Per-stage latency histograms for one run (or several merged runs) of one strategy.
+    // Samples are raw Common::CycleClock ticks; the tick length is calibrated against
+    // steady_clock between begin() and end(), so TSC timing needs no separate calibration pass.
+    class LatencyProfile {
+    public:
+        LatencyProfile() = default;
+        explicit LatencyProfile(std::string label) : label_(std::move(label)) {}
+
+        void set_label(std::string label) { label_ = std::move(label); }
+        const std::string& get_label() const { return label_; }
+
+        // Bracket the measured interval (called by Backtester::run)
+        void begin();
+        void end();
+
+        // Records the time since 'since' into 'stage' and returns the current tick
+        std::uint64_t lap(Stage stage, std::uint64_t since) {
+            std::uint64_t now = Common::CycleClock::now();
+            histograms_[static_cast<size_t>(stage)].record(now - since);
+            return now;
+        }
+
+        const Common::LatencyHistogram& get_histogram(Stage stage) const { return histograms_[static_cast<size_t>(stage)]; }
+        double ns_per_tick() const;
+        double to_ns(std::uint64_t ticks) const { return static_cast<double>(ticks) * ns_per_tick(); }
+
+        void merge(const LatencyProfile& other);
+        void reset();
+
+        // Table of count / mean / p50 / p99 / p99.9 / max per stage
+        void print(std::ostream& out) const;
+        // {"label":..., "ns_per_tick":..., "stages":{"get_next_bar":{"count":..., "p50_ns":..., ...}, ...}}
+        std::string to_json() const;
+        // Throws std::runtime_error if the file cannot be written
+        void write_json(const std::string& path) const;
+
+    private:
+        std::string label_ = "strategy";
+        std::array<Common::LatencyHistogram, static_cast<size_t>(Stage::COUNT)> histograms_;
+        // Calibration: total ticks vs. wall nanoseconds over all begin()/end() intervals
+        std::uint64_t calibration_ticks_ = 0;
+        std::int64_t calibration_ns_ = 0;
+        std::uint64_t begin_ticks_ = 0;
+        std::chrono::steady_clock::time_point begin_time_;
+    };
+
+} // namespace Backtester
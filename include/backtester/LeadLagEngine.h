@@ -0,0 +1,121 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../common/Event.h"
+#include "../common/RunArena.h"
+#include "../common/Serialization.h"
+#include "StepAligner.h"
+#include "CrossSection.h"
+
+namespace Backtester {
+
+    // --- Universe-wide lead-lag engine ---
+    // Rolling cross-correlations between every ordered pair of symbols in a universe, at every
+    // lag 1..max_lag, maintained incrementally from one return stream per symbol:
+    //
+    //   corr(leader -> lagger, k) = correlation over the last 'window' steps t of
+    //                               (leader return at t - k, lagger return at t)
+    //
+    // A step is one timestamp (see StepAligner): a symbol without a bar in a step contributes
+    // a zero return.
+    //
+    // Per step the engine adds the newest products and drops the oldest: O(N^2 * max_lag)
+    // multiply-adds over the universe, laid out [leader][lag][lagger] so the inner loop runs
+    // over contiguous laggers as one Common::Simd window kernel per (leader, lag); leaders with
+    // zero returns at both ends of a lag are skipped. The running sums are re-derived from the
+    // stored returns once every kResyncWindows windows (as the rolling operators in
+    // RollingStats.h do). best_leaders() ranks all N * max_lag candidate leads of a symbol.
+    //
+    // Strategies subscribe() to the pairs they trade and forward their bars to on_bar() (or
+    // whole slices to on_slice()): bars already recorded are ignored, so several strategies can
+    // share one engine over the same event stream.
+    class LeadLagEngine {
+    public:
+        LeadLagEngine(std::vector<std::string> universe, size_t window, size_t max_lag,
+                      std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+        // A (leader, lagger, lag) triple resolved to symbol ids once, for O(1) reads
+        struct Subscription {
+            size_t leader = 0;
+            size_t lagger = 0;
+            size_t lag = 1;
+        };
+        // Throws std::invalid_argument for a symbol outside the universe or a lag outside 1..max_lag
+        Subscription subscribe(std::string_view leader, std::string_view lagger, size_t lag) const;
+
+        // Records the bar's close; true when the bar completed a step (including when it is a
+        // repeat of the bar that did, so every subscriber sees the step). Bars for symbols
+        // outside the universe, without a close, or older than the open step are ignored.
+        bool on_bar(const Common::MarketEvent& event);
+        // Slice delivery: records every bar of 'slice' as on_bar would, reading its close
+        // column; true when one of them completed a step
+        bool on_slice(const CrossSection& slice);
+        // Closes the open step (e.g. at the end of the data); true if there was one
+        bool flush();
+        void reset();
+
+        // --- Queries (as of the last completed step) ---
+        std::uint64_t steps() const { return steps_; }
+        // True once 'window' (return at t - lag, return at t) pairs have been seen
+        bool ready(size_t lag) const { return steps_ >= window_ + lag; }
+        // Pearson correlation; 0 while either side of the window is flat
+        double correlation(size_t leader, size_t lagger, size_t lag) const;
+        double correlation(const Subscription& s) const { return correlation(s.leader, s.lagger, s.lag); }
+        // The return of 'symbol' 'lag' steps before the last one (lag 0: the last step's)
+        double lagged_return(size_t symbol, size_t lag) const;
+        double lagged_return(const Subscription& s) const { return lagged_return(s.leader, s.lag); }
+
+        struct Lead {
+            size_t leader;
+            size_t lag;
+            double correlation;
+        };
+        // The 'count' strongest leads (by |correlation|) of 'lagger' over every other symbol and lag
+        std::vector<Lead> best_leaders(size_t lagger, size_t count) const;
+
+        // --- Universe ---
+        size_t size() const { return symbols_.size(); }
+        size_t window() const { return window_; }
+        size_t max_lag() const { return max_lag_; }
+        const std::string& symbol(size_t id) const { return symbols_.at(id); }
+        // Id of 'symbol', or size() if it is not in the universe
+        size_t symbol_id(std::string_view symbol) const;
+
+        void serialize(Common::BinaryWriter& writer) const;
+        void deserialize(Common::BinaryReader& reader);
+
+    private:
+        std::vector<std::string> symbols_;
+        Common::SymbolMap<size_t> ids_;
+        size_t window_;
+        size_t max_lag_;
+        size_t rows_;               // Ring of per-step return rows: power of two > window + max_lag
+        std::uint64_t steps_ = 0;   // Completed steps; row t lives at slot t & (rows_ - 1)
+        std::uint64_t since_resync_ = 0;
+
+        std::pmr::vector<double> returns_;    // [row][symbol]
+        std::pmr::vector<double> sum_;        // [lag 0..max_lag][symbol]: sum of returns over the window shifted by lag
+        std::pmr::vector<double> sum_sq_;     // [lag 0..max_lag][symbol]
+        std::pmr::vector<double> cross_;      // [leader][lag - 1][lagger]: sum of leader(t - lag) * lagger(t)
+
+        StepAligner aligner_;
+        SliceIdMap slice_ids_; // Slice id -> symbol id (size() outside the universe)
+        std::pmr::vector<double> previous_close_; // Close as of the last completed step
+
+        const double* row(std::uint64_t t) const { return returns_.data() + (t & (rows_ - 1)) * symbols_.size(); }
+        double* row(std::uint64_t t) { return returns_.data() + (t & (rows_ - 1)) * symbols_.size(); }
+        double* cross(size_t leader, size_t lag) { return cross_.data() + (leader * max_lag_ + (lag - 1)) * symbols_.size(); }
+        const double* cross(size_t leader, size_t lag) const {
+            return cross_.data() + (leader * max_lag_ + (lag - 1)) * symbols_.size();
+        }
+
+        void close_step();
+        void resync();
+    };
+
+} // namespace Backtester
@@ -0,0 +1,53 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+namespace Backtester {
+
+    // One latency distribution (see OrderLatencyModel)
+    struct LatencyDistribution {
+        enum class Kind {
+            NONE,       // Orders execute on the bar that raised them
+            FIXED,      // Always 'a'
+            UNIFORM,    // Uniform in [a, b]
+            LOGNORMAL   // Median 'a', log-space standard deviation 'sigma' (heavy right tail)
+        };
+        Kind kind = Kind::NONE;
+        std::chrono::nanoseconds a{0};
+        std::chrono::nanoseconds b{0};
+        double sigma = 0.0;
+
+        static LatencyDistribution none() { return {}; }
+        static LatencyDistribution fixed(std::chrono::nanoseconds delay);
+        static LatencyDistribution uniform(std::chrono::nanoseconds min, std::chrono::nanoseconds max);
+        static LatencyDistribution lognormal(std::chrono::nanoseconds median, double sigma);
+        // "none", "fixed:DUR", "uniform:DUR:DUR" or "lognormal:DUR:SIGMA"; DUR is a number with
+        // an ns/us/ms/s suffix (no suffix: microseconds). Throws std::invalid_argument.
+        static LatencyDistribution parse(const std::string& spec);
+    };
+
+    // Delay between a strategy raising an order and the order reaching the ExecutionSimulator.
+    // A default distribution applies to every symbol without its own. Samples are a pure
+    // function of (seed, draw), where the caller numbers its draws (the Backtester mixes the
+    // count of orders scheduled in the run with the run's seed), so a run -- and a run resumed
+    // from a checkpoint -- draws the same delays every time without any generator state to save.
+    class OrderLatencyModel {
+    public:
+        OrderLatencyModel() = default;
+        explicit OrderLatencyModel(LatencyDistribution default_latency, std::uint64_t seed = 1)
+            : default_(default_latency), seed_(seed) {}
+
+        void set_symbol_latency(const std::string& symbol, LatencyDistribution latency) { per_symbol_[symbol] = latency; }
+        // false when every distribution is NONE (orders are routed on the bar that raised them)
+        bool enabled() const;
+        std::chrono::nanoseconds sample(const std::string& symbol, std::uint64_t draw) const;
+
+    private:
+        LatencyDistribution default_;
+        std::unordered_map<std::string, LatencyDistribution> per_symbol_;
+        std::uint64_t seed_ = 1;
+    };
+
+} // namespace Backtester
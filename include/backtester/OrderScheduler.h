@@ -0,0 +1,78 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <memory_resource>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../common/OrderRequest.h"
+#include "../common/Serialization.h"
+
+namespace Backtester {
+
+    // --- Delayed order scheduler ---
+    // Orders in flight between the strategy and the ExecutionSimulator, keyed by the event time
+    // at which they arrive. An order executes against the first bar of its own symbol stamped
+    // at or after its arrival, so delayed orders price against the correct later bar.
+    //
+    // In-flight orders sit in a 4-ary min-heap of (arrival, sequence, slot) entries -- 24
+    // bytes each, with the orders themselves in a slot array reused through a free list -- so
+    // scheduling or releasing an order is O(log n) and millions can be in flight. Equal
+    // arrival times keep submission order. Cancelled orders are dropped lazily when their
+    // entry surfaces. Once due, orders wait in a per-symbol queue for that symbol's next bar.
+    class OrderScheduler {
+    public:
+        explicit OrderScheduler(std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+        void schedule(const Common::OrderRequest& order, std::chrono::system_clock::time_point arrival);
+        // Moves every order due by 'now' to its symbol's queue, then appends the queued orders
+        // for 'symbol' to 'out' (in arrival order) and removes them
+        void release(const std::string& symbol, std::chrono::system_clock::time_point now,
+                     std::pmr::vector<Common::OrderRequest>& out) {
+            if (live_ == 0) return;
+            release_slow(symbol, now, out);
+        }
+
+        // Amend an order still in flight (or due but not yet executed); false if there is none
+        bool cancel(long long order_id);
+        bool replace(long long order_id, double new_price, double new_quantity);
+
+        bool empty() const { return live_ == 0; }
+        size_t in_flight() const { return live_; }
+        // Orders scheduled so far this run (restored by deserialize)
+        std::uint64_t scheduled() const { return sequence_; }
+        void clear();
+
+        void serialize(Common::BinaryWriter& writer) const;
+        void deserialize(Common::BinaryReader& reader);
+
+    private:
+        struct HeapEntry {
+            std::int64_t arrival_ns;
+            std::uint64_t sequence;
+            std::uint32_t slot;
+        };
+        static bool earlier(const HeapEntry& x, const HeapEntry& y) {
+            return x.arrival_ns != y.arrival_ns ? x.arrival_ns < y.arrival_ns : x.sequence < y.sequence;
+        }
+
+        std::pmr::vector<HeapEntry> heap_; // 4-ary min-heap: half the depth of a binary one, siblings share cache lines
+        std::pmr::vector<Common::OrderRequest> slots_;
+        std::pmr::vector<std::uint8_t> slot_live_;     // 0: free or cancelled
+        std::pmr::vector<std::uint32_t> free_slots_;
+        std::pmr::unordered_map<long long, std::uint32_t> by_id_; // Live orders
+        std::pmr::unordered_map<std::string, std::pmr::vector<std::uint32_t>> due_; // Per symbol, arrival order
+        size_t due_count_ = 0;   // Slots (live or cancelled) waiting in due_
+        size_t live_ = 0;
+        std::uint64_t sequence_ = 0;
+
+        void release_slow(const std::string& symbol, std::chrono::system_clock::time_point now,
+                          std::pmr::vector<Common::OrderRequest>& out);
+        std::uint32_t acquire_slot(const Common::OrderRequest& order);
+        void free_slot(std::uint32_t slot);
+        void push(std::int64_t arrival_ns, std::uint64_t sequence, std::uint32_t slot);
+        void pop();
+    };
+
+} // namespace Backtester
@@ -0,0 +1,67 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "../common/Event.h"
+
+namespace Backtester {
+
+    struct PairScreenConfig {
+        size_t hedge_window = 390;         // Steps per rolling OLS hedge ratio (a session of minute bars)
+        double max_adf_statistic = -3.34;  // Engle-Granger 5% critical value for two series
+        double max_half_life = 0.0;        // Steps; 0 keeps any reverting pair
+        unsigned threads = 0;              // 0 uses every hardware thread
+    };
+
+    // One screened pair: log(a) = intercept + hedge_ratio * log(b) + residual
+    struct PairCandidate {
+        std::string symbol_a;          // Dependent leg
+        std::string symbol_b;
+        double hedge_ratio = 0.0;      // Full-sample OLS slope
+        double intercept = 0.0;
+        double adf_statistic = 0.0;    // Dickey-Fuller t-statistic of the residual; more negative reverts harder
+        double half_life = 0.0;        // Steps for a residual deviation to halve (infinity if it does not revert)
+        double rolling_hedge_ratio = 0.0;  // Over the last hedge_window steps
+        double hedge_ratio_stddev = 0.0;   // Of the rolling hedge ratio across the sample: drift of the relationship
+        size_t observations = 0;
+    };
+
+    // --- Batch cointegration screen ---
+    // Runs an Engle-Granger test on every pair of a loaded dataset. Bars are aligned into a
+    // panel of log closes, one row per timestamp (as the universe-wide engines step: see
+    // StepAligner), starting once every symbol has a close.
+    //
+    // Every statistic the test needs for every pair comes from three symbol x symbol moment
+    // matrices of the demeaned panel -- levels x levels, lagged levels x differences and
+    // differences x differences -- built in one blocked pass over the panel (symbol row
+    // blocks on a Common::ThreadPool, time tiles sized to stay in cache). A pair's hedge
+    // ratio, residual variance and ADF regression are then O(1) quadratic forms in those
+    // entries instead of a pass over its own residual series. Both regression directions are
+    // tested and the one with the more negative statistic is kept (so the chance of passing a
+    // pair that is not cointegrated is above the nominal 5%: about 9% on independent random
+    // walks). The rolling hedge ratios are one sweep per symbol row over the panel, with the
+    // window updates through the Common::Simd kernels.
+    class PairScreener {
+    public:
+        explicit PairScreener(PairScreenConfig config = {});
+
+        // Replaces the panel with the given time-sorted bars (symbols in name order)
+        void load(const std::vector<Common::MarketEvent>& events);
+
+        size_t symbols() const { return symbols_.size(); }
+        size_t steps() const { return steps_; }
+        const std::string& symbol(size_t id) const { return symbols_.at(id); }
+
+        // Pairs passing the ADF and half-life thresholds, most negative ADF statistic first
+        std::vector<PairCandidate> screen() const;
+
+    private:
+        PairScreenConfig config_;
+        std::vector<std::string> symbols_;
+        size_t steps_ = 0;
+        std::vector<double> log_prices_; // [step][symbol], demeaned per symbol
+        std::vector<double> means_;      // Removed per-symbol mean log price
+    };
+
+} // namespace Backtester
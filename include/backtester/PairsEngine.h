@@ -0,0 +1,121 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../common/Event.h"
+#include "../common/RunArena.h"
+#include "../common/Serialization.h"
+#include "../common/ThreadPool.h"
+#include "StepAligner.h"
+#include "CrossSection.h"
+
+namespace Backtester {
+
+    // --- Universe-wide pairs engine ---
+    // Rolling mean and variance of the log spread log(a) - log(b) over the last 'lookback'
+    // steps for every unordered pair of symbols in a universe, kept incrementally, plus the
+    // PairsTrading entry/exit state machine on each selected pair's z-score.
+    //
+    // Pairs are packed in a triangular layout: pair (a, b), a < b, at
+    // a * (2N - a - 1) / 2 + (b - a - 1), so symbol a's pairs are contiguous and a step's
+    // update is one Common::Simd kernel sweep per row: a windowed Welford replace per pair
+    // (the oldest spread is rebuilt from the stored log prices, so nothing per pair but mean,
+    // M2 and state is kept). Rows are split into blocks of roughly equal pair counts that a
+    // Common::ThreadPool updates in parallel. Statistics are re-derived from the stored log
+    // prices once every kResyncWindows windows, as the RollingStats operators do.
+    //
+    // A step is one timestamp (see StepAligner); statistics start once every symbol has a
+    // close, and a symbol without a bar in a step keeps its last close. crossings() lists the
+    // selected pairs whose state changed in the last step.
+    class PairsEngine {
+    public:
+        // threads: 1 updates on the calling thread, 0 uses every hardware thread
+        PairsEngine(std::vector<std::string> universe, size_t lookback, double entry_z, double exit_z,
+                    unsigned threads = 1, std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+        enum class PairState : std::uint8_t { FLAT, LONG_A_SHORT_B, SHORT_A_LONG_B };
+
+        // --- Pairs ---
+        size_t pairs() const { return mean_.size(); }
+        // Index of the pair of symbols 'a' and 'b' (in either order; they must differ)
+        size_t pair_index(size_t a, size_t b) const;
+        // The pair's symbols, a < b: its spread is log(a) - log(b)
+        std::pair<size_t, size_t> pair_symbols(size_t pair) const;
+        // Marks a pair for crossing detection (by default none are)
+        void select(size_t pair);
+        void select_all();
+        bool selected(size_t pair) const { return selected_[pair] != 0; }
+
+        // Records the bar's close; true when the bar completed a step (see StepAligner)
+        bool on_bar(const Common::MarketEvent& event);
+        // Slice delivery: records every bar of 'slice' as on_bar would, reading its close
+        // column; true when one of them completed a step
+        bool on_slice(const CrossSection& slice);
+        // Closes the open step (e.g. at the end of the data); true if there was one
+        bool flush();
+        void reset();
+
+        // --- Queries (as of the last completed step) ---
+        // True once 'lookback' steps with a close for every symbol have been seen
+        bool ready() const { return filled_ >= lookback_; }
+        double mean(size_t pair) const { return mean_[pair]; }
+        double stddev(size_t pair) const; // Sample standard deviation
+        double spread(size_t pair) const;
+        double zscore(size_t pair) const; // 0 while the spread is flat
+        PairState state(size_t pair) const { return static_cast<PairState>(state_[pair]); }
+
+        struct Crossing {
+            size_t pair;
+            PairState from;
+            PairState to;
+            double zscore;
+        };
+        // Selected pairs whose state changed in the last step, in pair order
+        const std::vector<Crossing>& crossings() const { return crossings_; }
+
+        // --- Universe ---
+        size_t size() const { return symbols_.size(); }
+        size_t lookback() const { return lookback_; }
+        const std::string& symbol(size_t id) const { return symbols_.at(id); }
+        // Id of 'symbol', or size() if it is not in the universe
+        size_t symbol_id(std::string_view symbol) const;
+
+        void serialize(Common::BinaryWriter& writer) const;
+        void deserialize(Common::BinaryReader& reader);
+
+    private:
+        std::vector<std::string> symbols_;
+        Common::SymbolMap<size_t> ids_;
+        size_t lookback_;
+        double entry_z_;
+        double exit_z_;
+        size_t rows_;                 // Ring of per-step log price rows: power of two > lookback
+        std::uint64_t filled_ = 0;    // Rows written; row t lives at slot t & (rows_ - 1)
+        std::uint64_t since_resync_ = 0;
+        StepAligner aligner_;
+        SliceIdMap slice_ids_; // Slice id -> symbol id (size() outside the universe)
+
+        std::pmr::vector<double> log_prices_; // [row][symbol]
+        std::pmr::vector<double> mean_;       // [pair]
+        std::pmr::vector<double> m2_;         // [pair]: sum of squared deviations from mean_
+        std::pmr::vector<std::uint8_t> state_;
+        std::pmr::vector<std::uint8_t> selected_;
+        std::vector<size_t> row_offset_;       // First pair of each symbol's row
+        std::vector<size_t> block_rows_;       // Row boundaries of the parallel blocks
+        std::vector<std::vector<Crossing>> block_crossings_;
+        std::vector<Crossing> crossings_;
+        std::unique_ptr<Common::ThreadPool> pool_;
+
+        const double* row(std::uint64_t t) const { return log_prices_.data() + (t & (rows_ - 1)) * symbols_.size(); }
+        double* row(std::uint64_t t) { return log_prices_.data() + (t & (rows_ - 1)) * symbols_.size(); }
+
+        void close_step();
+        void update_block(size_t block, bool resync);
+        void for_each_block(bool resync);
+    };
+
+} // namespace Backtester
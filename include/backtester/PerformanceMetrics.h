@@ -0,0 +1,93 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+
+#include "../common/Serialization.h"
+
+namespace Backtester {
+
+    // Point-in-time view of the metrics (see PerformanceMetrics::snapshot)
+    struct MetricsSnapshot {
+        double final_equity = 0.0;            // Latest recorded equity
+        double peak_equity = 0.0;             // Highest equity seen (at least the initial capital)
+        double max_drawdown_pct = 0.0;        // Largest peak-to-trough drop, relative to peak_equity
+        double max_drawdown_duration_s = 0.0; // Longest time spent below a previous peak
+        double annualized_return_pct = 0.0;   // Total return scaled to one calendar year (simple, not compounded)
+        double sharpe = 0.0;                  // Annualized mean / stddev of per-point returns
+        double sortino = 0.0;                 // Annualized mean / downside deviation of per-point returns
+        double calmar = 0.0;                  // annualized_return_pct / max_drawdown_pct
+        double turnover = 0.0;                // Traded notional / initial capital
+        double exposure_pct = 0.0;            // Share of the elapsed time with at least one open position
+        double hit_rate_pct = 0.0;            // Winning share of the fills that closed or reduced a position
+        long closed_trades = 0;
+        long winning_trades = 0;
+    };
+
+    // Streaming performance metrics over an equity series.
+    // Each update costs O(1) time and memory, so the summary never needs the equity curve:
+    // drawdown and its duration come from a running peak, Sharpe / Sortino from running
+    // (Welford) moments of the per-point returns, exposure from the time between points.
+    // Points arrive in timestamp order; a point for the timestamp already being recorded
+    // replaces it (several fills and market updates land on one bar), and only the last
+    // value per timestamp enters the statistics.
+    class PerformanceMetrics {
+    public:
+        PerformanceMetrics() : PerformanceMetrics(0.0) {}
+        explicit PerformanceMetrics(double initial_capital) : initial_capital_(initial_capital), peak_(initial_capital) {}
+
+        // 'exposed': whether a position is open from this point until the next one.
+        // Points older than the one being recorded are ignored.
+        void record_equity(std::chrono::system_clock::time_point timestamp, double equity, bool exposed);
+        // A fill of 'notional' value; reduces_position marks fills that closed or reduced a
+        // position, 'realized_pnl' being what they realized net of commission
+        void record_fill(double notional, bool reduces_position, double realized_pnl);
+
+        // Adds another run's fills and exposure (not its equity points) to this one. Used to
+        // combine independently replayed sessions whose points were fed here back to back.
+        void merge_activity(const PerformanceMetrics& other);
+
+        bool empty() const { return !has_pending_; }
+        MetricsSnapshot snapshot() const;
+
+        void serialize(Common::BinaryWriter& writer) const;
+        void deserialize(Common::BinaryReader& reader);
+
+    private:
+        using TimePoint = std::chrono::system_clock::time_point;
+
+        double initial_capital_;
+
+        // Latest point, still open to revision until a later timestamp arrives
+        bool has_pending_ = false;
+        TimePoint pending_time_{};
+        double pending_equity_ = 0.0;
+        bool pending_exposed_ = false;
+
+        // Committed points
+        long points_ = 0;
+        TimePoint first_time_{};
+        TimePoint last_time_{};
+        double last_equity_ = 0.0;
+        bool last_exposed_ = false;
+
+        // Drawdown
+        double peak_;
+        TimePoint peak_time_{};
+        double max_drawdown_ = 0.0;          // Absolute
+        double max_drawdown_duration_s_ = 0.0;
+
+        // Returns (change in equity / initial capital) between consecutive points
+        long returns_ = 0;
+        double return_mean_ = 0.0;
+        double return_m2_ = 0.0;             // Sum of squared deviations from the mean
+        double downside_sum_sq_ = 0.0;       // Sum of squared negative returns
+
+        double exposed_seconds_ = 0.0;
+        double traded_notional_ = 0.0;
+        long closed_trades_ = 0;
+        long winning_trades_ = 0;
+
+        void commit(TimePoint timestamp, double equity, bool exposed);
+    };
+
+} // namespace Backtester
@@ -5,15 +5,21 @@
 #include <unordered_map>
 #include <chrono>
 #include <memory>
+#include <memory_resource>
 #include <numeric>
 #include <iostream>
 #include <optional>
 
 // --- Include necessary COMMON types directly ---
 // These are needed for member variables or parameter/return types in this header
-#include "../common/Position.h"       // Needs full Position definition for positions_ member
+#include "../common/PositionBook.h"   // positions_ member
 #include "../common/FillEvent.h"    // Needs FillDetails for update_fill parameter
-#include "../common/OrderRequest.h" // Needs OrderRequest for generate_order return type
+#include "../common/OrderRequest.h" // Needs OrderRequest for the order queue
+#include "../common/Serialization.h" // BinaryWriter/BinaryReader for checkpoints
+#include "../common/ExactSum.h"      // Running position totals
+#include "../common/RunContext.h"    // Per-run order ids
+#include "PerformanceMetrics.h"          // Streaming metrics over the equity series
+#include "RoundTripStats.h"              // Per-trade statistics
 
 // --- Forward declarations with FULL namespaces ---
 // Use the actual namespace where the types are defined (common)
@@ -25,6 +31,8 @@ namespace Backtester::Common {
 
 namespace Backtester {
 
+    class TradeLedger; // TradeLedger.h
+
     // --- Define StrategyResult Struct (Moved from Portfolio.h in previous answer for clarity) ---
     // This struct is used by main.cpp to collect results. Defining it here avoids
     // main.cpp needing to include Portfolio.h just for this struct.
@@ -36,47 +44,152 @@ namespace Backtester {
         double total_commission = 0.0;
         long num_fills = 0;
         double final_equity = 0.0;
+        // Risk / activity metrics (see PerformanceMetrics)
+        double max_drawdown_duration_s = 0.0;
+        double sharpe = 0.0;
+        double sortino = 0.0;
+        double calmar = 0.0;
+        double turnover = 0.0;
+        double exposure_pct = 0.0;
+        double hit_rate_pct = 0.0;
+        long closed_trades = 0;
+        long winning_trades = 0;
+        RoundTripSummary round_trips; // Completed flat-to-flat trades
+    };
+
+    // How much of the equity curve a Portfolio keeps (the metrics never need it)
+    enum class EquityCurveMode {
+        FULL,        // One point per distinct timestamp
+        DOWNSAMPLED, // At most max_points evenly strided points; the stride doubles as the run grows
+        NONE         // No curve
     };
 
 
     // Manages portfolio state
     class Portfolio {
     public:
-        Portfolio(double initial_capital); // Implementation in .cpp
+        // Positions, the equity curve and the order queue allocate from 'resource' (e.g. a
+        // Common::RunArena that outlives the Portfolio)
+        Portfolio(double initial_capital, std::pmr::memory_resource* resource = std::pmr::get_default_resource()); // Implementation in .cpp
         virtual ~Portfolio() = default;
 
         // Method signatures use fully qualified names
         void update_fill(const Common::FillDetails& fill); // Implementation in .cpp
         void update_market_value(const Common::MarketEvent& event); // Implementation in .cpp
-        std::optional<Common::OrderRequest> generate_order(const Common::SignalEvent& signal_event); // Implementation in .cpp
+        // Queues the order the signal calls for; returns its id, 0 if it needs none
+        long long generate_order(const Common::SignalEvent& signal_event); // Implementation in .cpp
 
         // Accessors
         double get_cash() const { return cash_; }
         double get_initial_capital() const { return initial_capital_; }
-        double get_total_market_value() const; // Implementation in .cpp
-        double get_total_unrealized_pnl() const; // Implementation in .cpp
+        // Totals are maintained incrementally as positions change (rounded once per change): O(1) per call
+        double get_total_market_value() const { return market_value_; }
+        double get_total_unrealized_pnl() const { return unrealized_pnl_; }
         double get_total_realized_pnl() const; // Implementation in .cpp
         double get_equity() const; // Implementation in .cpp
-        const std::unordered_map<std::string, Common::Position>& get_positions() const { return positions_; }
-        Common::Position get_position(const std::string& symbol) const; // Implementation in .cpp
+        // Every symbol ever traded (flat ones included), by SymbolId in first-fill order
+        const Common::PositionBook& get_positions() const { return positions_; }
+        // Non-owning view; a flat, symbol-less view if 'symbol' was never traded
+        Common::PositionView get_position(std::string_view symbol) const { return positions_.view(symbol); }
+        const std::pmr::vector<std::pair<std::chrono::system_clock::time_point, double>>& get_equity_curve() const { return equity_curve_; }
+        // Pre-sizes the equity curve for 'market_updates' more bars so recording it does not
+        // allocate per bar; fills (which may add points) re-extend that headroom as needed.
+        // Only FULL curves grow with the run; the others are sized by set_equity_curve_mode.
+        void reserve_equity_curve(size_t market_updates); // Implementation in .cpp
+        // Call before the run. DOWNSAMPLED requires max_points >= 2.
+        void set_equity_curve_mode(EquityCurveMode mode, size_t max_points = 0); // Implementation in .cpp
+        EquityCurveMode get_equity_curve_mode() const { return equity_curve_mode_; }
+        const PerformanceMetrics& get_performance_metrics() const { return metrics_; }
+        const RoundTripStats& get_round_trips() const { return round_trips_; }
+        // Every later fill is appended to 'ledger' (not owned; nullptr stops recording).
+        // The ledger is output, not state: checkpoints neither save nor restore it.
+        void set_trade_ledger(TradeLedger* ledger) { ledger_ = ledger; }
+        // Orders are numbered from 'context' (not owned; the Backtester binds its own). Without
+        // one the Portfolio numbers them from a context of its own.
+        void set_run_context(Common::RunContext* context) { run_context_ = context; }
+        Common::RunContext& get_run_context() { return run_context_ ? *run_context_ : own_run_context_; }
+
+        // --- Order Routing ---
+        // generate_order also queues the order here; the Backtester drains the queue after
+        // each strategy callback and routes the orders through the ExecutionSimulator.
+        // submit_order queues any order as given (LIMIT and STOP orders rest in the simulator
+        // until a bar reaches them) and returns the id it assigned to it; cancel_order /
+        // replace_order amend a resting order by that id and are applied before the orders
+        // queued with them.
+        long long submit_order(const Common::OrderRequest& order) {
+            Common::OrderRequest& queued = queue_order();
+            queued = order; // Copy-assigned, so the slot's symbol keeps its storage
+            return queued.order_id = get_run_context().next_order_id();
+        }
+        void cancel_order(long long order_id) { pending_amendments_.push_back(Common::OrderAmendment::cancel_order(order_id)); }
+        void replace_order(long long order_id, double new_price, double new_quantity) {
+            pending_amendments_.push_back(Common::OrderAmendment::replace_order(order_id, new_price, new_quantity));
+        }
+        bool has_pending_orders() const { return pending_count_ > 0 || !pending_amendments_.empty(); }
+        // Orders handed over by take_pending_orders
+        class OrderBatch {
+        public:
+            OrderBatch(const Common::OrderRequest* first, size_t count) : first_(first), count_(count) {}
+            const Common::OrderRequest* begin() const { return first_; }
+            const Common::OrderRequest* end() const { return first_ + count_; }
+            size_t size() const { return count_; }
+            bool empty() const { return count_ == 0; }
+        private:
+            const Common::OrderRequest* first_;
+            size_t count_;
+        };
+        // The taken queue is valid until the next take of the same kind; orders queued while
+        // routing it go to the other (recycled) queue, whose slots keep their symbol strings,
+        // so steady state allocates nothing
+        OrderBatch take_pending_orders(); // Implementation in .cpp
+        const std::pmr::vector<Common::OrderAmendment>& take_pending_amendments(); // Implementation in .cpp
 
         // --- Performance Metrics ---
-        // Added these back as they were in the previous correct version
+        // Computed from the streaming PerformanceMetrics: O(1) regardless of run length
         void calculate_and_print_metrics() const; // Declaration
         void print_final_summary() const;         // Declaration
         StrategyResult get_results_summary() const; // Declaration
 
+        // --- Checkpointing ---
+        void serialize(Common::BinaryWriter& writer) const;
+        void deserialize(Common::BinaryReader& reader);
+
 
     private:
         double initial_capital_;
         double cash_;
-        std::unordered_map<std::string, Common::Position> positions_;
+        Common::PositionBook positions_;
         // Added members needed for metrics calculation back
         double total_commission_ = 0.0;
         double realized_pnl_ = 0.0; // Portfolio-level tracking
         long num_fills_ = 0;
-        std::vector<std::pair<std::chrono::system_clock::time_point, double>> equity_curve_;
+        long open_positions_ = 0; // Positions with non-zero quantity
+        // Sums of market_value / unrealized_pnl over positions_, updated by each position's change
+        Common::ExactSum market_value_total_;
+        Common::ExactSum unrealized_pnl_total_;
+        double market_value_ = 0.0;   // market_value_total_.value(), refreshed by update_totals
+        double unrealized_pnl_ = 0.0; // unrealized_pnl_total_.value(), likewise
+        std::pmr::vector<std::pair<std::chrono::system_clock::time_point, double>> equity_curve_;
+        size_t equity_headroom_ = 0; // Market updates still covered by reserve_equity_curve
+        EquityCurveMode equity_curve_mode_ = EquityCurveMode::FULL;
+        size_t equity_curve_max_points_ = 0;  // DOWNSAMPLED only
+        size_t equity_curve_stride_ = 1;      // DOWNSAMPLED: keeps every stride-th timestamp
+        std::uint64_t equity_timestamps_ = 0; // DOWNSAMPLED: distinct timestamps seen
+        std::chrono::system_clock::time_point last_equity_time_{};
+        PerformanceMetrics metrics_;
+        RoundTripStats round_trips_;
+        TradeLedger* ledger_ = nullptr;
+        Common::RunContext* run_context_ = nullptr;
+        Common::RunContext own_run_context_;
+        std::pmr::vector<Common::OrderRequest> pending_orders_; // Slots; the first pending_count_ await execution
+        size_t pending_count_ = 0;
+        std::pmr::vector<Common::OrderAmendment> pending_amendments_; // Cancels / replaces awaiting routing
+        std::pmr::vector<Common::OrderRequest> taken_orders_; // Last take_pending_orders (swapped with pending_orders_)
+        std::pmr::vector<Common::OrderAmendment> taken_amendments_; // Last take_pending_amendments
         void record_equity(const std::chrono::system_clock::time_point& timestamp); // Declaration
+        Common::OrderRequest& queue_order(); // Next free slot of pending_orders_
+        // Folds a position's change (from the given previous values) into the running totals
+        void update_totals(Common::SymbolId id, double previous_market_value, double previous_unrealized_pnl);
 
     }; // End class Portfolio
 
@@ -0,0 +1,108 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "../common/OrderRequest.h"
+#include "../common/Serialization.h"
+#include "ExecutionPolicies.h" // BarQuote
+
+namespace Backtester {
+
+    // A resting order's (partial) execution on a bar, before slippage and commission
+    struct BookExecution {
+        long long order_id;
+        Common::OrderDirection direction;
+        double quantity;
+        double price;       // Limit price (or the open if the bar gapped through it), or the stop's trigger price
+        bool market;        // A triggered stop: executes as a market order (slippage applies)
+        std::optional<double> commission; // Accrued by the order's earlier partial fills, before the
+                                          // minimum; none before its first fill
+    };
+
+    // --- Resting order book ---
+    // LIMIT and STOP orders that could not execute when they were routed rest here until a
+    // later bar's range reaches them. Each symbol keeps four ladders sorted by trigger price
+    // -- buy limits from the highest price down, sell limits from the lowest up, buy stops
+    // from the lowest up, sell stops from the highest down -- so the orders a bar can touch
+    // are always a prefix of each ladder: match() walks those and stops at the first order out
+    // of range. A bar that triggers nothing costs four comparisons however many orders rest;
+    // one that does costs O(log n) per order it executes. Equal prices keep time priority.
+    //
+    // With a participation rate, each bar executes at most rate * bar volume per symbol, in
+    // ladder priority; the rest of an order stays resting at its price (partial fill). Stops
+    // that triggered but found no volume become market orders queued ahead of the ladders
+    // for the next bars.
+    class RestingOrderBook {
+    public:
+        // Fraction of each bar's volume available to resting orders (0 = no cap, full fills)
+        void set_participation_rate(double rate);
+        double get_participation_rate() const { return participation_rate_; }
+
+        // Rests a LIMIT or STOP order with its full quantity. An order without a finite positive
+        // price is rejected with a warning (false). Throws std::invalid_argument for other order
+        // types or a duplicate order id.
+        bool add(const Common::OrderRequest& order);
+        // false if the order is not resting (filled, cancelled or unknown)
+        bool cancel(long long order_id);
+        // New price and remaining quantity (<= 0 cancels). Lowering the quantity at the same
+        // price keeps the order's place in the queue; any other change re-queues it behind
+        // orders at its new price. Triggered stops are already market orders: false.
+        bool replace(long long order_id, double new_price, double new_quantity);
+
+        // Appends the executions 'bar' triggers for 'symbol' to 'out'
+        void match(const std::string& symbol, const BarQuote& bar, std::vector<BookExecution>& out);
+
+        bool empty() const { return index_.empty(); }
+        size_t size() const { return index_.size(); }
+        bool contains(long long order_id) const { return index_.count(order_id) != 0; }
+        // Remaining quantity of a resting order (0 if it is not resting)
+        double remaining_quantity(long long order_id) const;
+        // Records the commission a partially filled order has accrued (see BookExecution)
+        void set_commission(long long order_id, double commission);
+        void clear();
+
+        void serialize(Common::BinaryWriter& writer) const;
+        void deserialize(Common::BinaryReader& reader);
+
+    private:
+        enum Side { BUY_LIMIT, SELL_LIMIT, BUY_STOP, SELL_STOP, TRIGGERED, kSides };
+
+        // Ascending (key, sequence). Descending ladders store the negated price, and the
+        // TRIGGERED queue a constant key, so it is first come, first served.
+        using LadderKey = std::pair<double, std::uint64_t>;
+        struct Entry {
+            long long order_id;
+            Common::OrderDirection direction;
+            double price;
+            double remaining;
+            std::optional<double> commission; // See BookExecution
+        };
+        using Ladder = std::map<LadderKey, Entry>;
+        struct SymbolOrders {
+            std::array<Ladder, kSides> ladders;
+        };
+        struct Locator {
+            SymbolOrders* orders;
+            Side side;
+            Ladder::iterator it;
+        };
+
+        std::unordered_map<std::string, SymbolOrders> symbols_; // Node-based: SymbolOrders never move
+        std::unordered_map<long long, Locator> index_;           // Resting orders by id
+        std::uint64_t sequence_ = 0;
+        double participation_rate_ = 0.0;
+
+        static bool descending(Side side) { return side == BUY_LIMIT || side == SELL_STOP; }
+        LadderKey next_key(Side side, double price) { return {side == TRIGGERED ? 0.0 : (descending(side) ? -price : price), ++sequence_}; }
+        void insert(SymbolOrders& orders, Side side, const Entry& entry);
+        void erase(const Locator& locator);
+    };
+
+} // namespace Backtester
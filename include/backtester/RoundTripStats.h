@@ -0,0 +1,103 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <memory_resource>
+#include <ostream>
+#include <vector>
+
+#include "../common/PositionBook.h" // SymbolId
+#include "../common/Serialization.h"
+
+namespace Backtester {
+
+    // Aggregates over completed round trips (see RoundTripStats::summary)
+    struct RoundTripSummary {
+        long trades = 0;
+        long winners = 0;               // Net P&L > 0
+        double win_pct = 0.0;
+        double avg_pnl = 0.0;           // Net of commission
+        double pnl_stddev = 0.0;
+        double avg_win = 0.0;
+        double avg_loss = 0.0;          // <= 0
+        double best_trade = 0.0;
+        double worst_trade = 0.0;
+        double profit_factor = 0.0;     // Gross wins / |gross losses| (0 without losses)
+        double avg_holding_s = 0.0;
+        double max_holding_s = 0.0;
+        double avg_mae = 0.0;           // Maximum adverse excursion, <= 0
+        double worst_mae = 0.0;
+        double avg_mfe = 0.0;           // Maximum favorable excursion, >= 0
+        double best_mfe = 0.0;
+    };
+
+    // "Round Trips: ..." block of the printed metrics
+    void print_round_trips(std::ostream& out, const RoundTripSummary& summary);
+
+    // Round trips detected online from fills and marks. A trade opens when a position leaves
+    // flat, may scale in and out, and closes when the position returns to flat (a fill that
+    // flips the position closes one trade and opens the next). While it is open its P&L --
+    // realized so far plus the position's unrealized P&L -- is tracked at every mark, giving
+    // its maximum adverse / favorable excursion. Closed trades only update running
+    // aggregates, so each fill or mark costs O(1) and nothing is stored per completed trade.
+    // Trades still open at the end of a run are not in the summary.
+    class RoundTripStats {
+    public:
+        RoundTripStats() = default;
+        explicit RoundTripStats(std::pmr::memory_resource* resource) : open_(resource) {}
+
+        // After a fill on 'id' moved its quantity from previous_quantity to quantity, realized
+        // realized_change (net of commission) and left the position at unrealized_pnl
+        void on_fill(Common::SymbolId id, std::chrono::system_clock::time_point timestamp,
+                     double previous_quantity, double quantity, double realized_change, double unrealized_pnl);
+        // After the position 'id' was marked to unrealized_pnl
+        void on_mark(Common::SymbolId id, double unrealized_pnl) {
+            if (id >= open_.size()) return;
+            OpenTrade& trade = open_[id];
+            if (!trade.open) return;
+            excursion(trade, trade.realized + unrealized_pnl);
+        }
+
+        // Adds another run's completed trades (ShardedBacktester sessions)
+        void merge(const RoundTripStats& other);
+
+        long open_trades() const;
+        RoundTripSummary summary() const;
+
+        void serialize(Common::BinaryWriter& writer) const;
+        void deserialize(Common::BinaryReader& reader);
+
+    private:
+        struct OpenTrade {
+            bool open = false;
+            std::int64_t entry_ns = 0;  // Entry time, ns since the epoch
+            double realized = 0.0;      // Realized so far (scale-outs, commissions)
+            double mae = 0.0;
+            double mfe = 0.0;
+        };
+        std::pmr::vector<OpenTrade> open_; // By SymbolId
+
+        // Completed trades
+        long trades_ = 0;
+        long winners_ = 0;
+        double pnl_mean_ = 0.0;
+        double pnl_m2_ = 0.0;           // Welford: sum of squared deviations from the mean
+        double gross_wins_ = 0.0;
+        double gross_losses_ = 0.0;     // <= 0
+        double best_trade_ = 0.0;
+        double worst_trade_ = 0.0;
+        double holding_s_sum_ = 0.0;
+        double max_holding_s_ = 0.0;
+        double mae_sum_ = 0.0;
+        double worst_mae_ = 0.0;
+        double mfe_sum_ = 0.0;
+        double best_mfe_ = 0.0;
+
+        static void excursion(OpenTrade& trade, double pnl) {
+            if (pnl < trade.mae) trade.mae = pnl;
+            if (pnl > trade.mfe) trade.mfe = pnl;
+        }
+        void open_trade(Common::SymbolId id, std::int64_t entry_ns, double realized, double unrealized_pnl);
+        void close_trade(OpenTrade& trade, std::int64_t exit_ns);
+    };
+
+} // namespace Backtester
@@ -0,0 +1,91 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include <memory_resource>
+#include <string>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <utility>
+
+#include "DataManager.h"
+#include "Strategy.h"
+#include "Portfolio.h"          // For StrategyResult
+#include "LatencyProfile.h"
+#include "OrderLatencyModel.h"
+
+namespace Backtester {
+
+    // Outcome of replaying one trading session in isolation
+    struct SessionResult {
+        std::chrono::system_clock::time_point session_start;
+        std::chrono::system_clock::time_point session_end;
+        long num_bars = 0;
+        double pnl = 0.0;          // Final equity minus initial capital for this session
+        bool ended_flat = true;    // False if the strategy still held positions at the session close
+        StrategyResult result;     // Per-session metrics (as if the session were a full run)
+        PerformanceMetrics metrics; // The session's metric state, merged into the stitched totals
+        RoundTripStats round_trips; // The session's completed trades (copied out of its arena)
+        std::vector<std::pair<std::chrono::system_clock::time_point, double>> equity_curve;
+        LatencyProfile latency_profile; // Stage timings of this session's run
+    };
+
+    // Day-sharded replay for strategies that end every session flat.
+    // The loaded timeline is split at session (calendar day) boundaries; each session runs
+    // on its own thread with a fresh strategy, Portfolio and ExecutionSimulator, and the
+    // per-session P&L is stitched back into one equity curve and one set of metrics.
+    // Each session's state lives in its own Common::RunArena, released when the session ends.
+    class ShardedBacktester {
+    public:
+        // Builds a fresh strategy whose state allocates from the given (session) resource
+        using StrategyFactory = std::function<std::unique_ptr<StrategyBase>(std::pmr::memory_resource*)>;
+
+        // num_threads == 0 uses std::thread::hardware_concurrency().
+        // session_offset shifts the day boundary away from 00:00 UTC (e.g. -5h for US/Eastern).
+        ShardedBacktester(
+            DataManager& dataManager,
+            StrategyFactory strategy_factory,
+            double initial_capital,
+            unsigned num_threads = 0,
+            std::chrono::seconds session_offset = std::chrono::seconds(0)
+        );
+        void run();
+
+        const std::vector<SessionResult>& get_session_results() const { return session_results_; }
+        const std::vector<std::pair<std::chrono::system_clock::time_point, double>>& get_equity_curve() const { return equity_curve_; }
+        StrategyResult get_results_summary() const { return summary_; }
+        // Stage latencies merged over all sessions
+        const LatencyProfile& get_latency_profile() const { return latency_profile_; }
+        void set_latency_label(const std::string& label) { latency_profile_.set_label(label); }
+        // Applied to every session's Backtester (see Backtester::set_order_latency); orders still
+        // in flight when a session ends are dropped with it
+        void set_order_latency(OrderLatencyModel model) { order_latency_ = std::move(model); }
+        // Each session runs with its own RunContext (ids from 1) seeded from 'seed' and the
+        // session's position in the timeline, so a session draws the same delays however the
+        // sessions are scheduled across threads
+        void set_seed(std::uint64_t seed) { seed_ = seed; }
+        // Applied to every session's Backtester (see Backtester::set_slice_delivery)
+        void set_slice_delivery(bool enabled) { slice_delivery_ = enabled; }
+        void print_summary() const;
+
+    private:
+        DataManager& data_manager_;
+        StrategyFactory strategy_factory_;
+        double initial_capital_;
+        unsigned num_threads_;
+        std::chrono::seconds session_offset_;
+        OrderLatencyModel order_latency_;
+        std::uint64_t seed_ = 0;
+        bool slice_delivery_ = false;
+
+        std::vector<SessionResult> session_results_;
+        std::vector<std::pair<std::chrono::system_clock::time_point, double>> equity_curve_;
+        StrategyResult summary_;
+        LatencyProfile latency_profile_;
+
+        std::vector<std::pair<size_t, size_t>> split_sessions(const std::vector<Common::MarketEvent>& events) const;
+        SessionResult run_session(const std::vector<Common::MarketEvent>& events, size_t begin, size_t end) const;
+        void stitch_results();
+    };
+
+} // namespace Backtester
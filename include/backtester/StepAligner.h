@@ -0,0 +1,144 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <memory_resource>
+#include <stdexcept>
+#include <vector>
+
+#include "../common/Event.h"
+#include "../common/Serialization.h"
+
+namespace Backtester {
+
+    // --- Timestamp-aligned steps over a fixed universe ---
+    // Groups the bars of symbols 0..N-1 into steps, one per timestamp, for the universe-wide
+    // engines (LeadLagEngine, PairsEngine). A step closes when every symbol has reported or a
+    // bar with a later timestamp arrives; closes() carries each symbol's last close forward.
+    //
+    // Bars already recorded are ignored, and a repeat of the bar that completed the last step
+    // reports it again, so strategies sharing an engine can all forward the same event stream
+    // and each sees every step.
+    class StepAligner {
+    public:
+        explicit StepAligner(size_t symbols, std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+            : close_(symbols, 0.0, resource), reported_(symbols, 0, resource) {
+            if (symbols == 0) throw std::invalid_argument("StepAligner: empty universe");
+        }
+
+        // Records symbol 'id's close. 'close_step()' runs for every step this bar closes (the
+        // open one when the bar is later, and its own when it is the last to report), with
+        // reported() still describing the closing step. True if a step closed.
+        template <class CloseStep>
+        bool on_bar(size_t id, std::chrono::system_clock::time_point timestamp, double close, CloseStep&& close_step) {
+            if (id == completed_by_ && timestamp == completed_at_) return true;
+            bool completed = false;
+            if (step_open_) {
+                if (timestamp < step_time_) return false; // Behind the open step
+                if (timestamp > step_time_) {
+                    finish(close_step);
+                    completed = true;
+                } else if (reported_[id]) {
+                    return false; // Already recorded
+                }
+            } else if (steps_ > 0 && timestamp <= step_time_) {
+                return false; // Belongs to a step already closed
+            }
+            if (!step_open_) {
+                step_open_ = true;
+                step_time_ = timestamp;
+            }
+            close_[id] = close;
+            reported_[id] = 1;
+            if (++reported_count_ == close_.size()) {
+                finish(close_step);
+                completed = true;
+            }
+            if (completed) {
+                completed_by_ = id;
+                completed_at_ = timestamp;
+            }
+            return completed;
+        }
+        // Closes the open step (e.g. at the end of the data); true if there was one
+        template <class CloseStep>
+        bool flush(CloseStep&& close_step) {
+            if (!step_open_) return false;
+            finish(close_step);
+            return true;
+        }
+
+        // The bar's close ("Close" or "close"); false if it has none
+        static bool close_of(const Common::DataSnapshot& data, double& close) {
+            auto it = data.find("Close");
+            if (it == data.end()) it = data.find("close");
+            if (it == data.end()) return false;
+            close = it->second;
+            return true;
+        }
+
+        size_t size() const { return close_.size(); }
+        std::uint64_t steps() const { return steps_; }
+        // Latest close per symbol (0 until the symbol first reports)
+        const std::pmr::vector<double>& closes() const { return close_; }
+        // Whether 'id' reported in the step being closed (or the open one)
+        bool reported(size_t id) const { return reported_[id] != 0; }
+        std::chrono::system_clock::time_point step_time() const { return step_time_; }
+
+        void reset() {
+            std::fill(close_.begin(), close_.end(), 0.0);
+            std::fill(reported_.begin(), reported_.end(), 0);
+            reported_count_ = 0;
+            step_open_ = false;
+            step_time_ = {};
+            completed_by_ = SIZE_MAX;
+            completed_at_ = {};
+            steps_ = 0;
+        }
+
+        void serialize(Common::BinaryWriter& writer) const {
+            writer.write(close_);
+            writer.write(reported_);
+            writer.write(step_open_);
+            writer.write(step_time_);
+            writer.write(static_cast<std::uint64_t>(completed_by_));
+            writer.write(completed_at_);
+            writer.write(steps_);
+        }
+        void deserialize(Common::BinaryReader& reader) {
+            const size_t symbols = close_.size();
+            reader.read(close_);
+            reader.read(reported_);
+            if (close_.size() != symbols || reported_.size() != symbols) {
+                throw std::runtime_error("StepAligner: checkpoint does not match the universe");
+            }
+            reader.read(step_open_);
+            reader.read(step_time_);
+            completed_by_ = static_cast<size_t>(reader.read<std::uint64_t>());
+            reader.read(completed_at_);
+            reader.read(steps_);
+            reported_count_ = static_cast<size_t>(std::count(reported_.begin(), reported_.end(), 1));
+        }
+
+    private:
+        std::pmr::vector<double> close_;
+        std::pmr::vector<std::uint8_t> reported_;
+        size_t reported_count_ = 0;
+        bool step_open_ = false;
+        std::chrono::system_clock::time_point step_time_{}; // Of the open step, else of the last one
+        // The bar that completed the last step (repeats of it report the step again)
+        size_t completed_by_ = SIZE_MAX;
+        std::chrono::system_clock::time_point completed_at_{};
+        std::uint64_t steps_ = 0;
+
+        template <class CloseStep>
+        void finish(CloseStep& close_step) {
+            close_step();
+            std::fill(reported_.begin(), reported_.end(), 0);
+            reported_count_ = 0;
+            step_open_ = false;
+            ++steps_;
+        }
+    };
+
+} // namespace Backtester
@@ -6,6 +6,9 @@
 
 // Include necessary common types used in the interface
 #include "../common/Event.h" // Needs MarketEvent definition
+#include "../common/Serialization.h" // BinaryWriter/BinaryReader for checkpoint hooks
+#include "CrossSection.h" // Slice passed to handle_slice
+#include <stdexcept>
 
 // Forward declare Portfolio to avoid circular dependency
 namespace Backtester { class Portfolio; }
@@ -22,6 +25,14 @@ namespace Backtester {
         // to potentially generate orders.
         virtual void handle_market_event(const Common::MarketEvent& event, Portfolio& portfolio) = 0;
 
+        // Called instead of handle_market_event when the Backtester runs with slice delivery:
+        // once per timestamp, with every bar of that timestamp (orders raised here are routed
+        // after the whole slice). Multi-symbol strategies override it to read the slice's
+        // columns by symbol id; the default replays the bars in arrival order.
+        virtual void handle_slice(const CrossSection& slice, Portfolio& portfolio) {
+             for (Common::SymbolId id : slice.members()) handle_market_event(slice.bar(id), portfolio);
+        }
+
         // Optional: Method to handle fill events if strategy needs to react to fills
         //           (e.g., update internal state, trailing stops)
         virtual void handle_fill_event(const Common::FillEvent& event, Portfolio& portfolio) {
@@ -30,6 +41,18 @@ namespace Backtester {
              (void)portfolio; // Suppress unused warning
         }
 
+        // Checkpoint hooks: write/restore ALL internal state so a run resumed through
+        // Backtester::load_checkpoint behaves bit-identically to an uninterrupted one.
+        // Stateful strategies must override both; the defaults refuse to checkpoint.
+        virtual void serialize(Common::BinaryWriter& writer) const {
+             (void)writer;
+             throw std::logic_error("Strategy does not support checkpointing (serialize not implemented)");
+        }
+        virtual void deserialize(Common::BinaryReader& reader) {
+             (void)reader;
+             throw std::logic_error("Strategy does not support checkpointing (deserialize not implemented)");
+        }
+
         // Optional: Method to handle signal events (if using a separate signal step)
         // virtual void handle_signal_event(const Common::SignalEvent& event, Portfolio& portfolio) {}
 
@@ -0,0 +1,144 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../common/FillEvent.h"
+#include "../common/PositionBook.h" // SymbolId
+
+namespace Backtester {
+
+    // --- Trade ledger ---
+    // Append-only record of every fill, its order and the position it left behind, kept in
+    // columns (one array per field) of up to block_capacity fills each. Appending a fill is
+    // a store per column into preallocated arrays.
+    //
+    // In memory, full blocks are kept. With spill_to(path), each full block is written to a
+    // binary file and its arrays are reused, so a long run holds one block in memory; after
+    // close(), LedgerReader maps the file and serves its columns in place (no parsing, no
+    // copies; without POSIX mmap the file is read into one buffer). File layout (native byte order):
+    //   header   "BTLEDGR1", u32 version, u32 reserved
+    //   blocks   u64 count, then the columns below in order, the block padded to 8 bytes
+    //   symbols  u64 n, then per symbol: u64 length + bytes
+    //   footer   u64 symbols offset, u64 fills, u64 blocks, "BTLEDEND"
+
+    // One block's columns (row i of every column is one fill)
+    struct LedgerBlock {
+        size_t count = 0;
+        const std::int64_t* timestamp_ns = nullptr;      // Fill time, ns since the epoch
+        const std::int64_t* fill_id = nullptr;
+        const std::int64_t* order_id = nullptr;
+        const double* quantity = nullptr;                // Unsigned; see direction
+        const double* price = nullptr;
+        const double* commission = nullptr;
+        const double* position_quantity = nullptr;       // Signed position after the fill
+        const double* average_entry_price = nullptr;     // ... its average entry price
+        const double* realized_pnl = nullptr;            // ... the position's realized P&L to date
+        const double* cash = nullptr;                    // Portfolio cash after the fill
+        const Common::SymbolId* symbol_id = nullptr;     // Index into the ledger's symbols
+        const std::uint8_t* direction = nullptr;         // Common::OrderDirection
+    };
+
+    // Writes blocks as CSV, one row per fill with a header line; doubles round-trip exactly
+    void write_ledger_csv(std::ostream& out, const std::vector<LedgerBlock>& blocks, const std::vector<std::string>& symbols);
+
+    class TradeLedger {
+    public:
+        static constexpr size_t kDefaultBlockFills = 64 * 1024;
+
+        explicit TradeLedger(size_t block_capacity = kDefaultBlockFills);
+        ~TradeLedger();
+        TradeLedger(const TradeLedger&) = delete;
+        TradeLedger& operator=(const TradeLedger&) = delete;
+
+        // Streams full blocks to 'path' from now on (call before the first append).
+        // Throws std::runtime_error if the file cannot be created.
+        void spill_to(const std::string& path);
+        // Writes the remaining fills and the symbol table and closes the file (no-op when
+        // not spilling). Called by the destructor; call it explicitly to see write errors.
+        void close();
+
+        // 'symbol_id' is the fill's id in the Portfolio's PositionBook; the position fields
+        // describe that position after the fill
+        void append(const Common::FillDetails& fill, Common::SymbolId symbol_id,
+                    double position_quantity, double average_entry_price, double realized_pnl, double cash) {
+            if (current_.count == block_capacity_) flush_block();
+            const size_t i = current_.count++;
+            current_.timestamp_ns[i] = std::chrono::duration_cast<std::chrono::nanoseconds>(fill.timestamp.time_since_epoch()).count();
+            current_.fill_id[i] = fill.fill_id;
+            current_.order_id[i] = fill.order_id;
+            current_.quantity[i] = fill.quantity;
+            current_.price[i] = fill.fill_price;
+            current_.commission[i] = fill.commission;
+            current_.position_quantity[i] = position_quantity;
+            current_.average_entry_price[i] = average_entry_price;
+            current_.realized_pnl[i] = realized_pnl;
+            current_.cash[i] = cash;
+            current_.symbol_id[i] = symbol_id;
+            current_.direction[i] = static_cast<std::uint8_t>(fill.direction);
+            if (symbol_id >= symbols_.size() || symbols_[symbol_id].empty()) register_symbol(symbol_id, fill.symbol);
+            fills_++;
+        }
+
+        size_t size() const { return fills_; }
+        const std::vector<std::string>& symbols() const { return symbols_; }
+        // Fills still held in memory (all of them unless spilling)
+        std::vector<LedgerBlock> blocks() const;
+        void write_csv(std::ostream& out) const { write_ledger_csv(out, blocks(), symbols_); }
+
+    private:
+        struct Columns {
+            size_t count = 0;
+            std::vector<std::int64_t> timestamp_ns, fill_id, order_id;
+            std::vector<double> quantity, price, commission, position_quantity, average_entry_price, realized_pnl, cash;
+            std::vector<Common::SymbolId> symbol_id;
+            std::vector<std::uint8_t> direction;
+
+            explicit Columns(size_t capacity);
+            LedgerBlock view() const;
+        };
+
+        size_t block_capacity_;
+        std::vector<Columns> full_blocks_; // In-memory mode only
+        Columns current_;
+        std::vector<std::string> symbols_;
+        size_t fills_ = 0;
+
+        std::ofstream file_;
+        std::string path_;
+        std::uint64_t blocks_written_ = 0;
+        std::uint64_t bytes_written_ = 0;
+
+        void flush_block();
+        void write_block(const Columns& block);
+        void register_symbol(Common::SymbolId symbol_id, const std::string& symbol);
+    };
+
+    // Read-only, memory-mapped view of a closed ledger file (read into memory where mmap is
+    // unavailable)
+    class LedgerReader {
+    public:
+        // Throws std::runtime_error if the file is missing, truncated or not a ledger
+        explicit LedgerReader(const std::string& path);
+        ~LedgerReader();
+        LedgerReader(const LedgerReader&) = delete;
+        LedgerReader& operator=(const LedgerReader&) = delete;
+
+        size_t size() const { return fills_; }
+        const std::vector<LedgerBlock>& blocks() const { return blocks_; } // Point into the mapping
+        const std::vector<std::string>& symbols() const { return symbols_; }
+        void write_csv(std::ostream& out) const { write_ledger_csv(out, blocks_, symbols_); }
+
+    private:
+        void* mapping_ = nullptr;
+        size_t mapping_size_ = 0;
+        size_t fills_ = 0;
+        std::vector<LedgerBlock> blocks_;
+        std::vector<std::string> symbols_;
+    };
+
+} // namespace Backtester
@@ -0,0 +1,122 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <string>
+#include <variant>
+#include <vector>
+
+#include "../common/Event.h"
+#include "ColumnarData.h"
+#include "ExecutionPolicies.h"
+#include "Portfolio.h" // StrategyResult
+#include "Strategy.h"
+
+namespace Backtester {
+
+    // --- Vectorized strategies ---
+    // Parameters of the built-in strategies the vectorized mode implements; the defaults are
+    // the strategy constructors' own.
+    struct MACrossoverParams {
+        size_t short_window = 5;
+        size_t long_window = 20;
+    };
+    struct VWAPReversionParams {
+        double deviation_multiplier = 2.0;
+    };
+    struct OpeningRangeBreakoutParams {
+        int range_minutes = 30;
+        int session_close_minutes = 24 * 60; // OpeningRangeBreakout::kNoSessionClose
+    };
+    struct MomentumIgnitionParams {
+        size_t price_window = 5;
+        size_t volume_window = 10;
+        double volume_multiplier = 2.0;
+        size_t return_window = 3;
+    };
+    struct PairsTradingParams {
+        std::string symbol_a;
+        std::string symbol_b;
+        size_t lookback = 60;
+        double entry_z = 2.0;
+        double exit_z = 0.5;
+        double hedge_ratio = 1.0; // See PairsTrading::set_hedge_ratio
+    };
+    using VectorStrategy = std::variant<MACrossoverParams, VWAPReversionParams, OpeningRangeBreakoutParams,
+                                        MomentumIgnitionParams, PairsTradingParams>;
+
+    // The event-driven strategy a VectorStrategy reproduces
+    std::unique_ptr<StrategyBase> make_event_strategy(const VectorStrategy& strategy,
+                                                      std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+    // The cost model of a vectorized run: the SweepExecutionSimulator policies, defaulting
+    // to the ExecutionSimulator's (close plus one cent, $0.005/share with a $1 minimum)
+    struct VectorCostModel {
+        ExecutionPolicies::ConfigurablePrice fill_price;
+        ExecutionPolicies::ConfigurableSlippage slippage{0.01};
+        ExecutionPolicies::ConfigurableCommission commission{0.005, 0.0, 1.0};
+    };
+
+    struct VectorFill {
+        size_t event = 0;        // Index of the bar it executed on in the event stream
+        size_t symbol = 0;       // ColumnarData id
+        double quantity = 0.0;   // Signed: buys are positive
+        double price = 0.0;
+        double commission = 0.0;
+    };
+
+    struct VectorRun {
+        StrategyResult result;   // Without round-trip statistics
+        std::vector<VectorFill> fills;
+    };
+
+    // A vectorized run next to the event-driven run of the same strategy on the same events
+    struct CrossCheck {
+        VectorRun vectorized;
+        StrategyResult event_driven;
+        double vectorized_seconds = 0.0;
+        double event_driven_seconds = 0.0;
+        bool matches = false;
+        std::string mismatch; // First difference found (empty when they match)
+    };
+
+    // --- Vectorized research mode ---
+    // Runs a built-in strategy over a whole ColumnarData history at once instead of bar by
+    // bar through StrategyBase::handle_market_event:
+    //
+    //   1. A signal kernel per strategy turns a symbol's columns into its signals: elementwise
+    //      passes over the arrays (typical prices and returns through the Common::Simd
+    //      kernels, crossover and band tests), the rolling windows as array sweeps with the
+    //      strategy's arithmetic (the RollingStats operators', or MomentumIgnition's sums
+    //      taken afresh per window), and the strategy's state machine as a scan
+    //      over the resulting flags. Pairs walk the two legs' bars in event order, as the
+    //      strategy sees them.
+    //   2. The signals become fills as the Portfolio sizes them (a fixed 100 units per
+    //      direction) and the cost model prices them against the symbol's latest bar.
+    //   3. Mark-to-market P&L is one pass per symbol over its closes, position held
+    //      constant between fills, scattered onto the event stream; its running sum is the
+    //      equity curve, streamed into PerformanceMetrics for the summary.
+    //
+    // Signals, fills and the summary match an event-driven Backtester run with the default
+    // Portfolio and an ExecutionSimulator under the same cost model (cross_check() verifies
+    // it); equity agrees to rounding. Orders route immediately: order latency and resting
+    // orders are not modelled.
+    class VectorizedBacktester {
+    public:
+        VectorizedBacktester(const ColumnarData& data, double initial_capital, VectorCostModel costs = {});
+
+        VectorRun run(const VectorStrategy& strategy) const;
+
+        // Runs 'strategy' both ways; 'events' must be the stream the ColumnarData was loaded from
+        CrossCheck cross_check(const VectorStrategy& strategy, const std::vector<Common::MarketEvent>& events) const;
+
+        const ColumnarData& data() const { return data_; }
+
+    private:
+        const ColumnarData& data_;
+        double initial_capital_;
+        VectorCostModel costs_;
+    };
+
+} // namespace Backtester
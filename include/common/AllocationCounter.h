@@ -0,0 +1,26 @@
+#pragma once
+#include <cstdint>
+
+// --- Heap allocation accounting ---
+// Builds configured with -DBACKTESTER_ALLOC_ACCOUNTING=ON define BT_ALLOC_ACCOUNTING and
+// replace the global operator new/delete with versions that count, per thread, every
+// allocation and its size (src/AllocationCounter.cpp). Backtester::run samples the counter
+// around each stage to attribute allocations to stages and bars (see AllocationProfile).
+// In normal builds the counter reads zero and the sampling compiles away.
+namespace Backtester::Common {
+
+    struct AllocationCount {
+        std::uint64_t allocations = 0;
+        std::uint64_t bytes = 0;
+    };
+
+#if defined(BT_ALLOC_ACCOUNTING)
+    inline constexpr bool kAllocationAccounting = true;
+#else
+    inline constexpr bool kAllocationAccounting = false;
+#endif
+
+    // Allocations made by the calling thread since it started (zero without accounting)
+    AllocationCount thread_allocations();
+
+} // namespace Backtester::Common
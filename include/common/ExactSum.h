@@ -0,0 +1,127 @@
+#pragma once
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+namespace Backtester::Common {
+
+    // Running total of doubles that terms can be added to and removed from without any
+    // rounding drift. The exact sum of the live terms is kept as a floating-point expansion
+    // (Shewchuk, "Adaptive Precision Floating-Point Arithmetic"): a few non-overlapping
+    // doubles whose unrounded sum is the true value. value() returns that value rounded
+    // once to the nearest double, so it equals a fresh re-summation of the live terms
+    // wherever that re-summation is itself exact (e.g. two terms), and is never further
+    // from the truth than it. Portfolio uses it for its market value / unrealized P&L
+    // totals; each update costs a few operations regardless of the number of positions.
+    class ExactSum {
+    public:
+        void add(double x) {
+            if (x != 0.0) grow(x);
+        }
+        // Replaces a term previously added as 'old_value' by 'new_value'
+        void update(double old_value, double new_value) {
+            if (old_value == new_value) return;
+            add(-old_value);
+            add(new_value);
+        }
+        void reset() { size_ = 0; }
+
+        // The exact sum, correctly rounded (ties to even)
+        double value() const {
+            if (size_ == 0) return 0.0;
+            if (size_ == 1) return parts_[0];
+            ExactSum rest = *this;
+            rest.compress();
+            double rounded = rest.parts_[--rest.size_]; // Within one ulp of the sum (Compress)
+            // 'rest' holds the exact remainder (sum - rounded); step towards it while it
+            // reaches past half the gap to the neighbouring double
+            while (rest.size_ > 0) {
+                const bool up = rest.parts_[rest.size_ - 1] > 0.0;
+                double neighbour = std::nextafter(rounded, up ? std::numeric_limits<double>::infinity()
+                                                              : -std::numeric_limits<double>::infinity());
+                double gap = neighbour - rounded; // Exact: a power of two
+                ExactSum excess = rest;
+                excess.grow(-gap * 0.5);
+                if (excess.size_ == 0) return is_even(rounded) ? rounded : neighbour;
+                if ((excess.parts_[excess.size_ - 1] > 0.0) != up) return rounded;
+                rest.grow(-gap);
+                rounded = neighbour;
+            }
+            return rounded;
+        }
+
+    private:
+        static constexpr size_t kCapacity = 32;
+        std::array<double, kCapacity> parts_{}; // Non-overlapping, increasing magnitude, no zeros
+        size_t size_ = 0;
+
+        static void two_sum(double a, double b, double& sum, double& error) {
+            sum = a + b;
+            double b_virtual = sum - a;
+            error = (a - (sum - b_virtual)) + (b - b_virtual);
+        }
+        static void fast_two_sum(double a, double b, double& sum, double& error) { // Requires |a| >= |b|
+            sum = a + b;
+            error = b - (sum - a);
+        }
+        static bool is_even(double x) {
+            std::uint64_t bits;
+            std::memcpy(&bits, &x, sizeof(bits));
+            return (bits & 1u) == 0;
+        }
+
+        // Grow-Expansion with zero elimination; may lengthen the expansion by one
+        void grow(double x) {
+            if (size_ == kCapacity) compact();
+            double carry = x;
+            size_t out = 0;
+            for (size_t i = 0; i < size_; ++i) {
+                double part;
+                two_sum(carry, parts_[i], carry, part);
+                if (part != 0.0) parts_[out++] = part;
+            }
+            if (carry != 0.0 || out == 0) parts_[out++] = carry;
+            size_ = out;
+            if (size_ == 1 && parts_[0] == 0.0) size_ = 0;
+        }
+
+        // Compress: same value, shortest form, largest part within one ulp of the total
+        void compress() {
+            if (size_ < 2) return;
+            std::array<double, kCapacity> top_down{};
+            size_t bottom = size_ - 1;
+            double q = parts_[size_ - 1];
+            for (size_t i = size_ - 1; i-- > 0;) {
+                double sum, error;
+                fast_two_sum(q, parts_[i], sum, error);
+                q = sum;
+                if (error != 0.0) { top_down[bottom--] = q; q = error; }
+            }
+            top_down[bottom] = q;
+            size_t out = 0;
+            for (size_t i = bottom + 1; i < size_; ++i) {
+                double sum, error;
+                fast_two_sum(top_down[i], q, sum, error);
+                q = sum;
+                if (error != 0.0) parts_[out++] = error;
+            }
+            parts_[out++] = q;
+            size_ = out;
+        }
+
+        // Keeps room for another term: compressing bounds the length for any realistic spread
+        // of magnitudes; past that the two smallest parts are merged (a last-bit rounding)
+        void compact() {
+            compress();
+            if (size_ == kCapacity) {
+                parts_[1] += parts_[0];
+                for (size_t i = 1; i < size_; ++i) parts_[i - 1] = parts_[i];
+                --size_;
+            }
+        }
+    };
+
+} // namespace Backtester::Common
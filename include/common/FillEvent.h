@@ -1,13 +1,10 @@
 #pragma once
 #include <chrono>
 #include <string>
-#include <atomic>
 #include "OrderTypes.h"
 
 namespace Backtester::Common {
-    inline long long generate_unique_fill_id() { /* ... as provided ... */
-         static std::atomic<long long> id_counter{0}; return ++id_counter;
-     }
+    // Fill ids are per run (RunContext::next_fill_id, drawn by the ExecutionSimulator)
     struct FillDetails {
         std::chrono::time_point<std::chrono::system_clock> timestamp;
         long long fill_id;
@@ -18,9 +15,13 @@ namespace Backtester::Common {
         double fill_price;
         double commission;
 
-        FillDetails(std::chrono::time_point<std::chrono::system_clock> ts, long long original_order_id,
+        FillDetails(long long id, std::chrono::time_point<std::chrono::system_clock> ts, long long original_order_id,
                     std::string sym, OrderDirection dir, double qty, double price, double comm)
-            : timestamp(ts), fill_id(generate_unique_fill_id()), order_id(original_order_id),
+            : timestamp(ts), fill_id(id), order_id(original_order_id),
               symbol(std::move(sym)), direction(dir), quantity(qty), fill_price(price), commission(comm) {}
+        // Without a fill id (0)
+        FillDetails(std::chrono::time_point<std::chrono::system_clock> ts, long long original_order_id,
+                    std::string sym, OrderDirection dir, double qty, double price, double comm)
+            : FillDetails(0, ts, original_order_id, std::move(sym), dir, qty, price, comm) {}
     };
 }
\ No newline at end of file
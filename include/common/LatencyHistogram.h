@@ -0,0 +1,112 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <algorithm>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace Backtester::Common {
+
+    // Cheapest available monotonic tick source: the TSC on x86, steady_clock nanoseconds
+    // elsewhere. Ticks are converted to nanoseconds by the caller (see LatencyProfile),
+    // which calibrates against steady_clock over the measured interval.
+    struct CycleClock {
+        static std::uint64_t now() {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+            return __rdtsc();
+#elif defined(__x86_64__) || defined(__i386__)
+            return __rdtsc();
+#else
+            return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+        }
+    };
+
+    // Log-linear histogram of tick counts (HDR-style): values below 16 get exact buckets,
+    // every power-of-two range above is split into 16 linear sub-buckets, so any recorded
+    // value is reported within 1/16 (6.25%) of its true size. Fixed size, no allocation.
+    class LatencyHistogram {
+    public:
+        static constexpr int kSubBucketBits = 4;
+        static constexpr std::uint64_t kSubBuckets = 1ull << kSubBucketBits;
+        static constexpr size_t kNumBuckets = (64 - kSubBucketBits + 1) * kSubBuckets;
+
+        void record(std::uint64_t value) {
+            ++counts_[bucket_index(value)];
+            ++count_;
+            sum_ += value;
+            min_ = std::min(min_, value);
+            max_ = std::max(max_, value);
+        }
+
+        void merge(const LatencyHistogram& other) {
+            for (size_t i = 0; i < kNumBuckets; ++i) counts_[i] += other.counts_[i];
+            count_ += other.count_;
+            sum_ += other.sum_;
+            min_ = std::min(min_, other.min_);
+            max_ = std::max(max_, other.max_);
+        }
+
+        void reset() { *this = LatencyHistogram(); }
+
+        std::uint64_t count() const { return count_; }
+        std::uint64_t sum() const { return sum_; }
+        std::uint64_t min() const { return count_ ? min_ : 0; }
+        std::uint64_t max() const { return max_; }
+        double mean() const { return count_ ? static_cast<double>(sum_) / static_cast<double>(count_) : 0.0; }
+
+        // Smallest bucket bound covering fraction q (0..1] of the samples, capped at max()
+        std::uint64_t value_at_quantile(double q) const {
+            if (count_ == 0) return 0;
+            q = std::clamp(q, 0.0, 1.0);
+            std::uint64_t rank = static_cast<std::uint64_t>(q * static_cast<double>(count_) + 0.999999);
+            rank = std::clamp<std::uint64_t>(rank, 1, count_);
+            std::uint64_t seen = 0;
+            for (size_t i = 0; i < kNumBuckets; ++i) {
+                seen += counts_[i];
+                if (seen >= rank) return std::min(bucket_upper_bound(i), max_);
+            }
+            return max_;
+        }
+
+    private:
+        std::array<std::uint64_t, kNumBuckets> counts_{};
+        std::uint64_t count_ = 0;
+        std::uint64_t sum_ = 0;
+        std::uint64_t min_ = std::numeric_limits<std::uint64_t>::max();
+        std::uint64_t max_ = 0;
+
+        static int highest_bit(std::uint64_t value) { // value > 0
+#if defined(_MSC_VER)
+            unsigned long index = 0;
+            _BitScanReverse64(&index, value);
+            return static_cast<int>(index);
+#else
+            return 63 - __builtin_clzll(value);
+#endif
+        }
+
+        static size_t bucket_index(std::uint64_t value) {
+            if (value < kSubBuckets) return static_cast<size_t>(value);
+            int shift = highest_bit(value) - kSubBucketBits;
+            std::uint64_t sub = (value >> shift) & (kSubBuckets - 1);
+            return static_cast<size_t>((static_cast<std::uint64_t>(shift) + 1) * kSubBuckets + sub);
+        }
+
+        static std::uint64_t bucket_upper_bound(size_t index) {
+            if (index < kSubBuckets) return index;
+            int shift = static_cast<int>(index / kSubBuckets) - 1;
+            std::uint64_t sub = index % kSubBuckets;
+            std::uint64_t lower = (kSubBuckets + sub) << shift;
+            return lower + ((1ull << shift) - 1);
+        }
+    };
+
+} // namespace Backtester::Common
@@ -0,0 +1,206 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+// --- Asynchronous, leveled logging ---
+// The hot path only encodes its arguments into a per-thread lock-free ring buffer;
+// a background thread does all formatting (including timestamps) and the I/O.
+//
+//   BT_LOG_INFO("CROSSOVER: {} @ {} ShortSMA={:.4f}", symbol, event.timestamp, sma);
+//
+// Placeholders are "{}" or "{:.Nf}" (fixed, N decimals); "{{" and "}}" are literal braces.
+// The format string must be a string literal (only its pointer is stored). Strings are
+// copied inline (truncated to Arg::kInlineChars), so arguments may be temporaries.
+//
+// Compile-time level: statements below BT_LOG_LEVEL expand to nothing, arguments included.
+//   0 = TRACE, 1 = DEBUG, 2 = INFO (default), 3 = WARN, 4 = ERROR, 5 = OFF
+#ifndef BT_LOG_LEVEL
+#define BT_LOG_LEVEL 2
+#endif
+
+namespace Backtester::Log {
+
+    enum class Level : std::uint8_t { TRACE = 0, DEBUG = 1, INFO = 2, WARN = 3, ERROR = 4, OFF = 5 };
+
+    // One encoded log argument
+    struct Arg {
+        enum class Type : std::uint8_t { INT, UINT, DOUBLE, BOOL, STRING, TIME };
+        static constexpr size_t kInlineChars = 38;
+        Type type;
+        std::uint8_t length; // STRING only
+        union {
+            long long i;
+            unsigned long long u;
+            double d;
+            bool b;
+            std::int64_t t;   // TIME: system_clock ticks since epoch
+            char s[kInlineChars];
+        };
+    };
+
+    // One log statement as stored in the ring
+    struct Record {
+        static constexpr size_t kMaxArgs = 10;
+        const char* format;
+        Level level;
+        std::uint8_t num_args;
+        Arg args[kMaxArgs];
+    };
+
+    namespace detail {
+        inline void encode_string(Arg& arg, std::string_view value) {
+            arg.type = Arg::Type::STRING;
+            size_t length = value.size();
+            if (length > Arg::kInlineChars) {
+                length = Arg::kInlineChars;
+                std::memcpy(arg.s, value.data(), length - 1);
+                arg.s[length - 1] = '~'; // Mark truncation
+            } else {
+                std::memcpy(arg.s, value.data(), length);
+            }
+            arg.length = static_cast<std::uint8_t>(length);
+        }
+
+        template <class T>
+        void encode(Arg& arg, const T& value) {
+            if constexpr (std::is_same_v<T, bool>) {
+                arg.type = Arg::Type::BOOL; arg.b = value;
+            } else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+                arg.type = Arg::Type::INT; arg.i = value;
+            } else if constexpr (std::is_integral_v<T>) {
+                arg.type = Arg::Type::UINT; arg.u = value;
+            } else if constexpr (std::is_floating_point_v<T>) {
+                arg.type = Arg::Type::DOUBLE; arg.d = static_cast<double>(value);
+            } else if constexpr (std::is_same_v<T, std::chrono::system_clock::time_point>) {
+                arg.type = Arg::Type::TIME; arg.t = value.time_since_epoch().count();
+            } else if constexpr (std::is_convertible_v<const T&, std::string_view>) {
+                encode_string(arg, std::string_view(value));
+            } else {
+                static_assert(std::is_arithmetic_v<T>, "Unsupported log argument type");
+            }
+        }
+    } // namespace detail
+
+    // Single-producer/single-consumer ring owned by one logging thread
+    class ThreadRing {
+    public:
+        static constexpr std::uint64_t kCapacity = 2048; // Power of two (~850 KB per thread)
+
+        ThreadRing() : slots_(new Record[kCapacity]) {}
+
+        // Producer side
+        Record* try_reserve() {
+            std::uint64_t head = head_.load(std::memory_order_relaxed);
+            if (head - cached_tail_ >= kCapacity) {
+                cached_tail_ = tail_.load(std::memory_order_acquire);
+                if (head - cached_tail_ >= kCapacity) return nullptr;
+            }
+            return &slots_[head & (kCapacity - 1)];
+        }
+        void publish() { head_.store(head_.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+        // Consumer side
+        const Record* front() const {
+            std::uint64_t tail = tail_.load(std::memory_order_relaxed);
+            if (tail == head_.load(std::memory_order_acquire)) return nullptr;
+            return &slots_[tail & (kCapacity - 1)];
+        }
+        void pop() { tail_.store(tail_.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+        bool empty() const { return tail_.load(std::memory_order_acquire) == head_.load(std::memory_order_acquire); }
+
+    private:
+        alignas(64) std::atomic<std::uint64_t> head_{0};
+        std::uint64_t cached_tail_ = 0; // Producer's last view of tail_
+        alignas(64) std::atomic<std::uint64_t> tail_{0};
+        std::unique_ptr<Record[]> slots_;
+    };
+
+    class Logger {
+    public:
+        static Logger& instance();
+
+        bool is_enabled(Level level) const {
+            return static_cast<std::uint8_t>(level) >= runtime_level_.load(std::memory_order_relaxed);
+        }
+
+        template <class... Args>
+        void log(Level level, const char* format, const Args&... args) {
+            static_assert(sizeof...(Args) <= Record::kMaxArgs, "Too many log arguments");
+            ThreadRing& ring = thread_ring();
+            Record* record = ring.try_reserve();
+            while (record == nullptr) { // Ring full: wait for the writer thread (never drop lines)
+                wait_for_space();
+                record = ring.try_reserve();
+            }
+            record->format = format;
+            record->level = level;
+            record->num_args = static_cast<std::uint8_t>(sizeof...(Args));
+            [[maybe_unused]] size_t index = 0;
+            (detail::encode(record->args[index++], args), ...);
+            ring.publish();
+        }
+
+        // Blocks until everything logged before the call has been written and flushed.
+        // Call before printing to std::cout directly to keep output ordered.
+        void flush();
+
+        // Runtime threshold on top of BT_LOG_LEVEL (e.g. Level::OFF for benchmarks)
+        void set_level(Level level) { runtime_level_.store(static_cast<std::uint8_t>(level), std::memory_order_relaxed); }
+        // INFO and below go to 'out', WARN and above to 'err' (defaults: stdout/stderr)
+        void set_output(std::FILE* out, std::FILE* err);
+
+        ~Logger();
+        Logger(const Logger&) = delete;
+        Logger& operator=(const Logger&) = delete;
+
+    private:
+        Logger();
+        struct State;
+        std::unique_ptr<State> state_;
+        std::atomic<std::uint8_t> runtime_level_{static_cast<std::uint8_t>(Level::TRACE)};
+
+        ThreadRing& thread_ring();   // Registers the calling thread on first use
+        void wait_for_space();
+        void writer_loop();
+    };
+
+} // namespace Backtester::Log
+
+#define BT_LOG_IMPL(level, ...)                                                   \
+    do {                                                                          \
+        ::Backtester::Log::Logger& bt_logger_ = ::Backtester::Log::Logger::instance(); \
+        if (bt_logger_.is_enabled(level)) bt_logger_.log(level, __VA_ARGS__);     \
+    } while (0)
+
+#if BT_LOG_LEVEL <= 0
+#define BT_LOG_TRACE(...) BT_LOG_IMPL(::Backtester::Log::Level::TRACE, __VA_ARGS__)
+#else
+#define BT_LOG_TRACE(...) ((void)0)
+#endif
+#if BT_LOG_LEVEL <= 1
+#define BT_LOG_DEBUG(...) BT_LOG_IMPL(::Backtester::Log::Level::DEBUG, __VA_ARGS__)
+#else
+#define BT_LOG_DEBUG(...) ((void)0)
+#endif
+#if BT_LOG_LEVEL <= 2
+#define BT_LOG_INFO(...) BT_LOG_IMPL(::Backtester::Log::Level::INFO, __VA_ARGS__)
+#else
+#define BT_LOG_INFO(...) ((void)0)
+#endif
+#if BT_LOG_LEVEL <= 3
+#define BT_LOG_WARN(...) BT_LOG_IMPL(::Backtester::Log::Level::WARN, __VA_ARGS__)
+#else
+#define BT_LOG_WARN(...) ((void)0)
+#endif
+#if BT_LOG_LEVEL <= 4
+#define BT_LOG_ERROR(...) BT_LOG_IMPL(::Backtester::Log::Level::ERROR, __VA_ARGS__)
+#else
+#define BT_LOG_ERROR(...) ((void)0)
+#endif
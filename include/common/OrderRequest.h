@@ -2,13 +2,11 @@
 #include <chrono>
 #include <string>
 #include <optional>
-#include <atomic>
 #include "OrderTypes.h"
 
 namespace Backtester::Common {
-    inline long long generate_unique_order_id() { /* ... as provided ... */
-        static std::atomic<long long> id_counter{0}; return ++id_counter;
-    }
+    // Order ids are per run (RunContext::next_order_id). The constructors without an id leave
+    // it 0, "unassigned": Portfolio assigns the run's next id when the order is queued.
     struct OrderRequest {
         std::chrono::time_point<std::chrono::system_clock> timestamp;
         long long order_id;
@@ -17,16 +15,44 @@ namespace Backtester::Common {
         OrderDirection direction;
         double quantity;
         std::optional<double> limit_price;
+        std::optional<double> stop_price; // STOP orders
+
 
         // Market Order Constructor
         OrderRequest(std::chrono::time_point<std::chrono::system_clock> ts, std::string sym,
-                     OrderDirection dir, double qty) : timestamp(ts), order_id(generate_unique_order_id()),
+                     OrderDirection dir, double qty) : timestamp(ts), order_id(0),
                      symbol(std::move(sym)), order_type(OrderType::MARKET), direction(dir),
                      quantity(qty), limit_price(std::nullopt) {}
         // Limit Order Constructor
         OrderRequest(std::chrono::time_point<std::chrono::system_clock> ts, std::string sym,
-                     OrderDirection dir, double qty, double price) : timestamp(ts), order_id(generate_unique_order_id()),
+                     OrderDirection dir, double qty, double price) : timestamp(ts), order_id(0),
                      symbol(std::move(sym)), order_type(OrderType::LIMIT), direction(dir),
                      quantity(qty), limit_price(price) {}
+        // Fully specified order with its id (e.g. a checkpoint restore)
+        OrderRequest(long long id, std::chrono::time_point<std::chrono::system_clock> ts, std::string sym, OrderType type,
+                     OrderDirection dir, double qty, std::optional<double> limit, std::optional<double> stop)
+            : timestamp(ts), order_id(id), symbol(std::move(sym)), order_type(type), direction(dir),
+              quantity(qty), limit_price(limit), stop_price(stop) {}
+        // Stop Order (a buy stop triggers at or above stop, a sell stop at or below)
+        static OrderRequest stop(std::chrono::time_point<std::chrono::system_clock> ts, std::string sym,
+                                 OrderDirection dir, double qty, double stop) {
+            OrderRequest order(ts, std::move(sym), dir, qty);
+            order.order_type = OrderType::STOP;
+            order.stop_price = stop;
+            return order;
+        }
+    };
+
+    // Cancel or cancel/replace of a resting LIMIT or STOP order, by order id
+    struct OrderAmendment {
+        long long order_id;
+        bool cancel;          // false: replace with the price/quantity below
+        double price;         // New limit or stop price
+        double quantity;      // New remaining quantity
+
+        static OrderAmendment cancel_order(long long id) { return {id, true, 0.0, 0.0}; }
+        static OrderAmendment replace_order(long long id, double new_price, double new_quantity) {
+            return {id, false, new_price, new_quantity};
+        }
     };
 }
\ No newline at end of file
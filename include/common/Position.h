@@ -6,6 +6,56 @@
 #include "OrderTypes.h" // Needs OrderDirection
 
 namespace Backtester::Common {
+
+    // --- Position arithmetic ---
+    // Shared by Position and PositionBook (which keeps the same fields column-wise)
+
+    // Applies a fill to (quantity, average entry price, realized P&L); commission is charged to realized P&L
+    inline void apply_fill(double& quantity, double& average_entry_price, double& realized_pnl, const FillDetails& fill) {
+        double fill_cost = fill.quantity * fill.fill_price;
+        double previous_quantity = quantity; // Store before modification
+        double previous_average_entry_price = average_entry_price; // Store before modification
+
+        if (fill.direction == OrderDirection::BUY) {
+            if (previous_quantity < -1e-9 && (previous_quantity + fill.quantity) > 1e-9) { // Crossing zero (closing short, opening long)
+                realized_pnl += std::abs(previous_quantity) * (previous_average_entry_price - fill.fill_price);
+                average_entry_price = fill.fill_price;
+            } else if (previous_quantity >= -1e-9) { // Adding to long or opening long from flat (check >= to handle initial buy)
+                if (std::abs(previous_quantity + fill.quantity) > 1e-9) { // Avoid division by zero
+                    double current_total_cost = previous_quantity * previous_average_entry_price;
+                    average_entry_price = (current_total_cost + fill_cost) / (previous_quantity + fill.quantity);
+                } else {
+                    average_entry_price = fill.fill_price; // Initial buy
+                }
+            } else { // Reducing short position
+                 realized_pnl += fill.quantity * (previous_average_entry_price - fill.fill_price);
+            }
+            quantity += fill.quantity;
+        } else { // SELL
+            if (previous_quantity > 1e-9 && (previous_quantity - fill.quantity) < -1e-9) { // Crossing zero (closing long, opening short)
+                realized_pnl += previous_quantity * (fill.fill_price - previous_average_entry_price);
+                average_entry_price = fill.fill_price;
+            } else if (previous_quantity <= 1e-9) { // Adding to short or opening short from flat (check <= to handle initial sell)
+                 if (std::abs(previous_quantity - fill.quantity) > 1e-9) { // Avoid division by zero
+                    double current_total_value = std::abs(previous_quantity) * previous_average_entry_price;
+                    average_entry_price = (current_total_value + fill_cost) / std::abs(previous_quantity - fill.quantity);
+                 } else {
+                     average_entry_price = fill.fill_price; // Initial sell
+                 }
+            } else { // Reducing long position
+                 realized_pnl += fill.quantity * (fill.fill_price - previous_average_entry_price);
+            }
+            quantity -= fill.quantity;
+        }
+        realized_pnl -= fill.commission;
+        if (std::abs(quantity) < 1e-9) { average_entry_price = 0.0; }
+    }
+
+    // Unrealized P&L of 'quantity' held at 'average_entry_price' when marked at 'price'
+    inline double unrealized_pnl_at(double quantity, double average_entry_price, double price) {
+        return std::abs(quantity) > 1e-9 ? quantity * (price - average_entry_price) : 0.0;
+    }
+
     struct Position {
         std::string symbol;
         double quantity = 0.0;
@@ -17,56 +67,15 @@ namespace Backtester::Common {
 
         Position(std::string sym = "") : symbol(std::move(sym)) {}
 
-        // Use the detailed update_on_fill logic from the research doc
-        void update_on_fill(const FillDetails& fill) { /* ... copy from research doc ... */
-            double fill_cost = fill.quantity * fill.fill_price;
-            double previous_quantity = quantity; // Store before modification
-            double previous_average_entry_price = average_entry_price; // Store before modification
-
-            if (fill.direction == OrderDirection::BUY) {
-                if (previous_quantity < -1e-9 && (previous_quantity + fill.quantity) > 1e-9) { // Crossing zero (closing short, opening long)
-                    realized_pnl += std::abs(previous_quantity) * (previous_average_entry_price - fill.fill_price);
-                    average_entry_price = fill.fill_price;
-                } else if (previous_quantity >= -1e-9) { // Adding to long or opening long from flat (check >= to handle initial buy)
-                    if (std::abs(previous_quantity + fill.quantity) > 1e-9) { // Avoid division by zero
-                        double current_total_cost = previous_quantity * previous_average_entry_price;
-                        average_entry_price = (current_total_cost + fill_cost) / (previous_quantity + fill.quantity);
-                    } else {
-                        average_entry_price = fill.fill_price; // Initial buy
-                    }
-                } else { // Reducing short position
-                     realized_pnl += fill.quantity * (previous_average_entry_price - fill.fill_price);
-                }
-                quantity += fill.quantity;
-            } else { // SELL
-                if (previous_quantity > 1e-9 && (previous_quantity - fill.quantity) < -1e-9) { // Crossing zero (closing long, opening short)
-                    realized_pnl += previous_quantity * (fill.fill_price - previous_average_entry_price);
-                    average_entry_price = fill.fill_price;
-                } else if (previous_quantity <= 1e-9) { // Adding to short or opening short from flat (check <= to handle initial sell)
-                     if (std::abs(previous_quantity - fill.quantity) > 1e-9) { // Avoid division by zero
-                        double current_total_value = std::abs(previous_quantity) * previous_average_entry_price;
-                        average_entry_price = (current_total_value + fill_cost) / std::abs(previous_quantity - fill.quantity);
-                     } else {
-                         average_entry_price = fill.fill_price; // Initial sell
-                     }
-                } else { // Reducing long position
-                     realized_pnl += fill.quantity * (fill.fill_price - previous_average_entry_price);
-                }
-                quantity -= fill.quantity;
-            }
-            realized_pnl -= fill.commission;
-            if (std::abs(quantity) < 1e-9) { average_entry_price = 0.0; }
+        void update_on_fill(const FillDetails& fill) {
+            apply_fill(quantity, average_entry_price, realized_pnl, fill);
             update_market_value(last_price); // Update immediately based on *last known* price
         }
 
-        void update_market_value(double current_price) { /* ... copy from research doc ... */
+        void update_market_value(double current_price) {
              last_price = current_price;
              market_value = quantity * current_price;
-             if (std::abs(quantity) > 1e-9) {
-                  unrealized_pnl = quantity * (current_price - average_entry_price);
-             } else {
-                 unrealized_pnl = 0.0;
-             }
+             unrealized_pnl = unrealized_pnl_at(quantity, average_entry_price, current_price);
         }
     };
-}
\ No newline at end of file
+}
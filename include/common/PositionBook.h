@@ -0,0 +1,155 @@
+#pragma once
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "Position.h"
+
+namespace Backtester::Common {
+
+    // Dense per-book symbol index: 0, 1, 2, ... in the order symbols were first added
+    using SymbolId = std::uint32_t;
+    constexpr SymbolId kNoSymbol = std::numeric_limits<SymbolId>::max();
+
+    class PositionBook;
+
+    // Non-owning, read-only view of one position in a PositionBook. Holds the book and the
+    // id rather than pointers into the columns, so it stays valid while symbols are added.
+    // A default-constructed view (unknown symbol) reads as a flat position with no symbol.
+    class PositionView {
+    public:
+        PositionView() = default;
+        PositionView(const PositionBook* book, SymbolId id) : book_(book), id_(id) {}
+
+        bool valid() const { return book_ != nullptr; }
+        SymbolId id() const { return id_; }
+        inline std::string_view symbol() const;
+        inline double quantity() const;
+        inline double average_entry_price() const;
+        inline double last_price() const;
+        inline double market_value() const;
+        inline double unrealized_pnl() const;
+        inline double realized_pnl() const;
+        bool is_open() const { return std::abs(quantity()) > 1e-9; }
+
+    private:
+        const PositionBook* book_ = nullptr;
+        SymbolId id_ = kNoSymbol;
+    };
+
+    // Position book stored as a structure of arrays indexed by SymbolId: one column per
+    // Position field. Looking a position up by id touches one element of each column it
+    // reads. Symbol names are interned once; lookups by name hash a string_view (no temporary
+    // string). The arithmetic is Position's (apply_fill / unrealized_pnl_at), so results
+    // match a std::map<std::string, Position> bit for bit.
+    // Columns, names and the index allocate from the given resource.
+    class PositionBook {
+    public:
+        explicit PositionBook(std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+            : symbols_(resource), ids_(resource), quantity_(resource), average_entry_price_(resource),
+              last_price_(resource), market_value_(resource), unrealized_pnl_(resource), realized_pnl_(resource) {}
+
+        // Copying would leave the index pointing at the source's names
+        PositionBook(const PositionBook&) = delete;
+        PositionBook& operator=(const PositionBook&) = delete;
+
+        size_t size() const { return symbols_.size(); }
+        bool empty() const { return symbols_.empty(); }
+
+        // kNoSymbol if the book has never held 'symbol'
+        SymbolId find(std::string_view symbol) const {
+            auto it = ids_.find(symbol);
+            return it != ids_.end() ? it->second : kNoSymbol;
+        }
+        // The id of 'symbol', adding a flat position for it on first use
+        SymbolId intern(std::string_view symbol) {
+            auto it = ids_.find(symbol);
+            if (it != ids_.end()) return it->second;
+            const SymbolId id = static_cast<SymbolId>(symbols_.size());
+            symbols_.emplace_back(symbol); // Deque: existing names (and the index's views of them) never move
+            ids_.emplace(std::string_view(symbols_.back()), id);
+            quantity_.push_back(0.0);
+            average_entry_price_.push_back(0.0);
+            last_price_.push_back(0.0);
+            market_value_.push_back(0.0);
+            unrealized_pnl_.push_back(0.0);
+            realized_pnl_.push_back(0.0);
+            return id;
+        }
+        void clear() {
+            ids_.clear();
+            symbols_.clear();
+            quantity_.clear();
+            average_entry_price_.clear();
+            last_price_.clear();
+            market_value_.clear();
+            unrealized_pnl_.clear();
+            realized_pnl_.clear();
+        }
+
+        PositionView view(SymbolId id) const { return PositionView(this, id); }
+        // Invalid view if 'symbol' is unknown
+        PositionView view(std::string_view symbol) const {
+            SymbolId id = find(symbol);
+            return id != kNoSymbol ? view(id) : PositionView();
+        }
+
+        // --- Columns ---
+        std::string_view symbol(SymbolId id) const { return symbols_[id]; }
+        double quantity(SymbolId id) const { return quantity_[id]; }
+        double average_entry_price(SymbolId id) const { return average_entry_price_[id]; }
+        double last_price(SymbolId id) const { return last_price_[id]; }
+        double market_value(SymbolId id) const { return market_value_[id]; }
+        double unrealized_pnl(SymbolId id) const { return unrealized_pnl_[id]; }
+        double realized_pnl(SymbolId id) const { return realized_pnl_[id]; }
+
+        // --- Updates (Position::update_on_fill / update_market_value) ---
+        void apply_fill(SymbolId id, const FillDetails& fill) {
+            Common::apply_fill(quantity_[id], average_entry_price_[id], realized_pnl_[id], fill);
+            mark(id, last_price_[id]); // Re-mark at the last known price
+        }
+        void mark(SymbolId id, double price) {
+            last_price_[id] = price;
+            market_value_[id] = quantity_[id] * price;
+            unrealized_pnl_[id] = unrealized_pnl_at(quantity_[id], average_entry_price_[id], price);
+        }
+        // Restores a position's fields as saved (checkpoints)
+        void set(SymbolId id, double quantity, double average_entry_price, double last_price,
+                 double market_value, double unrealized_pnl, double realized_pnl) {
+            quantity_[id] = quantity;
+            average_entry_price_[id] = average_entry_price;
+            last_price_[id] = last_price;
+            market_value_[id] = market_value;
+            unrealized_pnl_[id] = unrealized_pnl;
+            realized_pnl_[id] = realized_pnl;
+        }
+
+    private:
+        std::pmr::deque<std::pmr::string> symbols_; // id -> name
+        std::pmr::unordered_map<std::string_view, SymbolId> ids_; // Views into symbols_
+        std::pmr::vector<double> quantity_;
+        std::pmr::vector<double> average_entry_price_;
+        std::pmr::vector<double> last_price_;
+        std::pmr::vector<double> market_value_;
+        std::pmr::vector<double> unrealized_pnl_;
+        std::pmr::vector<double> realized_pnl_;
+    };
+
+    // --- PositionView ---
+    inline std::string_view PositionView::symbol() const { return book_ ? book_->symbol(id_) : std::string_view(); }
+    inline double PositionView::quantity() const { return book_ ? book_->quantity(id_) : 0.0; }
+    inline double PositionView::average_entry_price() const { return book_ ? book_->average_entry_price(id_) : 0.0; }
+    inline double PositionView::last_price() const { return book_ ? book_->last_price(id_) : 0.0; }
+    inline double PositionView::market_value() const { return book_ ? book_->market_value(id_) : 0.0; }
+    inline double PositionView::unrealized_pnl() const { return book_ ? book_->unrealized_pnl(id_) : 0.0; }
+    inline double PositionView::realized_pnl() const { return book_ ? book_->realized_pnl(id_) : 0.0; }
+
+} // namespace Backtester::Common
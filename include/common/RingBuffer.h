@@ -0,0 +1,237 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <memory_resource>
+#include <stdexcept>
+#include <utility>
+
+namespace Backtester::Common {
+
+    // A contiguous run of elements (the C++17 stand-in for std::span)
+    template <class T>
+    struct Segment {
+        T* data = nullptr;
+        size_t size = 0;
+
+        T* begin() const { return data; }
+        T* end() const { return data + size; }
+        bool empty() const { return size == 0; }
+        T& operator[](size_t i) const { return data[i]; }
+    };
+
+    // Contiguous circular buffer: a drop-in for the std::deque<T> histories the strategies
+    // trim with pop_front. Capacity is a power of two and only grows (doubling) when a push
+    // finds the buffer full, so a history of bounded length stops allocating once it has
+    // reached its maximum size; std::deque keeps allocating/freeing blocks as it slides.
+    // Index 0 is the oldest element, size()-1 the newest; recent(k) counts from the newest.
+    // push_overwrite() keeps the capacity fixed instead of growing, and segments() exposes
+    // the contents as at most two contiguous runs for loops the compiler can vectorize.
+    // Storage comes from a polymorphic allocator (the default resource unless one is given),
+    // and a RingBuffer inside a std::pmr container picks up that container's resource.
+    template <class T>
+    class RingBuffer {
+    public:
+        using value_type = T;
+        using size_type = size_t;
+        using reference = T&;
+        using const_reference = const T&;
+        using allocator_type = std::pmr::polymorphic_allocator<T>;
+
+        RingBuffer() = default;
+        explicit RingBuffer(const allocator_type& alloc) : alloc_(alloc) {}
+        explicit RingBuffer(size_t capacity, const allocator_type& alloc = {}) : alloc_(alloc) { reserve(capacity); }
+
+        // Copies use the default resource (like std::pmr containers) unless given one
+        RingBuffer(const RingBuffer& other, const allocator_type& alloc = {}) : alloc_(alloc) { assign(other); }
+        RingBuffer& operator=(const RingBuffer& other) {
+            if (this != &other) assign(other);
+            return *this;
+        }
+        RingBuffer(RingBuffer&& other) noexcept : alloc_(other.alloc_) { steal(other); }
+        RingBuffer(RingBuffer&& other, const allocator_type& alloc) : alloc_(alloc) {
+            if (alloc_ == other.alloc_) steal(other);
+            else assign(other);
+        }
+        // Keeps this buffer's allocator; only steals storage from the same resource
+        RingBuffer& operator=(RingBuffer&& other) {
+            if (this == &other) return *this;
+            if (alloc_ == other.alloc_) {
+                deallocate();
+                steal(other);
+            } else {
+                assign(other);
+            }
+            return *this;
+        }
+        ~RingBuffer() { deallocate(); }
+
+        // Requires equal allocators
+        void swap(RingBuffer& other) noexcept {
+            std::swap(data_, other.data_);
+            std::swap(capacity_, other.capacity_);
+            std::swap(head_, other.head_);
+            std::swap(size_, other.size_);
+        }
+
+        allocator_type get_allocator() const { return alloc_; }
+
+        size_t size() const { return size_; }
+        bool empty() const { return size_ == 0; }
+        size_t capacity() const { return capacity_; }
+        bool full() const { return size_ == capacity_; }
+
+        // Ensures room for 'capacity' elements (rounded up to a power of two)
+        void reserve(size_t capacity) {
+            if (capacity <= capacity_) return;
+            size_t rounded = 1;
+            while (rounded < capacity) rounded <<= 1;
+            T* grown = alloc_.allocate(rounded);
+            std::uninitialized_value_construct_n(grown, rounded);
+            for (size_t i = 0; i < size_; ++i) grown[i] = std::move((*this)[i]);
+            size_t size = size_;
+            deallocate();
+            data_ = grown;
+            capacity_ = rounded;
+            size_ = size;
+            head_ = 0;
+        }
+
+        void push_back(const T& value) {
+            if (size_ == capacity_) reserve(capacity_ ? capacity_ * 2 : 4);
+            data_[(head_ + size_) & (capacity_ - 1)] = value;
+            ++size_;
+        }
+        template <class... Args>
+        void emplace_back(Args&&... args) { push_back(T(std::forward<Args>(args)...)); }
+        // Fixed-capacity push: when full, the oldest element is overwritten instead of the
+        // buffer growing (reserve() the capacity first)
+        void push_overwrite(const T& value) {
+            if (capacity_ == 0) throw std::logic_error("RingBuffer::push_overwrite without reserved capacity");
+            data_[(head_ + size_) & (capacity_ - 1)] = value;
+            if (size_ == capacity_) head_ = (head_ + 1) & (capacity_ - 1);
+            else ++size_;
+        }
+
+        void pop_front() {
+            if (size_ == 0) throw std::out_of_range("RingBuffer::pop_front on empty buffer");
+            head_ = (head_ + 1) & (capacity_ - 1);
+            --size_;
+        }
+        void pop_back() {
+            if (size_ == 0) throw std::out_of_range("RingBuffer::pop_back on empty buffer");
+            --size_;
+        }
+        void clear() { head_ = 0; size_ = 0; }
+
+        T& operator[](size_t i) { return data_[(head_ + i) & (capacity_ - 1)]; }
+        const T& operator[](size_t i) const { return data_[(head_ + i) & (capacity_ - 1)]; }
+        T& front() { return (*this)[0]; }
+        const T& front() const { return (*this)[0]; }
+        T& back() { return (*this)[size_ - 1]; }
+        const T& back() const { return (*this)[size_ - 1]; }
+        // k-th newest element: recent(0) == back()
+        T& recent(size_t k) { return (*this)[size_ - 1 - k]; }
+        const T& recent(size_t k) const { return (*this)[size_ - 1 - k]; }
+
+        // --- Contiguous views ---
+        // The contents oldest to newest as two runs (the second is empty unless the data
+        // wraps around the end of the storage)
+        std::pair<Segment<T>, Segment<T>> segments() { return segments_of<T>(data_); }
+        std::pair<Segment<const T>, Segment<const T>> segments() const { return segments_of<const T>(data_); }
+        // Rotates the storage so the contents are one run starting at the oldest element:
+        // O(size) when wrapped, free when already contiguous
+        Segment<T> linearize() {
+            if (head_ + size_ > capacity_) {
+                std::rotate(data_, data_ + head_, data_ + capacity_);
+                head_ = 0;
+            }
+            return Segment<T>{data_ + head_, size_};
+        }
+
+        // --- Random-access iteration (oldest to newest) ---
+        template <bool Const>
+        class Iterator {
+        public:
+            using iterator_category = std::random_access_iterator_tag;
+            using value_type = T;
+            using difference_type = std::ptrdiff_t;
+            using pointer = std::conditional_t<Const, const T*, T*>;
+            using reference = std::conditional_t<Const, const T&, T&>;
+            using Owner = std::conditional_t<Const, const RingBuffer, RingBuffer>;
+
+            Iterator() = default;
+            Iterator(Owner* owner, size_t index) : owner_(owner), index_(index) {}
+            operator Iterator<true>() const { return Iterator<true>(owner_, index_); }
+
+            reference operator*() const { return (*owner_)[index_]; }
+            pointer operator->() const { return &(*owner_)[index_]; }
+            reference operator[](difference_type n) const { return (*owner_)[index_ + n]; }
+
+            Iterator& operator++() { ++index_; return *this; }
+            Iterator operator++(int) { Iterator copy = *this; ++index_; return copy; }
+            Iterator& operator--() { --index_; return *this; }
+            Iterator operator--(int) { Iterator copy = *this; --index_; return copy; }
+            Iterator& operator+=(difference_type n) { index_ += n; return *this; }
+            Iterator& operator-=(difference_type n) { index_ -= n; return *this; }
+            Iterator operator+(difference_type n) const { return Iterator(owner_, index_ + n); }
+            Iterator operator-(difference_type n) const { return Iterator(owner_, index_ - n); }
+            friend Iterator operator+(difference_type n, const Iterator& it) { return it + n; }
+            difference_type operator-(const Iterator& other) const {
+                return static_cast<difference_type>(index_) - static_cast<difference_type>(other.index_);
+            }
+
+            bool operator==(const Iterator& other) const { return index_ == other.index_; }
+            bool operator!=(const Iterator& other) const { return index_ != other.index_; }
+            bool operator<(const Iterator& other) const { return index_ < other.index_; }
+            bool operator>(const Iterator& other) const { return index_ > other.index_; }
+            bool operator<=(const Iterator& other) const { return index_ <= other.index_; }
+            bool operator>=(const Iterator& other) const { return index_ >= other.index_; }
+
+        private:
+            Owner* owner_ = nullptr;
+            size_t index_ = 0;
+        };
+        using iterator = Iterator<false>;
+        using const_iterator = Iterator<true>;
+
+        iterator begin() { return iterator(this, 0); }
+        iterator end() { return iterator(this, size_); }
+        const_iterator begin() const { return const_iterator(this, 0); }
+        const_iterator end() const { return const_iterator(this, size_); }
+
+    private:
+        allocator_type alloc_;
+        T* data_ = nullptr;
+        size_t capacity_ = 0;
+        size_t head_ = 0;  // Physical slot of element 0
+        size_t size_ = 0;
+
+        template <class U>
+        std::pair<Segment<U>, Segment<U>> segments_of(U* data) const {
+            const size_t first = std::min(size_, capacity_ - head_);
+            return {Segment<U>{data + head_, first}, Segment<U>{data, size_ - first}};
+        }
+
+        void assign(const RingBuffer& other) {
+            clear();
+            reserve(other.size_);
+            for (size_t i = 0; i < other.size_; ++i) push_back(other[i]);
+        }
+        void steal(RingBuffer& other) noexcept {
+            data_ = std::exchange(other.data_, nullptr);
+            capacity_ = std::exchange(other.capacity_, 0);
+            head_ = std::exchange(other.head_, 0);
+            size_ = std::exchange(other.size_, 0);
+        }
+        void deallocate() noexcept {
+            if (!data_) return;
+            std::destroy_n(data_, capacity_);
+            alloc_.deallocate(data_, capacity_);
+            data_ = nullptr;
+            capacity_ = head_ = size_ = 0;
+        }
+    };
+
+} // namespace Backtester::Common
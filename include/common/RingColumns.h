@@ -0,0 +1,120 @@
+#pragma once
+#include <cstddef>
+#include <initializer_list>
+#include <memory_resource>
+#include <stdexcept>
+#include <vector>
+
+#include "RingBuffer.h" // Segment
+#include "Serialization.h"
+
+namespace Backtester::Common {
+
+    // Fixed-capacity structure-of-arrays history: 'columns' parallel series (e.g. close,
+    // high, low, volume, or one return stream per symbol) that advance together, all in one
+    // allocation sized at construction. push() appends one value per column and overwrites
+    // the oldest row once full.
+    //
+    // Each column is stored mirrored (every value is written at slot and slot + capacity), so
+    // the newest n values of any column are always one contiguous run: latest() hands them
+    // to a vectorizable loop without copying or a wrap-around split, at the cost of two
+    // stores per value and twice the memory of a plain ring.
+    // Storage comes from a polymorphic allocator (the default resource unless one is given).
+    template <class T>
+    class RingColumns {
+    public:
+        using allocator_type = std::pmr::polymorphic_allocator<T>;
+
+        explicit RingColumns(const allocator_type& alloc = {}) : data_(alloc) {}
+        RingColumns(size_t columns, size_t capacity, const allocator_type& alloc = {}) : data_(alloc) {
+            reset(columns, capacity);
+        }
+        RingColumns(const RingColumns& other, const allocator_type& alloc) : data_(other.data_, alloc),
+            columns_(other.columns_), capacity_(other.capacity_), head_(other.head_), size_(other.size_) {}
+        RingColumns(const RingColumns&) = default;
+        RingColumns(RingColumns&&) noexcept = default;
+        RingColumns& operator=(const RingColumns&) = default;
+        RingColumns& operator=(RingColumns&&) = default;
+
+        allocator_type get_allocator() const { return data_.get_allocator(); }
+
+        // Re-sizes (capacity rounded up to a power of two) and empties the history
+        void reset(size_t columns, size_t capacity) {
+            if (columns == 0 || capacity == 0) throw std::invalid_argument("RingColumns needs at least one column and one row");
+            size_t rounded = 1;
+            while (rounded < capacity) rounded <<= 1;
+            columns_ = columns;
+            capacity_ = rounded;
+            data_.assign(columns_ * 2 * capacity_, T{});
+            head_ = size_ = 0;
+        }
+        void clear() { head_ = size_ = 0; }
+
+        size_t columns() const { return columns_; }
+        size_t capacity() const { return capacity_; }
+        size_t size() const { return size_; }
+        bool empty() const { return size_ == 0; }
+        bool full() const { return size_ == capacity_; }
+
+        // Appends a row: row[c] goes to column c (columns() values)
+        void push(const T* row) {
+            if (capacity_ == 0) throw std::logic_error("RingColumns used before reset()");
+            size_t slot = (head_ + size_) & (capacity_ - 1);
+            if (size_ == capacity_) head_ = (head_ + 1) & (capacity_ - 1);
+            else ++size_;
+            T* base = data_.data();
+            for (size_t c = 0; c < columns_; ++c, base += 2 * capacity_) {
+                base[slot] = row[c];
+                base[slot + capacity_] = row[c];
+            }
+        }
+        void push(std::initializer_list<T> row) {
+            if (row.size() != columns_) throw std::invalid_argument("RingColumns: row width does not match the column count");
+            push(row.begin());
+        }
+
+        // k-th newest value of 'column': recent(c, 0) is the latest push
+        const T& recent(size_t column, size_t k) const { return column_base(column)[head_ + size_ - 1 - k]; }
+        // The whole column, oldest to newest, as one run
+        Segment<const T> column(size_t column) const { return Segment<const T>{column_base(column) + head_, size_}; }
+        // The newest 'n' values of 'column' (n <= size()), oldest first, as one run
+        Segment<const T> latest(size_t column, size_t n) const {
+            if (n > size_) throw std::out_of_range("RingColumns::latest beyond the stored rows");
+            return Segment<const T>{column_base(column) + head_ + size_ - n, n};
+        }
+
+        void serialize(BinaryWriter& writer) const {
+            writer.write(columns_);
+            writer.write(capacity_);
+            writer.write(size_);
+            for (size_t c = 0; c < columns_; ++c) {
+                for (const T& value : column(c)) writer.write(value);
+            }
+        }
+        void deserialize(BinaryReader& reader) {
+            const auto columns = reader.read<size_t>();
+            const auto capacity = reader.read<size_t>();
+            const auto size = reader.read<size_t>();
+            if (size > capacity) throw std::runtime_error("RingColumns: corrupt checkpoint (size exceeds capacity)");
+            reset(columns, capacity);
+            // Replayed row by row so both mirrors are filled
+            std::vector<T> values(columns * size);
+            for (T& value : values) reader.read(value);
+            std::vector<T> row(columns);
+            for (size_t r = 0; r < size; ++r) {
+                for (size_t c = 0; c < columns; ++c) row[c] = values[c * size + r];
+                push(row.data());
+            }
+        }
+
+    private:
+        std::pmr::vector<T> data_; // Column c at [c * 2 * capacity_, (c + 1) * 2 * capacity_)
+        size_t columns_ = 0;
+        size_t capacity_ = 0;
+        size_t head_ = 0;  // Slot of the oldest row
+        size_t size_ = 0;
+
+        const T* column_base(size_t column) const { return data_.data() + column * 2 * capacity_; }
+    };
+
+} // namespace Backtester::Common
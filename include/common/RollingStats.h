@@ -0,0 +1,398 @@
+#pragma once
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory_resource>
+#include <stdexcept>
+#include <utility>
+
+#include "RingBuffer.h"
+#include "Serialization.h"
+
+// --- Incremental rolling-window indicators ---
+// Each operator keeps the last 'window' inputs in a RingBuffer and updates its statistic as a
+// value enters and the oldest leaves, so a push costs the same for a window of 5 or of 5000:
+//
+//   RollingSum / RollingMean     compensated (Neumaier) running sum with removal
+//   RollingVariance              Welford mean / M2 with exact downdate; stddev, z-score
+//   RollingCovariance            Welford co-moments of (x, y) pairs; covariance, correlation
+//   RollingMax / RollingMin      monotonic queue: amortized O(1) push, O(1) query
+//   Ema                          exponential moving average (no window)
+//
+// Downdates are exact inverses of the updates, but rounding still accumulates over millions of
+// pushes, so the windowed operators re-derive their state from the stored window once every
+// kResyncWindows full windows: amortized O(1/kResyncWindows) extra per push.
+//
+// The operators are allocator-aware (the window comes from the given resource, or the
+// container's when they sit in a Common::SymbolMap) and checkpoint their exact state with
+// serialize / deserialize. A default-constructed operator has window 0: call set_window()
+// before pushing.
+namespace Backtester::Common {
+
+    namespace detail {
+        constexpr std::uint64_t kResyncWindows = 16;
+
+        // Neumaier-compensated sum: 'sum + compensation' carries the rounding error of every
+        // addition, so adding and later subtracting the same terms returns to (almost) zero
+        struct CompensatedSum {
+            double sum = 0.0;
+            double compensation = 0.0;
+
+            void add(double x) {
+                const double t = sum + x;
+                compensation += std::abs(sum) >= std::abs(x) ? (sum - t) + x : (x - t) + sum;
+                sum = t;
+            }
+            double value() const { return sum + compensation; }
+            void reset() { sum = compensation = 0.0; }
+        };
+
+        // Window storage and the bookkeeping every windowed operator shares
+        template <class T>
+        class Window {
+        public:
+            using allocator_type = std::pmr::polymorphic_allocator<T>;
+
+            explicit Window(const allocator_type& alloc = {}) : values_(alloc) {}
+            explicit Window(size_t window, const allocator_type& alloc = {}) : values_(alloc) { set_window(window); }
+            Window(const Window& other, const allocator_type& alloc) : values_(other.values_, alloc),
+                window_(other.window_), replacements_(other.replacements_) {}
+
+            void set_window(size_t window) {
+                if (window == 0) throw std::invalid_argument("Rolling window must be at least 1");
+                window_ = window;
+                values_.clear();
+                values_.reserve(window);
+                replacements_ = 0;
+            }
+            size_t window() const { return window_; }
+            size_t size() const { return values_.size(); }
+            bool full() const { return values_.size() == window_; }
+            const RingBuffer<T>& values() const { return values_; }
+
+        protected:
+            RingBuffer<T> values_;   // Oldest first
+            size_t window_ = 0;
+            std::uint64_t replacements_ = 0; // Pushes into a full window since the last resync
+
+            // Appends 'value'; returns true (with the evicted value in 'evicted') once full
+            bool slide(const T& value, T& evicted) {
+                if (window_ == 0) throw std::logic_error("Rolling window used before set_window()");
+                const bool evict = values_.size() == window_;
+                if (evict) {
+                    evicted = values_.front();
+                    values_.pop_front();
+                }
+                values_.push_back(value);
+                return evict;
+            }
+            // True when the operator should re-derive its state from values_
+            bool resync_due() {
+                if (++replacements_ < window_ * kResyncWindows) return false;
+                replacements_ = 0;
+                return true;
+            }
+
+            void serialize_window(BinaryWriter& writer) const {
+                writer.write(window_);
+                writer.write(replacements_);
+                writer.write(values_);
+            }
+            void deserialize_window(BinaryReader& reader) {
+                reader.read(window_);
+                reader.read(replacements_);
+                reader.read(values_);
+            }
+        };
+    } // namespace detail
+
+    // --- Sum / mean ---
+    class RollingSum : public detail::Window<double> {
+    public:
+        using Window::Window;
+
+        void set_window(size_t window) {
+            Window::set_window(window);
+            total_.reset();
+        }
+        void push(double x) {
+            double evicted = 0.0;
+            if (slide(x, evicted)) {
+                if (resync_due()) { resync(); return; }
+                total_.add(-evicted);
+            }
+            total_.add(x);
+        }
+        double sum() const { return total_.value(); }
+        double mean() const { return size() ? total_.value() / static_cast<double>(size()) : 0.0; }
+
+        void serialize(BinaryWriter& writer) const {
+            serialize_window(writer);
+            writer.write(total_.sum);
+            writer.write(total_.compensation);
+        }
+        void deserialize(BinaryReader& reader) {
+            deserialize_window(reader);
+            reader.read(total_.sum);
+            reader.read(total_.compensation);
+        }
+
+    private:
+        detail::CompensatedSum total_;
+
+        void resync() {
+            total_.reset();
+            for (double v : values_.linearize()) total_.add(v);
+        }
+    };
+    using RollingMean = RollingSum; // mean() over the values pushed so far (at most 'window')
+
+    // --- Variance / standard deviation / z-score ---
+    class RollingVariance : public detail::Window<double> {
+    public:
+        using Window::Window;
+
+        void set_window(size_t window) {
+            Window::set_window(window);
+            mean_ = m2_ = 0.0;
+        }
+        void push(double x) {
+            double evicted = 0.0;
+            if (slide(x, evicted)) {
+                if (resync_due()) { resync(); return; }
+                remove(evicted);
+            }
+            add(x);
+        }
+
+        double mean() const { return mean_; }
+        double m2() const { return m2_; } // Sum of squared deviations from the mean
+        // Sample variance (n - 1); 0 until two values are in the window
+        double variance() const { return size() > 1 ? m2_ / static_cast<double>(size() - 1) : 0.0; }
+        double population_variance() const { return size() ? m2_ / static_cast<double>(size()) : 0.0; }
+        double stddev() const { return std::sqrt(variance()); }
+        // Standard score of 'x' against the window (0 while the window has no spread)
+        double zscore(double x) const {
+            const double sd = stddev();
+            return sd > 0.0 ? (x - mean_) / sd : 0.0;
+        }
+
+        void serialize(BinaryWriter& writer) const {
+            serialize_window(writer);
+            writer.write(mean_);
+            writer.write(m2_);
+        }
+        void deserialize(BinaryReader& reader) {
+            deserialize_window(reader);
+            reader.read(mean_);
+            reader.read(m2_);
+        }
+
+    private:
+        double mean_ = 0.0;
+        double m2_ = 0.0; // Sum of squared deviations from mean_
+
+        // Welford update over the values_.size() values now in the window
+        void add(double x) {
+            const double n = static_cast<double>(values_.size());
+            const double delta = x - mean_;
+            mean_ += delta / n;
+            m2_ += delta * (x - mean_);
+        }
+        // Exact inverse of add(x); called after the slide, so values_ already holds the new
+        // value and the window without 'x' or the new value has values_.size() - 1 values
+        void remove(double x) {
+            const double n = static_cast<double>(values_.size() - 1);
+            if (n == 0.0) { mean_ = m2_ = 0.0; return; }
+            const double previous_mean = mean_;
+            mean_ -= (x - mean_) / n;
+            m2_ -= (x - mean_) * (x - previous_mean);
+            if (m2_ < 0.0) m2_ = 0.0; // Rounding on a (nearly) constant window
+        }
+        void resync() {
+            const Segment<double> window = values_.linearize(); // One run, so the passes vectorize
+            double sum = 0.0;
+            for (double v : window) sum += v;
+            mean_ = sum / static_cast<double>(window.size);
+            m2_ = 0.0;
+            for (double v : window) m2_ += (v - mean_) * (v - mean_);
+        }
+    };
+
+    // --- Covariance / correlation of (x, y) pairs ---
+    class RollingCovariance : public detail::Window<std::pair<double, double>> {
+    public:
+        using Window::Window;
+
+        void set_window(size_t window) {
+            Window::set_window(window);
+            mean_x_ = mean_y_ = m2_x_ = m2_y_ = c_ = 0.0;
+        }
+        void push(double x, double y) {
+            std::pair<double, double> evicted;
+            if (slide({x, y}, evicted)) {
+                if (resync_due()) { resync(); return; }
+                remove(evicted.first, evicted.second);
+            }
+            add(x, y);
+        }
+
+        double mean_x() const { return mean_x_; }
+        double mean_y() const { return mean_y_; }
+        // Sample covariance (n - 1)
+        double covariance() const { return size() > 1 ? c_ / static_cast<double>(size() - 1) : 0.0; }
+        // Pearson correlation; 0 when either side's root sum of squared deviations is at most
+        // 'min_spread' (a flat window has no defined correlation)
+        double correlation(double min_spread = 0.0) const {
+            const double sx = std::sqrt(m2_x_), sy = std::sqrt(m2_y_);
+            if (sx <= min_spread || sy <= min_spread) return 0.0;
+            return c_ / (sx * sy);
+        }
+
+        void serialize(BinaryWriter& writer) const {
+            serialize_window(writer);
+            writer.write(mean_x_);
+            writer.write(mean_y_);
+            writer.write(m2_x_);
+            writer.write(m2_y_);
+            writer.write(c_);
+        }
+        void deserialize(BinaryReader& reader) {
+            deserialize_window(reader);
+            reader.read(mean_x_);
+            reader.read(mean_y_);
+            reader.read(m2_x_);
+            reader.read(m2_y_);
+            reader.read(c_);
+        }
+
+    private:
+        double mean_x_ = 0.0, mean_y_ = 0.0;
+        double m2_x_ = 0.0, m2_y_ = 0.0; // Sums of squared deviations
+        double c_ = 0.0;                 // Sum of co-deviations
+
+        void add(double x, double y) {
+            const double n = static_cast<double>(values_.size());
+            const double dx = x - mean_x_;
+            const double dy = y - mean_y_;
+            mean_x_ += dx / n;
+            mean_y_ += dy / n;
+            m2_x_ += dx * (x - mean_x_);
+            m2_y_ += dy * (y - mean_y_);
+            c_ += dx * (y - mean_y_);
+        }
+        void remove(double x, double y) { // See RollingVariance::remove
+            const double n = static_cast<double>(values_.size() - 1);
+            if (n == 0.0) { mean_x_ = mean_y_ = m2_x_ = m2_y_ = c_ = 0.0; return; }
+            const double previous_x = mean_x_, previous_y = mean_y_;
+            mean_x_ -= (x - mean_x_) / n;
+            mean_y_ -= (y - mean_y_) / n;
+            m2_x_ -= (x - mean_x_) * (x - previous_x);
+            m2_y_ -= (y - mean_y_) * (y - previous_y);
+            c_ -= (x - mean_x_) * (y - previous_y);
+            if (m2_x_ < 0.0) m2_x_ = 0.0;
+            if (m2_y_ < 0.0) m2_y_ = 0.0;
+        }
+        void resync() {
+            const Segment<std::pair<double, double>> window = values_.linearize(); // One run for both passes
+            double sum_x = 0.0, sum_y = 0.0;
+            for (const auto& [x, y] : window) { sum_x += x; sum_y += y; }
+            const double n = static_cast<double>(window.size);
+            mean_x_ = sum_x / n;
+            mean_y_ = sum_y / n;
+            m2_x_ = m2_y_ = c_ = 0.0;
+            for (const auto& [x, y] : window) {
+                m2_x_ += (x - mean_x_) * (x - mean_x_);
+                m2_y_ += (y - mean_y_) * (y - mean_y_);
+                c_ += (x - mean_x_) * (y - mean_y_);
+            }
+        }
+    };
+
+    // --- Max / min ---
+    // Keeps only the values that can still become the extreme (each newer than and beating
+    // every value behind it), so the extreme is always the queue's front
+    template <class Beats>
+    class RollingExtreme {
+    public:
+        using allocator_type = std::pmr::polymorphic_allocator<std::pair<std::uint64_t, double>>;
+
+        explicit RollingExtreme(const allocator_type& alloc = {}) : queue_(alloc) {}
+        explicit RollingExtreme(size_t window, const allocator_type& alloc = {}) : queue_(alloc) { set_window(window); }
+        RollingExtreme(const RollingExtreme& other, const allocator_type& alloc)
+            : queue_(other.queue_, alloc), window_(other.window_), pushed_(other.pushed_) {}
+
+        void set_window(size_t window) {
+            if (window == 0) throw std::invalid_argument("Rolling window must be at least 1");
+            window_ = window;
+            queue_.clear();
+            queue_.reserve(window + 1); // Push precedes the eviction
+            pushed_ = 0;
+        }
+        size_t window() const { return window_; }
+        size_t size() const { return pushed_ < window_ ? static_cast<size_t>(pushed_) : window_; }
+        bool full() const { return pushed_ >= window_; }
+
+        void push(double x) {
+            if (window_ == 0) throw std::logic_error("Rolling window used before set_window()");
+            while (!queue_.empty() && !Beats{}(queue_.back().second, x)) queue_.pop_back();
+            queue_.push_back({pushed_++, x});
+            if (queue_.front().first + window_ < pushed_) queue_.pop_front();
+        }
+        // The extreme of the window (requires at least one push)
+        double value() const { return queue_.front().second; }
+
+        void serialize(BinaryWriter& writer) const {
+            writer.write(window_);
+            writer.write(pushed_);
+            writer.write(queue_);
+        }
+        void deserialize(BinaryReader& reader) {
+            reader.read(window_);
+            reader.read(pushed_);
+            reader.read(queue_);
+        }
+
+    private:
+        RingBuffer<std::pair<std::uint64_t, double>> queue_; // (push index, value), front = extreme
+        size_t window_ = 0;
+        std::uint64_t pushed_ = 0;
+    };
+    using RollingMax = RollingExtreme<std::greater<>>;
+    using RollingMin = RollingExtreme<std::less<>>;
+
+    // --- Exponential moving average ---
+    class Ema {
+    public:
+        explicit Ema(double alpha = 1.0) : alpha_(alpha) {
+            if (!(alpha > 0.0 && alpha <= 1.0)) throw std::invalid_argument("Ema alpha must be in (0, 1]");
+        }
+        // The usual 'N-period' EMA: alpha = 2 / (N + 1)
+        static Ema span(size_t periods) { return Ema(2.0 / (static_cast<double>(periods) + 1.0)); }
+
+        // The first value seeds the average
+        void push(double x) {
+            value_ = initialized_ ? value_ + alpha_ * (x - value_) : x;
+            initialized_ = true;
+        }
+        double value() const { return value_; }
+        bool initialized() const { return initialized_; }
+        void reset() { value_ = 0.0; initialized_ = false; }
+
+        void serialize(BinaryWriter& writer) const {
+            writer.write(value_);
+            writer.write(initialized_);
+        }
+        void deserialize(BinaryReader& reader) {
+            reader.read(value_);
+            reader.read(initialized_);
+        }
+
+    private:
+        double alpha_;
+        double value_ = 0.0;
+        bool initialized_ = false;
+    };
+
+} // namespace Backtester::Common
@@ -0,0 +1,109 @@
+#pragma once
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
+
+// --- Per-run memory arena ---
+// A strategy run builds thousands of small, run-lifetime objects (per-symbol map nodes and
+// their keys, history buffers, equity points, queued orders). Components that take a
+// std::pmr::memory_resource* can place all of them in one RunArena, which hands memory out
+// by bumping a pointer and frees everything at once when the run's arena is destroyed:
+//
+//   Common::RunArena arena;                                  // declare first: outlives users
+//   auto strategy = std::make_unique<MovingAverageCrossover>(5, 20, arena.resource());
+//   Portfolio portfolio(100000.0, arena.resource());
+//   Backtester backtester(data, *strategy, portfolio, execution, arena.resource());
+//
+// The arena is not thread-safe; give each concurrently running backtest its own.
+namespace Backtester::Common {
+
+    // Forwards to an upstream resource and counts what passes through
+    class CountingResource : public std::pmr::memory_resource {
+    public:
+        explicit CountingResource(std::pmr::memory_resource* upstream = std::pmr::new_delete_resource())
+            : upstream_(upstream) {}
+
+        size_t bytes_in_use() const { return bytes_in_use_; }
+        size_t peak_bytes() const { return peak_bytes_; }
+        size_t allocations() const { return allocations_; }
+
+    private:
+        std::pmr::memory_resource* upstream_;
+        size_t bytes_in_use_ = 0;
+        size_t peak_bytes_ = 0;
+        size_t allocations_ = 0;
+
+        void* do_allocate(size_t bytes, size_t alignment) override {
+            void* p = upstream_->allocate(bytes, alignment);
+            bytes_in_use_ += bytes;
+            if (bytes_in_use_ > peak_bytes_) peak_bytes_ = bytes_in_use_;
+            allocations_++;
+            return p;
+        }
+        void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+            upstream_->deallocate(p, bytes, alignment);
+            bytes_in_use_ -= bytes;
+        }
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+    };
+
+    class RunArena {
+    public:
+        // First block requested from the heap; later blocks grow geometrically
+        static constexpr size_t kDefaultInitialBytes = 64 * 1024;
+
+        explicit RunArena(size_t initial_bytes = kDefaultInitialBytes,
+                          std::pmr::memory_resource* upstream = std::pmr::new_delete_resource())
+            : upstream_(upstream), arena_(initial_bytes, &upstream_) {}
+        RunArena(const RunArena&) = delete;
+        RunArena& operator=(const RunArena&) = delete;
+
+        std::pmr::memory_resource* resource() { return &arena_; }
+
+        // Heap memory currently held by the arena / number of blocks it took from the heap
+        size_t bytes_reserved() const { return upstream_.bytes_in_use(); }
+        size_t heap_blocks() const { return upstream_.allocations(); }
+
+        // Frees every block; everything allocated from the arena must already be gone
+        void release() { arena_.release(); }
+
+    private:
+        CountingResource upstream_;
+        std::pmr::monotonic_buffer_resource arena_;
+    };
+
+    // --- Arena-friendly per-symbol state ---
+    // Ordered map whose nodes, keys and (allocator-aware) values all come from the map's
+    // resource. Look symbols up through a string_view (symbol_slot / find_symbol) so no
+    // temporary key string is built per bar.
+    template <class V>
+    using SymbolMap = std::pmr::map<std::pmr::string, V, std::less<>>;
+
+    // The state for 'symbol', default-constructed (with the map's allocator) on first use
+    template <class V>
+    V& symbol_slot(SymbolMap<V>& map, std::string_view symbol) {
+        auto it = map.find(symbol);
+        if (it == map.end()) {
+            it = map.emplace(std::piecewise_construct, std::forward_as_tuple(symbol), std::forward_as_tuple()).first;
+        }
+        return it->second;
+    }
+
+    // nullptr if 'symbol' has no state yet
+    template <class V>
+    V* find_symbol(SymbolMap<V>& map, std::string_view symbol) {
+        auto it = map.find(symbol);
+        return it != map.end() ? &it->second : nullptr;
+    }
+    template <class V>
+    const V* find_symbol(const SymbolMap<V>& map, std::string_view symbol) {
+        auto it = map.find(symbol);
+        return it != map.end() ? &it->second : nullptr;
+    }
+
+} // namespace Backtester::Common
@@ -0,0 +1,75 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+
+#include "Serialization.h"
+
+// --- Per-run context ---
+// The state that numbers and times one backtest: its order and fill id sequences, the
+// simulated clock (event time of the bar being processed) and the run's RNG seed. The
+// Backtester owns one and hands it to its Portfolio and ExecutionSimulator, so every run
+// numbers its orders and fills from 1 no matter how many other runs share the process, and
+// concurrent runs never touch a shared counter. Checkpoints save the whole context.
+//
+// Like RunArena it is not thread-safe: one context per concurrently running backtest.
+namespace Backtester::Common {
+
+    class RunContext {
+    public:
+        explicit RunContext(std::uint64_t seed = 0) : seed_(seed) {}
+
+        // --- Ids ---
+        long long next_order_id() { return ++last_order_id_; }
+        long long next_fill_id() { return ++last_fill_id_; }
+        long long last_order_id() const { return last_order_id_; }
+        long long last_fill_id() const { return last_fill_id_; }
+
+        // --- Simulated clock ---
+        std::chrono::system_clock::time_point now() const { return now_; }
+        void advance_to(std::chrono::system_clock::time_point timestamp) { now_ = timestamp; }
+
+        // --- Seeds ---
+        // Components draw from derive_seed(stream) rather than the run seed itself, so each
+        // random stream is independent of the others and of the order they are drawn in
+        std::uint64_t seed() const { return seed_; }
+        void set_seed(std::uint64_t seed) { seed_ = seed; }
+        std::uint64_t derive_seed(std::uint64_t stream) const { return mix_seed(seed_, stream); }
+        static std::uint64_t mix_seed(std::uint64_t seed, std::uint64_t stream) {
+            return splitmix(seed ^ splitmix(stream + 0x9E3779B97F4A7C15ull));
+        }
+
+        // Back to the start of a run (the seed is configuration and stays)
+        void reset() {
+            last_order_id_ = 0;
+            last_fill_id_ = 0;
+            now_ = {};
+        }
+
+        void serialize(BinaryWriter& writer) const {
+            writer.write(seed_);
+            writer.write(last_order_id_);
+            writer.write(last_fill_id_);
+            writer.write(now_);
+        }
+        void deserialize(BinaryReader& reader) {
+            reader.read(seed_);
+            reader.read(last_order_id_);
+            reader.read(last_fill_id_);
+            reader.read(now_);
+        }
+
+    private:
+        std::uint64_t seed_ = 0;
+        long long last_order_id_ = 0;
+        long long last_fill_id_ = 0;
+        std::chrono::system_clock::time_point now_{};
+
+        // splitmix64 finalizer
+        static std::uint64_t splitmix(std::uint64_t x) {
+            x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+            x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+            return x ^ (x >> 31);
+        }
+    };
+
+} // namespace Backtester::Common
@@ -0,0 +1,155 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <unordered_map>
+#include <optional>
+#include <utility>
+#include <chrono>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <type_traits>
+#include <cstdint>
+
+#include "RingBuffer.h"
+
+// Compact binary (de)serialization used by Backtester checkpoints.
+// Values are written in native byte order and doubles as raw bits, so a restored
+// run continues bit-identically on the same platform/build.
+namespace Backtester::Common {
+
+    namespace detail {
+        template <class T> struct is_string : std::false_type {};
+        template <class Tr, class A> struct is_string<std::basic_string<char, Tr, A>> : std::true_type {}; // Also std::pmr::string
+        template <class T> struct is_vector : std::false_type {};
+        template <class T, class A> struct is_vector<std::vector<T, A>> : std::true_type {};
+        template <class T> struct is_deque : std::false_type {};
+        template <class T, class A> struct is_deque<std::deque<T, A>> : std::true_type {};
+        template <class T> struct is_deque<RingBuffer<T>> : std::true_type {}; // Same encoding as a deque
+        template <class T> struct is_arithmetic_ring : std::false_type {};
+        template <class T> struct is_arithmetic_ring<RingBuffer<T>> : std::is_arithmetic<T> {};
+        template <class T> struct is_map : std::false_type {};
+        template <class K, class V, class C, class A> struct is_map<std::map<K, V, C, A>> : std::true_type {};
+        template <class K, class V, class H, class E, class A> struct is_map<std::unordered_map<K, V, H, E, A>> : std::true_type {};
+        template <class T> struct is_pair : std::false_type {};
+        template <class A, class B> struct is_pair<std::pair<A, B>> : std::true_type {};
+        template <class T> struct is_optional : std::false_type {};
+        template <class T> struct is_optional<std::optional<T>> : std::true_type {};
+        template <class T> struct is_time_point : std::false_type {};
+        template <class C, class D> struct is_time_point<std::chrono::time_point<C, D>> : std::true_type {};
+    } // namespace detail
+
+    class BinaryWriter {
+    public:
+        explicit BinaryWriter(std::ostream& out) : out_(out) {}
+
+        template <class T>
+        void write(const T& value) {
+            if constexpr (detail::is_string<T>::value) {
+                write(static_cast<std::uint64_t>(value.size()));
+                out_.write(value.data(), static_cast<std::streamsize>(value.size()));
+            } else if constexpr (detail::is_time_point<T>::value) {
+                write(static_cast<std::int64_t>(value.time_since_epoch().count()));
+            } else if constexpr (detail::is_pair<T>::value) {
+                write(value.first);
+                write(value.second);
+            } else if constexpr (detail::is_optional<T>::value) {
+                write(value.has_value());
+                if (value.has_value()) write(*value);
+            } else if constexpr (detail::is_arithmetic_ring<T>::value) {
+                // The deque encoding, written a contiguous run at a time
+                write(static_cast<std::uint64_t>(value.size()));
+                const auto runs = value.segments();
+                for (const auto& run : {runs.first, runs.second}) {
+                    out_.write(reinterpret_cast<const char*>(run.data), static_cast<std::streamsize>(run.size * sizeof(*run.data)));
+                }
+            } else if constexpr (detail::is_vector<T>::value || detail::is_deque<T>::value || detail::is_map<T>::value) {
+                write(static_cast<std::uint64_t>(value.size()));
+                for (const auto& element : value) write(element);
+            } else {
+                static_assert(std::is_trivially_copyable_v<T>, "BinaryWriter: unsupported type");
+                out_.write(reinterpret_cast<const char*>(&value), sizeof(T));
+            }
+            if (!out_) throw std::runtime_error("BinaryWriter: write failed");
+        }
+
+    private:
+        std::ostream& out_;
+    };
+
+    class BinaryReader {
+    public:
+        explicit BinaryReader(std::istream& in) : in_(in) {}
+
+        template <class T>
+        void read(T& value) {
+            if constexpr (detail::is_string<T>::value) {
+                value.resize(static_cast<size_t>(read_size()));
+                in_.read(value.data(), static_cast<std::streamsize>(value.size()));
+            } else if constexpr (detail::is_time_point<T>::value) {
+                value = T(typename T::duration(read<std::int64_t>()));
+            } else if constexpr (detail::is_pair<T>::value) {
+                read(value.first);
+                read(value.second);
+            } else if constexpr (detail::is_optional<T>::value) {
+                value.reset();
+                if (read<bool>()) {
+                    typename T::value_type inner{};
+                    read(inner);
+                    value = std::move(inner);
+                }
+            } else if constexpr (detail::is_vector<T>::value || detail::is_deque<T>::value) {
+                value.clear();
+                std::uint64_t count = read_size();
+                for (std::uint64_t i = 0; i < count; ++i) {
+                    typename T::value_type element{};
+                    read(element);
+                    value.push_back(std::move(element));
+                }
+            } else if constexpr (detail::is_map<T>::value) {
+                value.clear();
+                std::uint64_t count = read_size();
+                for (std::uint64_t i = 0; i < count; ++i) {
+                    typename T::key_type key{};
+                    typename T::mapped_type mapped{};
+                    read(key);
+                    read(mapped);
+                    value.emplace(std::move(key), std::move(mapped));
+                }
+            } else {
+                static_assert(std::is_trivially_copyable_v<T>, "BinaryReader: unsupported type");
+                in_.read(reinterpret_cast<char*>(&value), sizeof(T));
+            }
+            if (!in_) throw std::runtime_error("BinaryReader: unexpected end of checkpoint data");
+        }
+
+        template <class T>
+        T read() {
+            T value{};
+            read(value);
+            return value;
+        }
+
+        // Reads a value and throws if it differs from what the caller expects
+        // (used to reject checkpoints taken with different strategy parameters)
+        template <class T>
+        void expect(const T& expected, const char* what) {
+            if (read<T>() != expected) {
+                throw std::runtime_error(std::string("Checkpoint mismatch: ") + what);
+            }
+        }
+
+    private:
+        std::istream& in_;
+
+        std::uint64_t read_size() {
+            std::uint64_t size = 0;
+            in_.read(reinterpret_cast<char*>(&size), sizeof(size));
+            if (!in_) throw std::runtime_error("BinaryReader: unexpected end of checkpoint data");
+            return size;
+        }
+    };
+
+} // namespace Backtester::Common
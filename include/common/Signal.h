@@ -1,19 +1,21 @@
 #pragma once
 #include <chrono>
-#include <string>
+#include <string_view>
 #include <optional>
 #include "OrderTypes.h"
 
 namespace Backtester::Common {
+    // A signal lives for one generate_order call (SignalEvent holds it by reference), so the
+    // symbol is a view: the caller's string must outlive the signal.
     struct Signal {
         std::chrono::time_point<std::chrono::system_clock> timestamp;
-        std::string symbol;
+        std::string_view symbol;
         SignalDirection direction;
         std::optional<double> strength;
 
         Signal(std::chrono::time_point<std::chrono::system_clock> ts,
-               std::string sym, SignalDirection dir,
+               std::string_view sym, SignalDirection dir,
                std::optional<double> str = std::nullopt)
-            : timestamp(ts), symbol(std::move(sym)), direction(dir), strength(str) {}
+            : timestamp(ts), symbol(sym), direction(dir), strength(str) {}
     };
-}
\ No newline at end of file
+}
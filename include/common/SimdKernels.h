@@ -0,0 +1,81 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// --- SIMD kernel layer ---
+// Batch indicator math over contiguous double arrays, with AVX-512, AVX2 and scalar
+// implementations chosen at run time. The level is the best one both the CPU and the build
+// support (x86-64 with GCC or Clang builds all three; other targets only the scalar one),
+// unless the BACKTESTER_SIMD environment variable (scalar, avx2 or avx512) caps it, or
+// set_level() does.
+//
+// Every kernel is lane-wise: element j of the outputs depends only on element j of the
+// inputs, so the vector implementations perform the very operations of the scalar one, in
+// the same order, and round identically (the kernel translation units are built with
+// -ffp-contract=off so no multiply-add is fused). Results never depend on the level; only
+// the speed does. Lanes are either the bars of one series (returns, true range, typical
+// prices, z-scores) or the symbols / pairs of one cross-section (the window updates).
+namespace Backtester::Common::Simd {
+
+    enum class Level : std::uint8_t { SCALAR, AVX2, AVX512 };
+
+    const char* level_name(Level level);
+    // Best level this CPU and build support
+    Level supported_level();
+    // Level the kernels run at
+    Level active_level();
+    // Runs the kernels at 'level', capped at supported_level(); returns the level in effect
+    Level set_level(Level level);
+
+    // --- Rolling windows across lanes ---
+    // Windowed sums as a value enters and another leaves each lane's window:
+    // sum[j] += in[j] - out[j], sum_sq[j] += in[j]^2 - out[j]^2
+    void window_sums(double* sum, double* sum_sq, const double* in, const double* out, size_t n);
+    // Windowed cross products against two scalars: cross[j] += a * in[j] - b * out[j]
+    void window_cross(double* cross, double a, const double* in, double b, const double* out, size_t n);
+
+    // --- Spread variances across lanes ---
+    // Lane j follows the spread a - b[j] (e.g. one symbol's log price against a row of
+    // others) with a Welford mean and M2; inv_count is 1 / (values in the window)
+    // A value enters a window that is still filling
+    void spread_window_add(double* mean, double* m2, double a, const double* b, double inv_count, size_t n);
+    // A value enters a full window and the spread a_out - b_out[j] leaves it
+    void spread_window_replace(double* mean, double* m2, double a, const double* b, double a_out,
+                               const double* b_out, double inv_count, size_t n);
+
+    // --- Standard scores ---
+    // z[j] = (x[j] - mean[j]) / sqrt(m2[j] / dof), as RollingVariance::stddev() divides
+    // (dof = window - 1); NaN where that stddev is under 1e-9, so any threshold test on a
+    // flat window is false
+    void zscores(const double* x, const double* mean, const double* m2, double dof, size_t n, double* z);
+
+    // --- Bar transforms ---
+    // Simple returns, out[j] = current[j] / previous[j] - 1 (0 where |previous[j]| <= 1e-9)
+    void returns(const double* previous, const double* current, size_t n, double* out);
+    // True range, max(high - low, |high - previous_close|, |low - previous_close|)
+    void true_range(const double* high, const double* low, const double* previous_close, size_t n, double* out);
+    // VWAP inputs: the typical price (high + low + close) / 3 (the close where high or low is
+    // not positive) and its product with the volume
+    void typical_prices(const double* high, const double* low, const double* close, const double* volume, size_t n,
+                        double* typical, double* price_volume);
+
+    namespace detail {
+        // One implementation of every kernel; the vector tables hand their tails (n not a
+        // multiple of the vector width) to the scalar one
+        struct KernelTable {
+            void (*window_sums)(double*, double*, const double*, const double*, size_t);
+            void (*window_cross)(double*, double, const double*, double, const double*, size_t);
+            void (*spread_window_add)(double*, double*, double, const double*, double, size_t);
+            void (*spread_window_replace)(double*, double*, double, const double*, double, const double*, double, size_t);
+            void (*zscores)(const double*, const double*, const double*, double, size_t, double*);
+            void (*returns)(const double*, const double*, size_t, double*);
+            void (*true_range)(const double*, const double*, const double*, size_t, double*);
+            void (*typical_prices)(const double*, const double*, const double*, const double*, size_t, double*, double*);
+        };
+        extern const KernelTable kScalarKernels;
+        // nullptr when the build has no kernels for the level
+        const KernelTable* avx2_kernels();
+        const KernelTable* avx512_kernels();
+    }
+
+} // namespace Backtester::Common::Simd
@@ -0,0 +1,55 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Backtester::Common {
+
+    // --- Fork-join thread pool ---
+    // Persistent workers for data-parallel loops that run many times (e.g. once per bar), where
+    // starting threads per call -- as ShardedBacktester does per run -- would cost more than the
+    // work. parallel_for() hands out task indices from a shared counter to the workers and the
+    // calling thread, and returns once every task has finished; the first exception a task
+    // throws is rethrown to the caller (the remaining tasks still run).
+    //
+    // One parallel_for at a time: calls from several threads are serialized.
+    class ThreadPool {
+    public:
+        // 'threads' counts the calling thread; 0 uses std::thread::hardware_concurrency()
+        explicit ThreadPool(unsigned threads = 0);
+        ~ThreadPool();
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        unsigned size() const { return static_cast<unsigned>(workers_.size()) + 1; }
+
+        // Runs task(i) for every i in [0, count)
+        void parallel_for(size_t count, const std::function<void(size_t)>& task);
+
+    private:
+        std::vector<std::thread> workers_;
+        std::mutex call_mutex_; // Serializes parallel_for callers
+        std::mutex mutex_;
+        std::condition_variable wake_;
+        std::condition_variable done_;
+
+        // The current job (guarded by mutex_ except the counters)
+        const std::function<void(size_t)>* task_ = nullptr;
+        size_t count_ = 0;
+        std::atomic<size_t> next_{0};
+        size_t active_ = 0;              // Workers inside the current job
+        std::uint64_t generation_ = 0;   // Bumped per job so each worker joins it once
+        std::exception_ptr error_;
+        bool stopping_ = false;
+
+        void worker_loop();
+        void run_tasks(const std::function<void(size_t)>& task, size_t count);
+    };
+
+} // namespace Backtester::Common
@@ -0,0 +1,81 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <utility>
+
+// --- Timeline tracing (Chrome Trace Event format) ---
+// Spans are recorded into per-thread buffers and dumped as JSON that chrome://tracing,
+// Perfetto (ui.perfetto.dev) or speedscope can open. Tracing is off by default; a
+// disabled span costs one relaxed atomic load.
+//
+//   Trace::set_enabled(true);
+//   { BT_TRACE_SCOPE("load_data", "io"); dm->load_data(path); }
+//   { Trace::Span span("run", "backtest", strategy_name); backtester.run(); }
+//   Trace::write_chrome_json("trace.json");
+//
+// Names and categories must be string literals (only the pointer is stored); the optional
+// detail string is copied and shown under "args" in the viewer.
+namespace Backtester::Trace {
+
+    namespace detail {
+        inline std::atomic<bool>& enabled_flag() {
+            static std::atomic<bool> flag{false};
+            return flag;
+        }
+    } // namespace detail
+
+    inline bool is_enabled() { return detail::enabled_flag().load(std::memory_order_relaxed); }
+    inline void set_enabled(bool enabled) { detail::enabled_flag().store(enabled, std::memory_order_relaxed); }
+
+    // Microseconds on the steady clock (the trace format's time unit)
+    inline double now_us() {
+        return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // Appends a complete span to the calling thread's buffer
+    void record(const char* name, const char* category, double start_us, double end_us, std::string detail = {});
+    // Label for the calling thread's row in the viewer
+    void set_thread_name(const std::string& name);
+    // Writes every thread's spans; throws std::runtime_error if the file cannot be written
+    void write_chrome_json(const std::string& path);
+    // Drops all recorded spans
+    void clear();
+
+    // RAII span; records nothing if tracing was disabled when it was opened
+    class Span {
+    public:
+        Span(const char* name, const char* category) : name_(name), category_(category) {
+            if (is_enabled()) start_us_ = now_us();
+        }
+        Span(const char* name, const char* category, const std::string& detail) : name_(name), category_(category) {
+            if (is_enabled()) {
+                detail_ = detail;
+                start_us_ = now_us();
+            }
+        }
+        ~Span() { end(); }
+        // Closes the span early (idempotent)
+        void end() {
+            if (start_us_ >= 0.0) {
+                record(name_, category_, start_us_, now_us(), std::move(detail_));
+                start_us_ = -1.0;
+            }
+        }
+        Span(const Span&) = delete;
+        Span& operator=(const Span&) = delete;
+
+    private:
+        const char* name_;
+        const char* category_;
+        double start_us_ = -1.0;
+        std::string detail_;
+    };
+
+} // namespace Backtester::Trace
+
+#define BT_TRACE_CONCAT_INNER(a, b) a##b
+#define BT_TRACE_CONCAT(a, b) BT_TRACE_CONCAT_INNER(a, b)
+#define BT_TRACE_SCOPE(name, category) \
+    ::Backtester::Trace::Span BT_TRACE_CONCAT(bt_trace_span_, __LINE__)(name, category)
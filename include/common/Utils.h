@@ -1,14 +1,40 @@
 #pragma once // Use include guards
 
 #include <string>         // For std::string
-#include <chrono>         // For std::chrono::system_clock::time_point, to_time_t
-#include <sstream>        // For std::stringstream
-#include <iomanip>        // For std::put_time
-#include <ctime>          // For std::time_t, std::tm, std::gmtime
+#include <chrono>         // For std::chrono::system_clock::time_point
+#include <cstdint>        // For std::int64_t
+#include <cstdio>         // For std::snprintf
 
 // Define a namespace for utility functions to avoid polluting the global namespace
 namespace Backtester::Utils {
 
+    // Writes "YYYY-MM-DD HH:MM:SS UTC" for a Unix time (seconds) into buf, which must hold at
+    // least 24 chars (23 + terminator). Returns the number of chars written (excluding '\0').
+    // Pure arithmetic (days-to-civil conversion) - no locale, stream or libc time calls, so it is
+    // cheap and safe to call from any thread (used by the async logger).
+    inline size_t formatTimestampUTC(char* buf, std::int64_t seconds_since_epoch) {
+        std::int64_t days = seconds_since_epoch / 86400;
+        std::int64_t secs_of_day = seconds_since_epoch % 86400;
+        if (secs_of_day < 0) { secs_of_day += 86400; days -= 1; }
+
+        // Civil-from-days (proleptic Gregorian), see H. Hinnant's date algorithms
+        days += 719468;
+        const std::int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+        const std::int64_t doe = days - era * 146097;
+        const std::int64_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+        const std::int64_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+        const std::int64_t mp = (5 * doy + 2) / 153;
+        const std::int64_t day = doy - (153 * mp + 2) / 5 + 1;
+        const std::int64_t month = mp < 10 ? mp + 3 : mp - 9;
+        const std::int64_t year = yoe + era * 400 + (month <= 2 ? 1 : 0);
+
+        const int written = std::snprintf(buf, 24, "%04d-%02d-%02d %02d:%02d:%02d UTC",
+                                          static_cast<int>(year), static_cast<int>(month), static_cast<int>(day),
+                                          static_cast<int>(secs_of_day / 3600), static_cast<int>((secs_of_day / 60) % 60),
+                                          static_cast<int>(secs_of_day % 60));
+        return written > 0 ? static_cast<size_t>(written) : 0;
+    }
+
     // Utility function to format time_point for printing (using UTC)
     // Declared 'inline' as it's defined directly in the header.
     inline std::string formatTimestampUTC(const std::chrono::system_clock::time_point& tp) {
@@ -16,20 +42,29 @@ namespace Backtester::Utils {
         if (tp == std::chrono::system_clock::time_point::min() || tp == std::chrono::system_clock::time_point::max()) {
             return "N/A"; // Return "N/A" for uninitialized or end-of-data markers
         }
+        // Whole seconds since epoch (floor, so pre-1970 sub-second times round down)
+        auto seconds = std::chrono::floor<std::chrono::seconds>(tp.time_since_epoch()).count();
+        char buf[32];
+        size_t length = formatTimestampUTC(buf, static_cast<std::int64_t>(seconds));
+        return std::string(buf, length);
+    }
 
-        // Convert time_point to time_t (seconds since epoch)
-        std::time_t time = std::chrono::system_clock::to_time_t(tp);
-
-        // Convert time_t to a UTC time structure (std::tm)
-        // Use std::gmtime for UTC, std::localtime for local time zone
-        std::tm utc_tm = *std::gmtime(&time); // Dereference pointer returned by gmtime
-
-        // Use a stringstream and std::put_time to format the tm struct
-        std::stringstream ss;
-        // Example Format: YYYY-MM-DD HH:MM:SS UTC (ISO 8601 like)
-        ss << std::put_time(&utc_tm, "%Y-%m-%d %H:%M:%S UTC");
+    // Calendar day index of a timestamp after applying the session offset (floor division):
+    // the trading session a bar belongs to for day-sharded replay and the intraday strategies
+    inline long long session_day(const std::chrono::system_clock::time_point& ts,
+                                 std::chrono::seconds offset = std::chrono::seconds(0)) {
+        long long secs = std::chrono::duration_cast<std::chrono::seconds>(ts.time_since_epoch() + offset).count();
+        constexpr long long seconds_per_day = 86400;
+        long long day = secs / seconds_per_day;
+        if (secs % seconds_per_day < 0) --day;
+        return day;
+    }
 
-        return ss.str(); // Return the formatted string
+    // Whole minutes since the start of the timestamp's session day (see session_day)
+    inline int session_minute(const std::chrono::system_clock::time_point& ts,
+                              std::chrono::seconds offset = std::chrono::seconds(0)) {
+        long long secs = std::chrono::duration_cast<std::chrono::seconds>(ts.time_since_epoch() + offset).count();
+        return static_cast<int>((secs - session_day(ts, offset) * 86400) / 60);
     }
 
     // --- Add other common utility functions below as needed ---
@@ -35,19 +35,21 @@ namespace Backtester {
         }
 
         // Calculates features based on the provided market data snapshot
-        virtual FeatureMap calculate_features(const Common::DataSnapshot& data) {
+        FeatureMap calculate_features(const Common::DataSnapshot& data) {
             FeatureMap features; // Create the map to store results
+            calculate_features(data, features);
+            return features; // Return the populated map
+        }
 
+        // Same, writing into a caller-owned map: reusing one map across bars overwrites the
+        // existing entries in place instead of building (and allocating) a new map each time
+        virtual void calculate_features(const Common::DataSnapshot& data, FeatureMap& features) {
             // Determine the correct key for the closing price ('Close' or 'close')
-            std::string close_key = "";
-            if (data.count("Close")) { // Check uppercase first (common convention)
-                close_key = "Close";
-            } else if (data.count("close")) { // Check lowercase as fallback
-                close_key = "close";
-            }
+            auto close_it = data.find("Close"); // Check uppercase first (common convention)
+            if (close_it == data.end()) close_it = data.find("close"); // Check lowercase as fallback
 
-            if (!close_key.empty()) {
-                 double close_price = data.at(close_key); // Get the close price once
+            if (close_it != data.end()) {
+                 double close_price = close_it->second; // Get the close price once
 
                  // --- Corrected Assignments using Map Keys ---
                  features["price"] = close_price;       // Assign close price to "price" feature
@@ -74,8 +76,6 @@ namespace Backtester {
 
             // --- TA-Lib Lookback Handling Comment ---
             // ... (comment remains the same) ...
-
-            return features; // Return the populated map
         }
 
         // Add private helper methods for actual calculations if needed
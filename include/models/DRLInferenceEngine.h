@@ -1,6 +1,7 @@
 #pragma once
 
 #include "InferenceEngine.h" // Include base class if using it
+#include "../common/Logger.h"
 #include <vector>
 #include <string>
 #include <unordered_map> // Keep for FeatureMap type alias if used elsewhere
@@ -41,15 +42,24 @@ namespace Backtester {
 
         // --- CORRECTED predict Signature and Return ---
         ModelOutput predict(const FeatureVector& features) override {
+            ModelOutput probabilities;
+            predict(features, probabilities);
+            return probabilities; // Return the vector of probabilities/scores
+        }
+
+        // Same, writing into a caller-owned buffer (no allocation once it has num_actions_ capacity)
+        void predict(const FeatureVector& features, ModelOutput& probabilities) {
             if (!model_loaded_) {
-                std::cerr << "DRL MOCK Warning: Model not loaded, returning default output." << std::endl;
-                return ModelOutput(num_actions_, 1.0/num_actions_); // Return uniform probabilities
+                BT_LOG_WARN("DRL MOCK Warning: Model not loaded, returning default output.");
+                probabilities.assign(num_actions_, 1.0/num_actions_); // Return uniform probabilities
+                return;
             }
             // Input validation is important for actual model
             if (features.size() != expected_feature_size_) {
-                 std::cerr << "DRL MOCK Warning: Feature vector size mismatch. Expected "
-                           << expected_feature_size_ << ", Got " << features.size() << std::endl;
-                 return ModelOutput(num_actions_, 1.0/num_actions_);
+                 BT_LOG_WARN("DRL MOCK Warning: Feature vector size mismatch. Expected {}, Got {}",
+                             expected_feature_size_, features.size());
+                 probabilities.assign(num_actions_, 1.0/num_actions_);
+                 return;
             }
 
             // --- Actual Inference Logic Placeholder ---
@@ -58,7 +68,7 @@ namespace Backtester {
             // 3. Convert output tensor back to ModelOutput (std::vector)
 
             // --- Placeholder Output (Example Probabilities) ---
-            ModelOutput probabilities(num_actions_);
+            probabilities.assign(num_actions_, 0.0);
             // Simulate some output probabilities (e.g., slightly favor HOLD)
             probabilities[0] = 0.3; // Probability of BUY
             probabilities[1] = 0.2; // Probability of SELL
@@ -66,8 +76,6 @@ namespace Backtester {
             // Optional: Normalize if model doesn't guarantee sum to 1
              double sum = std::accumulate(probabilities.begin(), probabilities.end(), 0.0);
              if (sum > 1e-9) { for(double& p : probabilities) p /= sum; }
-
-            return probabilities; // Return the vector of probabilities/scores
         }
     }; // End class DRLInferenceEngine
 
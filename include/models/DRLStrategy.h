@@ -6,9 +6,12 @@
 #include <vector>
 #include <string>
 #include <map>      // <<< ADDED THIS INCLUDE for std::map
+#include <unordered_map>
 #include <memory>   // For std::unique_ptr (used in example constructor)
+#include <memory_resource>
 // Include necessary common types fully if needed by members, otherwise forward declare
 #include "../common/OrderTypes.h" // Needed for SignalDirection member
+#include "../common/RunArena.h"   // SymbolMap
 
 // --- Forward declare dependencies used only as references/pointers IN THIS HEADER ---
 namespace Backtester {
@@ -33,7 +36,8 @@ namespace Backtester {
             FeatureCalculator& fc,
             DRLInferenceEngine& ie,
             const std::vector<std::string>& symbols,
-            double target_size
+            double target_size,
+            std::pmr::memory_resource* resource = std::pmr::get_default_resource()
         ); // Definition goes in .cpp file
 
         // Alternative constructor if taking ownership of engine:
@@ -47,6 +51,10 @@ namespace Backtester {
         // Override base class method - ensure signature matches base
         void handle_market_event(const Common::MarketEvent& event, Portfolio& portfolio) override; // Definition in .cpp
 
+        // Checkpoint hooks (only the signal state; model/feature objects are external)
+        void serialize(Common::BinaryWriter& writer) const override;
+        void deserialize(Common::BinaryReader& reader) override;
+
     private:
         // --- Member Variables ---
         // Store references to dependencies (ensure their lifetime exceeds this object's)
@@ -57,8 +65,13 @@ namespace Backtester {
         std::vector<std::string> symbols_to_trade_;
         double target_position_size_;
 
-        // Internal state - uses std::map
-        std::map<std::string, Common::SignalDirection> current_signal_state_;
+        // Internal state - ordered per-symbol map (from the run's memory resource)
+        Common::SymbolMap<Common::SignalDirection> current_signal_state_;
+
+        // Per-bar scratch, reused so steady-state bars do not allocate
+        std::unordered_map<std::string, double> features_;
+        std::vector<double> model_input_;
+        std::vector<double> predictions_;
 
     }; // End class DRLStrategy
 
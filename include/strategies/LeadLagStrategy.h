@@ -4,16 +4,22 @@
 #include "common/Event.h"
 #include "common/Signal.h"
 #include "common/Utils.h"
+#include "common/Logger.h"
+#include "common/RingBuffer.h"
+#include "common/RollingStats.h"
+#include "common/RunArena.h"
 #include "backtester/Portfolio.h"
+#include "backtester/LeadLagEngine.h"
+#include <chrono>
 #include <string>
 #include <vector>
-#include <deque>
 #include <numeric>
 #include <cmath>
 #include <iostream>
 #include <map>
+#include <memory>
+#include <memory_resource>
 #include <stdexcept>
-#include <algorithm> // For std::reverse
 
 namespace Backtester {
 
@@ -32,12 +38,27 @@ namespace Backtester {
             double close = 0.0;
             double previous_close = 0.0; // Store previous close to calculate return
             bool has_current = false;
+            std::chrono::system_clock::time_point timestamp{}; // Of 'close'
         };
-        std::map<std::string, PriceInfo> latest_prices_; // Tracks latest prices for pair
-        std::deque<std::pair<double, double>> return_history_; // (leader_return, lagger_return)
+        // Latest prices of the two legs. Fixed slots rather than a map keyed by every symbol
+        // seen (checkpoints still encode them as that map).
+        PriceInfo leader_price_;
+        PriceInfo lagger_price_;
+        // Slice ids of the legs
+        SliceSymbol slice_leader_;
+        SliceSymbol slice_lagger_;
+        // Leader returns of the latest steps (a fixed-capacity ring holding at least
+        // lag_period_ + 1), and the rolling correlation of each lagger return with the leader
+        // return lag_period_ steps earlier
+        Common::RingBuffer<double> leader_returns_;
+        Common::RollingCovariance lagged_returns_; // (leader return lag steps ago, lagger return)
+
+        // Engine mode: the pair is read from a (possibly shared) universe-wide engine instead
+        std::shared_ptr<LeadLagEngine> engine_;
+        LeadLagEngine::Subscription subscription_;
 
         // Track signal state for the LAGGING symbol
-        std::map<std::string, Common::SignalDirection> last_signal_direction_;
+        Common::SymbolMap<Common::SignalDirection> last_signal_direction_;
 
          // Helper to get close price
          bool get_close_price(const Common::DataSnapshot& data, double& close_price) const {
@@ -49,103 +70,179 @@ namespace Backtester {
     public:
         LeadLagStrategy(std::string leader, std::string lagger,
                         size_t corr_window = 30, size_t lag = 1,
-                        double corr_thresh = 0.6, double leader_ret_thresh = 0.0002)
+                        double corr_thresh = 0.6, double leader_ret_thresh = 0.0002,
+                        std::pmr::memory_resource* resource = std::pmr::get_default_resource())
             : leading_symbol_(std::move(leader)), lagging_symbol_(std::move(lagger)),
               correlation_window_(corr_window), lag_period_(lag),
-              correlation_threshold_(corr_thresh), leader_return_threshold_(leader_ret_thresh)
-              { /* Validation */ }
+              correlation_threshold_(corr_thresh), leader_return_threshold_(leader_ret_thresh),
+              leader_returns_(lag_period_ + 2, resource),
+              lagged_returns_(correlation_window_, resource), last_signal_direction_(resource) {}
+
+        // Engine mode: correlation and leader return come from 'engine' (window and lag range
+        // are the engine's). Every strategy sharing the engine forwards its bars to it; the
+        // engine records each bar once.
+        LeadLagStrategy(std::shared_ptr<LeadLagEngine> engine, std::string leader, std::string lagger,
+                        size_t lag = 1, double corr_thresh = 0.6, double leader_ret_thresh = 0.0002,
+                        std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+            : leading_symbol_(std::move(leader)), lagging_symbol_(std::move(lagger)),
+              correlation_window_(engine ? engine->window() : 0), lag_period_(lag),
+              correlation_threshold_(corr_thresh), leader_return_threshold_(leader_ret_thresh),
+              leader_returns_(resource), lagged_returns_(resource),
+              engine_(std::move(engine)), last_signal_direction_(resource) {
+            if (!engine_) throw std::invalid_argument("LeadLagStrategy: null engine");
+            subscription_ = engine_->subscribe(leading_symbol_, lagging_symbol_, lag_period_);
+        }
 
         void handle_market_event(const Common::MarketEvent& event, Portfolio& portfolio) override {
+            if (engine_) {
+                if (engine_->on_bar(event) && engine_->ready(lag_period_)) {
+                    update_signal(event.timestamp, engine_->correlation(subscription_),
+                                  engine_->lagged_return(subscription_), portfolio);
+                }
+                return;
+            }
             const std::string& current_symbol = event.symbol;
             double current_close = 0.0;
             if (!get_close_price(event.marketData, current_close)) return;
 
             // Update the price info for the current symbol, storing the previous close
-            PriceInfo& info = latest_prices_[current_symbol]; // Get/create entry
-            info.previous_close = info.close; // Store the last known close as previous
-            info.close = current_close;       // Update with current close
-            info.has_current = true;          // Mark that we have data for this tick
+            if (current_symbol == leading_symbol_) record_close(leader_price_, current_close, event.timestamp);
+            if (current_symbol == lagging_symbol_) record_close(lagger_price_, current_close, event.timestamp);
 
             // Check if we have updated data for BOTH symbols in this logical time step
-            if (latest_prices_.count(leading_symbol_) && latest_prices_[leading_symbol_].has_current &&
-                latest_prices_.count(lagging_symbol_) && latest_prices_[lagging_symbol_].has_current)
-            {
-                 // Calculate returns using previous_close stored in the PriceInfo struct
-                 double leader_return = 0.0;
-                 double lagger_return = 0.0;
-                 if (latest_prices_[leading_symbol_].previous_close > 1e-9) {
-                      leader_return = (latest_prices_[leading_symbol_].close / latest_prices_[leading_symbol_].previous_close) - 1.0;
-                 }
-                  if (latest_prices_[lagging_symbol_].previous_close > 1e-9) {
-                      lagger_return = (latest_prices_[lagging_symbol_].close / latest_prices_[lagging_symbol_].previous_close) - 1.0;
-                 }
-
-                 // Store return pair
-                 return_history_.emplace_back(leader_return, lagger_return);
-                 if (return_history_.size() > correlation_window_ + lag_period_) {
-                     return_history_.pop_front();
-                 }
-
-                 // Calculate correlation if enough history
-                 if (return_history_.size() >= correlation_window_ + lag_period_) {
-                     double correlation = calculate_lagged_correlation(lag_period_);
-                     double leader_lagged_return = return_history_[return_history_.size() - 1 - lag_period_].first;
-
-                     // Signal Generation
-                     Common::SignalDirection desired_signal = Common::SignalDirection::FLAT;
-                     if (correlation > correlation_threshold_) {
-                         if (leader_lagged_return > leader_return_threshold_) desired_signal = Common::SignalDirection::LONG;
-                         else if (leader_lagged_return < -leader_return_threshold_) desired_signal = Common::SignalDirection::SHORT;
-                     }
-                     // Add logic for negative correlation if desired
-
-                     // Generate Orders for Lagging Symbol if signal changes
-                     std::string signal_key = lagging_symbol_;
-                     if (desired_signal != last_signal_direction_[signal_key]) {
-                         // ***** CORRECTED NAMESPACE *****
-                          std::cout << "LEADLAG (" << leading_symbol_ << "->" << lagging_symbol_ << "): "
-                                    << " @ " << Utils::formatTimestampUTC(event.timestamp) // Use Utils::
-                                    << " Corr=" << correlation << " LeadRet(" << lag_period_ << ")=" << leader_lagged_return
-                                    << " Signal=" << Common::to_string(desired_signal) << std::endl;
-
-                         Common::Signal signal(event.timestamp, lagging_symbol_, desired_signal);
-                         Common::SignalEvent signal_event(event.timestamp, signal);
-                         portfolio.generate_order(signal_event);
-
-                         last_signal_direction_[signal_key] = desired_signal;
-                     }
-                 } // End if enough history for correlation
-
-                // Mark prices as 'used' for this time step calculation
-                 latest_prices_[leading_symbol_].has_current = false;
-                 latest_prices_[lagging_symbol_].has_current = false;
-            } // end if have prices for both
+            if (step_ready()) close_step(event.timestamp, portfolio);
         } // end handle_market_event
 
+        // Slice delivery: the legs' bars of a timestamp arrive together
+        void handle_slice(const CrossSection& slice, Portfolio& portfolio) override {
+            if (engine_) {
+                if (engine_->on_slice(slice) && engine_->ready(lag_period_)) {
+                    update_signal(slice.timestamp(), engine_->correlation(subscription_),
+                                  engine_->lagged_return(subscription_), portfolio);
+                }
+                return;
+            }
+            const Common::SymbolId leader = slice_leader_.resolve(slice, leading_symbol_);
+            const Common::SymbolId lagger = slice_lagger_.resolve(slice, lagging_symbol_);
+            if (slice.has_bar(leader) && !std::isnan(slice.close(leader))) record_close(leader_price_, slice.close(leader), slice.timestamp());
+            if (slice.has_bar(lagger) && !std::isnan(slice.close(lagger))) record_close(lagger_price_, slice.close(lagger), slice.timestamp());
+            if (step_ready()) close_step(slice.timestamp(), portfolio);
+        }
+
+        // --- Checkpoint hooks ---
+        // In engine mode the engine's state is saved with the strategy (restoring it once per
+        // sharing strategy is harmless: they all saved the same state)
+        void serialize(Common::BinaryWriter& writer) const override {
+            writer.write(leading_symbol_);
+            writer.write(lagging_symbol_);
+            writer.write(correlation_window_);
+            writer.write(lag_period_);
+            writer.write(static_cast<bool>(engine_));
+            if (engine_) {
+                engine_->serialize(writer);
+            } else {
+                // The legs, encoded as the symbol -> price map earlier versions kept
+                std::map<std::string, PriceInfo> prices;
+                prices[leading_symbol_] = leader_price_;
+                prices[lagging_symbol_] = lagger_price_;
+                writer.write(prices);
+                writer.write(leader_returns_);
+                lagged_returns_.serialize(writer);
+            }
+            writer.write(last_signal_direction_);
+        }
+
+        void deserialize(Common::BinaryReader& reader) override {
+            reader.expect(leading_symbol_, "LeadLagStrategy leader");
+            reader.expect(lagging_symbol_, "LeadLagStrategy lagger");
+            reader.expect(correlation_window_, "LeadLagStrategy correlation window");
+            reader.expect(lag_period_, "LeadLagStrategy lag");
+            reader.expect(static_cast<bool>(engine_), "LeadLagStrategy engine mode");
+            if (engine_) {
+                engine_->deserialize(reader);
+            } else {
+                auto prices = reader.read<std::map<std::string, PriceInfo>>();
+                auto find_leg = [&](const std::string& symbol) {
+                    auto it = prices.find(symbol);
+                    return it != prices.end() ? it->second : PriceInfo{};
+                };
+                leader_price_ = find_leg(leading_symbol_);
+                lagger_price_ = find_leg(lagging_symbol_);
+                reader.read(leader_returns_);
+                lagged_returns_.deserialize(reader);
+            }
+            reader.read(last_signal_direction_);
+        }
+
     private:
-         double calculate_lagged_correlation(size_t lag) { /* ... implementation same as before ... */
-             if (return_history_.size() < correlation_window_ + lag) return 0.0;
-             std::vector<double> lagger_returns_now, leader_returns_lagged;
-             lagger_returns_now.reserve(correlation_window_); leader_returns_lagged.reserve(correlation_window_);
-             for (size_t i = 0; i < correlation_window_; ++i) {
-                 size_t current_index = return_history_.size() - 1 - i; size_t lagged_index = current_index - lag;
-                 lagger_returns_now.push_back(return_history_[current_index].second);
-                 leader_returns_lagged.push_back(return_history_[lagged_index].first);
-             }
-             std::reverse(lagger_returns_now.begin(), lagger_returns_now.end());
-             std::reverse(leader_returns_lagged.begin(), leader_returns_lagged.end());
-             double mean_lagger = std::accumulate(lagger_returns_now.begin(), lagger_returns_now.end(), 0.0) / correlation_window_;
-             double mean_leader_lagged = std::accumulate(leader_returns_lagged.begin(), leader_returns_lagged.end(), 0.0) / correlation_window_;
-             double cov_sum = 0.0, stddev_lagger_sq_sum = 0.0, stddev_leader_lagged_sq_sum = 0.0;
-             for (size_t i = 0; i < correlation_window_; ++i) {
-                  double lagger_dev = lagger_returns_now[i] - mean_lagger; double leader_lagged_dev = leader_returns_lagged[i] - mean_leader_lagged;
-                  cov_sum += lagger_dev * leader_lagged_dev;
-                  stddev_lagger_sq_sum += std::pow(lagger_dev, 2); stddev_leader_lagged_sq_sum += std::pow(leader_lagged_dev, 2);
-             }
-             double stddev_lagger = std::sqrt(stddev_lagger_sq_sum); double stddev_leader_lagged = std::sqrt(stddev_leader_lagged_sq_sum);
-             if (stddev_lagger < 1e-9 || stddev_leader_lagged < 1e-9) return 0.0;
-             return cov_sum / (stddev_lagger * stddev_leader_lagged);
-         }
+        static void record_close(PriceInfo& info, double close, std::chrono::system_clock::time_point timestamp) {
+            info.previous_close = info.close; // Store the last known close as previous
+            info.close = close;               // Update with current close
+            info.has_current = true;          // Mark that we have data for this tick
+            info.timestamp = timestamp;
+        }
+
+        // A step pairs the legs' closes of one timestamp: where one leg skipped a timestamp,
+        // its stale close would otherwise pair with the other's next one, and per bar every
+        // later step would stay shifted by a bar
+        bool step_ready() const {
+            return leader_price_.has_current && lagger_price_.has_current && leader_price_.timestamp == lagger_price_.timestamp;
+        }
+
+        // Both legs have a new close: pair the returns and trade the correlation
+        void close_step(std::chrono::system_clock::time_point timestamp, Portfolio& portfolio) {
+            // Calculate returns using previous_close stored in the PriceInfo struct
+            double leader_return = 0.0;
+            double lagger_return = 0.0;
+            if (leader_price_.previous_close > 1e-9) {
+                leader_return = (leader_price_.close / leader_price_.previous_close) - 1.0;
+            }
+            if (lagger_price_.previous_close > 1e-9) {
+                lagger_return = (lagger_price_.close / lagger_price_.previous_close) - 1.0;
+            }
+
+            // Pair this lagger return with the leader return lag_period_ steps earlier
+            leader_returns_.push_overwrite(leader_return);
+            if (leader_returns_.size() > lag_period_) {
+                const double lagged_leader_return = leader_returns_.recent(lag_period_);
+                lagged_returns_.push(lagged_leader_return, lagger_return);
+
+                // Calculate correlation once the window is full
+                if (lagged_returns_.full()) {
+                    update_signal(timestamp, lagged_returns_.correlation(1e-9), lagged_leader_return, portfolio);
+                }
+            }
+
+            // Mark prices as 'used' for this time step calculation
+            leader_price_.has_current = false;
+            lagger_price_.has_current = false;
+        }
+
+        void update_signal(std::chrono::system_clock::time_point timestamp, double correlation,
+                           double leader_lagged_return, Portfolio& portfolio) {
+            // Signal Generation
+            Common::SignalDirection desired_signal = Common::SignalDirection::FLAT;
+            if (correlation > correlation_threshold_) {
+                if (leader_lagged_return > leader_return_threshold_) desired_signal = Common::SignalDirection::LONG;
+                else if (leader_lagged_return < -leader_return_threshold_) desired_signal = Common::SignalDirection::SHORT;
+            }
+            // Add logic for negative correlation if desired
+
+            // Generate Orders for Lagging Symbol if signal changes
+            Common::SignalDirection& last_direction = Common::symbol_slot(last_signal_direction_, lagging_symbol_);
+            if (desired_signal != last_direction) {
+                // ***** CORRECTED NAMESPACE *****
+                 BT_LOG_INFO("LEADLAG ({}->{}):  @ {} Corr={} LeadRet({})={} Signal={}",
+                             leading_symbol_, lagging_symbol_, timestamp, correlation, lag_period_,
+                             leader_lagged_return, Common::to_string(desired_signal));
+
+                Common::Signal signal(timestamp, lagging_symbol_, desired_signal);
+                Common::SignalEvent signal_event(timestamp, signal);
+                portfolio.generate_order(signal_event);
+
+                last_direction = desired_signal;
+            }
+        }
 
     }; // End Class LeadLagStrategy
 
@@ -4,10 +4,14 @@
 #include "common/Event.h"
 #include "common/Signal.h"
 #include "common/Utils.h"
+#include "common/Logger.h"
+#include "common/RingColumns.h"
+#include "common/RollingStats.h" // CompensatedSum
+#include "common/RunArena.h"
 #include "backtester/Portfolio.h"
 #include <string>
 #include <map>
-#include <deque>
+#include <memory_resource>
 #include <vector>
 #include <numeric>
 #include <limits>
@@ -26,14 +30,22 @@ namespace Backtester {
         size_t return_delta_window_;
         // Sizing handled by Portfolio
 
+        // Per-bar history as one structure-of-arrays ring (a single allocation, sized for the
+        // longest window when the symbol first appears): each bar's high, low, volume and
+        // return (0 on the first bar). The windows are short, so each bar reduces the newest
+        // runs of the columns directly; sums are compensated and taken afresh per window.
+        enum Column : size_t { kHigh, kLow, kVolume, kReturn, kColumns };
         struct SymbolState {
-            std::deque<double> close_history;
-            std::deque<double> high_history;
-            std::deque<double> low_history;
-            std::deque<double> volume_history;
+            // Allocator-aware, so the history shares the symbol map's resource
+            using allocator_type = std::pmr::polymorphic_allocator<double>;
+            explicit SymbolState(const allocator_type& alloc = {}) : history(alloc) {}
+
+            Common::RingColumns<double> history;
+            double last_close = 0.0;
+            std::uint64_t bars = 0;
         };
-        std::map<std::string, SymbolState> symbol_state_;
-        std::map<std::string, Common::SignalDirection> last_signal_direction_;
+        Common::SymbolMap<SymbolState> symbol_state_;
+        Common::SymbolMap<Common::SignalDirection> last_signal_direction_;
 
          bool get_ohlcv(const Common::DataSnapshot& data, double& o, double& h, double& l, double& c, double& v) const {
              // ... (helper function as before) ...
@@ -51,9 +63,11 @@ namespace Backtester {
          }
 
     public:
-        MomentumIgnition(size_t price_window = 5, size_t vol_window = 10, double vol_mult = 2.0, size_t ret_window = 3)
+        MomentumIgnition(size_t price_window = 5, size_t vol_window = 10, double vol_mult = 2.0, size_t ret_window = 3,
+                         std::pmr::memory_resource* resource = std::pmr::get_default_resource())
             : price_breakout_window_(price_window), volume_avg_window_(vol_window),
-              volume_multiplier_(vol_mult), return_delta_window_(ret_window) {
+              volume_multiplier_(vol_mult), return_delta_window_(ret_window),
+              symbol_state_(resource), last_signal_direction_(resource) {
             if (price_window == 0 || vol_window == 0 || vol_mult <= 0 || ret_window == 0) {
                  throw std::invalid_argument("Invalid parameters for MomentumIgnition");
             }
@@ -64,55 +78,46 @@ namespace Backtester {
             double open, high, low, close, volume;
 
             if (!get_ohlcv(event.marketData, open, high, low, close, volume)) {
-                 std::cerr << "Warning (Momentum): Missing OHLCV data for symbol " << symbol << std::endl;
+                 BT_LOG_WARN("Warning (Momentum): Missing OHLCV data for symbol {}", symbol);
                  return;
             }
 
             // Update state
-            SymbolState& state = symbol_state_[symbol];
-            size_t max_lookback = std::max({price_breakout_window_, volume_avg_window_, return_delta_window_}) + 1;
-            state.close_history.push_back(close);
-            state.high_history.push_back(high);
-            state.low_history.push_back(low);
-            state.volume_history.push_back(volume);
-            while(state.close_history.size() > max_lookback) state.close_history.pop_front();
-            while(state.high_history.size() > max_lookback) state.high_history.pop_front();
-            while(state.low_history.size() > max_lookback) state.low_history.pop_front();
-            while(state.volume_history.size() > max_lookback) state.volume_history.pop_front();
-
-            if (state.close_history.size() < max_lookback) return; // Need enough history
-
-            // Condition Checks
-            bool price_breakout_up = false, price_breakout_down = false;
-            double recent_high = -std::numeric_limits<double>::max();
-            double recent_low = std::numeric_limits<double>::max();
-            for (size_t i = 0; i < price_breakout_window_; ++i) {
-                 size_t index = state.high_history.size() - 2 - i;
-                 recent_high = std::max(recent_high, state.high_history[index]);
-                 recent_low = std::min(recent_low, state.low_history[index]);
-            }
-            if (close > recent_high) price_breakout_up = true;
-            if (close < recent_low) price_breakout_down = true;
-
-            double current_volume = volume;
-            double volume_sum = 0.0;
-            for (size_t i = 0; i < volume_avg_window_; ++i) {
-                 size_t index = state.volume_history.size() - 2 - i;
-                 volume_sum += state.volume_history[index];
+            SymbolState& state = Common::symbol_slot(symbol_state_, symbol);
+            const size_t max_lookback = std::max({price_breakout_window_, volume_avg_window_, return_delta_window_}) + 1;
+            double bar_return = 0.0;
+            if (state.bars == 0) { // New symbol: size the history once
+                state.history.reset(kColumns, max_lookback - 1);
+            } else if (std::abs(state.last_close) > 1e-9) {
+                bar_return = close / state.last_close - 1.0;
             }
-            double avg_volume = (volume_avg_window_ > 0) ? volume_sum / volume_avg_window_ : 0.0;
-            bool volume_surge = current_volume > (volume_multiplier_ * avg_volume) && avg_volume > 1e-9;
+            state.last_close = close;
+            const bool warm = ++state.bars >= max_lookback; // Need enough history
 
+            // Condition Checks (against the bars before this one)
+            bool price_breakout_up = false, price_breakout_down = false;
+            bool volume_surge = false;
             double return_delta_sum = 0.0;
-            if (state.close_history.size() >= return_delta_window_ + 1) {
-                for (size_t i = 0; i < return_delta_window_; ++i) {
-                    size_t index_now = state.close_history.size() - 1 - i;
-                    size_t index_prev = index_now - 1;
-                    if (std::abs(state.close_history[index_prev]) > 1e-9) {
-                         return_delta_sum += (state.close_history[index_now] / state.close_history[index_prev]) - 1.0;
-                    }
-                }
+            if (warm) {
+                const Common::Segment<const double> highs = state.history.latest(kHigh, price_breakout_window_);
+                const Common::Segment<const double> lows = state.history.latest(kLow, price_breakout_window_);
+                if (close > *std::max_element(highs.begin(), highs.end())) price_breakout_up = true;
+                if (close < *std::min_element(lows.begin(), lows.end())) price_breakout_down = true;
+
+                Common::detail::CompensatedSum volume_sum;
+                for (double v : state.history.latest(kVolume, volume_avg_window_)) volume_sum.add(v);
+                double avg_volume = volume_sum.value() / static_cast<double>(volume_avg_window_);
+                volume_surge = volume > (volume_multiplier_ * avg_volume) && avg_volume > 1e-9;
+
+                // The last return_delta_window_ returns, this bar's included
+                Common::detail::CompensatedSum return_sum;
+                for (double r : state.history.latest(kReturn, return_delta_window_ - 1)) return_sum.add(r);
+                return_sum.add(bar_return);
+                return_delta_sum = return_sum.value();
             }
+            const double row[kColumns] = {high, low, volume, bar_return};
+            state.history.push(row);
+            if (!warm) return;
             bool positive_delta = return_delta_sum > 1e-9; // Use tolerance
             bool negative_delta = return_delta_sum < -1e-9; // Use tolerance
 
@@ -122,23 +127,51 @@ namespace Backtester {
             else if (price_breakout_down && volume_surge && negative_delta) desired_signal_direction = Common::SignalDirection::SHORT;
 
             // Generate Signal Event if State Changes
-            if (desired_signal_direction != last_signal_direction_[symbol]) {
-                 if (desired_signal_direction != Common::SignalDirection::FLAT || last_signal_direction_[symbol] != Common::SignalDirection::FLAT) {
-                     // ***** CORRECTED NAMESPACE *****
-                     std::cout << "MOMENTUM IGNITION: " << symbol << " @ " << Utils::formatTimestampUTC(event.timestamp)
-                               << " PriceBreakUp=" << price_breakout_up << " PriceBreakDown=" << price_breakout_down
-                               << " VolSurge=" << volume_surge << " RetDelta=" << return_delta_sum
-                               << " Signal=" << Common::to_string(desired_signal_direction)
-                               << std::endl;
+            Common::SignalDirection& last_direction = Common::symbol_slot(last_signal_direction_, symbol);
+            if (desired_signal_direction != last_direction) {
+                 if (desired_signal_direction != Common::SignalDirection::FLAT || last_direction != Common::SignalDirection::FLAT) {
+                     BT_LOG_INFO("MOMENTUM IGNITION: {} @ {} PriceBreakUp={} PriceBreakDown={} VolSurge={} RetDelta={} Signal={}",
+                                 symbol, event.timestamp, price_breakout_up, price_breakout_down, volume_surge,
+                                 return_delta_sum, Common::to_string(desired_signal_direction));
 
                      Common::Signal signal(event.timestamp, symbol, desired_signal_direction);
                      Common::SignalEvent signal_event(event.timestamp, signal);
                      portfolio.generate_order(signal_event);
                  }
-                 last_signal_direction_[symbol] = desired_signal_direction; // Update state
+                 last_direction = desired_signal_direction; // Update state
             }
         } // end handle_market_event
 
+        // --- Checkpoint hooks ---
+        void serialize(Common::BinaryWriter& writer) const override {
+            writer.write(price_breakout_window_);
+            writer.write(volume_avg_window_);
+            writer.write(return_delta_window_);
+            writer.write(static_cast<std::uint64_t>(symbol_state_.size()));
+            for (const auto& [symbol, state] : symbol_state_) {
+                writer.write(symbol);
+                state.history.serialize(writer);
+                writer.write(state.last_close);
+                writer.write(state.bars);
+            }
+            writer.write(last_signal_direction_);
+        }
+
+        void deserialize(Common::BinaryReader& reader) override {
+            reader.expect(price_breakout_window_, "MomentumIgnition price window");
+            reader.expect(volume_avg_window_, "MomentumIgnition volume window");
+            reader.expect(return_delta_window_, "MomentumIgnition return window");
+            symbol_state_.clear();
+            auto count = reader.read<std::uint64_t>();
+            for (std::uint64_t i = 0; i < count; ++i) {
+                SymbolState& state = Common::symbol_slot(symbol_state_, reader.read<std::string>());
+                state.history.deserialize(reader);
+                reader.read(state.last_close);
+                reader.read(state.bars);
+            }
+            reader.read(last_signal_direction_);
+        }
+
     }; // <--- ADDED MISSING SEMICOLON HERE
 
 } // namespace Backtester
\ No newline at end of file
@@ -4,13 +4,16 @@
 #include "common/Event.h"         // Needs MarketEvent, DataSnapshot (Corrected include path)
 #include "common/Signal.h"        // Needs Signal struct definition (Corrected include path)
 #include "common/Utils.h"         // For formatTimestampUTC (Corrected include path)
+#include "common/Logger.h"        // BT_LOG_* macros
+#include "common/RollingStats.h"  // O(1) rolling means
+#include "common/RunArena.h"      // SymbolMap
 #include "backtester/Portfolio.h" // Needs Portfolio class definition for interaction (Corrected include path)
-#include <deque>
 #include <vector>
 #include <string>
 #include <numeric>
 #include <iostream>
 #include <map>
+#include <memory_resource>
 #include <cmath>
 #include <stdexcept> // For invalid_argument
 
@@ -24,10 +27,18 @@ namespace Backtester {
         size_t long_window_;
         // Portfolio handles sizing based on signal
 
-        std::map<std::string, std::deque<double>> price_history_;
-        std::map<std::string, double> short_sma_;
-        std::map<std::string, double> long_sma_;
-        std::map<std::string, Common::SignalDirection> last_signal_direction_;
+        // Both windows slide with each bar: a bar costs the same whatever the window lengths
+        struct SymbolState {
+            using allocator_type = std::pmr::polymorphic_allocator<double>;
+            explicit SymbolState(const allocator_type& alloc = {}) : short_mean(alloc), long_mean(alloc) {}
+
+            Common::RollingMean short_mean;
+            Common::RollingMean long_mean;
+        };
+        Common::SymbolMap<SymbolState> symbol_state_;
+        Common::SymbolMap<double> short_sma_;
+        Common::SymbolMap<double> long_sma_;
+        Common::SymbolMap<Common::SignalDirection> last_signal_direction_;
 
         // Helper to get close price, handling case variations
         bool get_close_price(const Common::DataSnapshot& data, double& close_price) const {
@@ -38,8 +49,10 @@ namespace Backtester {
         }
 
     public:
-        MovingAverageCrossover(size_t short_window, size_t long_window)
-            : short_window_(short_window), long_window_(long_window) {
+        MovingAverageCrossover(size_t short_window, size_t long_window,
+                               std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+            : short_window_(short_window), long_window_(long_window),
+              symbol_state_(resource), short_sma_(resource), long_sma_(resource), last_signal_direction_(resource) {
             if (short_window_ == 0 || long_window_ <= short_window_) {
                 throw std::invalid_argument("Invalid window sizes for MovingAverageCrossover");
             }
@@ -50,66 +63,61 @@ namespace Backtester {
             double price = 0.0;
             // Try to get the close price from the market data snapshot
             if (!get_close_price(event.marketData, price)) {
-                 std::cerr << "Warning (MACrossover): No 'Close' price found for symbol " << event.symbol
-                           << " at timestamp " << Utils::formatTimestampUTC(event.timestamp) << std::endl;
+                 BT_LOG_WARN("Warning (MACrossover): No 'Close' price found for symbol {} at timestamp {}",
+                             event.symbol, event.timestamp);
                  return; // Cannot proceed without a closing price
             }
 
             const std::string& symbol = event.symbol;
 
             // Initialize state map entries for a symbol if seen for the first time
-            if (price_history_.find(symbol) == price_history_.end()) {
-                price_history_[symbol]; // Creates an empty deque
-                short_sma_[symbol] = 0.0;
-                long_sma_[symbol] = 0.0;
-                last_signal_direction_[symbol] = Common::SignalDirection::FLAT; // Default state is flat
-            }
-
-            // Update historical price data
-            std::deque<double>& history = price_history_[symbol];
-            history.push_back(price);
-            // Keep the history buffer trimmed to the required maximum lookback size
-            if (history.size() > long_window_) {
-                history.pop_front();
+            SymbolState* found = Common::find_symbol(symbol_state_, symbol);
+            if (!found) {
+                found = &Common::symbol_slot(symbol_state_, symbol);
+                found->short_mean.set_window(short_window_);
+                found->long_mean.set_window(long_window_);
+                Common::symbol_slot(short_sma_, symbol) = 0.0;
+                Common::symbol_slot(long_sma_, symbol) = 0.0;
+                Common::symbol_slot(last_signal_direction_, symbol) = Common::SignalDirection::FLAT; // Default state is flat
             }
-
-            // Calculate Short SMA if enough history is available
-            if (history.size() >= short_window_) {
-                // Calculate sum of the last 'short_window_' elements
-                double short_sum = std::accumulate(history.end() - short_window_, history.end(), 0.0);
-                short_sma_[symbol] = short_sum / short_window_;
+            double& short_sma = Common::symbol_slot(short_sma_, symbol);
+            double& long_sma = Common::symbol_slot(long_sma_, symbol);
+            Common::SignalDirection& last_direction = Common::symbol_slot(last_signal_direction_, symbol);
+
+            // Slide both windows
+            SymbolState& state = *found;
+            state.short_mean.push(price);
+            state.long_mean.push(price);
+
+            // Short SMA once its window is full
+            if (state.short_mean.full()) {
+                short_sma = state.short_mean.mean();
             } else {
                 // Not enough data yet for short SMA, cannot proceed further
                 return;
             }
 
-            // Calculate Long SMA if enough history is available
-            if (history.size() >= long_window_) {
-                // Use the full history deque for the long SMA sum
-                double long_sum = std::accumulate(history.begin(), history.end(), 0.0);
-                long_sma_[symbol] = long_sum / long_window_;
+            // Long SMA once its window is full
+            if (state.long_mean.full()) {
+                long_sma = state.long_mean.mean();
 
                 // Determine desired signal based on SMA crossover
                 Common::SignalDirection desired_signal_direction = Common::SignalDirection::FLAT;
                 constexpr double tolerance = 1e-9; // Tolerance for floating point comparison noise
 
-                if (short_sma_[symbol] > long_sma_[symbol] + tolerance) {
+                if (short_sma > long_sma + tolerance) {
                     desired_signal_direction = Common::SignalDirection::LONG;
-                } else if (short_sma_[symbol] < long_sma_[symbol] - tolerance) {
+                } else if (short_sma < long_sma - tolerance) {
                     desired_signal_direction = Common::SignalDirection::SHORT;
                 }
                 // If they are very close (within tolerance), signal remains FLAT
 
                 // Generate signal ONLY if the desired direction changes from the last recorded one
-                if (desired_signal_direction != last_signal_direction_[symbol]) {
+                if (desired_signal_direction != last_direction) {
 
-                    // --- CORRECTED NAMESPACE for Utility Function ---
-                    std::cout << "CROSSOVER: " << symbol << " @ " << Utils::formatTimestampUTC(event.timestamp) // Use Utils:: directly
-                              << " ShortSMA=" << std::fixed << std::setprecision(4) << short_sma_[symbol]
-                              << " LongSMA=" << std::fixed << std::setprecision(4) << long_sma_[symbol]
-                              << " Signal=" << Common::to_string(desired_signal_direction) // Common::to_string is correct
-                              << std::endl;
-                    // --- END CORRECTION ---
+                    BT_LOG_INFO("CROSSOVER: {} @ {} ShortSMA={:.4f} LongSMA={:.4f} Signal={}",
+                                symbol, event.timestamp, short_sma, long_sma,
+                                Common::to_string(desired_signal_direction));
 
                     // Create a Signal struct payload
                     Common::Signal signal(event.timestamp, symbol, desired_signal_direction);
@@ -121,11 +129,41 @@ namespace Backtester {
                     portfolio.generate_order(signal_event);
 
                     // Update the last recorded signal direction for this symbol
-                    last_signal_direction_[symbol] = desired_signal_direction;
+                    last_direction = desired_signal_direction;
                 }
             } // end if enough history for long SMA
         } // end handle_market_event
 
+        // --- Checkpoint hooks ---
+        void serialize(Common::BinaryWriter& writer) const override {
+            writer.write(short_window_);
+            writer.write(long_window_);
+            writer.write(static_cast<std::uint64_t>(symbol_state_.size()));
+            for (const auto& [symbol, state] : symbol_state_) {
+                writer.write(symbol);
+                state.short_mean.serialize(writer);
+                state.long_mean.serialize(writer);
+            }
+            writer.write(short_sma_);
+            writer.write(long_sma_);
+            writer.write(last_signal_direction_);
+        }
+
+        void deserialize(Common::BinaryReader& reader) override {
+            reader.expect(short_window_, "MovingAverageCrossover short window");
+            reader.expect(long_window_, "MovingAverageCrossover long window");
+            symbol_state_.clear();
+            auto count = reader.read<std::uint64_t>();
+            for (std::uint64_t i = 0; i < count; ++i) {
+                SymbolState& state = Common::symbol_slot(symbol_state_, reader.read<std::string>());
+                state.short_mean.deserialize(reader);
+                state.long_mean.deserialize(reader);
+            }
+            reader.read(short_sma_);
+            reader.read(long_sma_);
+            reader.read(last_signal_direction_);
+        }
+
     }; // End class MovingAverageCrossover
 
 } // End namespace Backtester
\ No newline at end of file
@@ -4,9 +4,12 @@
 #include "common/Event.h"         // Correct path
 #include "common/Signal.h"        // Correct path
 #include "common/Utils.h"         // Correct path
+#include "common/Logger.h"        // BT_LOG_* macros
+#include "common/RunArena.h"      // SymbolMap
 #include "backtester/Portfolio.h" // Correct path
 #include <string>
 #include <map>
+#include <memory_resource>
 #include <chrono>
 #include <limits> // For numeric_limits
 #include <iostream>
@@ -16,23 +19,33 @@
 
 namespace Backtester {
 
+    // One breakout trade per symbol per session (calendar day, see Utils::session_day): the
+    // range is rebuilt from each session's first bar, and from session_close_minutes into the
+    // day the position is closed and no new trade is taken, so a session with a bar at or
+    // after the close ends flat. Without a close the position is closed on the next session's
+    // first bar.
     class OpeningRangeBreakout : public StrategyBase { // Inherit from StrategyBase
+    public:
+        static constexpr int kNoSessionClose = 24 * 60; // Never closes out within the day
+
     private:
         int opening_range_minutes_;
+        int session_close_minutes_; // Minutes into the session day
         // Sizing handled by Portfolio
 
         // --- State per Symbol ---
         struct SymbolState {
             // ***** ADDED MISSING MEMBERS *****
             std::chrono::system_clock::time_point start_time;
+            long long session_day = 0;
             double range_high = -std::numeric_limits<double>::max();
             double range_low = std::numeric_limits<double>::max();
             bool range_established = false;
             bool trade_taken = false;
             // ***** END ADDED MEMBERS *****
         };
-        std::map<std::string, SymbolState> symbol_state_;
-        std::map<std::string, Common::SignalDirection> last_signal_direction_;
+        Common::SymbolMap<SymbolState> symbol_state_;
+        Common::SymbolMap<Common::SignalDirection> last_signal_direction_;
 
          // Helper to get OHLC prices
          bool get_ohlc(const Common::DataSnapshot& data, double& o, double& h, double& l, double& c) const {
@@ -52,12 +65,35 @@ namespace Backtester {
                     (data.count("Close") || data.count("close"));
         }
 
+        void start_session(SymbolState& state, std::chrono::system_clock::time_point timestamp, long long session_day,
+                           double high, double low) const {
+            state.start_time = timestamp;
+            state.session_day = session_day;
+            state.range_high = high;
+            state.range_low = low;
+            state.range_established = false;
+            state.trade_taken = false;
+        }
+
+        void flatten(const Common::MarketEvent& event, Portfolio& portfolio, Common::SignalDirection& last_direction) const {
+            BT_LOG_INFO("ORB FLATTEN: {} @ {}", event.symbol, event.timestamp);
+            Common::Signal signal(event.timestamp, event.symbol, Common::SignalDirection::FLAT);
+            Common::SignalEvent signal_event(event.timestamp, signal);
+            portfolio.generate_order(signal_event);
+            last_direction = Common::SignalDirection::FLAT;
+        }
+
     public:
-        OpeningRangeBreakout(int range_minutes = 30)
-            : opening_range_minutes_(range_minutes) {
+        OpeningRangeBreakout(int range_minutes = 30, int session_close_minutes = kNoSessionClose,
+                             std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+            : opening_range_minutes_(range_minutes), session_close_minutes_(session_close_minutes),
+              symbol_state_(resource), last_signal_direction_(resource) {
             if (opening_range_minutes_ <= 0) {
                  throw std::invalid_argument("Opening range minutes must be positive");
             }
+            if (session_close_minutes_ <= 0 || session_close_minutes_ > kNoSessionClose) {
+                 throw std::invalid_argument("Session close must be within the day");
+            }
         }
 
         void handle_market_event(const Common::MarketEvent& event, Portfolio& portfolio) override {
@@ -65,28 +101,40 @@ namespace Backtester {
             double open, high, low, close;
 
             if (!get_ohlc(event.marketData, open, high, low, close)) {
-                 std::cerr << "Warning (ORB): Missing HLC data for symbol " << symbol << std::endl;
+                 BT_LOG_WARN("Warning (ORB): Missing HLC data for symbol {}", symbol);
                  return;
             }
 
             auto current_timestamp = event.timestamp;
+            const long long session_day = Utils::session_day(current_timestamp);
 
             // Initialize state for new symbols
-            if (symbol_state_.find(symbol) == symbol_state_.end()) {
-                SymbolState& new_state = symbol_state_[symbol]; // Get reference to new state
-                new_state.start_time = current_timestamp;
-                new_state.range_high = high;
-                new_state.range_low = low;
-                new_state.range_established = false; // Explicitly set
-                new_state.trade_taken = false;       // Explicitly set
-                last_signal_direction_[symbol] = Common::SignalDirection::FLAT;
+            SymbolState* found = Common::find_symbol(symbol_state_, symbol);
+            if (!found) {
+                SymbolState& new_state = Common::symbol_slot(symbol_state_, symbol); // Get reference to new state
+                start_session(new_state, current_timestamp, session_day, high, low);
+                Common::symbol_slot(last_signal_direction_, symbol) = Common::SignalDirection::FLAT;
                 // ***** CORRECTED NAMESPACE *****
-                std::cout << "ORB INIT: " << symbol << " @ " << Utils::formatTimestampUTC(current_timestamp) << std::endl;
+                BT_LOG_INFO("ORB INIT: {} @ {}", symbol, current_timestamp);
+                found = &new_state;
             }
 
-            SymbolState& state = symbol_state_[symbol]; // Get reference to state
+            SymbolState& state = *found; // Get reference to state
+            Common::SignalDirection& last_direction = Common::symbol_slot(last_signal_direction_, symbol);
+
+            // New session: a fresh range and trade; a position the previous session left open
+            // (no bar at or after its close) is closed on this first bar
+            if (state.session_day != session_day) {
+                start_session(state, current_timestamp, session_day, high, low);
+                if (last_direction != Common::SignalDirection::FLAT) flatten(event, portfolio, last_direction);
+            }
 
-            // Add daily reset logic here if needed based on timestamp comparison
+            // Session close: flat until the next session
+            if (Utils::session_minute(current_timestamp) >= session_close_minutes_) {
+                state.trade_taken = true;
+                if (last_direction != Common::SignalDirection::FLAT) flatten(event, portfolio, last_direction);
+                return;
+            }
 
             auto time_since_start = std::chrono::duration_cast<std::chrono::minutes>(current_timestamp - state.start_time);
 
@@ -98,8 +146,7 @@ namespace Backtester {
                 } else {
                     state.range_established = true;
                     // ***** CORRECTED NAMESPACE *****
-                    std::cout << "ORB ESTABLISHED: " << symbol << " @ " << Utils::formatTimestampUTC(current_timestamp)
-                              << " High=" << state.range_high << " Low=" << state.range_low << std::endl;
+                    BT_LOG_INFO("ORB ESTABLISHED: {} @ {} High={} Low={}", symbol, current_timestamp, state.range_high, state.range_low);
                 }
             }
 
@@ -111,20 +158,52 @@ namespace Backtester {
 
                 if (desired_signal_direction != Common::SignalDirection::FLAT) {
                      // ***** CORRECTED NAMESPACE *****
-                     std::cout << "ORB BREAKOUT: " << symbol << " @ " << Utils::formatTimestampUTC(event.timestamp)
-                               << " Close=" << close << " Range=[" << state.range_low << ", " << state.range_high << "]"
-                               << " Signal=" << Common::to_string(desired_signal_direction)
-                               << std::endl;
+                     BT_LOG_INFO("ORB BREAKOUT: {} @ {} Close={} Range=[{}, {}] Signal={}", symbol, event.timestamp, close,
+                                 state.range_low, state.range_high, Common::to_string(desired_signal_direction));
 
                     Common::Signal signal(event.timestamp, symbol, desired_signal_direction);
                     Common::SignalEvent signal_event(event.timestamp, signal);
                     portfolio.generate_order(signal_event); // Portfolio handles sizing/order
 
                     state.trade_taken = true; // Mark trade taken for this session/day
-                    last_signal_direction_[symbol] = desired_signal_direction;
+                    last_direction = desired_signal_direction;
                 }
             }
         }
+
+        // --- Checkpoint hooks ---
+        void serialize(Common::BinaryWriter& writer) const override {
+            writer.write(opening_range_minutes_);
+            writer.write(session_close_minutes_);
+            writer.write(static_cast<std::uint64_t>(symbol_state_.size()));
+            for (const auto& [symbol, state] : symbol_state_) {
+                writer.write(symbol);
+                writer.write(state.start_time);
+                writer.write(state.session_day);
+                writer.write(state.range_high);
+                writer.write(state.range_low);
+                writer.write(state.range_established);
+                writer.write(state.trade_taken);
+            }
+            writer.write(last_signal_direction_);
+        }
+
+        void deserialize(Common::BinaryReader& reader) override {
+            reader.expect(opening_range_minutes_, "OpeningRangeBreakout range minutes");
+            reader.expect(session_close_minutes_, "OpeningRangeBreakout session close");
+            symbol_state_.clear();
+            auto count = reader.read<std::uint64_t>();
+            for (std::uint64_t i = 0; i < count; ++i) {
+                SymbolState& state = Common::symbol_slot(symbol_state_, reader.read<std::string>());
+                reader.read(state.start_time);
+                reader.read(state.session_day);
+                reader.read(state.range_high);
+                reader.read(state.range_low);
+                reader.read(state.range_established);
+                reader.read(state.trade_taken);
+            }
+            reader.read(last_signal_direction_);
+        }
     }; // End class OpeningRangeBreakout
 
 } // namespace Backtester
\ No newline at end of file
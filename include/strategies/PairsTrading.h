@@ -4,15 +4,20 @@
 #include "../common/Event.h"
 #include "../common/Signal.h"
 #include "../common/Utils.h"
+#include "../common/Logger.h"
+#include "../common/RollingStats.h"
 #include "../backtester/Portfolio.h"
+#include "../backtester/PairsEngine.h"
 #include <string>
 #include <stdexcept>
 #include <vector>
-#include <deque>
+#include <optional>
 #include <numeric>
 #include <cmath>
 #include <iostream>
 #include <map> // Include map for symbol state storage
+#include <memory>
+#include <memory_resource>
 
 namespace Backtester {
 
@@ -25,13 +30,33 @@ namespace Backtester {
         double exit_zscore_threshold_;
         double target_trade_dollar_value_; // Portfolio generate_order handles sizing based on signal
 
-        std::deque<double> ratio_history_;
+        double hedge_ratio_ = 1.0; // The ratio is price_a / price_b^hedge_ratio_ (see set_hedge_ratio)
+        Common::RollingVariance ratio_stats_; // Mean / stddev of the last lookback ratios
         double ratio_mean_ = 0.0;
         double ratio_stddev_ = 0.0;
 
         enum class PairSignalState { FLAT, LONG_A_SHORT_B, SHORT_A_LONG_B };
         PairSignalState current_pair_state_ = PairSignalState::FLAT;
 
+        // Engine mode: the pair's statistics and state come from a (possibly shared)
+        // universe-wide engine instead. The engine's pair runs lower id first, so 'flipped_'
+        // maps its LONG_A_SHORT_B to this strategy's SHORT_A_LONG_B and back.
+        std::shared_ptr<PairsEngine> engine_;
+        size_t pair_ = 0;
+        bool flipped_ = false;
+
+        // Note: Pairs trading needs data for BOTH symbols in the SAME market event.
+        // Per bar, the Backtester sends one MarketEvent per symbol per timestamp, so the
+        // strategy buffers the legs internally; with slice delivery (handle_slice) it gets
+        // every bar of a timestamp at once.
+        // Latest price of each leg since the last ratio update. Fixed slots rather than a
+        // map: the map was cleared after every update, so each bar re-allocated its nodes.
+        std::optional<double> price_a_;
+        std::optional<double> price_b_;
+        // Slice ids of the legs
+        SliceSymbol slice_a_;
+        SliceSymbol slice_b_;
+
          // Helper to get close price
          bool get_close_price(const Common::DataSnapshot& data, double& close_price) const {
              if (data.count("Close")) { close_price = data.at("Close"); return true; }
@@ -39,103 +64,237 @@ namespace Backtester {
              return false;
         }
 
+        // Emits the signals for BOTH legs that move the pair into 'desired_state'
+        void transition_to(PairSignalState desired_state, double current_zscore,
+                           std::chrono::system_clock::time_point timestamp, Portfolio& portfolio) {
+            Common::SignalDirection signal_dir_a = Common::SignalDirection::FLAT;
+            Common::SignalDirection signal_dir_b = Common::SignalDirection::FLAT;
+
+            if (desired_state == PairSignalState::LONG_A_SHORT_B) {
+                 signal_dir_a = Common::SignalDirection::LONG;
+                 signal_dir_b = Common::SignalDirection::SHORT;
+                 BT_LOG_INFO("PAIRS ({}/{}): Z={} Mean={} StdD={} -> Signal: LONG {} / SHORT {}",
+                             symbol_a_, symbol_b_, current_zscore, ratio_mean_, ratio_stddev_, symbol_a_, symbol_b_);
+            } else if (desired_state == PairSignalState::SHORT_A_LONG_B) {
+                 signal_dir_a = Common::SignalDirection::SHORT;
+                 signal_dir_b = Common::SignalDirection::LONG;
+                 BT_LOG_INFO("PAIRS ({}/{}): Z={} Mean={} StdD={} -> Signal: SHORT {} / LONG {}",
+                             symbol_a_, symbol_b_, current_zscore, ratio_mean_, ratio_stddev_, symbol_a_, symbol_b_);
+            } else { // desired_state == FLAT
+                 BT_LOG_INFO("PAIRS ({}/{}): Z={} Mean={} StdD={} -> Signal: FLAT {} / FLAT {}",
+                             symbol_a_, symbol_b_, current_zscore, ratio_mean_, ratio_stddev_, symbol_a_, symbol_b_);
+                 // Signal FLAT for both to close positions
+            }
+
+            // Send signals to portfolio for order generation
+            Common::Signal signal_a(timestamp, symbol_a_, signal_dir_a);
+            Common::SignalEvent signal_event_a(timestamp, signal_a);
+            portfolio.generate_order(signal_event_a);
+
+            Common::Signal signal_b(timestamp, symbol_b_, signal_dir_b);
+            Common::SignalEvent signal_event_b(timestamp, signal_b);
+            portfolio.generate_order(signal_event_b);
+
+            current_pair_state_ = desired_state; // Update state
+        }
+
+        // Engine mode: follows the engine's state for the pair after a completed step
+        void follow_engine(std::chrono::system_clock::time_point timestamp, Portfolio& portfolio) {
+            if (!engine_->ready()) return;
+            PairSignalState desired_state = PairSignalState::FLAT;
+            switch (engine_->state(pair_)) {
+                case PairsEngine::PairState::LONG_A_SHORT_B:
+                    desired_state = flipped_ ? PairSignalState::SHORT_A_LONG_B : PairSignalState::LONG_A_SHORT_B;
+                    break;
+                case PairsEngine::PairState::SHORT_A_LONG_B:
+                    desired_state = flipped_ ? PairSignalState::LONG_A_SHORT_B : PairSignalState::SHORT_A_LONG_B;
+                    break;
+                case PairsEngine::PairState::FLAT:
+                    break;
+            }
+            if (desired_state == current_pair_state_) return;
+            const double sign = flipped_ ? -1.0 : 1.0;
+            ratio_mean_ = sign * engine_->mean(pair_);
+            ratio_stddev_ = engine_->stddev(pair_);
+            transition_to(desired_state, sign * engine_->zscore(pair_), timestamp, portfolio);
+        }
+
+        // Adds the ratio of the legs' prices and trades its z-score. False if the prices were
+        // rejected or the statistics are not usable yet (the pending prices are then kept).
+        bool update_ratio(double price_a, double price_b, std::chrono::system_clock::time_point timestamp,
+                          Portfolio& portfolio) {
+            if (price_a <= 1e-9 || price_b <= 1e-9) return false; // Avoid bad prices
+
+            // --- Calculations based on having both prices ---
+            double current_ratio = hedge_ratio_ == 1.0 ? price_a / price_b : price_a / std::pow(price_b, hedge_ratio_);
+            ratio_stats_.push(current_ratio);
+            if (!ratio_stats_.full()) return false; // Need history
+
+            ratio_mean_ = ratio_stats_.mean();
+            ratio_stddev_ = ratio_stats_.stddev(); // Sample stddev; 0 for a lookback of 1
+
+            if (ratio_stddev_ < 1e-9) return false; // Avoid division by zero
+
+            double current_zscore = (current_ratio - ratio_mean_) / ratio_stddev_;
+
+            // Determine desired state
+            PairSignalState desired_state = current_pair_state_;
+            if (current_pair_state_ == PairSignalState::FLAT) {
+                if (current_zscore > entry_zscore_threshold_) desired_state = PairSignalState::SHORT_A_LONG_B;
+                else if (current_zscore < -entry_zscore_threshold_) desired_state = PairSignalState::LONG_A_SHORT_B;
+            } else {
+                if (current_pair_state_ == PairSignalState::SHORT_A_LONG_B && current_zscore < exit_zscore_threshold_) desired_state = PairSignalState::FLAT;
+                else if (current_pair_state_ == PairSignalState::LONG_A_SHORT_B && current_zscore > -exit_zscore_threshold_) desired_state = PairSignalState::FLAT;
+            }
+
+            // If state changes, generate signals for BOTH legs
+            if (desired_state != current_pair_state_) {
+                transition_to(desired_state, current_zscore, timestamp, portfolio);
+            }
+            return true;
+        }
+
     public:
         PairsTrading(std::string sym_a, std::string sym_b, size_t lookback = 60,
-                     double entry_z = 2.0, double exit_z = 0.5, double trade_value = 10000.0)
+                     double entry_z = 2.0, double exit_z = 0.5, double trade_value = 10000.0,
+                     std::pmr::memory_resource* resource = std::pmr::get_default_resource())
             : symbol_a_(std::move(sym_a)), symbol_b_(std::move(sym_b)),
               lookback_window_(lookback), entry_zscore_threshold_(entry_z),
-              exit_zscore_threshold_(exit_z), target_trade_dollar_value_(trade_value) // Store for reference if needed, Portfolio handles sizing
-              { /* Validation */ }
+              exit_zscore_threshold_(exit_z), target_trade_dollar_value_(trade_value), // Store for reference if needed, Portfolio handles sizing
+              ratio_stats_(lookback_window_, resource) {}
 
-        // Note: Pairs trading needs data for BOTH symbols in the SAME market event.
-        // The current event structure sends one MarketEvent per symbol per timestamp.
-        // This strategy needs modification to buffer data or the Backtester needs
-        // to send multi-symbol snapshots.
-        // --- TEMPORARY WORKAROUND: Assume Backtester sends snapshot via Portfolio state? No.
-        // --- Need to rethink event handling or strategy state management ---
+        // Engine mode: lookback and thresholds are the engine's, and the z-score is of the log
+        // spread log(a) - log(b) rather than the price ratio. The pair is selected in the
+        // engine; every strategy sharing it forwards its bars, and the engine records each once.
+        PairsTrading(std::shared_ptr<PairsEngine> engine, std::string sym_a, std::string sym_b,
+                     double trade_value = 10000.0,
+                     std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+            : symbol_a_(std::move(sym_a)), symbol_b_(std::move(sym_b)),
+              lookback_window_(engine ? engine->lookback() : 0), entry_zscore_threshold_(0.0),
+              exit_zscore_threshold_(0.0), target_trade_dollar_value_(trade_value),
+              ratio_stats_(resource), engine_(std::move(engine)) {
+            if (!engine_) throw std::invalid_argument("PairsTrading: null engine");
+            const size_t a = engine_->symbol_id(symbol_a_);
+            const size_t b = engine_->symbol_id(symbol_b_);
+            if (a == engine_->size()) throw std::invalid_argument("PairsTrading: " + symbol_a_ + " is not in the engine's universe");
+            if (b == engine_->size()) throw std::invalid_argument("PairsTrading: " + symbol_b_ + " is not in the engine's universe");
+            pair_ = engine_->pair_index(a, b);
+            flipped_ = a > b;
+            engine_->select(pair_);
+        }
 
-        // --- Let's assume the strategy buffers the required data internally ---
-        std::map<std::string, double> latest_prices_;
+        // Trades the hedged ratio price_a / price_b^hedge_ratio instead of the plain ratio, e.g.
+        // with the OLS slope a PairScreener found for log(a) on log(b) (legs are still sized by
+        // the Portfolio). The z-score is of that ratio, i.e. of exp(log(a) - hedge_ratio *
+        // log(b)), not of the log spread itself. Set before the first bar; the engine mode's
+        // log spread is always 1:1.
+        void set_hedge_ratio(double hedge_ratio) {
+            if (engine_) throw std::logic_error("PairsTrading: the engine mode has no hedge ratio");
+            if (!std::isfinite(hedge_ratio) || hedge_ratio <= 0.0) throw std::invalid_argument("PairsTrading: hedge ratio must be positive");
+            hedge_ratio_ = hedge_ratio;
+        }
+        double hedge_ratio() const { return hedge_ratio_; }
 
         void handle_market_event(const Common::MarketEvent& event, Portfolio& portfolio) override {
+             if (engine_) {
+                 if (engine_->on_bar(event)) follow_engine(event.timestamp, portfolio);
+                 return;
+             }
              const std::string& current_symbol = event.symbol;
              double current_price = 0.0;
              if (!get_close_price(event.marketData, current_price)) return; // Skip if no close price
 
-             latest_prices_[current_symbol] = current_price; // Store latest price
+             // Store latest price (other symbols still re-evaluate while both legs are pending)
+             if (current_symbol == symbol_a_) price_a_ = current_price;
+             if (current_symbol == symbol_b_) price_b_ = current_price;
 
              // Check if we have prices for BOTH symbols now
-             if (latest_prices_.count(symbol_a_) && latest_prices_.count(symbol_b_)) {
-                  double price_a = latest_prices_[symbol_a_];
-                  double price_b = latest_prices_[symbol_b_];
-
-                  if (price_a <= 1e-9 || price_b <= 1e-9) return; // Avoid bad prices
-
-                  // --- Calculations based on having both prices ---
-                  double current_ratio = price_a / price_b;
-                  ratio_history_.push_back(current_ratio);
-                  if (ratio_history_.size() > lookback_window_) ratio_history_.pop_front();
-                  if (ratio_history_.size() < lookback_window_) return; // Need history
-
-                  double sum = std::accumulate(ratio_history_.begin(), ratio_history_.end(), 0.0);
-                  ratio_mean_ = sum / lookback_window_;
-                  double sq_sum = 0.0;
-                  for (double r : ratio_history_) sq_sum += std::pow(r - ratio_mean_, 2);
-                  ratio_stddev_ = (lookback_window_ > 1) ? std::sqrt(sq_sum / (lookback_window_ - 1)) : 0.0;
-
-                  if (ratio_stddev_ < 1e-9) return; // Avoid division by zero
-
-                  double current_zscore = (current_ratio - ratio_mean_) / ratio_stddev_;
-
-                  // Determine desired state
-                  PairSignalState desired_state = current_pair_state_;
-                  if (current_pair_state_ == PairSignalState::FLAT) {
-                      if (current_zscore > entry_zscore_threshold_) desired_state = PairSignalState::SHORT_A_LONG_B;
-                      else if (current_zscore < -entry_zscore_threshold_) desired_state = PairSignalState::LONG_A_SHORT_B;
-                  } else {
-                      if (current_pair_state_ == PairSignalState::SHORT_A_LONG_B && current_zscore < exit_zscore_threshold_) desired_state = PairSignalState::FLAT;
-                      else if (current_pair_state_ == PairSignalState::LONG_A_SHORT_B && current_zscore > -exit_zscore_threshold_) desired_state = PairSignalState::FLAT;
-                  }
-
-                  // If state changes, generate signals for BOTH legs
-                  if (desired_state != current_pair_state_) {
-                       std::cout << "PAIRS (" << symbol_a_ << "/" << symbol_b_ << "): Z=" << current_zscore
-                                 << " Mean=" << ratio_mean_ << " StdD=" << ratio_stddev_;
-
-                       Common::SignalDirection signal_dir_a = Common::SignalDirection::FLAT;
-                       Common::SignalDirection signal_dir_b = Common::SignalDirection::FLAT;
-
-                       if (desired_state == PairSignalState::LONG_A_SHORT_B) {
-                            signal_dir_a = Common::SignalDirection::LONG;
-                            signal_dir_b = Common::SignalDirection::SHORT;
-                            std::cout << " -> Signal: LONG " << symbol_a_ << " / SHORT " << symbol_b_ << std::endl;
-                       } else if (desired_state == PairSignalState::SHORT_A_LONG_B) {
-                            signal_dir_a = Common::SignalDirection::SHORT;
-                            signal_dir_b = Common::SignalDirection::LONG;
-                            std::cout << " -> Signal: SHORT " << symbol_a_ << " / LONG " << symbol_b_ << std::endl;
-                       } else { // desired_state == FLAT
-                            std::cout << " -> Signal: FLAT " << symbol_a_ << " / FLAT " << symbol_b_ << std::endl;
-                            // Signal FLAT for both to close positions
-                            signal_dir_a = Common::SignalDirection::FLAT;
-                            signal_dir_b = Common::SignalDirection::FLAT;
-                       }
-
-                       // Send signals to portfolio for order generation
-                       Common::Signal signal_a(event.timestamp, symbol_a_, signal_dir_a);
-                       Common::SignalEvent signal_event_a(event.timestamp, signal_a);
-                       portfolio.generate_order(signal_event_a);
-
-                       Common::Signal signal_b(event.timestamp, symbol_b_, signal_dir_b);
-                       Common::SignalEvent signal_event_b(event.timestamp, signal_b);
-                       portfolio.generate_order(signal_event_b);
-
-                       current_pair_state_ = desired_state; // Update state
-                  }
+             if (price_a_ && price_b_ && update_ratio(*price_a_, *price_b_, event.timestamp, portfolio)) {
                   // Clear prices for next tick to ensure fresh data for both
-                   latest_prices_.clear();
-
-             } // end if have prices for both
+                  price_a_.reset();
+                  price_b_.reset();
+             }
         } // end handle_market_event
+
+        // Slice delivery: replays the per-bar path over the slice's closes in arrival order,
+        // so with one bar per symbol per timestamp both modes add the same ratios and signal
+        // on the same bars (while both legs are pending and update_ratio declines, every later
+        // bar with a close re-adds the ratio, as it does per bar). It differs from per-bar
+        // delivery where a leg has several bars at one timestamp (counted once, at its last
+        // close) or a NaN close (skipped), and in fill prices: the orders are routed after the
+        // whole slice, so a leg whose bar comes later in the timestamp fills against that bar
+        // rather than its previous one. The bench's check/ gate compares the two modes' fills.
+        void handle_slice(const CrossSection& slice, Portfolio& portfolio) override {
+             if (engine_) {
+                 if (engine_->on_slice(slice)) follow_engine(slice.timestamp(), portfolio);
+                 return;
+             }
+             const Common::SymbolId a = slice_a_.resolve(slice, symbol_a_);
+             const Common::SymbolId b = slice_b_.resolve(slice, symbol_b_);
+             if (!(price_a_ && price_b_) && !slice.has_bar(a) && !slice.has_bar(b)) return; // Nothing to add
+             for (Common::SymbolId id : slice.members()) {
+                 const double close = slice.close(id);
+                 if (std::isnan(close)) continue;
+                 if (id == a) price_a_ = close;
+                 if (id == b) price_b_ = close;
+                 if (price_a_ && price_b_ && update_ratio(*price_a_, *price_b_, slice.timestamp(), portfolio)) {
+                     price_a_.reset();
+                     price_b_.reset();
+                 }
+             }
+        }
+
+        // --- Checkpoint hooks ---
+        // In engine mode the engine's state is saved with the strategy (see LeadLagStrategy)
+        void serialize(Common::BinaryWriter& writer) const override {
+            writer.write(symbol_a_);
+            writer.write(symbol_b_);
+            writer.write(lookback_window_);
+            writer.write(entry_zscore_threshold_);
+            writer.write(exit_zscore_threshold_);
+            writer.write(hedge_ratio_);
+            writer.write(static_cast<bool>(engine_));
+            if (engine_) {
+                engine_->serialize(writer);
+            } else {
+                ratio_stats_.serialize(writer);
+            }
+            writer.write(ratio_mean_);
+            writer.write(ratio_stddev_);
+            writer.write(current_pair_state_);
+            // Pending leg prices, encoded as the symbol -> price map earlier versions kept
+            std::map<std::string, double> pending;
+            if (price_a_) pending[symbol_a_] = *price_a_;
+            if (price_b_) pending[symbol_b_] = *price_b_;
+            writer.write(pending);
+        }
+
+        void deserialize(Common::BinaryReader& reader) override {
+            reader.expect(symbol_a_, "PairsTrading symbol A");
+            reader.expect(symbol_b_, "PairsTrading symbol B");
+            reader.expect(lookback_window_, "PairsTrading lookback window");
+            reader.expect(entry_zscore_threshold_, "PairsTrading entry z threshold");
+            reader.expect(exit_zscore_threshold_, "PairsTrading exit z threshold");
+            // The ratio statistics are of price_a / price_b^hedge_ratio_: another ratio would mix the two
+            reader.expect(hedge_ratio_, "PairsTrading hedge ratio");
+            reader.expect(static_cast<bool>(engine_), "PairsTrading engine mode");
+            if (engine_) {
+                engine_->deserialize(reader);
+            } else {
+                ratio_stats_.deserialize(reader);
+            }
+            reader.read(ratio_mean_);
+            reader.read(ratio_stddev_);
+            reader.read(current_pair_state_);
+            auto pending = reader.read<std::map<std::string, double>>();
+            auto find_leg = [&](const std::string& symbol) -> std::optional<double> {
+                auto it = pending.find(symbol);
+                if (it == pending.end()) return std::nullopt;
+                return it->second;
+            };
+            price_a_ = find_leg(symbol_a_);
+            price_b_ = find_leg(symbol_b_);
+        }
     }; // End class
 
 } // namespace Backtester
\ No newline at end of file
@@ -4,9 +4,12 @@
 #include "common/Event.h"         // Correct path
 #include "common/Signal.h"        // Correct path
 #include "common/Utils.h"         // Correct path
+#include "common/Logger.h"        // BT_LOG_* macros
+#include "common/RunArena.h"      // SymbolMap
 #include "backtester/Portfolio.h" // Correct path
 #include <string>
 #include <map>
+#include <memory_resource>
 #include <vector>
 #include <cmath>
 #include <numeric>
@@ -28,8 +31,8 @@ namespace Backtester {
             // std::vector<double> price_vwap_diffs;
             // int rolling_stddev_window = 20;
         };
-        std::map<std::string, SymbolState> symbol_state_;
-        std::map<std::string, Common::SignalDirection> last_signal_direction_; // Renamed for clarity
+        Common::SymbolMap<SymbolState> symbol_state_;
+        Common::SymbolMap<Common::SignalDirection> last_signal_direction_; // Renamed for clarity
 
         // Helper to get OHLCV prices
          bool get_ohlcv(const Common::DataSnapshot& data, double& o, double& h, double& l, double& c, double& v) const {
@@ -50,8 +53,8 @@ namespace Backtester {
 
 
     public:
-        VWAPReversion(double deviation_multiplier = 2.0)
-            : deviation_multiplier_(deviation_multiplier) {
+        VWAPReversion(double deviation_multiplier = 2.0, std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+            : deviation_multiplier_(deviation_multiplier), symbol_state_(resource), last_signal_direction_(resource) {
              if (deviation_multiplier_ <= 0) {
                   throw std::invalid_argument("Deviation multiplier must be positive for VWAPReversion");
              }
@@ -64,10 +67,10 @@ namespace Backtester {
             if (!get_ohlcv(event.marketData, open, high, low, close, volume)) {
                  // Allow processing if at least Close and Volume are present
                  if (!event.marketData.count("Close") && !event.marketData.count("close")) {
-                     std::cerr << "Warning (VWAP): Missing Close price for " << symbol << std::endl; return;
+                     BT_LOG_WARN("Warning (VWAP): Missing Close price for {}", symbol); return;
                  }
                  if (!event.marketData.count("Volume") && !event.marketData.count("volume")) {
-                      std::cerr << "Warning (VWAP): Missing Volume for " << symbol << std::endl; return;
+                      BT_LOG_WARN("Warning (VWAP): Missing Volume for {}", symbol); return;
                  }
                  // Get the ones we have (might be partial)
                  get_ohlcv(event.marketData, open, high, low, close, volume);
@@ -75,7 +78,8 @@ namespace Backtester {
 
             if (volume < 1e-9) return; // Skip zero volume bars
 
-            SymbolState& state = symbol_state_[symbol]; // Get/create state
+            SymbolState& state = Common::symbol_slot(symbol_state_, symbol); // Get/create state
+            Common::SignalDirection& last_direction = Common::symbol_slot(last_signal_direction_, symbol);
             // Use typical price if H/L available, otherwise fallback to Close
             double typical_price = (high > 1e-9 && low > 1e-9) ? (high + low + close) / 3.0 : close;
             state.cumulative_price_volume += typical_price * volume;
@@ -93,27 +97,51 @@ namespace Backtester {
             if (close > upper_band) desired_signal_direction = Common::SignalDirection::SHORT;
             else if (close < lower_band) desired_signal_direction = Common::SignalDirection::LONG;
             else { // Exit logic: Cross back over VWAP
-                 if (last_signal_direction_[symbol] == Common::SignalDirection::SHORT && close < state.current_vwap) desired_signal_direction = Common::SignalDirection::FLAT;
-                 else if (last_signal_direction_[symbol] == Common::SignalDirection::LONG && close > state.current_vwap) desired_signal_direction = Common::SignalDirection::FLAT;
+                 if (last_direction == Common::SignalDirection::SHORT && close < state.current_vwap) desired_signal_direction = Common::SignalDirection::FLAT;
+                 else if (last_direction == Common::SignalDirection::LONG && close > state.current_vwap) desired_signal_direction = Common::SignalDirection::FLAT;
                  // Else, stay in existing trade if between bands and not crossing VWAP exit
-                 else desired_signal_direction = last_signal_direction_[symbol]; // Maintain position
+                 else desired_signal_direction = last_direction; // Maintain position
             }
 
             // Generate signal event if direction changes
-            if (desired_signal_direction != last_signal_direction_[symbol]) {
+            if (desired_signal_direction != last_direction) {
                  // ***** CORRECTED NAMESPACE *****
-                 std::cout << "VWAP REVERSION: " << symbol << " @ " << Utils::formatTimestampUTC(event.timestamp) // Use Utils:: directly
-                           << " Close=" << close << " VWAP=" << state.current_vwap
-                           << " Signal=" << Common::to_string(desired_signal_direction)
-                           << std::endl;
+                 BT_LOG_INFO("VWAP REVERSION: {} @ {} Close={} VWAP={} Signal={}", symbol, event.timestamp, close,
+                             state.current_vwap, Common::to_string(desired_signal_direction));
 
                 Common::Signal signal(event.timestamp, symbol, desired_signal_direction);
                 Common::SignalEvent signal_event(event.timestamp, signal);
                 portfolio.generate_order(signal_event);
 
-                last_signal_direction_[symbol] = desired_signal_direction;
+                last_direction = desired_signal_direction;
             }
         }
+
+        // --- Checkpoint hooks ---
+        void serialize(Common::BinaryWriter& writer) const override {
+            writer.write(deviation_multiplier_);
+            writer.write(static_cast<std::uint64_t>(symbol_state_.size()));
+            for (const auto& [symbol, state] : symbol_state_) {
+                writer.write(symbol);
+                writer.write(state.cumulative_price_volume);
+                writer.write(state.cumulative_volume);
+                writer.write(state.current_vwap);
+            }
+            writer.write(last_signal_direction_);
+        }
+
+        void deserialize(Common::BinaryReader& reader) override {
+            reader.expect(deviation_multiplier_, "VWAPReversion deviation multiplier");
+            symbol_state_.clear();
+            auto count = reader.read<std::uint64_t>();
+            for (std::uint64_t i = 0; i < count; ++i) {
+                SymbolState& state = Common::symbol_slot(symbol_state_, reader.read<std::string>());
+                reader.read(state.cumulative_price_volume);
+                reader.read(state.cumulative_volume);
+                reader.read(state.current_vwap);
+            }
+            reader.read(last_signal_direction_);
+        }
     }; // End class VWAPReversion
 
 } // namespace Backtester
\ No newline at end of file
@@ -0,0 +1,48 @@
+#include "../include/common/AllocationCounter.h" // Self header first
+
+#include <cstdlib>
+#include <new>
+
+namespace Backtester::Common {
+
+#if defined(BT_ALLOC_ACCOUNTING)
+    namespace {
+        // Trivial type: no TLS initialization guard, safe to touch from operator new
+        thread_local AllocationCount t_allocations;
+    } // namespace
+
+    AllocationCount thread_allocations() { return t_allocations; }
+
+    namespace detail {
+        inline void count_allocation(std::size_t size) {
+            ++t_allocations.allocations;
+            t_allocations.bytes += size;
+        }
+    } // namespace detail
+#else
+    AllocationCount thread_allocations() { return {}; }
+#endif
+
+} // namespace Backtester::Common
+
+#if defined(BT_ALLOC_ACCOUNTING)
+// --- Global replacements (the array and nothrow forms forward to these by default) ---
+void* operator new(std::size_t size) {
+    Backtester::Common::detail::count_allocation(size);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    Backtester::Common::detail::count_allocation(size);
+    std::size_t align = static_cast<std::size_t>(alignment);
+    std::size_t rounded = ((size ? size : 1) + align - 1) / align * align; // aligned_alloc wants a multiple
+    if (void* p = std::aligned_alloc(align, rounded)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+#endif
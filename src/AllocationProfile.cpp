@@ -0,0 +1,54 @@
+#include "../include/backtester/AllocationProfile.h" // Self header first
+
+#include <iomanip>
+
+namespace Backtester {
+
+    void AllocationProfile::merge(const AllocationProfile& other) {
+        for (size_t i = 0; i < stages_.size(); ++i) {
+            stages_[i].allocations += other.stages_[i].allocations;
+            stages_[i].bytes += other.stages_[i].bytes;
+        }
+        bars_ += other.bars_;
+        bars_with_allocations_ += other.bars_with_allocations_;
+        max_bar_allocations_ = std::max(max_bar_allocations_, other.max_bar_allocations_);
+        steady_bars_ += other.steady_bars_;
+        steady_violations_ += other.steady_violations_;
+        steady_allocations_ += other.steady_allocations_;
+        steady_bytes_ += other.steady_bytes_;
+        if (first_violation_bar_ < 0) first_violation_bar_ = other.first_violation_bar_;
+    }
+
+    void AllocationProfile::reset() {
+        long warmup = warmup_bars_;
+        *this = AllocationProfile();
+        warmup_bars_ = warmup;
+    }
+
+    void AllocationProfile::print(std::ostream& out) const {
+        std::ios_base::fmtflags flags = out.flags();
+        std::streamsize precision = out.precision();
+        out << "\n--- Heap Allocations ---" << std::endl;
+        if (!Common::kAllocationAccounting) {
+            out << "(not counted: configure with -DBACKTESTER_ALLOC_ACCOUNTING=ON)" << std::endl;
+            return;
+        }
+        out << std::left << std::setw(22) << "Stage" << std::right
+            << std::setw(14) << "Allocations" << std::setw(16) << "Bytes" << std::setw(12) << "Per bar" << std::endl;
+        out << std::fixed << std::setprecision(3);
+        for (size_t i = 0; i < stages_.size(); ++i) {
+            const StageCount& stage = stages_[i];
+            out << std::left << std::setw(22) << to_string(static_cast<Stage>(i)) << std::right
+                << std::setw(14) << stage.allocations << std::setw(16) << stage.bytes
+                << std::setw(12) << (bars_ ? static_cast<double>(stage.allocations) / static_cast<double>(bars_) : 0.0) << std::endl;
+        }
+        out << "Bars: " << bars_ << " (" << bars_with_allocations_ << " allocated, max " << max_bar_allocations_ << " per bar)" << std::endl;
+        out << "Steady state (after " << warmup_bars_ << " warm-up bars): " << steady_bars_ << " bars, "
+            << steady_violations_ << " allocated (" << steady_allocations_ << " allocations, " << steady_bytes_ << " bytes)";
+        if (first_violation_bar_ >= 0) out << ", first at bar " << first_violation_bar_;
+        out << std::endl << "-------------------------------" << std::endl;
+        out.flags(flags);
+        out.precision(precision);
+    }
+
+} // namespace Backtester
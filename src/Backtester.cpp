@@ -8,6 +8,12 @@
 #include <iomanip> // For put_time
 #include <ctime>   // For time_t, gmtime
 #include <cmath>   // For std::abs if used
+#include <fstream>
+#include <filesystem>
+#include <typeinfo>
+#include <cstring>
+#include <cstdint>
+#include <algorithm>
 
 // --- Include FULL definitions needed for implementation ---
 #include "../include/common/Event.h"           // <<< NEED FULL MarketEvent def HERE
@@ -15,66 +21,187 @@
 #include "../include/backtester/DataManager.h"     // Need full DataManager def
 #include "../include/backtester/Strategy.h"      // Need full StrategyBase def
 #include "../include/backtester/ExecutionSimulator.h" // Need full ExecutionSimulator def
+#include "../include/common/Utils.h"              // For formatTimestampUTC
+#include "../include/common/Serialization.h"      // Checkpoint encoding
+#include "../include/common/Logger.h"             // BT_LOG_* macros
+#include "../include/common/Trace.h"              // Timeline spans
+#include "../include/common/AllocationCounter.h"  // Per-stage allocation accounting
 
 
 namespace Backtester {
 
     // Constructor implementation
     Backtester::Backtester( DataManager& dataManager, StrategyBase& strategy,
-                            Portfolio& portfolio, ExecutionSimulator& executionSimulator)
+                            Portfolio& portfolio, ExecutionSimulator& executionSimulator,
+                            std::pmr::memory_resource* resource)
         : data_manager_(dataManager), strategy_(strategy),
-          portfolio_(portfolio), execution_simulator_(executionSimulator) {}
+          portfolio_(portfolio), execution_simulator_(executionSimulator), latest_market_data_(resource),
+          order_scheduler_(resource), arrived_orders_(resource), slice_(resource),
+          fill_({}, 0, std::string(), Common::OrderDirection::BUY, 0.0, 0.0, 0.0) {
+        portfolio_.set_run_context(&run_context_);
+        execution_simulator_.set_run_context(&run_context_);
+    }
+
+    Backtester::~Backtester() {
+        // The components may outlive this run (results are read from them afterwards)
+        portfolio_.set_run_context(nullptr);
+        execution_simulator_.set_run_context(nullptr);
+    }
 
     // Functional run loop
     void Backtester::run() {
-        std::cout << "Backtester: Starting simulation..." << std::endl;
+        if (verbose_) {
+            // Keep setup-time log lines ahead of our direct output (a round trip to the log
+            // writer thread, so quiet runs -- sweeps, sharded sessions -- leave it to the caller)
+            Log::Logger::instance().flush();
+            std::cout << "Backtester: Starting simulation..." << std::endl;
+        }
+        Trace::Span run_span("Backtester::run", "backtest", latency_profile_.get_label());
         auto start_time = std::chrono::high_resolution_clock::now();
-        long bar_count = 0;
+        long start_bar_count = bar_count_; // Non-zero when resuming from a checkpoint
+
+        // Stage timing: 'lap' is the tick at which the current stage started. Per-bar stages
+        // are timed on every latency_sample_interval_-th bar; rare stages (orders, checkpoints)
+        // are always timed.
+        const bool profile = profile_latency_;
+        const long sample_interval = std::max(1L, latency_sample_interval_);
+        long sample_phase = 0;
+        bool timed = profile;
+        if (profile) latency_profile_.begin();
+        std::uint64_t lap = profile ? Common::CycleClock::now() : 0;
+
+        // Timeline: one span per calendar day (UTC) of replayed data
+        const bool tracing = Trace::is_enabled();
+        long long trace_day = 0;
+        double trace_day_start = -1.0;
+        std::string trace_day_label;
+
+        // Size the equity curve up front so recording it stays allocation-free per bar
+        portfolio_.reserve_equity_curve(data_manager_.remaining_bars());
 
-        // (Optional) Suppress unused variable warning if simulator not used yet
-        // (void)execution_simulator_;
+        // Allocation accounting: compiled out unless built with BACKTESTER_ALLOC_ACCOUNTING
+        constexpr bool count_allocations = Common::kAllocationAccounting;
+        Common::AllocationCount alloc_mark = Common::thread_allocations();
 
-        // Main Event Loop
-        std::optional<Common::MarketEvent> market_event_opt; // From common namespace
-        while ((market_event_opt = data_manager_.get_next_bar()).has_value()) {
-            // Get the actual market event (type is Common::MarketEvent)
-            const Common::MarketEvent& market_event = market_event_opt.value();
-            bar_count++;
+        // Slice delivery holds a timestamp's bars at once, so it reads them where they stay put
+        const std::vector<Common::MarketEvent>* timeline = slice_delivery_ ? &data_manager_.get_all_events() : nullptr;
+        slice_.clear(); // A run that stopped on an error may have left a partial slice
+
+        // Main Event Loop (events are read in place, not copied)
+        const Common::MarketEvent* next_event = nullptr;
+        while ((next_event = data_manager_.get_next_bar_ref()) != nullptr) {
+            if (timed) lap = latency_profile_.lap(Stage::GET_NEXT_BAR, lap);
+            if (count_allocations) alloc_mark = allocation_profile_.charge(Stage::GET_NEXT_BAR, alloc_mark);
+            const Common::MarketEvent& market_event = *next_event;
+            bar_count_++;
+            run_context_.advance_to(market_event.timestamp);
+            bool quiet_bar = true; // No checkpoint written (order bars count as steady state)
+
+            if (tracing) {
+                long long day = std::chrono::floor<std::chrono::hours>(market_event.timestamp.time_since_epoch()).count();
+                day = (day >= 0 ? day : day - 23) / 24;
+                if (trace_day_start < 0.0 || day != trace_day) {
+                    double now = Trace::now_us();
+                    if (trace_day_start >= 0.0) Trace::record("day", "backtest", trace_day_start, now, std::move(trace_day_label));
+                    trace_day = day;
+                    trace_day_start = now;
+                    trace_day_label = Utils::formatTimestampUTC(market_event.timestamp).substr(0, 10);
+                }
+            }
 
             // Optional: Print progress
-            if (bar_count % 10000 == 0) {
-                std::time_t tt = std::chrono::system_clock::to_time_t(market_event.timestamp);
-                std::cout << "... Processing bar " << bar_count << " | Time: "
-                          << std::put_time(std::gmtime(&tt), "%Y-%m-%d %H:%M:%S UTC") << std::endl;
+            if (verbose_ && bar_count_ % 10000 == 0) {
+                BT_LOG_INFO("... Processing bar {} | Time: {}", bar_count_, market_event.timestamp);
             }
 
             try {
+                // 0. Remember this symbol's latest prices for order execution
+                latest_market_data_[market_event.symbol] = market_event.marketData;
+
                 // 1. Update Portfolio Market Value
-                // Portfolio::update_market_value expects MarketEvent (implicitly Backtester::MarketEvent due to fwd decl)
-                // But market_event is Common::MarketEvent. Compiler needs full def via Event.h to resolve.
-                portfolio_.update_market_value(market_event); // <<< This call needs Event.h included
+                portfolio_.update_market_value(market_event);
+                if (timed) lap = latency_profile_.lap(Stage::UPDATE_MARKET_VALUE, lap);
+                if (count_allocations) alloc_mark = allocation_profile_.charge(Stage::UPDATE_MARKET_VALUE, alloc_mark);
 
-                // 2. Let Strategy react to Market Data
-                // Strategy::handle_market_event expects Common::MarketEvent, which matches.
-                strategy_.handle_market_event(market_event, portfolio_);
+                // 1b. Execute resting limit/stop orders this bar reaches, then delayed orders that
+                //     have arrived for its symbol (before the strategy sees the bar)
+                if (execution_simulator_.has_resting_orders() || !order_scheduler_.empty()) {
+                    if (profile && !timed) lap = Common::CycleClock::now();
+                    if (execution_simulator_.has_resting_orders()) execute_resting_orders(market_event);
+                    if (!order_scheduler_.empty()) execute_arrived_orders(market_event);
+                    if (profile) lap = latency_profile_.lap(Stage::ORDER_ROUTING, lap);
+                    if (count_allocations) alloc_mark = allocation_profile_.charge(Stage::ORDER_ROUTING, alloc_mark);
+                }
 
-                // 3. Order/Fill Handling (Simplified Flow Explanation)
-                 if (bar_count == 1) {
-                     std::cout << "INFO: Backtester.run simplified flow - order/fill simulation triggered internally." << std::endl;
-                 }
+                // 2. Let Strategy react to Market Data (under slice delivery, once the
+                //    timestamp's last bar is in)
+                bool slice_complete = false;
+                if (slice_delivery_) {
+                    slice_.add((*timeline)[data_manager_.get_cursor() - 1]); // This bar, in place
+                    const Common::MarketEvent* upcoming = data_manager_.peek_next_bar();
+                    slice_complete = !upcoming || upcoming->timestamp != market_event.timestamp;
+                    if (slice_complete) strategy_.handle_slice(slice_, portfolio_);
+                } else {
+                    strategy_.handle_market_event(market_event, portfolio_);
+                }
+                if (timed) lap = latency_profile_.lap(Stage::STRATEGY, lap);
+                if (count_allocations) alloc_mark = allocation_profile_.charge(Stage::STRATEGY, alloc_mark);
+
+                // 3. Execute any orders the strategy raised through the Portfolio
+                if (portfolio_.has_pending_orders()) {
+                    if (profile && !timed) lap = Common::CycleClock::now();
+                    route_pending_orders(market_event);
+                    if (profile) lap = latency_profile_.lap(Stage::ORDER_ROUTING, lap);
+                    if (count_allocations) alloc_mark = allocation_profile_.charge(Stage::ORDER_ROUTING, alloc_mark);
+                }
+
+                // 4. Periodic checkpoint (taken between bars; orders still in flight under an
+                //    order latency model are saved with the OrderScheduler. Under slice
+                //    delivery, at the end of the slice that reached the interval)
+                bool checkpoint_due = false;
+                if (checkpoint_interval_ > 0) {
+                    checkpoint_due = slice_delivery_
+                        ? slice_complete && (bar_count_ - static_cast<long>(slice_.bar_count())) / checkpoint_interval_ != bar_count_ / checkpoint_interval_
+                        : bar_count_ % checkpoint_interval_ == 0;
+                }
+                if (slice_complete) slice_.clear();
+                if (checkpoint_due) {
+                    if (profile) lap = Common::CycleClock::now();
+                    save_checkpoint(checkpoint_path_);
+                    if (profile) lap = latency_profile_.lap(Stage::CHECKPOINT, lap);
+                    if (count_allocations) alloc_mark = allocation_profile_.charge(Stage::CHECKPOINT, alloc_mark);
+                    quiet_bar = false;
+                }
 
             } catch (const std::exception& e) {
-                std::cerr << "Error during loop for bar " << bar_count << " timestamp "
-                          << std::chrono::system_clock::to_time_t(market_event.timestamp) << ": " << e.what() << std::endl;
+                BT_LOG_ERROR("Error during loop for bar {} timestamp {}: {}", bar_count_, market_event.timestamp, e.what());
                  break; // Stop on error
             }
+            if (count_allocations) allocation_profile_.end_bar(bar_count_, quiet_bar);
+
+            // Decide whether the next bar is timed ('lap' is already current if this one was)
+            if (profile) {
+                bool next_timed = (++sample_phase % sample_interval) == 0;
+                if (next_timed && !timed) lap = Common::CycleClock::now();
+                timed = next_timed;
+            }
         } // End while loop
+        if (profile) latency_profile_.end();
+        if (tracing && trace_day_start >= 0.0) {
+            Trace::record("day", "backtest", trace_day_start, Trace::now_us(), std::move(trace_day_label));
+        }
+        run_span.end();
 
-        // ... (Rest of run method - finish/summary printout) ...
+        if (!verbose_) return;
+        // Drain queued log lines so they precede the summary below
+        Log::Logger::instance().flush();
+
+        // --- Finish/summary printout ---
         auto end_time = std::chrono::high_resolution_clock::now();
         auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
 
-        std::cout << "Backtester: Simulation finished after processing " << bar_count << " bars." << std::endl;
+        std::cout << "Backtester: Simulation finished after processing " << (bar_count_ - start_bar_count) << " bars"
+                  << (start_bar_count > 0 ? " (resumed at bar " + std::to_string(start_bar_count) + ")." : ".") << std::endl;
         std::cout << "Backtester: Total duration: " << duration.count() << " ms" << std::endl;
         std::cout << "----------------------------------------" << std::endl;
         std::cout << "           Final Backtest Results           " << std::endl;
@@ -92,15 +219,173 @@ namespace Backtester {
         std::cout << "\nFinal Positions:" << std::endl;
         const auto& final_positions = portfolio_.get_positions();
         bool has_positions = false;
-        for (const auto& pair : final_positions) {
-             const auto& pos = pair.second;
-             if (std::abs(pos.quantity) > 1e-9) {
+        for (Common::SymbolId id = 0; id < final_positions.size(); ++id) {
+             const Common::PositionView pos = final_positions.view(id);
+             if (pos.is_open()) {
                  has_positions = true;
-                 std::cout << "  Symbol: " << pos.symbol << ", Qty: " << pos.quantity << ", AvgPx: " << pos.average_entry_price << ", MV: " << pos.market_value << ", UPL: " << pos.unrealized_pnl << ", RPL: " << pos.realized_pnl << std::endl;
+                 std::cout << "  Symbol: " << pos.symbol() << ", Qty: " << pos.quantity() << ", AvgPx: " << pos.average_entry_price() << ", MV: " << pos.market_value() << ", UPL: " << pos.unrealized_pnl() << ", RPL: " << pos.realized_pnl() << std::endl;
              }
         }
          if (!has_positions) { std::cout << "  (None)" << std::endl; }
         std::cout << "----------------------------------------" << std::endl;
+        if (profile) latency_profile_.print(std::cout);
+        if (count_allocations) allocation_profile_.print(std::cout);
+    }
+
+    // --- Checkpointing ---
+    namespace {
+        constexpr char kCheckpointMagic[8] = {'B', 'T', 'C', 'K', 'P', 'T', '0', '1'};
+        constexpr char kCheckpointEndMagic[8] = {'B', 'T', 'C', 'K', 'E', 'N', 'D', '!'};
+        constexpr std::uint32_t kCheckpointVersion = 12; // 2: equity-curve mode and streaming metrics state; 3: open round trips; 4: resting orders; 5: orders in flight; 6: run context; 7: PairsTrading engine mode; 8: resting orders' accrued commission; 9: PairsTrading thresholds and hedge ratio; 10: LeadLagStrategy leg timestamps; 11: OpeningRangeBreakout sessions; 12: MomentumIgnition ring history
+    } // namespace
+
+    void Backtester::save_checkpoint(const std::string& path) const {
+        BT_TRACE_SCOPE("save_checkpoint", "io");
+        // Write to a temporary file and rename it over the target, so a crash mid-write
+        // never destroys the previous good checkpoint
+        const std::string tmp_path = path + ".tmp";
+        {
+            std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+            if (!out) throw std::runtime_error("Backtester: cannot open checkpoint file '" + tmp_path + "'");
+            Common::BinaryWriter writer(out);
+            out.write(kCheckpointMagic, sizeof(kCheckpointMagic));
+            writer.write(kCheckpointVersion);
+
+            // Engine state: data cursor plus the last consumed event, so resuming against a
+            // different (or re-sorted) dataset is detected rather than silently diverging
+            const std::vector<Common::MarketEvent>& events = data_manager_.get_all_events();
+            const size_t cursor = data_manager_.get_cursor();
+            writer.write(static_cast<std::uint64_t>(cursor));
+            writer.write(bar_count_);
+            const bool has_last_event = cursor > 0 && cursor <= events.size();
+            writer.write(has_last_event);
+            if (has_last_event) {
+                writer.write(events[cursor - 1].timestamp);
+                writer.write(events[cursor - 1].symbol);
+            }
+            run_context_.serialize(writer);
+            writer.write(latest_market_data_);
+
+            // Components
+            portfolio_.serialize(writer);
+            execution_simulator_.serialize(writer);
+            order_scheduler_.serialize(writer);
+            writer.write(std::string(typeid(strategy_).name()));
+            strategy_.serialize(writer);
+
+            out.write(kCheckpointEndMagic, sizeof(kCheckpointEndMagic));
+            out.flush();
+            if (!out) throw std::runtime_error("Backtester: failed writing checkpoint '" + tmp_path + "'");
+        }
+        std::filesystem::rename(tmp_path, path);
+    }
+
+    // On failure the components may be partially restored and should not be reused
+    void Backtester::load_checkpoint(const std::string& path) {
+        BT_TRACE_SCOPE("load_checkpoint", "io");
+        std::ifstream in(path, std::ios::binary);
+        if (!in) throw std::runtime_error("Backtester: cannot open checkpoint file '" + path + "'");
+        Common::BinaryReader reader(in);
+
+        char magic[sizeof(kCheckpointMagic)] = {};
+        in.read(magic, sizeof(magic));
+        if (!in || std::memcmp(magic, kCheckpointMagic, sizeof(magic)) != 0) {
+            throw std::runtime_error("Backtester: '" + path + "' is not a checkpoint file");
+        }
+        reader.expect(kCheckpointVersion, "checkpoint format version");
+
+        const std::vector<Common::MarketEvent>& events = data_manager_.get_all_events();
+        const auto cursor = reader.read<std::uint64_t>();
+        reader.read(bar_count_);
+        if (cursor > events.size()) {
+            throw std::runtime_error("Backtester: checkpoint cursor " + std::to_string(cursor) +
+                                     " is beyond the loaded data (" + std::to_string(events.size()) + " events)");
+        }
+        if (reader.read<bool>()) {
+            auto last_timestamp = reader.read<std::chrono::system_clock::time_point>();
+            auto last_symbol = reader.read<std::string>();
+            if (cursor == 0 || events[cursor - 1].timestamp != last_timestamp || events[cursor - 1].symbol != last_symbol) {
+                throw std::runtime_error("Backtester: loaded data does not match the checkpoint (event " +
+                                         std::to_string(cursor) + " differs)");
+            }
+        }
+        run_context_.deserialize(reader);
+        reader.read(latest_market_data_);
+
+        portfolio_.deserialize(reader);
+        execution_simulator_.deserialize(reader);
+        order_scheduler_.deserialize(reader);
+        reader.expect(std::string(typeid(strategy_).name()), "strategy type");
+        strategy_.deserialize(reader);
+
+        char end_magic[sizeof(kCheckpointEndMagic)] = {};
+        in.read(end_magic, sizeof(end_magic));
+        if (!in || std::memcmp(end_magic, kCheckpointEndMagic, sizeof(end_magic)) != 0) {
+            throw std::runtime_error("Backtester: checkpoint '" + path + "' is truncated or corrupt");
+        }
+
+        data_manager_.seek(static_cast<size_t>(cursor));
+        if (verbose_) {
+            std::cout << "Backtester: Restored checkpoint '" << path << "' at bar " << bar_count_ << std::endl;
+        }
+    }
+
+    // Without an order latency model, orders are executed immediately against the latest bar
+    // of their own symbol; with one, they are scheduled to arrive after their sampled delay
+    void Backtester::route_pending_orders(const Common::MarketEvent& market_event) {
+        // Cancels / replaces first, so an order queued with them is not amended by mistake.
+        // They take effect at once, whether the order is still in flight or already resting.
+        for (const Common::OrderAmendment& amendment : portfolio_.take_pending_amendments()) {
+            bool applied = amendment.cancel
+                ? (order_scheduler_.cancel(amendment.order_id) || execution_simulator_.cancel_order(amendment.order_id))
+                : (order_scheduler_.replace(amendment.order_id, amendment.price, amendment.quantity) ||
+                   execution_simulator_.replace_order(amendment.order_id, amendment.price, amendment.quantity));
+            if (!applied) {
+                BT_LOG_WARN("Backtester Warning: OrderID {} is not resting; {} ignored", amendment.order_id,
+                            amendment.cancel ? "cancel" : "replace");
+            }
+        }
+        for (const auto& order : portfolio_.take_pending_orders()) {
+            if (order_latency_enabled_) {
+                order_scheduler_.schedule(order, market_event.timestamp + order_latency_.sample(order.symbol, run_context_.derive_seed(order_scheduler_.scheduled())));
+                continue;
+            }
+            auto data_it = latest_market_data_.find(order.symbol);
+            if (data_it == latest_market_data_.end()) {
+                BT_LOG_WARN("Backtester Warning: No market data yet for {}; dropping OrderID {}", order.symbol, order.order_id);
+                continue;
+            }
+            execute_order(order, data_it->second, market_event.timestamp);
+        }
+    }
+
+    // Delayed orders that have arrived by this bar and wait for its symbol execute against it
+    void Backtester::execute_arrived_orders(const Common::MarketEvent& market_event) {
+        arrived_orders_.clear();
+        order_scheduler_.release(market_event.symbol, market_event.timestamp, arrived_orders_);
+        for (const Common::OrderRequest& order : arrived_orders_) {
+            execute_order(order, market_event.marketData, market_event.timestamp);
+        }
+    }
+
+    void Backtester::execute_order(const Common::OrderRequest& order, const Common::DataSnapshot& market_data,
+                                   std::chrono::system_clock::time_point timestamp) {
+        if (!execution_simulator_.simulate_order(order, market_data, timestamp, fill_)) return;
+
+        portfolio_.update_fill(fill_);
+        Common::FillEvent fill_event(fill_.timestamp, fill_);
+        strategy_.handle_fill_event(fill_event, portfolio_);
+    }
+
+    // Fills of resting orders triggered by this bar, applied like routed fills
+    void Backtester::execute_resting_orders(const Common::MarketEvent& market_event) {
+        resting_fills_.clear();
+        execution_simulator_.on_bar(market_event, resting_fills_);
+        for (const Common::FillDetails& fill : resting_fills_) {
+            portfolio_.update_fill(fill);
+            Common::FillEvent fill_event(fill.timestamp, fill);
+            strategy_.handle_fill_event(fill_event, portfolio_);
+        }
     }
 
-} // namespace Backtester
\ No newline at end of file
+} // namespace Backtester
@@ -0,0 +1,93 @@
+#include "../include/backtester/ColumnarData.h" // Self header first
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <set>
+#include <stdexcept>
+
+namespace Backtester {
+
+    namespace {
+        constexpr double kMissing = std::numeric_limits<double>::quiet_NaN();
+
+        // "Upper" first, then "lower", as the strategies look fields up
+        double field(const Common::DataSnapshot& data, const std::string& upper, const std::string& lower) {
+            auto it = data.find(upper);
+            if (it != data.end()) return it->second;
+            it = data.find(lower);
+            return it != data.end() ? it->second : kMissing;
+        }
+    }
+
+    void ColumnarData::load(const std::vector<Common::MarketEvent>& events) {
+        if (events.size() >= kNoRow) throw std::invalid_argument("ColumnarData: too many events");
+        static const std::string kUpper[] = {"Open", "High", "Low", "Close", "Volume"};
+        static const std::string kLower[] = {"open", "high", "low", "close", "volume"};
+
+        std::set<std::string> names;
+        for (const auto& event : events) names.insert(event.symbol);
+        symbols_.assign(names.begin(), names.end());
+        ids_.clear();
+        for (size_t id = 0; id < symbols_.size(); ++id) ids_.emplace(symbols_[id], id);
+
+        // Size each series up front: one pass to count, one to fill
+        std::vector<size_t> counts(symbols_.size(), 0);
+        event_symbol_.resize(events.size());
+        event_row_.assign(events.size(), kNoRow);
+        for (size_t e = 0; e < events.size(); ++e) {
+            const std::uint32_t id = static_cast<std::uint32_t>(*Common::find_symbol(ids_, events[e].symbol));
+            event_symbol_[e] = id;
+            const auto& data = events[e].marketData;
+            if (data.count("Close") || data.count("close")) {
+                event_row_[e] = 0; // Has a bar; numbered below
+                ++counts[id];
+            }
+        }
+        series_.assign(symbols_.size(), Series{});
+        for (size_t id = 0; id < symbols_.size(); ++id) {
+            Series& s = series_[id];
+            for (auto* column : {&s.open, &s.high, &s.low, &s.close, &s.volume}) column->reserve(counts[id]);
+            s.time_ns.reserve(counts[id]);
+            s.event.reserve(counts[id]);
+        }
+
+        event_time_ns_.resize(events.size());
+        for (size_t e = 0; e < events.size(); ++e) {
+            const auto& event = events[e];
+            event_time_ns_[e] = std::chrono::duration_cast<std::chrono::nanoseconds>(event.timestamp.time_since_epoch()).count();
+            if (event_row_[e] == kNoRow) continue;
+            Series& s = series_[event_symbol_[e]];
+            event_row_[e] = static_cast<std::uint32_t>(s.size());
+            s.time_ns.push_back(event_time_ns_[e]);
+            s.open.push_back(field(event.marketData, kUpper[0], kLower[0]));
+            s.high.push_back(field(event.marketData, kUpper[1], kLower[1]));
+            s.low.push_back(field(event.marketData, kUpper[2], kLower[2]));
+            s.close.push_back(field(event.marketData, kUpper[3], kLower[3]));
+            s.volume.push_back(field(event.marketData, kUpper[4], kLower[4]));
+            s.event.push_back(static_cast<std::uint32_t>(e));
+        }
+    }
+
+    size_t ColumnarData::symbol_id(std::string_view symbol) const {
+        const size_t* id = Common::find_symbol(ids_, symbol);
+        return id ? *id : symbols_.size();
+    }
+
+    BarQuote ColumnarData::quote(size_t id, size_t row) const {
+        // The fallbacks of BarQuote::from: a missing open is the close, a missing high / low
+        // the larger / smaller of open and close
+        const Series& s = series_.at(id);
+        BarQuote q;
+        q.valid = true;
+        q.close = s.close[row];
+        q.open = std::isnan(s.open[row]) ? q.close : s.open[row];
+        q.high = std::max(std::isnan(s.high[row]) ? std::max(q.open, q.close) : s.high[row], q.open);
+        q.low = std::min(std::isnan(s.low[row]) ? std::min(q.open, q.close) : s.low[row], q.open);
+        q.has_volume = !std::isnan(s.volume[row]);
+        if (q.has_volume) q.volume = s.volume[row];
+        return q;
+    }
+
+} // namespace Backtester
@@ -6,6 +6,7 @@
 #include "../include/common/Signal.h"
 #include "../include/common/OrderTypes.h"
 #include "../include/common/Utils.h"
+#include "../include/common/Logger.h"
 #include <iostream>
 #include <vector>
 #include <string>
@@ -22,20 +23,29 @@ using FeatureMap = std::unordered_map<std::string, double>; // From FeatureCalcu
 
 namespace Backtester {
 
+    namespace {
+        // Model input layout (MUST match model training!) -- built once, not per bar
+        const std::vector<std::string>& feature_order() {
+            static const std::vector<std::string> order = {"price", "SMA_10_stub", "RSI_14_stub", "dummy_feature"}; // EXAMPLE ORDER
+            return order;
+        }
+    } // namespace
+
     // Constructor Definition (Example taking references)
     DRLStrategy::DRLStrategy(
         FeatureCalculator& fc,
         DRLInferenceEngine& ie,
         const std::vector<std::string>& symbols,
-        double target_size)
+        double target_size,
+        std::pmr::memory_resource* resource)
         : feature_calculator_(fc), inference_engine_(ie),
-          symbols_to_trade_(symbols), target_position_size_(target_size)
+          symbols_to_trade_(symbols), target_position_size_(target_size), current_signal_state_(resource)
     {
         if (symbols_to_trade_.empty() || target_position_size_ <= 0) {
             throw std::invalid_argument("Invalid symbols or target size for DRLStrategy");
         }
         for (const auto& sym : symbols_to_trade_) {
-            current_signal_state_[sym] = Common::SignalDirection::FLAT;
+            Common::symbol_slot(current_signal_state_, sym) = Common::SignalDirection::FLAT;
         }
     }
 
@@ -45,27 +55,28 @@ namespace Backtester {
         for (const auto& traded_sym : symbols_to_trade_) { if (event.symbol == traded_sym) { trade_this_symbol = true; break; } }
         if (!trade_this_symbol) return;
 
-        // 1. Calculate features (returns FeatureMap)
-        FeatureMap features = feature_calculator_.calculate_features(event.marketData);
+        // 1. Calculate features (into the reused FeatureMap)
+        FeatureMap& features = features_;
+        feature_calculator_.calculate_features(event.marketData, features);
 
         // 2. Prepare feature vector (MUST match model training!)
-        FeatureVector model_input;
+        FeatureVector& model_input = model_input_;
+        model_input.clear();
         // --- Use actual feature names defined in FeatureCalculator ---
-        std::vector<std::string> feature_order = {"price", "SMA_10_stub", "RSI_14_stub", "dummy_feature"}; // EXAMPLE ORDER
-        model_input.reserve(feature_order.size());
-        for(const std::string& fname : feature_order) {
-            if (features.count(fname)) model_input.push_back(features.at(fname));
-            else model_input.push_back(0.0); // Use 0 for missing
+        for(const std::string& fname : feature_order()) {
+            auto it = features.find(fname);
+            model_input.push_back(it != features.end() ? it->second : 0.0); // Use 0 for missing
         }
 
         if (model_input.empty()) { return; } // Skip if no features
 
-        // 3. Get prediction (predict now takes FeatureVector, returns ModelOutput)
-        ModelOutput predictions = inference_engine_.predict(model_input); // <-- Should match now
+        // 3. Get prediction (into the reused ModelOutput)
+        ModelOutput& predictions = predictions_;
+        inference_engine_.predict(model_input, predictions);
 
         // 4. Interpret predictions (vector of probabilities/scores)
         if (predictions.empty() || predictions.size() < 3) { // Check vector size
-            std::cerr << "Warning (DRLStrategy): Invalid prediction output size for " << event.symbol << std::endl;
+            BT_LOG_WARN("Warning (DRLStrategy): Invalid prediction output size for {}", event.symbol);
             return;
         }
         Common::SignalDirection desired_signal = Common::SignalDirection::FLAT;
@@ -78,21 +89,31 @@ namespace Backtester {
         // else FLAT (default)
 
         // 5. Generate SignalEvent if state changes
-        if (desired_signal != current_signal_state_[event.symbol]) {
-             std::cout << "DRL Signal: " << event.symbol << " @ " << Utils::formatTimestampUTC(event.timestamp)
-                       << " Action=" << Common::to_string(desired_signal);
+        Common::SignalDirection& current_state = Common::symbol_slot(current_signal_state_, event.symbol);
+        if (desired_signal != current_state) {
              if (predictions.size() >= 3) { // Print probabilities
-                  std::cout << " (Probs: B=" << std::fixed << std::setprecision(3) << predictions[0]
-                            << ", S=" << predictions[1] << ", H=" << predictions[2] << ")";
+                  BT_LOG_INFO("DRL Signal: {} @ {} Action={} (Probs: B={:.3f}, S={:.3f}, H={:.3f})", event.symbol,
+                              event.timestamp, Common::to_string(desired_signal), predictions[0], predictions[1], predictions[2]);
+             } else {
+                  BT_LOG_INFO("DRL Signal: {} @ {} Action={}", event.symbol, event.timestamp, Common::to_string(desired_signal));
              }
-             std::cout << std::endl;
 
              Common::Signal signal(event.timestamp, event.symbol, desired_signal);
              Common::SignalEvent signal_event(event.timestamp, signal);
              portfolio.generate_order(signal_event); // Portfolio handles order generation
 
-             current_signal_state_[event.symbol] = desired_signal; // Update state
+             current_state = desired_signal; // Update state
         }
     }
 
+    void DRLStrategy::serialize(Common::BinaryWriter& writer) const {
+        writer.write(symbols_to_trade_);
+        writer.write(current_signal_state_);
+    }
+
+    void DRLStrategy::deserialize(Common::BinaryReader& reader) {
+        reader.expect(symbols_to_trade_, "DRLStrategy symbols");
+        reader.read(current_signal_state_);
+    }
+
 } // namespace Backtester
\ No newline at end of file
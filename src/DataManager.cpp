@@ -17,6 +17,7 @@
 #include <cctype>          // <<< NEED THIS for std::tolower
 
 #include <csv2/reader.hpp> // Include csv2 header
+#include "common/Trace.h"    // Timeline spans
 
 // Filesystem alias
 namespace fs = std::filesystem;
@@ -140,6 +141,7 @@ namespace Backtester {
 
         // --- load_data handles DIRECTORY path ---
         bool load_data(const std::string& directory_source) override {
+            Trace::Span load_span("load_data", "io", directory_source);
             data_directory_path_ = directory_source;
             current_row_index_ = 0;
             all_parsed_data_.clear();
@@ -162,6 +164,7 @@ namespace Backtester {
                           if (ext == ".csv") {
                               // --- Use getSymbolFromFilename --- <<< CORRECTED
                               std::string current_symbol = getSymbolFromFilename(file_path);
+                              Trace::Span file_span("parse_file", "io", file_path.filename().string());
                               std::cout << "  --> Processing file: " << file_path.filename().string() << " for symbol: " << current_symbol << std::endl;
 
                               csv2::Reader<csv2::delimiter<'\t'>, // Assuming TAB delimiter
@@ -236,8 +239,11 @@ namespace Backtester {
 
             // --- Sort all loaded data by timestamp ---
             std::cout << "DataManager: Sorting " << all_parsed_data_.size() << " loaded events by timestamp..." << std::endl;
-            std::sort(all_parsed_data_.begin(), all_parsed_data_.end(),
-                      [](const Common::MarketEvent& a, const Common::MarketEvent& b) { return a.timestamp < b.timestamp; });
+            {
+                BT_TRACE_SCOPE("sort_events", "data");
+                std::sort(all_parsed_data_.begin(), all_parsed_data_.end(),
+                          [](const Common::MarketEvent& a, const Common::MarketEvent& b) { return a.timestamp < b.timestamp; });
+            }
             std::cout << "DataManager: Data sorting complete." << std::endl;
 
             return true;
@@ -248,16 +254,75 @@ namespace Backtester {
             if (current_row_index_ >= all_parsed_data_.size()) { return std::nullopt; }
             return all_parsed_data_[current_row_index_++];
         }
+        const Common::MarketEvent* get_next_bar_ref() override {
+            if (current_row_index_ >= all_parsed_data_.size()) { return nullptr; }
+            return &all_parsed_data_[current_row_index_++];
+        }
 
         void reset() override {
             current_row_index_ = 0;
             std::cout << "Data stream reset to beginning for directory " << data_directory_path_ << std::endl;
         }
+
+        const std::vector<Common::MarketEvent>& get_all_events() const override { return all_parsed_data_; }
+
+        size_t get_cursor() const override { return current_row_index_; }
+        void seek(size_t cursor) override {
+            if (cursor > all_parsed_data_.size()) {
+                throw std::out_of_range("DataManager: seek position " + std::to_string(cursor) + " beyond loaded data");
+            }
+            current_row_index_ = cursor;
+        }
     }; // End of CsvDataManager class
 
+    // Replays a contiguous slice of another manager's events (one session, one shard, ...)
+    class SliceDataManager : public DataManager {
+    private:
+        const std::vector<Common::MarketEvent>& events_;
+        size_t begin_;
+        size_t end_;
+        size_t current_row_index_;
+
+    public:
+        SliceDataManager(const std::vector<Common::MarketEvent>& events, size_t begin, size_t end)
+            : events_(events), begin_(std::min(begin, events.size())),
+              end_(std::min(std::max(begin, end), events.size())), current_row_index_(begin_) {}
+
+        // Data is bound at construction; nothing to load
+        bool load_data(const std::string& source) override { return begin_ < end_; }
+
+        std::optional<Common::MarketEvent> get_next_bar() override {
+            if (current_row_index_ >= end_) { return std::nullopt; }
+            return events_[current_row_index_++];
+        }
+        const Common::MarketEvent* get_next_bar_ref() override {
+            if (current_row_index_ >= end_) { return nullptr; }
+            return &events_[current_row_index_++];
+        }
+        size_t remaining_bars() const override { return end_ - std::min(current_row_index_, end_); }
+
+        void reset() override { current_row_index_ = begin_; }
+
+        // Note: returns the full underlying event set, not just this slice
+        const std::vector<Common::MarketEvent>& get_all_events() const override { return events_; }
+
+        size_t get_cursor() const override { return current_row_index_; }
+        void seek(size_t cursor) override {
+            if (cursor < begin_ || cursor > end_) {
+                throw std::out_of_range("SliceDataManager: seek position outside slice");
+            }
+            current_row_index_ = cursor;
+        }
+    }; // End of SliceDataManager class
+
     // Factory function implementation
     std::unique_ptr<DataManager> create_csv_data_manager() {
          return std::make_unique<CsvDataManager>();
     }
 
+    std::unique_ptr<DataManager> create_slice_data_manager(
+        const std::vector<Common::MarketEvent>& events, size_t begin, size_t end) {
+         return std::make_unique<SliceDataManager>(events, begin, end);
+    }
+
 } // namespace Backtester
\ No newline at end of file
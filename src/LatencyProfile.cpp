@@ -0,0 +1,118 @@
+#include "../include/backtester/LatencyProfile.h" // Self header first
+
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <stdexcept>
+
+namespace Backtester {
+
+    const char* to_string(Stage stage) {
+        switch (stage) {
+            case Stage::GET_NEXT_BAR:        return "get_next_bar";
+            case Stage::UPDATE_MARKET_VALUE: return "update_market_value";
+            case Stage::STRATEGY:            return "handle_market_event";
+            case Stage::ORDER_ROUTING:       return "order_routing";
+            case Stage::CHECKPOINT:          return "checkpoint";
+            default:                         return "unknown";
+        }
+    }
+
+    namespace {
+        std::string json_escape(const std::string& text) {
+            std::string escaped;
+            escaped.reserve(text.size());
+            for (char c : text) {
+                if (c == '"' || c == '\\') { escaped.push_back('\\'); escaped.push_back(c); }
+                else if (static_cast<unsigned char>(c) < 0x20) escaped.push_back(' ');
+                else escaped.push_back(c);
+            }
+            return escaped;
+        }
+    } // namespace
+
+    void LatencyProfile::begin() {
+        begin_time_ = std::chrono::steady_clock::now();
+        begin_ticks_ = Common::CycleClock::now();
+    }
+
+    void LatencyProfile::end() {
+        std::uint64_t end_ticks = Common::CycleClock::now();
+        auto end_time = std::chrono::steady_clock::now();
+        calibration_ticks_ += end_ticks - begin_ticks_;
+        calibration_ns_ += std::chrono::duration_cast<std::chrono::nanoseconds>(end_time - begin_time_).count();
+    }
+
+    double LatencyProfile::ns_per_tick() const {
+        if (calibration_ticks_ == 0 || calibration_ns_ <= 0) return 1.0; // Uncalibrated: assume 1 tick = 1 ns
+        return static_cast<double>(calibration_ns_) / static_cast<double>(calibration_ticks_);
+    }
+
+    void LatencyProfile::merge(const LatencyProfile& other) {
+        for (size_t i = 0; i < histograms_.size(); ++i) histograms_[i].merge(other.histograms_[i]);
+        calibration_ticks_ += other.calibration_ticks_;
+        calibration_ns_ += other.calibration_ns_;
+    }
+
+    void LatencyProfile::reset() {
+        for (auto& histogram : histograms_) histogram.reset();
+        calibration_ticks_ = 0;
+        calibration_ns_ = 0;
+    }
+
+    void LatencyProfile::print(std::ostream& out) const {
+        std::ios_base::fmtflags flags = out.flags();
+        std::streamsize precision = out.precision();
+        out << "\n--- Stage Latency (" << label_ << ", ns) ---" << std::endl;
+        out << std::left << std::setw(22) << "Stage" << std::right
+            << std::setw(10) << "Count" << std::setw(10) << "Mean" << std::setw(10) << "p50"
+            << std::setw(10) << "p99" << std::setw(10) << "p99.9" << std::setw(12) << "Max" << std::endl;
+        out << std::fixed << std::setprecision(0);
+        for (size_t i = 0; i < histograms_.size(); ++i) {
+            const Common::LatencyHistogram& h = histograms_[i];
+            if (h.count() == 0) continue;
+            out << std::left << std::setw(22) << to_string(static_cast<Stage>(i)) << std::right
+                << std::setw(10) << h.count()
+                << std::setw(10) << h.mean() * ns_per_tick()
+                << std::setw(10) << to_ns(h.value_at_quantile(0.50))
+                << std::setw(10) << to_ns(h.value_at_quantile(0.99))
+                << std::setw(10) << to_ns(h.value_at_quantile(0.999))
+                << std::setw(12) << to_ns(h.max()) << std::endl;
+        }
+        out << "-------------------------------" << std::endl;
+        out.flags(flags);
+        out.precision(precision);
+    }
+
+    std::string LatencyProfile::to_json() const {
+        std::ostringstream json;
+        json << std::fixed << std::setprecision(1);
+        json << "{\"label\":\"" << json_escape(label_) << "\",\"ns_per_tick\":" << std::setprecision(6) << ns_per_tick()
+             << std::setprecision(1) << ",\"stages\":{";
+        bool first = true;
+        for (size_t i = 0; i < histograms_.size(); ++i) {
+            const Common::LatencyHistogram& h = histograms_[i];
+            if (!first) json << ",";
+            first = false;
+            json << "\"" << to_string(static_cast<Stage>(i)) << "\":{"
+                 << "\"count\":" << h.count()
+                 << ",\"mean_ns\":" << h.mean() * ns_per_tick()
+                 << ",\"min_ns\":" << to_ns(h.min())
+                 << ",\"p50_ns\":" << to_ns(h.value_at_quantile(0.50))
+                 << ",\"p99_ns\":" << to_ns(h.value_at_quantile(0.99))
+                 << ",\"p999_ns\":" << to_ns(h.value_at_quantile(0.999))
+                 << ",\"max_ns\":" << to_ns(h.max())
+                 << ",\"total_ns\":" << to_ns(h.sum()) << "}";
+        }
+        json << "}}";
+        return json.str();
+    }
+
+    void LatencyProfile::write_json(const std::string& path) const {
+        std::ofstream out(path);
+        if (!out) throw std::runtime_error("LatencyProfile: cannot open '" + path + "' for writing");
+        out << to_json() << "\n";
+        if (!out) throw std::runtime_error("LatencyProfile: failed writing '" + path + "'");
+    }
+
+} // namespace Backtester
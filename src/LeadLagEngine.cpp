@@ -0,0 +1,209 @@
+#include "../include/backtester/LeadLagEngine.h" // Self header first
+
+#include "../include/common/RollingStats.h" // detail::kResyncWindows
+#include "../include/common/SimdKernels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace Backtester {
+
+    LeadLagEngine::LeadLagEngine(std::vector<std::string> universe, size_t window, size_t max_lag,
+                                 std::pmr::memory_resource* resource)
+        : symbols_(std::move(universe)), ids_(resource), window_(window), max_lag_(max_lag),
+          returns_(resource), sum_(resource), sum_sq_(resource), cross_(resource),
+          aligner_(symbols_.size(), resource), slice_ids_(resource), previous_close_(resource) {
+        if (symbols_.empty()) throw std::invalid_argument("LeadLagEngine: empty universe");
+        if (window_ < 2) throw std::invalid_argument("LeadLagEngine: window must be at least 2");
+        if (max_lag_ == 0) throw std::invalid_argument("LeadLagEngine: max_lag must be at least 1");
+        for (size_t id = 0; id < symbols_.size(); ++id) {
+            if (!ids_.emplace(symbols_[id], id).second) {
+                throw std::invalid_argument("LeadLagEngine: duplicate symbol " + symbols_[id]);
+            }
+        }
+        rows_ = 1;
+        while (rows_ <= window_ + max_lag_) rows_ <<= 1;
+        reset();
+    }
+
+    void LeadLagEngine::reset() {
+        const size_t n = symbols_.size();
+        returns_.assign(rows_ * n, 0.0);
+        sum_.assign((max_lag_ + 1) * n, 0.0);
+        sum_sq_.assign((max_lag_ + 1) * n, 0.0);
+        cross_.assign(n * max_lag_ * n, 0.0);
+        aligner_.reset();
+        previous_close_.assign(n, 0.0);
+        steps_ = 0;
+        since_resync_ = 0;
+    }
+
+    size_t LeadLagEngine::symbol_id(std::string_view symbol) const {
+        const size_t* id = Common::find_symbol(ids_, symbol);
+        return id ? *id : symbols_.size();
+    }
+
+    LeadLagEngine::Subscription LeadLagEngine::subscribe(std::string_view leader, std::string_view lagger, size_t lag) const {
+        Subscription s{symbol_id(leader), symbol_id(lagger), lag};
+        if (s.leader == size()) throw std::invalid_argument("LeadLagEngine: leader " + std::string(leader) + " is not in the universe");
+        if (s.lagger == size()) throw std::invalid_argument("LeadLagEngine: lagger " + std::string(lagger) + " is not in the universe");
+        if (lag == 0 || lag > max_lag_) throw std::invalid_argument("LeadLagEngine: lag must be in 1.." + std::to_string(max_lag_));
+        return s;
+    }
+
+    // --- Steps ---
+    bool LeadLagEngine::on_bar(const Common::MarketEvent& event) {
+        const size_t id = symbol_id(event.symbol);
+        if (id == size()) return false;
+        double close = 0.0;
+        if (!StepAligner::close_of(event.marketData, close)) return false;
+        return aligner_.on_bar(id, event.timestamp, close, [this] { close_step(); });
+    }
+
+    bool LeadLagEngine::on_slice(const CrossSection& slice) {
+        bool stepped = false;
+        for (Common::SymbolId member : slice.members()) {
+            const size_t id = slice_ids_.map(slice, member, [this](std::string_view symbol) { return symbol_id(symbol); });
+            const double close = slice.close(member);
+            if (id == size() || std::isnan(close)) continue;
+            if (aligner_.on_bar(id, slice.timestamp(), close, [this] { close_step(); })) stepped = true;
+        }
+        return stepped;
+    }
+
+    bool LeadLagEngine::flush() {
+        return aligner_.flush([this] { close_step(); });
+    }
+
+    void LeadLagEngine::close_step() {
+        const size_t n = size();
+        const std::uint64_t t = steps_;
+        double* r = row(t);
+        const auto& close = aligner_.closes();
+        for (size_t j = 0; j < n; ++j) {
+            const bool reported = aligner_.reported(j);
+            r[j] = reported && previous_close_[j] > 1e-9 ? close[j] / previous_close_[j] - 1.0 : 0.0;
+            if (reported) previous_close_[j] = close[j];
+        }
+        ++steps_;
+
+        if (++since_resync_ >= window_ * Common::detail::kResyncWindows) {
+            resync();
+            return;
+        }
+        // Rows before the first step are still zero (the ring is longer than window + max_lag)
+        const double* out = row(t - window_); // Leaves the lag-0 window
+        for (size_t k = 0; k <= max_lag_; ++k) {
+            const double* in_k = row(t - k);
+            const double* out_k = row(t - k - window_);
+            Common::Simd::window_sums(sum_.data() + k * n, sum_sq_.data() + k * n, in_k, out_k, n);
+        }
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t k = 1; k <= max_lag_; ++k) {
+                const double a = row(t - k)[i];           // Leader return paired with r[j]
+                const double b = row(t - k - window_)[i]; // Leader return paired with out[j]
+                if (a == 0.0 && b == 0.0) continue;
+                Common::Simd::window_cross(cross(i, k), a, r, b, out, n);
+            }
+        }
+    }
+
+    void LeadLagEngine::resync() {
+        since_resync_ = 0;
+        const size_t n = size();
+        std::fill(sum_.begin(), sum_.end(), 0.0);
+        std::fill(sum_sq_.begin(), sum_sq_.end(), 0.0);
+        std::fill(cross_.begin(), cross_.end(), 0.0);
+        const std::uint64_t last = steps_ - 1;
+        for (std::uint64_t back = 0; back < window_ && back <= last; ++back) {
+            const std::uint64_t s = last - back;
+            const double* y = row(s);
+            for (size_t k = 0; k <= max_lag_ && k <= s; ++k) {
+                const double* x = row(s - k);
+                double* sum = sum_.data() + k * n;
+                double* sum_sq = sum_sq_.data() + k * n;
+                for (size_t j = 0; j < n; ++j) {
+                    sum[j] += x[j];
+                    sum_sq[j] += x[j] * x[j];
+                }
+                if (k == 0) continue;
+                for (size_t i = 0; i < n; ++i) {
+                    if (x[i] == 0.0) continue;
+                    double* c = cross(i, k);
+                    for (size_t j = 0; j < n; ++j) c[j] += x[i] * y[j];
+                }
+            }
+        }
+    }
+
+    // --- Queries ---
+    double LeadLagEngine::correlation(size_t leader, size_t lagger, size_t lag) const {
+        const size_t n = size();
+        const double w = static_cast<double>(window_);
+        const double sx = sum_[lag * n + leader], qx = sum_sq_[lag * n + leader];
+        const double sy = sum_[lagger], qy = sum_sq_[lagger];
+        const double var_x = qx - sx * sx / w; // Sums of squared deviations
+        const double var_y = qy - sy * sy / w;
+        if (var_x <= 1e-18 || var_y <= 1e-18) return 0.0; // Flat window (spread under 1e-9)
+        const double cov = cross(leader, lag)[lagger] - sx * sy / w;
+        return std::clamp(cov / std::sqrt(var_x * var_y), -1.0, 1.0);
+    }
+
+    double LeadLagEngine::lagged_return(size_t symbol, size_t lag) const {
+        if (steps_ <= lag) return 0.0;
+        return row(steps_ - 1 - lag)[symbol];
+    }
+
+    std::vector<LeadLagEngine::Lead> LeadLagEngine::best_leaders(size_t lagger, size_t count) const {
+        std::vector<Lead> leads;
+        leads.reserve(size() * max_lag_);
+        for (size_t i = 0; i < size(); ++i) {
+            if (i == lagger) continue;
+            for (size_t k = 1; k <= max_lag_; ++k) {
+                if (ready(k)) leads.push_back(Lead{i, k, correlation(i, lagger, k)});
+            }
+        }
+        count = std::min(count, leads.size());
+        std::partial_sort(leads.begin(), leads.begin() + count, leads.end(), [](const Lead& x, const Lead& y) {
+            return std::abs(x.correlation) > std::abs(y.correlation);
+        });
+        leads.resize(count);
+        return leads;
+    }
+
+    // --- Checkpointing ---
+    void LeadLagEngine::serialize(Common::BinaryWriter& writer) const {
+        writer.write(symbols_);
+        writer.write(window_);
+        writer.write(max_lag_);
+        writer.write(steps_);
+        writer.write(since_resync_);
+        writer.write(returns_);
+        writer.write(sum_);
+        writer.write(sum_sq_);
+        writer.write(cross_);
+        aligner_.serialize(writer);
+        writer.write(previous_close_);
+    }
+
+    void LeadLagEngine::deserialize(Common::BinaryReader& reader) {
+        reader.expect(symbols_, "LeadLagEngine universe");
+        reader.expect(window_, "LeadLagEngine window");
+        reader.expect(max_lag_, "LeadLagEngine max lag");
+        reader.read(steps_);
+        reader.read(since_resync_);
+        reader.read(returns_);
+        reader.read(sum_);
+        reader.read(sum_sq_);
+        reader.read(cross_);
+        aligner_.deserialize(reader);
+        reader.read(previous_close_);
+        const size_t n = size();
+        if (returns_.size() != rows_ * n || sum_.size() != (max_lag_ + 1) * n || sum_sq_.size() != sum_.size() ||
+            cross_.size() != n * max_lag_ * n || previous_close_.size() != n) {
+            throw std::runtime_error("LeadLagEngine: corrupt checkpoint (state does not match the universe)");
+        }
+    }
+
+} // namespace Backtester
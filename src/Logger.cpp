@@ -0,0 +1,197 @@
+#include "../include/common/Logger.h" // Self header first
+
+#include "../include/common/Utils.h"  // Allocation-free timestamp formatting
+#include "../include/common/Trace.h"  // Spans for the writer's I/O
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+
+namespace Backtester::Log {
+
+    // Writer-thread state, hidden from the header
+    struct Logger::State {
+        std::mutex mutex;                                  // Guards rings, outputs and flush bookkeeping
+        std::condition_variable work_cv;                   // Wakes the writer (flush requests, full rings)
+        std::condition_variable flushed_cv;                // Signals completed flush requests
+        std::vector<std::shared_ptr<ThreadRing>> rings;    // One per thread that ever logged
+        std::FILE* out = stdout;
+        std::FILE* err = stderr;
+        std::uint64_t flush_requests = 0;
+        std::uint64_t flushes_completed = 0;
+        bool stopping = false;
+        std::thread writer;
+        std::string out_buffer;                            // Writer-thread scratch buffers
+        std::string err_buffer;
+    };
+
+    namespace {
+        // Formats one argument per its placeholder spec (precision < 0 means default)
+        void append_arg(std::string& out, const Arg& arg, int precision) {
+            char buf[64];
+            int length = 0;
+            switch (arg.type) {
+                case Arg::Type::INT:    length = std::snprintf(buf, sizeof(buf), "%lld", arg.i); break;
+                case Arg::Type::UINT:   length = std::snprintf(buf, sizeof(buf), "%llu", arg.u); break;
+                case Arg::Type::BOOL:   length = std::snprintf(buf, sizeof(buf), "%d", arg.b ? 1 : 0); break;
+                case Arg::Type::DOUBLE:
+                    length = (precision >= 0) ? std::snprintf(buf, sizeof(buf), "%.*f", precision, arg.d)
+                                              : std::snprintf(buf, sizeof(buf), "%g", arg.d);
+                    break;
+                case Arg::Type::STRING: out.append(arg.s, arg.length); return;
+                case Arg::Type::TIME: {
+                    auto ticks = std::chrono::system_clock::duration(arg.t);
+                    auto seconds = std::chrono::floor<std::chrono::seconds>(ticks).count();
+                    length = static_cast<int>(Utils::formatTimestampUTC(buf, static_cast<std::int64_t>(seconds)));
+                    break;
+                }
+            }
+            if (length > 0) out.append(buf, std::min<size_t>(static_cast<size_t>(length), sizeof(buf) - 1));
+        }
+
+        // Expands "{}" / "{:.Nf}" placeholders; surplus placeholders print as-is
+        void format_record(std::string& out, const Record& record) {
+            const char* p = record.format;
+            size_t next_arg = 0;
+            while (*p) {
+                if (p[0] == '{' && p[1] == '{') { out.push_back('{'); p += 2; continue; }
+                if (p[0] == '}' && p[1] == '}') { out.push_back('}'); p += 2; continue; }
+                if (p[0] == '{') {
+                    const char* close = p + 1;
+                    while (*close && *close != '}') ++close;
+                    if (*close == '}' && next_arg < record.num_args) {
+                        int precision = -1;
+                        if (close - p > 3 && p[1] == ':' && p[2] == '.') precision = std::atoi(p + 3);
+                        append_arg(out, record.args[next_arg++], precision);
+                        p = close + 1;
+                        continue;
+                    }
+                }
+                out.push_back(*p++);
+            }
+            out.push_back('\n');
+        }
+    } // namespace
+
+    Logger& Logger::instance() {
+        static Logger logger;
+        return logger;
+    }
+
+    Logger::Logger() : state_(std::make_unique<State>()) {
+        state_->writer = std::thread([this]() { writer_loop(); });
+    }
+
+    // Drains everything still queued before the process exits
+    Logger::~Logger() {
+        {
+            std::lock_guard<std::mutex> lock(state_->mutex);
+            state_->stopping = true;
+        }
+        state_->work_cv.notify_one();
+        if (state_->writer.joinable()) state_->writer.join();
+    }
+
+    ThreadRing& Logger::thread_ring() {
+        // The logger keeps a reference too, so lines from exited threads are still written
+        thread_local std::shared_ptr<ThreadRing> ring;
+        if (!ring) {
+            ring = std::make_shared<ThreadRing>();
+            std::lock_guard<std::mutex> lock(state_->mutex);
+            state_->rings.push_back(ring);
+        }
+        return *ring;
+    }
+
+    void Logger::wait_for_space() {
+        state_->work_cv.notify_one();
+        std::this_thread::yield();
+    }
+
+    void Logger::flush() {
+        std::unique_lock<std::mutex> lock(state_->mutex);
+        const std::uint64_t request = ++state_->flush_requests;
+        state_->work_cv.notify_one();
+        state_->flushed_cv.wait(lock, [&]() { return state_->flushes_completed >= request || state_->stopping; });
+    }
+
+    void Logger::set_output(std::FILE* out, std::FILE* err) {
+        flush();
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        state_->out = out;
+        state_->err = err;
+    }
+
+    void Logger::writer_loop() {
+        Trace::set_thread_name("logger");
+        std::vector<std::shared_ptr<ThreadRing>> rings;
+        while (true) {
+            std::uint64_t pending_request = 0;
+            bool stopping = false;
+            std::FILE* out = nullptr;
+            std::FILE* err = nullptr;
+            rings.clear(); // Drop last pass's references before checking use counts
+            {
+                std::lock_guard<std::mutex> lock(state_->mutex);
+                // Forget rings whose thread has exited (we hold the last reference) once drained
+                state_->rings.erase(std::remove_if(state_->rings.begin(), state_->rings.end(),
+                                                   [](const std::shared_ptr<ThreadRing>& ring) {
+                                                       return ring.use_count() == 1 && ring->empty();
+                                                   }),
+                                    state_->rings.end());
+                rings = state_->rings;   // Snapshot; new threads are picked up next pass
+                pending_request = state_->flush_requests;
+                stopping = state_->stopping;
+                out = state_->out;
+                err = state_->err;
+            }
+
+            // Drain every ring, formatting into per-stream buffers
+            const double write_start_us = Trace::is_enabled() ? Trace::now_us() : -1.0;
+            bool wrote_any = false;
+            for (const auto& ring : rings) {
+                while (const Record* record = ring->front()) {
+                    format_record(record->level >= Level::WARN ? state_->err_buffer : state_->out_buffer, *record);
+                    ring->pop();
+                    wrote_any = true;
+                    if (state_->out_buffer.size() > (1u << 16)) {
+                        std::fwrite(state_->out_buffer.data(), 1, state_->out_buffer.size(), out);
+                        state_->out_buffer.clear();
+                    }
+                }
+            }
+            if (!state_->out_buffer.empty()) {
+                std::fwrite(state_->out_buffer.data(), 1, state_->out_buffer.size(), out);
+                state_->out_buffer.clear();
+            }
+            if (!state_->err_buffer.empty()) {
+                std::fwrite(state_->err_buffer.data(), 1, state_->err_buffer.size(), err);
+                state_->err_buffer.clear();
+            }
+            if (wrote_any) {
+                std::fflush(out);
+                std::fflush(err);
+                if (write_start_us >= 0.0) Trace::record("log_write", "io", write_start_us, Trace::now_us());
+                continue; // Keep draining until a pass finds every ring empty
+            }
+
+            // Every ring was empty: all lines logged before 'pending_request' are written
+            std::unique_lock<std::mutex> lock(state_->mutex);
+            if (pending_request > state_->flushes_completed) {
+                state_->flushes_completed = pending_request;
+                state_->flushed_cv.notify_all();
+            }
+            if (stopping) break;
+            if (state_->flush_requests == pending_request) {
+                state_->work_cv.wait_for(lock, std::chrono::milliseconds(1));
+            }
+        }
+    }
+
+} // namespace Backtester::Log
@@ -0,0 +1,126 @@
+#include "../include/backtester/OrderLatencyModel.h" // Self header first
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+namespace Backtester {
+
+    namespace {
+        // splitmix64 finalizer: a well-mixed 64-bit value per input
+        std::uint64_t mix(std::uint64_t x) {
+            x += 0x9E3779B97F4A7C15ULL;
+            x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+            return x ^ (x >> 31);
+        }
+        // Uniform in (0, 1)
+        double unit(std::uint64_t bits) {
+            return (static_cast<double>(bits >> 11) + 0.5) * (1.0 / 9007199254740992.0);
+        }
+
+        std::chrono::nanoseconds parse_duration(const std::string& text) {
+            size_t used = 0;
+            double value = 0.0;
+            try { value = std::stod(text, &used); }
+            catch (const std::exception&) { used = 0; }
+            const std::string unit_suffix = text.substr(used);
+            double scale = 0.0; // Stays 0 for a missing number or an unknown unit
+            if (used == 0) {}
+            else if (unit_suffix == "ns") scale = 1.0;
+            else if (unit_suffix == "us" || unit_suffix.empty()) scale = 1e3;
+            else if (unit_suffix == "ms") scale = 1e6;
+            else if (unit_suffix == "s") scale = 1e9;
+            if (scale == 0.0 || !(value >= 0.0)) {
+                throw std::invalid_argument("LatencyDistribution: bad duration '" + text + "'");
+            }
+            return std::chrono::nanoseconds(static_cast<std::int64_t>(std::llround(value * scale)));
+        }
+    } // namespace
+
+    // --- LatencyDistribution ---
+    LatencyDistribution LatencyDistribution::fixed(std::chrono::nanoseconds delay) {
+        if (delay.count() < 0) throw std::invalid_argument("LatencyDistribution: negative delay");
+        LatencyDistribution d;
+        d.kind = Kind::FIXED;
+        d.a = delay;
+        return d;
+    }
+
+    LatencyDistribution LatencyDistribution::uniform(std::chrono::nanoseconds min, std::chrono::nanoseconds max) {
+        if (min.count() < 0 || max < min) throw std::invalid_argument("LatencyDistribution: uniform needs 0 <= min <= max");
+        LatencyDistribution d;
+        d.kind = Kind::UNIFORM;
+        d.a = min;
+        d.b = max;
+        return d;
+    }
+
+    LatencyDistribution LatencyDistribution::lognormal(std::chrono::nanoseconds median, double sigma) {
+        if (median.count() <= 0 || !(sigma >= 0.0)) throw std::invalid_argument("LatencyDistribution: lognormal needs median > 0, sigma >= 0");
+        LatencyDistribution d;
+        d.kind = Kind::LOGNORMAL;
+        d.a = median;
+        d.sigma = sigma;
+        return d;
+    }
+
+    LatencyDistribution LatencyDistribution::parse(const std::string& spec) {
+        std::vector<std::string> parts;
+        size_t start = 0;
+        while (true) {
+            size_t colon = spec.find(':', start);
+            parts.push_back(spec.substr(start, colon - start));
+            if (colon == std::string::npos) break;
+            start = colon + 1;
+        }
+        const std::string& kind = parts[0];
+        if (kind == "none" && parts.size() == 1) return none();
+        if (kind == "fixed" && parts.size() == 2) return fixed(parse_duration(parts[1]));
+        if (kind == "uniform" && parts.size() == 3) return uniform(parse_duration(parts[1]), parse_duration(parts[2]));
+        if (kind == "lognormal" && parts.size() == 3) {
+            double sigma = 0.0;
+            try { sigma = std::stod(parts[2]); }
+            catch (const std::exception&) { throw std::invalid_argument("LatencyDistribution: bad sigma '" + parts[2] + "'"); }
+            return lognormal(parse_duration(parts[1]), sigma);
+        }
+        throw std::invalid_argument("LatencyDistribution: expected none, fixed:DUR, uniform:DUR:DUR or lognormal:DUR:SIGMA, got '" + spec + "'");
+    }
+
+    // --- OrderLatencyModel ---
+    bool OrderLatencyModel::enabled() const {
+        if (default_.kind != LatencyDistribution::Kind::NONE) return true;
+        return std::any_of(per_symbol_.begin(), per_symbol_.end(),
+                           [](const auto& entry) { return entry.second.kind != LatencyDistribution::Kind::NONE; });
+    }
+
+    std::chrono::nanoseconds OrderLatencyModel::sample(const std::string& symbol, std::uint64_t draw) const {
+        const LatencyDistribution* d = &default_;
+        if (!per_symbol_.empty()) {
+            auto it = per_symbol_.find(symbol);
+            if (it != per_symbol_.end()) d = &it->second;
+        }
+        const std::uint64_t bits = mix(seed_ ^ mix(draw));
+        switch (d->kind) {
+            case LatencyDistribution::Kind::NONE:
+                return std::chrono::nanoseconds(0);
+            case LatencyDistribution::Kind::FIXED:
+                return d->a;
+            case LatencyDistribution::Kind::UNIFORM: {
+                const double span = static_cast<double>((d->b - d->a).count());
+                return d->a + std::chrono::nanoseconds(static_cast<std::int64_t>(unit(bits) * span));
+            }
+            case LatencyDistribution::Kind::LOGNORMAL: {
+                // Box-Muller from two independent uniforms
+                const double u1 = unit(bits);
+                const double u2 = unit(mix(bits));
+                const double z = std::sqrt(-2.0 * std::log(u1)) * std::cos(6.283185307179586 * u2);
+                const double ns = static_cast<double>(d->a.count()) * std::exp(d->sigma * z);
+                return std::chrono::nanoseconds(static_cast<std::int64_t>(std::min(ns, 9.0e18)));
+            }
+        }
+        return std::chrono::nanoseconds(0);
+    }
+
+} // namespace Backtester
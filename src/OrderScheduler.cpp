@@ -0,0 +1,217 @@
+#include "../include/backtester/OrderScheduler.h" // Self header first
+
+#include <algorithm>
+
+namespace Backtester {
+
+    namespace {
+        std::int64_t to_ns(std::chrono::system_clock::time_point timestamp) {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(timestamp.time_since_epoch()).count();
+        }
+
+        void write_order(Common::BinaryWriter& writer, const Common::OrderRequest& order) {
+            writer.write(order.order_id);
+            writer.write(order.timestamp);
+            writer.write(order.symbol);
+            writer.write(order.order_type);
+            writer.write(order.direction);
+            writer.write(order.quantity);
+            writer.write(order.limit_price);
+            writer.write(order.stop_price);
+        }
+        Common::OrderRequest read_order(Common::BinaryReader& reader) {
+            auto id = reader.read<long long>();
+            auto timestamp = reader.read<std::chrono::system_clock::time_point>();
+            auto symbol = reader.read<std::string>();
+            auto type = reader.read<Common::OrderType>();
+            auto direction = reader.read<Common::OrderDirection>();
+            auto quantity = reader.read<double>();
+            auto limit = reader.read<std::optional<double>>();
+            auto stop = reader.read<std::optional<double>>();
+            return Common::OrderRequest(id, timestamp, std::move(symbol), type, direction, quantity, limit, stop);
+        }
+    } // namespace
+
+    OrderScheduler::OrderScheduler(std::pmr::memory_resource* resource)
+        : heap_(resource), slots_(resource), slot_live_(resource), free_slots_(resource), by_id_(resource), due_(resource) {}
+
+    std::uint32_t OrderScheduler::acquire_slot(const Common::OrderRequest& order) {
+        std::uint32_t slot;
+        if (!free_slots_.empty()) {
+            slot = free_slots_.back();
+            free_slots_.pop_back();
+            slots_[slot] = order; // Reuses the slot's symbol capacity
+        } else {
+            slot = static_cast<std::uint32_t>(slots_.size());
+            slots_.push_back(order);
+            slot_live_.push_back(0);
+        }
+        slot_live_[slot] = 1;
+        by_id_[order.order_id] = slot;
+        live_++;
+        return slot;
+    }
+
+    void OrderScheduler::free_slot(std::uint32_t slot) {
+        if (slot_live_[slot]) {
+            by_id_.erase(slots_[slot].order_id);
+            slot_live_[slot] = 0;
+            live_--;
+        }
+        free_slots_.push_back(slot);
+    }
+
+    // --- 4-ary heap ---
+    void OrderScheduler::push(std::int64_t arrival_ns, std::uint64_t sequence, std::uint32_t slot) {
+        const HeapEntry entry{arrival_ns, sequence, slot};
+        size_t i = heap_.size();
+        heap_.push_back(entry);
+        while (i > 0) {
+            const size_t parent = (i - 1) / 4;
+            if (!earlier(entry, heap_[parent])) break;
+            heap_[i] = heap_[parent];
+            i = parent;
+        }
+        heap_[i] = entry;
+    }
+
+    void OrderScheduler::pop() {
+        const HeapEntry last = heap_.back();
+        heap_.pop_back();
+        const size_t n = heap_.size();
+        if (n == 0) return;
+        size_t i = 0;
+        while (true) {
+            const size_t first = 4 * i + 1;
+            if (first >= n) break;
+            size_t best = first;
+            const size_t end = std::min(first + 4, n);
+            for (size_t c = first + 1; c < end; ++c) {
+                if (earlier(heap_[c], heap_[best])) best = c;
+            }
+            if (!earlier(heap_[best], last)) break;
+            heap_[i] = heap_[best];
+            i = best;
+        }
+        heap_[i] = last;
+    }
+
+    void OrderScheduler::schedule(const Common::OrderRequest& order, std::chrono::system_clock::time_point arrival) {
+        push(to_ns(arrival), ++sequence_, acquire_slot(order));
+    }
+
+    void OrderScheduler::release_slow(const std::string& symbol, std::chrono::system_clock::time_point now,
+                                      std::pmr::vector<Common::OrderRequest>& out) {
+        // Orders for 'symbol' that arrived before now go first...
+        if (due_count_ > 0) {
+            auto it = due_.find(symbol);
+            if (it != due_.end() && !it->second.empty()) {
+                for (std::uint32_t slot : it->second) {
+                    if (slot_live_[slot]) out.push_back(slots_[slot]);
+                    free_slot(slot);
+                }
+                due_count_ -= it->second.size();
+                it->second.clear();
+            }
+        }
+        // ...then those arriving by now, in arrival order; other symbols' wait for their bars
+        const std::int64_t now_ns = to_ns(now);
+        while (!heap_.empty() && heap_.front().arrival_ns <= now_ns) {
+            const std::uint32_t slot = heap_.front().slot;
+            pop();
+            if (!slot_live_[slot]) { free_slot(slot); continue; } // Cancelled in flight
+            if (slots_[slot].symbol == symbol) {
+                out.push_back(slots_[slot]);
+                free_slot(slot);
+                continue;
+            }
+            due_[slots_[slot].symbol].push_back(slot);
+            due_count_++;
+        }
+    }
+
+    bool OrderScheduler::cancel(long long order_id) {
+        auto found = by_id_.find(order_id);
+        if (found == by_id_.end()) return false;
+        // The heap or due entry stays behind and frees the slot when it is reached
+        slot_live_[found->second] = 0;
+        by_id_.erase(found);
+        live_--;
+        return true;
+    }
+
+    bool OrderScheduler::replace(long long order_id, double new_price, double new_quantity) {
+        auto found = by_id_.find(order_id);
+        if (found == by_id_.end()) return false;
+        Common::OrderRequest& order = slots_[found->second];
+        if (new_quantity <= 1e-9) return cancel(order_id);
+        order.quantity = new_quantity;
+        if (order.order_type == Common::OrderType::LIMIT) order.limit_price = new_price;
+        else if (order.order_type == Common::OrderType::STOP) order.stop_price = new_price;
+        return true;
+    }
+
+    void OrderScheduler::clear() {
+        heap_.clear();
+        slots_.clear();
+        slot_live_.clear();
+        free_slots_.clear();
+        by_id_.clear();
+        due_.clear();
+        due_count_ = 0;
+        live_ = 0;
+        sequence_ = 0;
+    }
+
+    // --- Checkpointing ---
+    // Only live orders are saved: in-flight ones with their heap keys, then the due queues
+    void OrderScheduler::serialize(Common::BinaryWriter& writer) const {
+        writer.write(sequence_);
+        std::vector<HeapEntry> in_flight;
+        for (const HeapEntry& entry : heap_) {
+            if (slot_live_[entry.slot]) in_flight.push_back(entry);
+        }
+        writer.write(static_cast<std::uint64_t>(in_flight.size()));
+        for (const HeapEntry& entry : in_flight) {
+            writer.write(entry.arrival_ns);
+            writer.write(entry.sequence);
+            write_order(writer, slots_[entry.slot]);
+        }
+        std::uint64_t symbols = 0;
+        for (const auto& [symbol, slots] : due_) {
+            if (!slots.empty()) symbols++;
+        }
+        writer.write(symbols);
+        for (const auto& [symbol, slots] : due_) {
+            if (slots.empty()) continue;
+            writer.write(symbol);
+            const auto live = static_cast<std::uint64_t>(std::count_if(slots.begin(), slots.end(),
+                                                                       [&](std::uint32_t slot) { return slot_live_[slot] != 0; }));
+            writer.write(live);
+            for (std::uint32_t slot : slots) {
+                if (slot_live_[slot]) write_order(writer, slots_[slot]);
+            }
+        }
+    }
+
+    void OrderScheduler::deserialize(Common::BinaryReader& reader) {
+        clear();
+        reader.read(sequence_);
+        auto in_flight = reader.read<std::uint64_t>();
+        for (std::uint64_t i = 0; i < in_flight; ++i) {
+            auto arrival_ns = reader.read<std::int64_t>();
+            auto sequence = reader.read<std::uint64_t>();
+            push(arrival_ns, sequence, acquire_slot(read_order(reader)));
+        }
+        auto symbols = reader.read<std::uint64_t>();
+        for (std::uint64_t s = 0; s < symbols; ++s) {
+            auto& queue = due_[reader.read<std::string>()];
+            auto count = reader.read<std::uint64_t>();
+            for (std::uint64_t i = 0; i < count; ++i) {
+                queue.push_back(acquire_slot(read_order(reader)));
+                due_count_++;
+            }
+        }
+    }
+
+} // namespace Backtester
@@ -0,0 +1,289 @@
+#include "../include/backtester/PairScreener.h" // Self header first
+
+#include "../include/backtester/StepAligner.h"
+#include "../include/common/RollingStats.h" // detail::kResyncWindows
+#include "../include/common/RunArena.h"     // SymbolMap
+#include "../include/common/SimdKernels.h"
+#include "../include/common/ThreadPool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <set>
+#include <stdexcept>
+#include <tuple>
+
+namespace Backtester {
+
+    namespace {
+        constexpr size_t kGramRowBlock = 8;     // Symbol rows per moment-matrix task
+        constexpr size_t kTileDoubles = 16384;  // Panel rows per time tile: ~128 KB of panel
+        constexpr size_t kMinTaskPairs = 256;   // Rolling-sweep pairs per task
+
+        // The Engle-Granger statistics of regressing symbol y on symbol x
+        struct Regression {
+            double slope = 0.0;
+            double adf = std::numeric_limits<double>::infinity(); // +inf when undefined
+            double gamma = 0.0; // Residual reversion per step
+        };
+    }
+
+    PairScreener::PairScreener(PairScreenConfig config) : config_(config) {
+        if (config_.hedge_window < 2) throw std::invalid_argument("PairScreener: hedge_window must be at least 2");
+    }
+
+    // --- Panel ---
+    void PairScreener::load(const std::vector<Common::MarketEvent>& events) {
+        std::set<std::string> names;
+        for (const auto& event : events) names.insert(event.symbol);
+        symbols_.assign(names.begin(), names.end());
+        log_prices_.clear();
+        means_.assign(symbols_.size(), 0.0);
+        steps_ = 0;
+        if (symbols_.empty()) return;
+
+        Common::SymbolMap<size_t> ids;
+        for (size_t id = 0; id < symbols_.size(); ++id) ids.emplace(symbols_[id], id);
+        const size_t n = symbols_.size();
+        StepAligner aligner(n);
+        bool started = false;
+        auto close_step = [&] {
+            const auto& close = aligner.closes();
+            if (!started) {
+                started = std::all_of(close.begin(), close.end(), [](double c) { return c > 1e-9; });
+                if (!started) return;
+            }
+            const size_t at = log_prices_.size();
+            log_prices_.resize(at + n);
+            for (size_t j = 0; j < n; ++j) {
+                // A bad close keeps the symbol's last log price
+                log_prices_[at + j] = close[j] > 1e-9 ? std::log(close[j]) : log_prices_[at + j - n];
+            }
+            ++steps_;
+        };
+        for (const auto& event : events) {
+            double close = 0.0;
+            if (!StepAligner::close_of(event.marketData, close)) continue;
+            aligner.on_bar(*Common::find_symbol(ids, event.symbol), event.timestamp, close, close_step);
+        }
+        aligner.flush(close_step);
+
+        // Demeaned levels keep the moment sums well conditioned
+        for (size_t t = 0; t < steps_; ++t) {
+            for (size_t j = 0; j < n; ++j) means_[j] += log_prices_[t * n + j];
+        }
+        for (size_t j = 0; j < n; ++j) means_[j] /= static_cast<double>(std::max<size_t>(steps_, 1));
+        for (size_t t = 0; t < steps_; ++t) {
+            for (size_t j = 0; j < n; ++j) log_prices_[t * n + j] -= means_[j];
+        }
+    }
+
+    // --- Screen ---
+    std::vector<PairCandidate> PairScreener::screen() const {
+        const size_t n = symbols_.size();
+        const size_t steps = steps_;
+        const size_t window = config_.hedge_window;
+        if (n < 2) return {};
+        if (steps <= window + 1) {
+            throw std::runtime_error("PairScreener: " + std::to_string(steps) + " aligned steps, need more than hedge_window + 1");
+        }
+        Common::ThreadPool pool(config_.threads);
+        const double* x = log_prices_.data();
+
+        // --- Moment matrices ---
+        // levels[i][j] = sum_t x_i,t x_j,t; lagged[i][j] = sum_t x_i,t-1 dx_j,t;
+        // diffs[i][j] = sum_t dx_i,t dx_j,t
+        std::vector<double> levels(n * n, 0.0), lagged(n * n, 0.0), diffs(n * n, 0.0);
+        const size_t tile = std::max<size_t>(16, kTileDoubles / n);
+        pool.parallel_for((n + kGramRowBlock - 1) / kGramRowBlock, [&](size_t task) {
+            const size_t i0 = task * kGramRowBlock, i1 = std::min(n, i0 + kGramRowBlock);
+            for (size_t t0 = 0; t0 < steps; t0 += tile) {
+                const size_t t1 = std::min(steps, t0 + tile);
+                for (size_t i = i0; i < i1; ++i) {
+                    double* c = levels.data() + i * n;
+                    double* l = lagged.data() + i * n;
+                    double* d = diffs.data() + i * n;
+                    for (size_t t = t0; t < t1; ++t) {
+                        const double* row = x + t * n;
+                        const double xi = row[i];
+                        for (size_t j = 0; j < n; ++j) c[j] += xi * row[j];
+                        if (t == 0) continue;
+                        const double* prev = row - n;
+                        const double li = prev[i], di = row[i] - prev[i];
+                        for (size_t j = 0; j < n; ++j) {
+                            const double dj = row[j] - prev[j];
+                            l[j] += li * dj;
+                            d[j] += di * dj;
+                        }
+                    }
+                }
+            }
+        });
+
+        // Regression of y on x (demeaned, so no intercept) and the Dickey-Fuller regression
+        // de_t = gamma * e_t-1 of its residual, all as quadratic forms in the moments. The
+        // lagged level sums drop the last step: levels minus its outer product.
+        const double* last = x + (steps - 1) * n;
+        auto regress = [&](size_t y, size_t xs) {
+            Regression r;
+            const double var_x = levels[xs * n + xs];
+            if (var_x <= 1e-18) return r;
+            const double b = levels[y * n + xs] / var_x;
+            r.slope = b;
+            auto lag_level = [&](size_t i, size_t j) { return levels[i * n + j] - last[i] * last[j]; };
+            const double see = lag_level(y, y) - 2.0 * b * lag_level(y, xs) + b * b * lag_level(xs, xs);
+            const double sed = lagged[y * n + y] - b * (lagged[y * n + xs] + lagged[xs * n + y]) + b * b * lagged[xs * n + xs];
+            const double sdd = diffs[y * n + y] - 2.0 * b * diffs[y * n + xs] + b * b * diffs[xs * n + xs];
+            if (see <= 1e-18) return r; // Residual is flat
+            r.gamma = sed / see;
+            const double ssr = sdd - r.gamma * sed;
+            const double dof = static_cast<double>(steps - 2); // steps - 1 differences, one parameter
+            if (ssr <= 0.0) return r;
+            r.adf = r.gamma / std::sqrt(ssr / dof / see);
+            return r;
+        };
+
+        // --- Rolling hedge ratios ---
+        // Per-symbol window sums and sums of squares, then per pair the windowed cross sum;
+        // both are re-derived from the panel every kResyncWindows windows
+        const size_t rolled = steps - window + 1; // Steps with a full window
+        std::vector<double> sum(rolled * n), sum_sq(rolled * n);
+        {
+            std::vector<double> s(n, 0.0), q(n, 0.0), zeros(n, 0.0);
+            std::uint64_t since_resync = 0;
+            for (size_t t = 0; t < steps; ++t) {
+                const double* in = x + t * n;
+                if (t >= window && ++since_resync >= window * Common::detail::kResyncWindows) {
+                    since_resync = 0;
+                    std::fill(s.begin(), s.end(), 0.0);
+                    std::fill(q.begin(), q.end(), 0.0);
+                    for (size_t u = t + 1 - window; u <= t; ++u) {
+                        for (size_t j = 0; j < n; ++j) {
+                            s[j] += x[u * n + j];
+                            q[j] += x[u * n + j] * x[u * n + j];
+                        }
+                    }
+                } else {
+                    // Zeros leave the window while it fills
+                    Common::Simd::window_sums(s.data(), q.data(), in, t >= window ? in - window * n : zeros.data(), n);
+                }
+                if (t + 1 >= window) {
+                    std::copy(s.begin(), s.end(), sum.begin() + (t + 1 - window) * n);
+                    std::copy(q.begin(), q.end(), sum_sq.begin() + (t + 1 - window) * n);
+                }
+            }
+        }
+
+        // Pairs (a, b), a < b, packed row by row; per pair the last rolling slope and the
+        // Welford mean / M2 of it over the sample, in both regression directions
+        std::vector<size_t> row_offset(n);
+        for (size_t a = 0, offset = 0; a < n; offset += n - a - 1, ++a) row_offset[a] = offset;
+        const size_t pairs = n * (n - 1) / 2;
+        std::vector<double> last_ab(pairs), mean_ab(pairs, 0.0), m2_ab(pairs, 0.0);  // a on b
+        std::vector<double> last_ba(pairs), mean_ba(pairs, 0.0), m2_ba(pairs, 0.0);  // b on a
+
+        std::vector<size_t> block_rows{0};
+        const size_t target = std::max(kMinTaskPairs, pairs / (pool.size() * 4) + 1);
+        for (size_t a = 0, in_block = 0; a < n; ++a) {
+            in_block += n - a - 1;
+            if (in_block >= target && a + 1 < n) {
+                block_rows.push_back(a + 1);
+                in_block = 0;
+            }
+        }
+        block_rows.push_back(n);
+
+        const double inv_w = 1.0 / static_cast<double>(window);
+        pool.parallel_for(block_rows.size() - 1, [&](size_t block) {
+            std::vector<double> cross;
+            for (size_t a = block_rows[block]; a < block_rows[block + 1]; ++a) {
+                const size_t m = n - a - 1;
+                const size_t p0 = row_offset[a];
+                cross.assign(m, 0.0);
+                std::uint64_t since_resync = 0;
+                for (size_t t = 0; t < steps; ++t) {
+                    const double* in = x + t * n;
+                    const double* in_b = in + a + 1;
+                    if (t >= window && ++since_resync >= window * Common::detail::kResyncWindows) {
+                        since_resync = 0;
+                        std::fill(cross.begin(), cross.end(), 0.0);
+                        for (size_t u = t + 1 - window; u <= t; ++u) {
+                            const double* row = x + u * n;
+                            for (size_t k = 0; k < m; ++k) cross[k] += row[a] * row[a + 1 + k];
+                        }
+                    } else if (t >= window) {
+                        const double* out = in - window * n;
+                        const double* out_b = out + a + 1;
+                        Common::Simd::window_cross(cross.data(), in[a], in_b, out[a], out_b, m);
+                    } else {
+                        const double xa = in[a];
+                        for (size_t k = 0; k < m; ++k) cross[k] += xa * in_b[k];
+                    }
+                    if (t + 1 < window) continue;
+
+                    const size_t r = t + 1 - window;
+                    const double* s = sum.data() + r * n;
+                    const double* q = sum_sq.data() + r * n;
+                    const double sa = s[a];
+                    const double va = q[a] - sa * sa * inv_w;
+                    const double inv_va = va > 1e-18 ? 1.0 / va : 0.0;
+                    const double inv_count = 1.0 / static_cast<double>(r + 1);
+                    const double* sb = s + a + 1;
+                    const double* qb = q + a + 1;
+                    double* lab = last_ab.data() + p0; double* mab = mean_ab.data() + p0; double* vab = m2_ab.data() + p0;
+                    double* lba = last_ba.data() + p0; double* mba = mean_ba.data() + p0; double* vba = m2_ba.data() + p0;
+                    for (size_t k = 0; k < m; ++k) {
+                        const double cov = cross[k] - sa * sb[k] * inv_w;
+                        const double vb = qb[k] - sb[k] * sb[k] * inv_w;
+                        const double ab = vb > 1e-18 ? cov / vb : 0.0; // Flat window: no slope
+                        const double ba = cov * inv_va;
+                        lab[k] = ab;
+                        lba[k] = ba;
+                        const double dab = ab - mab[k];
+                        mab[k] += dab * inv_count;
+                        vab[k] += dab * (ab - mab[k]);
+                        const double dba = ba - mba[k];
+                        mba[k] += dba * inv_count;
+                        vba[k] += dba * (ba - mba[k]);
+                    }
+                }
+            }
+        });
+
+        // --- Candidates ---
+        std::vector<PairCandidate> ranked;
+        const double dof = static_cast<double>(rolled - 1);
+        for (size_t a = 0; a < n; ++a) {
+            for (size_t b = a + 1; b < n; ++b) {
+                const size_t p = row_offset[a] + (b - a - 1);
+                const Regression ab = regress(a, b), ba = regress(b, a);
+                const bool forward = ab.adf <= ba.adf;
+                const Regression& best = forward ? ab : ba;
+                if (!(best.adf <= config_.max_adf_statistic)) continue;
+                double half_life = std::numeric_limits<double>::infinity();
+                if (best.gamma <= -1.0) half_life = 0.0; // Overshoots within a step
+                else if (best.gamma < 0.0) half_life = -std::log(2.0) / std::log1p(best.gamma);
+                if (config_.max_half_life > 0.0 && !(half_life <= config_.max_half_life)) continue;
+
+                PairCandidate c;
+                const size_t y = forward ? a : b, xs = forward ? b : a;
+                c.symbol_a = symbols_[y];
+                c.symbol_b = symbols_[xs];
+                c.hedge_ratio = best.slope;
+                c.intercept = means_[y] - best.slope * means_[xs];
+                c.adf_statistic = best.adf;
+                c.half_life = half_life;
+                c.rolling_hedge_ratio = forward ? last_ab[p] : last_ba[p];
+                c.hedge_ratio_stddev = dof > 0.0 ? std::sqrt(std::max(0.0, (forward ? m2_ab[p] : m2_ba[p]) / dof)) : 0.0;
+                c.observations = steps;
+                ranked.push_back(std::move(c));
+            }
+        }
+        std::sort(ranked.begin(), ranked.end(), [](const PairCandidate& l, const PairCandidate& r) {
+            if (l.adf_statistic != r.adf_statistic) return l.adf_statistic < r.adf_statistic;
+            return std::tie(l.symbol_a, l.symbol_b) < std::tie(r.symbol_a, r.symbol_b);
+        });
+        return ranked;
+    }
+
+} // namespace Backtester
@@ -0,0 +1,284 @@
+#include "../include/backtester/PairsEngine.h" // Self header first
+
+#include "../include/common/RollingStats.h" // detail::kResyncWindows
+#include "../include/common/SimdKernels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace Backtester {
+
+    namespace {
+        // Fewer pairs than this per block and handing the block to another thread costs more
+        // than updating it
+        constexpr size_t kMinBlockPairs = 4096;
+    }
+
+    PairsEngine::PairsEngine(std::vector<std::string> universe, size_t lookback, double entry_z, double exit_z,
+                             unsigned threads, std::pmr::memory_resource* resource)
+        : symbols_(std::move(universe)), ids_(resource), lookback_(lookback), entry_z_(entry_z), exit_z_(exit_z),
+          aligner_(std::max<size_t>(symbols_.size(), 1), resource), slice_ids_(resource), log_prices_(resource), mean_(resource),
+          m2_(resource), state_(resource), selected_(resource) {
+        if (symbols_.size() < 2) throw std::invalid_argument("PairsEngine: the universe needs at least two symbols");
+        if (lookback_ < 2) throw std::invalid_argument("PairsEngine: lookback must be at least 2");
+        for (size_t id = 0; id < symbols_.size(); ++id) {
+            if (!ids_.emplace(symbols_[id], id).second) {
+                throw std::invalid_argument("PairsEngine: duplicate symbol " + symbols_[id]);
+            }
+        }
+        rows_ = 1;
+        while (rows_ <= lookback_) rows_ <<= 1;
+
+        const size_t n = symbols_.size();
+        row_offset_.resize(n);
+        for (size_t a = 0, offset = 0; a < n; offset += n - a - 1, ++a) row_offset_[a] = offset;
+        const size_t pairs = n * (n - 1) / 2;
+        selected_.assign(pairs, 0);
+
+        if (threads != 1) {
+            pool_ = std::make_unique<Common::ThreadPool>(threads);
+            if (pool_->size() == 1) pool_.reset();
+        }
+        // Row blocks of roughly equal pair counts, a few per thread so uneven rows even out
+        size_t target = pairs;
+        if (pool_) target = std::max(kMinBlockPairs, (pairs + pool_->size() * 4 - 1) / (pool_->size() * 4));
+        block_rows_.push_back(0);
+        for (size_t a = 0, in_block = 0; a < n; ++a) {
+            in_block += n - a - 1;
+            if (in_block >= target && a + 1 < n) {
+                block_rows_.push_back(a + 1);
+                in_block = 0;
+            }
+        }
+        block_rows_.push_back(n);
+        block_crossings_.resize(block_rows_.size() - 1);
+        reset();
+    }
+
+    void PairsEngine::reset() {
+        const size_t pairs = selected_.size();
+        log_prices_.assign(rows_ * symbols_.size(), 0.0);
+        mean_.assign(pairs, 0.0);
+        m2_.assign(pairs, 0.0);
+        state_.assign(pairs, static_cast<std::uint8_t>(PairState::FLAT));
+        aligner_.reset();
+        for (auto& block : block_crossings_) block.clear();
+        crossings_.clear();
+        filled_ = 0;
+        since_resync_ = 0;
+    }
+
+    size_t PairsEngine::symbol_id(std::string_view symbol) const {
+        const size_t* id = Common::find_symbol(ids_, symbol);
+        return id ? *id : symbols_.size();
+    }
+
+    // --- Pairs ---
+    size_t PairsEngine::pair_index(size_t a, size_t b) const {
+        if (a == b || a >= size() || b >= size()) throw std::invalid_argument("PairsEngine: invalid pair");
+        if (a > b) std::swap(a, b);
+        return row_offset_[a] + (b - a - 1);
+    }
+
+    std::pair<size_t, size_t> PairsEngine::pair_symbols(size_t pair) const {
+        if (pair >= pairs()) throw std::out_of_range("PairsEngine: pair index out of range");
+        const size_t a = static_cast<size_t>(std::upper_bound(row_offset_.begin(), row_offset_.end(), pair) - row_offset_.begin()) - 1;
+        return {a, a + 1 + (pair - row_offset_[a])};
+    }
+
+    void PairsEngine::select(size_t pair) {
+        if (pair >= pairs()) throw std::out_of_range("PairsEngine: pair index out of range");
+        selected_[pair] = 1;
+    }
+
+    void PairsEngine::select_all() {
+        std::fill(selected_.begin(), selected_.end(), 1);
+    }
+
+    // --- Steps ---
+    bool PairsEngine::on_bar(const Common::MarketEvent& event) {
+        const size_t id = symbol_id(event.symbol);
+        if (id == size()) return false;
+        double close = 0.0;
+        if (!StepAligner::close_of(event.marketData, close)) return false;
+        return aligner_.on_bar(id, event.timestamp, close, [this] { close_step(); });
+    }
+
+    bool PairsEngine::on_slice(const CrossSection& slice) {
+        bool stepped = false;
+        for (Common::SymbolId member : slice.members()) {
+            const size_t id = slice_ids_.map(slice, member, [this](std::string_view symbol) { return symbol_id(symbol); });
+            const double close = slice.close(member);
+            if (id == size() || std::isnan(close)) continue;
+            if (aligner_.on_bar(id, slice.timestamp(), close, [this] { close_step(); })) stepped = true;
+        }
+        return stepped;
+    }
+
+    bool PairsEngine::flush() {
+        return aligner_.flush([this] { close_step(); });
+    }
+
+    void PairsEngine::close_step() {
+        crossings_.clear();
+        const size_t n = size();
+        const auto& close = aligner_.closes();
+        if (filled_ == 0) { // Statistics start once every symbol has a close
+            for (size_t j = 0; j < n; ++j) {
+                if (close[j] <= 1e-9) return;
+            }
+        }
+        double* r = row(filled_);
+        const double* previous = filled_ > 0 ? row(filled_ - 1) : nullptr;
+        for (size_t j = 0; j < n; ++j) r[j] = close[j] > 1e-9 ? std::log(close[j]) : previous[j]; // Bad close: keep the last
+        ++filled_;
+
+        const bool resync = ++since_resync_ >= lookback_ * Common::detail::kResyncWindows;
+        if (resync) since_resync_ = 0;
+        for_each_block(resync);
+        for (auto& block : block_crossings_) { // Block order is pair order
+            crossings_.insert(crossings_.end(), block.begin(), block.end());
+            block.clear();
+        }
+    }
+
+    void PairsEngine::for_each_block(bool resync) {
+        const size_t blocks = block_rows_.size() - 1;
+        if (!pool_ || blocks == 1) {
+            for (size_t b = 0; b < blocks; ++b) update_block(b, resync);
+            return;
+        }
+        pool_->parallel_for(blocks, [this, resync](size_t b) { update_block(b, resync); });
+    }
+
+    void PairsEngine::update_block(size_t block, bool resync) {
+        const size_t n = size();
+        const std::uint64_t last = filled_ - 1;
+        const double* in = row(last);
+        const bool evict = filled_ > lookback_;
+        const double* out = evict ? row(last - lookback_) : nullptr; // Leaves the window
+        const std::uint64_t count = std::min<std::uint64_t>(filled_, lookback_);
+        const std::uint64_t first = filled_ - count;
+
+        for (size_t a = block_rows_[block]; a < block_rows_[block + 1]; ++a) {
+            const size_t m = n - a - 1; // Pairs (a, a+1..n-1)
+            double* mean = mean_.data() + row_offset_[a];
+            double* m2 = m2_.data() + row_offset_[a];
+            if (resync) {
+                std::fill(mean, mean + m, 0.0);
+                std::fill(m2, m2 + m, 0.0);
+                for (std::uint64_t t = first; t <= last; ++t) {
+                    const double* x = row(t);
+                    for (size_t k = 0; k < m; ++k) mean[k] += x[a] - x[a + 1 + k];
+                }
+                const double inv = 1.0 / static_cast<double>(count);
+                for (size_t k = 0; k < m; ++k) mean[k] *= inv;
+                for (std::uint64_t t = first; t <= last; ++t) {
+                    const double* x = row(t);
+                    for (size_t k = 0; k < m; ++k) {
+                        const double d = x[a] - x[a + 1 + k] - mean[k];
+                        m2[k] += d * d;
+                    }
+                }
+            } else if (evict) {
+                // Windowed Welford replace of the spread leaving by the one entering
+                Common::Simd::spread_window_replace(mean, m2, in[a], in + a + 1, out[a], out + a + 1,
+                                                    1.0 / static_cast<double>(lookback_), m);
+            } else {
+                // Filling the window: Welford add
+                Common::Simd::spread_window_add(mean, m2, in[a], in + a + 1, 1.0 / static_cast<double>(count), m);
+            }
+        }
+
+        if (!ready()) return;
+        // --- Crossings (the PairsTrading state machine) ---
+        auto& crossings = block_crossings_[block];
+        const double inv_dof = 1.0 / static_cast<double>(lookback_ - 1);
+        const double entry_sq = entry_z_ * entry_z_;
+        for (size_t a = block_rows_[block]; a < block_rows_[block + 1]; ++a) {
+            const size_t begin = row_offset_[a];
+            for (size_t k = 0; k < n - a - 1; ++k) {
+                const size_t p = begin + k;
+                if (!selected_[p]) continue;
+                const double var = m2_[p] * inv_dof;
+                if (var < 1e-18) continue; // Flat spread (stddev under 1e-9)
+                const double d = in[a] - in[a + 1 + k] - mean_[p];
+                const auto current = static_cast<PairState>(state_[p]);
+                // Most pairs are flat and inside the entry band: settle those without sqrt/div
+                if (current == PairState::FLAT && entry_z_ >= 0.0 && d * d <= entry_sq * var) continue;
+                const double z = d / std::sqrt(var);
+                PairState desired = current;
+                if (current == PairState::FLAT) {
+                    if (z > entry_z_) desired = PairState::SHORT_A_LONG_B;
+                    else if (z < -entry_z_) desired = PairState::LONG_A_SHORT_B;
+                } else if (current == PairState::SHORT_A_LONG_B && z < exit_z_) {
+                    desired = PairState::FLAT;
+                } else if (current == PairState::LONG_A_SHORT_B && z > -exit_z_) {
+                    desired = PairState::FLAT;
+                }
+                if (desired == current) continue;
+                state_[p] = static_cast<std::uint8_t>(desired);
+                crossings.push_back(Crossing{p, current, desired, z});
+            }
+        }
+    }
+
+    // --- Queries ---
+    double PairsEngine::stddev(size_t pair) const {
+        const std::uint64_t count = std::min<std::uint64_t>(filled_, lookback_);
+        if (count < 2) return 0.0;
+        return std::sqrt(m2_[pair] / static_cast<double>(count - 1));
+    }
+
+    double PairsEngine::spread(size_t pair) const {
+        if (filled_ == 0) return 0.0;
+        const auto [a, b] = pair_symbols(pair);
+        const double* x = row(filled_ - 1);
+        return x[a] - x[b];
+    }
+
+    double PairsEngine::zscore(size_t pair) const {
+        const double sd = stddev(pair);
+        if (sd < 1e-9) return 0.0;
+        return (spread(pair) - mean_[pair]) / sd;
+    }
+
+    // --- Checkpointing ---
+    void PairsEngine::serialize(Common::BinaryWriter& writer) const {
+        writer.write(symbols_);
+        writer.write(lookback_);
+        writer.write(entry_z_);
+        writer.write(exit_z_);
+        writer.write(filled_);
+        writer.write(since_resync_);
+        aligner_.serialize(writer);
+        writer.write(log_prices_);
+        writer.write(mean_);
+        writer.write(m2_);
+        writer.write(state_);
+        writer.write(selected_);
+    }
+
+    void PairsEngine::deserialize(Common::BinaryReader& reader) {
+        reader.expect(symbols_, "PairsEngine universe");
+        reader.expect(lookback_, "PairsEngine lookback");
+        reader.expect(entry_z_, "PairsEngine entry z-score");
+        reader.expect(exit_z_, "PairsEngine exit z-score");
+        const size_t pairs = selected_.size();
+        reader.read(filled_);
+        reader.read(since_resync_);
+        aligner_.deserialize(reader);
+        reader.read(log_prices_);
+        reader.read(mean_);
+        reader.read(m2_);
+        reader.read(state_);
+        reader.read(selected_);
+        if (log_prices_.size() != rows_ * size() || mean_.size() != pairs || m2_.size() != pairs ||
+            state_.size() != pairs || selected_.size() != pairs) {
+            throw std::runtime_error("PairsEngine: corrupt checkpoint (state does not match the universe)");
+        }
+        crossings_.clear();
+    }
+
+} // namespace Backtester
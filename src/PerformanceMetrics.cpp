@@ -0,0 +1,158 @@
+#include "../include/backtester/PerformanceMetrics.h" // Self header first
+
+#include <algorithm>
+#include <cmath>
+
+namespace Backtester {
+
+    namespace {
+        constexpr double kSecondsPerYear = 365.25 * 86400.0;
+
+        double seconds_between(std::chrono::system_clock::time_point from, std::chrono::system_clock::time_point to) {
+            return std::chrono::duration<double>(to - from).count();
+        }
+    } // namespace
+
+    void PerformanceMetrics::record_equity(TimePoint timestamp, double equity, bool exposed) {
+        if (has_pending_) {
+            if (timestamp < pending_time_) return;
+            if (pending_time_ < timestamp) commit(pending_time_, pending_equity_, pending_exposed_);
+        }
+        has_pending_ = true;
+        pending_time_ = timestamp;
+        pending_equity_ = equity;
+        pending_exposed_ = exposed;
+    }
+
+    void PerformanceMetrics::record_fill(double notional, bool reduces_position, double realized_pnl) {
+        traded_notional_ += std::abs(notional);
+        if (reduces_position) {
+            closed_trades_++;
+            if (realized_pnl > 0.0) winning_trades_++;
+        }
+    }
+
+    void PerformanceMetrics::merge_activity(const PerformanceMetrics& other) {
+        traded_notional_ += other.traded_notional_;
+        closed_trades_ += other.closed_trades_;
+        winning_trades_ += other.winning_trades_;
+        exposed_seconds_ += other.exposed_seconds_;
+    }
+
+    void PerformanceMetrics::commit(TimePoint timestamp, double equity, bool exposed) {
+        if (points_ == 0) {
+            first_time_ = timestamp;
+            peak_time_ = timestamp;
+        } else {
+            if (last_exposed_) exposed_seconds_ += seconds_between(last_time_, timestamp);
+            if (initial_capital_ > 1e-9) {
+                double r = (equity - last_equity_) / initial_capital_;
+                returns_++;
+                double delta = r - return_mean_;
+                return_mean_ += delta / static_cast<double>(returns_);
+                return_m2_ += delta * (r - return_mean_);
+                if (r < 0.0) downside_sum_sq_ += r * r;
+            }
+        }
+        points_++;
+        last_time_ = timestamp;
+        last_equity_ = equity;
+        last_exposed_ = exposed;
+
+        if (equity >= peak_) {
+            peak_ = equity;
+            peak_time_ = timestamp;
+        } else {
+            max_drawdown_duration_s_ = std::max(max_drawdown_duration_s_, seconds_between(peak_time_, timestamp));
+        }
+        max_drawdown_ = std::max(max_drawdown_, peak_ - equity);
+    }
+
+    MetricsSnapshot PerformanceMetrics::snapshot() const {
+        PerformanceMetrics m = *this; // Fold the pending point into a copy
+        if (m.has_pending_) m.commit(m.pending_time_, m.pending_equity_, m.pending_exposed_);
+
+        MetricsSnapshot s;
+        s.final_equity = m.points_ > 0 ? m.last_equity_ : initial_capital_;
+        s.peak_equity = m.peak_;
+        s.max_drawdown_pct = (m.peak_ > 1e-9) ? (m.max_drawdown_ / m.peak_) * 100.0 : 0.0;
+        s.max_drawdown_duration_s = m.max_drawdown_duration_s_;
+        s.closed_trades = m.closed_trades_;
+        s.winning_trades = m.winning_trades_;
+        s.hit_rate_pct = m.closed_trades_ > 0 ? 100.0 * static_cast<double>(m.winning_trades_) / static_cast<double>(m.closed_trades_) : 0.0;
+        if (initial_capital_ > 1e-9) s.turnover = m.traded_notional_ / initial_capital_;
+
+        const double elapsed = m.points_ > 1 ? seconds_between(m.first_time_, m.last_time_) : 0.0;
+        if (elapsed <= 0.0) return s;
+        s.exposure_pct = 100.0 * m.exposed_seconds_ / elapsed;
+        if (initial_capital_ > 1e-9) {
+            double total_return_pct = ((s.final_equity / initial_capital_) - 1.0) * 100.0;
+            s.annualized_return_pct = total_return_pct * kSecondsPerYear / elapsed;
+        }
+        if (s.max_drawdown_pct > 1e-12) s.calmar = s.annualized_return_pct / s.max_drawdown_pct;
+
+        // Returns are sampled once per point, so a year holds about this many of them
+        const double periods_per_year = kSecondsPerYear * static_cast<double>(m.returns_) / elapsed;
+        if (m.returns_ > 1) {
+            double stddev = std::sqrt(m.return_m2_ / static_cast<double>(m.returns_ - 1));
+            if (stddev > 1e-15) s.sharpe = m.return_mean_ / stddev * std::sqrt(periods_per_year);
+        }
+        if (m.returns_ > 0) {
+            double downside = std::sqrt(m.downside_sum_sq_ / static_cast<double>(m.returns_));
+            if (downside > 1e-15) s.sortino = m.return_mean_ / downside * std::sqrt(periods_per_year);
+        }
+        return s;
+    }
+
+    // --- Checkpointing ---
+    void PerformanceMetrics::serialize(Common::BinaryWriter& writer) const {
+        writer.write(initial_capital_);
+        writer.write(has_pending_);
+        writer.write(pending_time_);
+        writer.write(pending_equity_);
+        writer.write(pending_exposed_);
+        writer.write(points_);
+        writer.write(first_time_);
+        writer.write(last_time_);
+        writer.write(last_equity_);
+        writer.write(last_exposed_);
+        writer.write(peak_);
+        writer.write(peak_time_);
+        writer.write(max_drawdown_);
+        writer.write(max_drawdown_duration_s_);
+        writer.write(returns_);
+        writer.write(return_mean_);
+        writer.write(return_m2_);
+        writer.write(downside_sum_sq_);
+        writer.write(exposed_seconds_);
+        writer.write(traded_notional_);
+        writer.write(closed_trades_);
+        writer.write(winning_trades_);
+    }
+
+    void PerformanceMetrics::deserialize(Common::BinaryReader& reader) {
+        reader.read(initial_capital_);
+        reader.read(has_pending_);
+        reader.read(pending_time_);
+        reader.read(pending_equity_);
+        reader.read(pending_exposed_);
+        reader.read(points_);
+        reader.read(first_time_);
+        reader.read(last_time_);
+        reader.read(last_equity_);
+        reader.read(last_exposed_);
+        reader.read(peak_);
+        reader.read(peak_time_);
+        reader.read(max_drawdown_);
+        reader.read(max_drawdown_duration_s_);
+        reader.read(returns_);
+        reader.read(return_mean_);
+        reader.read(return_m2_);
+        reader.read(downside_sum_sq_);
+        reader.read(exposed_seconds_);
+        reader.read(traded_notional_);
+        reader.read(closed_trades_);
+        reader.read(winning_trades_);
+    }
+
+} // namespace Backtester
@@ -8,6 +8,8 @@
 #include "../include/common/Signal.h"       // Provides Signal struct
 #include "../include/common/OrderTypes.h"   // Provides enums
 #include "../include/common/Utils.h"          // For formatTimestampUTC
+#include "../include/common/Logger.h"         // BT_LOG_* macros
+#include "../include/backtester/TradeLedger.h"
 
 // Standard library includes used in implementation
 #include <iostream>
@@ -22,9 +24,11 @@
 namespace Backtester {
 
     // Constructor implementation
-    Portfolio::Portfolio(double initial_capital)
-        : initial_capital_(initial_capital), cash_(initial_capital) {
-        std::cout << "Portfolio Initialized with cash: $" << std::fixed << std::setprecision(2) << initial_capital << std::endl;
+    Portfolio::Portfolio(double initial_capital, std::pmr::memory_resource* resource)
+        : initial_capital_(initial_capital), cash_(initial_capital),
+          positions_(resource), equity_curve_(resource), metrics_(initial_capital), round_trips_(resource), pending_orders_(resource),
+          pending_amendments_(resource), taken_orders_(resource), taken_amendments_(resource) {
+        BT_LOG_INFO("Portfolio Initialized with cash: ${:.2f}", initial_capital);
     }
 
     // update_fill implementation
@@ -33,16 +37,17 @@ namespace Backtester {
         total_commission_ += fill.commission; // Accumulate commission
         cash_ -= fill.commission;
 
-        std::string symbol = fill.symbol;
-        Common::Position& position = positions_[symbol];
-        if (position.symbol.empty()) { position.symbol = symbol; } // Initialize symbol if new
+        const Common::SymbolId id = positions_.intern(fill.symbol);
 
         double transaction_value = fill.quantity * fill.fill_price;
-        // Store previous state *before* calling update_on_fill
-        double previous_position_rpl = position.realized_pnl; // Store previous RPL for portfolio calculation
+        // Store previous state *before* applying the fill
+        double previous_position_rpl = positions_.realized_pnl(id); // Store previous RPL for portfolio calculation
+        const double previous_quantity = positions_.quantity(id);
+        const double previous_market_value = positions_.market_value(id);
+        const double previous_unrealized_pnl = positions_.unrealized_pnl(id);
 
-        // Delegate detailed position update (AvgPx, quantity, internal RPL)
-        position.update_on_fill(fill);
+        // Detailed position update (AvgPx, quantity, position RPL)
+        positions_.apply_fill(id, fill);
 
         // Update portfolio cash based on BUY/SELL *after* getting prev state
         if (fill.direction == Common::OrderDirection::BUY) {
@@ -52,90 +57,231 @@ namespace Backtester {
         }
 
         // Accumulate the *change* in the position's realized PnL to the portfolio total
-        realized_pnl_ += (position.realized_pnl - previous_position_rpl);
+        const double realized_change = positions_.realized_pnl(id) - previous_position_rpl;
+        realized_pnl_ += realized_change;
 
-        std::cout << "Portfolio: Updated fill for OrderID " << fill.order_id << " (" << Common::to_string(fill.direction) << " "
-                  << fill.quantity << " " << fill.symbol << " @ " << std::fixed << std::setprecision(4) << fill.fill_price << "). " // More precision for price
-                  << "Comm: " << std::fixed << std::setprecision(2) << fill.commission << ". New Cash: " << cash_
-                  << ". New Pos Qty: " << std::fixed << std::setprecision(4) << position.quantity // Allow fractional display
-                  << ". Avg Px: " << std::fixed << std::setprecision(4) << position.average_entry_price
-                  << ". Total RPL: " << realized_pnl_ << std::endl;
+        // Trade statistics: a fill against an open position (reducing, closing or flipping it)
+        // completes a trade
+        const bool was_open = std::abs(previous_quantity) > 1e-9;
+        const bool is_open = std::abs(positions_.quantity(id)) > 1e-9;
+        const bool reduces = was_open && (previous_quantity > 0) != (fill.direction == Common::OrderDirection::BUY);
+        open_positions_ += static_cast<long>(is_open) - static_cast<long>(was_open);
+        metrics_.record_fill(transaction_value, reduces, realized_change);
+
+        BT_LOG_INFO("Portfolio: Updated fill for OrderID {} ({} {:.4f} {} @ {:.4f}). Comm: {:.2f}. New Cash: {:.2f}. "
+                    "New Pos Qty: {:.4f}. Avg Px: {:.4f}. Total RPL: {:.4f}",
+                    fill.order_id, Common::to_string(fill.direction), fill.quantity, fill.symbol, fill.fill_price,
+                    fill.commission, cash_, positions_.quantity(id), positions_.average_entry_price(id), realized_pnl_);
 
         // Update market value with fill price immediately
-        position.update_market_value(fill.fill_price);
+        positions_.mark(id, fill.fill_price);
+        update_totals(id, previous_market_value, previous_unrealized_pnl);
+        round_trips_.on_fill(id, fill.timestamp, previous_quantity, positions_.quantity(id), realized_change, positions_.unrealized_pnl(id));
+        if (ledger_) {
+            ledger_->append(fill, id, positions_.quantity(id), positions_.average_entry_price(id), positions_.realized_pnl(id), cash_);
+        }
+        // Keep room for the reserved market updates, so the curve only ever grows on fill bars
+        if (equity_curve_mode_ == EquityCurveMode::FULL && equity_headroom_ > 0 && equity_curve_.capacity() < equity_curve_.size() + 1 + equity_headroom_) {
+            equity_curve_.reserve(std::max(equity_curve_.size() + 1 + equity_headroom_,
+                                           equity_curve_.capacity() + equity_curve_.capacity() / 2));
+        }
         record_equity(fill.timestamp); // Record equity after fill
     }
 
+    void Portfolio::reserve_equity_curve(size_t market_updates) {
+        if (equity_curve_mode_ != EquityCurveMode::FULL) return;
+        equity_headroom_ = market_updates;
+        equity_curve_.reserve(equity_curve_.size() + market_updates);
+    }
+
+    void Portfolio::set_equity_curve_mode(EquityCurveMode mode, size_t max_points) {
+        if (mode == EquityCurveMode::DOWNSAMPLED && max_points < 2) {
+            throw std::invalid_argument("Portfolio: a downsampled equity curve needs at least 2 points");
+        }
+        equity_curve_mode_ = mode;
+        equity_curve_max_points_ = mode == EquityCurveMode::DOWNSAMPLED ? max_points : 0;
+        equity_curve_stride_ = 1;
+        equity_timestamps_ = 0;
+        equity_headroom_ = 0;
+        equity_curve_.clear();
+        if (mode == EquityCurveMode::NONE) equity_curve_.shrink_to_fit();
+        if (mode == EquityCurveMode::DOWNSAMPLED) equity_curve_.reserve(max_points + 1); // Never grows past this
+    }
+
     // update_market_value implementation - takes Common::MarketEvent
     void Portfolio::update_market_value(const Common::MarketEvent& event) {
-        auto it = positions_.find(event.symbol);
-        if (it != positions_.end()) {
-            Common::Position& position = it->second;
+        const Common::SymbolId id = positions_.find(event.symbol);
+        if (id != Common::kNoSymbol) {
             std::string price_key = "Close";
             if (!event.marketData.count(price_key) && event.marketData.count("close")) {
                 price_key = "close";
             }
             if (event.marketData.count(price_key)) {
-                position.update_market_value(event.marketData.at(price_key));
+                const double previous_market_value = positions_.market_value(id);
+                const double previous_unrealized_pnl = positions_.unrealized_pnl(id);
+                positions_.mark(id, event.marketData.at(price_key));
+                update_totals(id, previous_market_value, previous_unrealized_pnl);
+                round_trips_.on_mark(id, positions_.unrealized_pnl(id));
             } else {
-                std::cerr << "Warning: MarketEvent for " << event.symbol << " missing '" << price_key << "' price." << std::endl;
+                BT_LOG_WARN("Warning: MarketEvent for {} missing '{}' price.", event.symbol, price_key);
             }
         }
         // Record equity AFTER updating market value for the relevant symbol(s)
+        if (equity_headroom_ > 0) --equity_headroom_;
         record_equity(event.timestamp); // Record equity on market update
     }
 
     // generate_order implementation - takes Common::SignalEvent
-    std::optional<Common::OrderRequest> Portfolio::generate_order(const Common::SignalEvent& signal_event) {
+    long long Portfolio::generate_order(const Common::SignalEvent& signal_event) {
         const Common::Signal& signal = signal_event.signalDetails; // Access nested signal
-        Common::Position current_pos = get_position(signal.symbol);
+        const double current_quantity = positions_.view(signal.symbol).quantity();
         double target_quantity = 0.0;
         std::optional<Common::OrderDirection> direction_opt;
         const double fixed_order_quantity = 100.0; // Simple fixed size - Replace later
 
         // Logic to determine order based on signal and current position
         if (signal.direction == Common::SignalDirection::LONG) {
-            if (current_pos.quantity < fixed_order_quantity - 1e-9) {
-                 target_quantity = fixed_order_quantity - current_pos.quantity;
+            if (current_quantity < fixed_order_quantity - 1e-9) {
+                 target_quantity = fixed_order_quantity - current_quantity;
                  direction_opt = Common::OrderDirection::BUY;
             }
         } else if (signal.direction == Common::SignalDirection::SHORT) {
-             if (current_pos.quantity > -fixed_order_quantity + 1e-9) {
-                 target_quantity = std::abs(-fixed_order_quantity - current_pos.quantity);
+             if (current_quantity > -fixed_order_quantity + 1e-9) {
+                 target_quantity = std::abs(-fixed_order_quantity - current_quantity);
                  direction_opt = Common::OrderDirection::SELL;
              }
         } else if (signal.direction == Common::SignalDirection::FLAT) {
-            if (std::abs(current_pos.quantity) > 1e-9) {
-                target_quantity = std::abs(current_pos.quantity);
-                direction_opt = (current_pos.quantity > 0)? Common::OrderDirection::SELL : Common::OrderDirection::BUY;
+            if (std::abs(current_quantity) > 1e-9) {
+                target_quantity = std::abs(current_quantity);
+                direction_opt = (current_quantity > 0)? Common::OrderDirection::SELL : Common::OrderDirection::BUY;
             }
         }
 
         if (direction_opt.has_value() && target_quantity > 1e-9) {
-             Common::OrderRequest order_request(
-                 signal_event.timestamp,
-                 signal.symbol,
-                 direction_opt.value(),
-                 target_quantity
-             );
-             std::cout << "Portfolio: Generated MARKET order: " << Common::to_string(order_request.direction)
-                       << " " << std::fixed << std::setprecision(4) << order_request.quantity << " " // Allow fractional display
-                       << order_request.symbol << std::endl;
-             return order_request;
+             // Filled in place: the slot's symbol string keeps its storage from earlier orders
+             Common::OrderRequest& order_request = queue_order(); // Queue for execution by the Backtester
+             order_request.timestamp = signal_event.timestamp;
+             order_request.order_id = get_run_context().next_order_id();
+             order_request.symbol.assign(signal.symbol);
+             order_request.order_type = Common::OrderType::MARKET;
+             order_request.direction = direction_opt.value();
+             order_request.quantity = target_quantity;
+             order_request.limit_price.reset();
+             order_request.stop_price.reset();
+             BT_LOG_INFO("Portfolio: Generated MARKET order: {} {:.4f} {}", // Allow fractional display
+                         Common::to_string(order_request.direction), order_request.quantity, order_request.symbol);
+             return order_request.order_id;
          }
-        return std::nullopt;
+        return 0;
     }
 
+    Common::OrderRequest& Portfolio::queue_order() {
+        if (pending_count_ == pending_orders_.size()) {
+            pending_orders_.emplace_back(std::chrono::system_clock::time_point{}, std::string(),
+                                         Common::OrderDirection::BUY, 0.0);
+        }
+        return pending_orders_[pending_count_++];
+    }
+
+    // Hand over all queued orders (leaves the queue empty)
+    Portfolio::OrderBatch Portfolio::take_pending_orders() {
+        pending_orders_.swap(taken_orders_);
+        const size_t count = pending_count_;
+        pending_count_ = 0;
+        return OrderBatch(taken_orders_.data(), count);
+    }
+
+    const std::pmr::vector<Common::OrderAmendment>& Portfolio::take_pending_amendments() {
+        taken_amendments_.clear();
+        taken_amendments_.swap(pending_amendments_);
+        return taken_amendments_;
+    }
+
+    // --- Checkpointing ---
+    void Portfolio::serialize(Common::BinaryWriter& writer) const {
+        if (has_pending_orders()) {
+            throw std::logic_error("Portfolio: cannot checkpoint with unrouted pending orders");
+        }
+        writer.write(initial_capital_);
+        writer.write(cash_);
+        writer.write(total_commission_);
+        writer.write(realized_pnl_);
+        writer.write(num_fills_);
+        writer.write(static_cast<std::uint64_t>(positions_.size()));
+        for (Common::SymbolId id = 0; id < positions_.size(); ++id) {
+            writer.write(std::string(positions_.symbol(id)));
+            writer.write(positions_.quantity(id));
+            writer.write(positions_.average_entry_price(id));
+            writer.write(positions_.last_price(id));
+            writer.write(positions_.market_value(id));
+            writer.write(positions_.unrealized_pnl(id));
+            writer.write(positions_.realized_pnl(id));
+        }
+        writer.write(equity_curve_mode_);
+        writer.write(static_cast<std::uint64_t>(equity_curve_max_points_));
+        writer.write(static_cast<std::uint64_t>(equity_curve_stride_));
+        writer.write(equity_timestamps_);
+        writer.write(last_equity_time_);
+        writer.write(equity_curve_);
+        metrics_.serialize(writer);
+        round_trips_.serialize(writer);
+    }
+
+    void Portfolio::deserialize(Common::BinaryReader& reader) {
+        reader.read(initial_capital_);
+        reader.read(cash_);
+        reader.read(total_commission_);
+        reader.read(realized_pnl_);
+        reader.read(num_fills_);
+        positions_.clear();
+        pending_count_ = 0;
+        pending_amendments_.clear();
+        taken_amendments_.clear();
+        market_value_total_.reset();
+        unrealized_pnl_total_.reset();
+        market_value_ = 0.0;
+        unrealized_pnl_ = 0.0;
+        open_positions_ = 0;
+        auto count = reader.read<std::uint64_t>();
+        for (std::uint64_t i = 0; i < count; ++i) {
+            const Common::SymbolId id = positions_.intern(reader.read<std::string>());
+            Common::Position pos;
+            reader.read(pos.quantity);
+            reader.read(pos.average_entry_price);
+            reader.read(pos.last_price);
+            reader.read(pos.market_value);
+            reader.read(pos.unrealized_pnl);
+            reader.read(pos.realized_pnl);
+            positions_.set(id, pos.quantity, pos.average_entry_price, pos.last_price,
+                           pos.market_value, pos.unrealized_pnl, pos.realized_pnl);
+            update_totals(id, 0.0, 0.0);
+            if (std::abs(pos.quantity) > 1e-9) open_positions_++;
+        }
+        reader.read(equity_curve_mode_);
+        equity_curve_max_points_ = static_cast<size_t>(reader.read<std::uint64_t>());
+        equity_curve_stride_ = static_cast<size_t>(reader.read<std::uint64_t>());
+        reader.read(equity_timestamps_);
+        reader.read(last_equity_time_);
+        reader.read(equity_curve_);
+        if (equity_curve_mode_ == EquityCurveMode::DOWNSAMPLED) equity_curve_.reserve(equity_curve_max_points_ + 1);
+        metrics_.deserialize(reader);
+        round_trips_.deserialize(reader);
+    }
 
     // --- Accessor Implementations ---
-    double Portfolio::get_total_market_value() const {
-        return std::accumulate(positions_.begin(), positions_.end(), 0.0,
-           [](double sum, const auto& pair) { return sum + pair.second.market_value; });
+    void Portfolio::update_totals(Common::SymbolId id, double previous_market_value, double previous_unrealized_pnl) {
+        // Rounding the expansion costs more than updating it, so it is done once per change
+        const double market_value = positions_.market_value(id);
+        if (market_value != previous_market_value) {
+            market_value_total_.update(previous_market_value, market_value);
+            market_value_ = market_value_total_.value();
+        }
+        const double unrealized_pnl = positions_.unrealized_pnl(id);
+        if (unrealized_pnl != previous_unrealized_pnl) {
+            unrealized_pnl_total_.update(previous_unrealized_pnl, unrealized_pnl);
+            unrealized_pnl_ = unrealized_pnl_total_.value();
+        }
     }
-     double Portfolio::get_total_unrealized_pnl() const {
-         return std::accumulate(positions_.begin(), positions_.end(), 0.0,
-            [](double sum, const auto& pair) { return sum + pair.second.unrealized_pnl; });
-     }
      double Portfolio::get_total_realized_pnl() const {
          // Return the portfolio-level accumulated RPL
          return realized_pnl_;
@@ -143,19 +289,39 @@ namespace Backtester {
     double Portfolio::get_equity() const {
         return cash_ + get_total_market_value();
     }
-    // Return default-constructed Position if symbol not found
-    Common::Position Portfolio::get_position(const std::string& symbol) const {
-        auto it = positions_.find(symbol);
-        if (it != positions_.end()) { return it->second; }
-        return Common::Position(symbol);
-    }
 
     // --- Equity Recording ---
     void Portfolio::record_equity(const std::chrono::system_clock::time_point& timestamp) {
-        if (equity_curve_.empty() || equity_curve_.back().first < timestamp) {
-             equity_curve_.emplace_back(timestamp, get_equity());
-        } else if (equity_curve_.back().first == timestamp) {
-             equity_curve_.back().second = get_equity();
+        const double equity = get_equity();
+        metrics_.record_equity(timestamp, equity, open_positions_ > 0);
+        switch (equity_curve_mode_) {
+            case EquityCurveMode::FULL:
+                if (equity_curve_.empty() || equity_curve_.back().first < timestamp) {
+                     equity_curve_.emplace_back(timestamp, equity);
+                } else if (equity_curve_.back().first == timestamp) {
+                     equity_curve_.back().second = equity;
+                }
+                break;
+            case EquityCurveMode::DOWNSAMPLED:
+                if (equity_timestamps_ > 0 && timestamp <= last_equity_time_) {
+                    if (timestamp == last_equity_time_ && !equity_curve_.empty() && equity_curve_.back().first == timestamp) {
+                        equity_curve_.back().second = equity;
+                    }
+                    break;
+                }
+                last_equity_time_ = timestamp;
+                if (equity_timestamps_++ % equity_curve_stride_ != 0) break;
+                equity_curve_.emplace_back(timestamp, equity);
+                if (equity_curve_.size() > equity_curve_max_points_) {
+                    // Full: keep every other point (the multiples of the doubled stride)
+                    size_t kept = 0;
+                    for (size_t i = 0; i < equity_curve_.size(); i += 2) equity_curve_[kept++] = equity_curve_[i];
+                    equity_curve_.resize(kept);
+                    equity_curve_stride_ *= 2;
+                }
+                break;
+            case EquityCurveMode::NONE:
+                break;
         }
     }
 
@@ -163,36 +329,26 @@ namespace Backtester {
     void Portfolio::calculate_and_print_metrics() const {
         std::cout << "\n--- Performance Metrics ---" << std::endl;
         std::cout << std::fixed << std::setprecision(2);
-        if (equity_curve_.empty() && num_fills_ == 0) {
+        if (metrics_.empty() && num_fills_ == 0) {
             std::cout << "No equity data or fills recorded. Cannot calculate metrics." << std::endl;
             return;
         }
 
-        double final_equity = get_equity();
-        double total_return_pct = (initial_capital_ > 1e-9) ? (((final_equity / initial_capital_) - 1.0) * 100.0) : 0.0;
-
-        std::cout << "Ending Equity:       " << final_equity << std::endl;
-        std::cout << "Total Return:        " << total_return_pct << "%" << std::endl;
-        std::cout << "Realized PnL:        " << realized_pnl_ << " (Aggregated)" << std::endl; // Use portfolio RPL
-        std::cout << "Total Commission:    " << total_commission_ << std::endl;
-        std::cout << "Total Fills/Trades:  " << num_fills_ << std::endl;
-
-        // Calculate Max Drawdown
-        double peak_equity = initial_capital_;
-        double max_drawdown = 0.0;
-        if (!equity_curve_.empty()) {
-            for (const auto& point : equity_curve_) {
-                peak_equity = std::max(peak_equity, point.second);
-                max_drawdown = std::max(max_drawdown, peak_equity - point.second);
-            }
-        } else {
-             peak_equity = std::max(initial_capital_, final_equity);
-             max_drawdown = std::max(0.0, peak_equity - final_equity);
-        }
-
-        double max_drawdown_pct = (peak_equity > 1e-9) ? (max_drawdown / peak_equity) * 100.0 : 0.0;
-        std::cout << "Peak Equity Recorded: " << peak_equity << std::endl;
-        std::cout << "Max Drawdown:        " << max_drawdown_pct << "%" << std::endl;
+        StrategyResult res = get_results_summary();
+        std::cout << "Ending Equity:       " << res.final_equity << std::endl;
+        std::cout << "Total Return:        " << res.total_return_pct << "%" << std::endl;
+        std::cout << "Realized PnL:        " << res.realized_pnl << " (Aggregated)" << std::endl; // Use portfolio RPL
+        std::cout << "Total Commission:    " << res.total_commission << std::endl;
+        std::cout << "Total Fills/Trades:  " << res.num_fills << std::endl;
+        std::cout << "Peak Equity Recorded: " << metrics_.snapshot().peak_equity << std::endl;
+        std::cout << "Max Drawdown:        " << res.max_drawdown_pct << "%" << std::endl;
+        std::cout << "Max DD Duration:     " << res.max_drawdown_duration_s / 3600.0 << " h" << std::endl;
+        std::cout << "Sharpe / Sortino:    " << res.sharpe << " / " << res.sortino << std::endl;
+        std::cout << "Calmar:              " << res.calmar << std::endl;
+        std::cout << "Turnover:            " << res.turnover << "x" << std::endl;
+        std::cout << "Exposure:            " << res.exposure_pct << "%" << std::endl;
+        std::cout << "Hit Rate:            " << res.hit_rate_pct << "% (" << res.winning_trades << "/" << res.closed_trades << " closing fills)" << std::endl;
+        print_round_trips(std::cout, res.round_trips);
         std::cout << "--------------------------" << std::endl;
     }
 
@@ -208,15 +364,15 @@ namespace Backtester {
         std::cout << "Unrealized PnL:  " << total_unrealized_pnl << std::endl;
         std::cout << "Ending Positions:" << std::endl;
         bool has_positions = false;
-        for (const auto& pair : positions_) {
-            if (std::abs(pair.second.quantity) > 1e-9) {
+        for (Common::SymbolId id = 0; id < positions_.size(); ++id) {
+            const Common::PositionView pos = positions_.view(id);
+            if (pos.is_open()) {
                 has_positions = true;
-                const auto& pos = pair.second;
-                std::cout << "  Symbol: " << std::left << std::setw(30) << pos.symbol << ": " // Wider field
-                          << std::right << std::setw(12) << std::fixed << std::setprecision(4) << pos.quantity // More precision
-                          << " @ AvgPx " << std::setw(10) << std::fixed << std::setprecision(4) << pos.average_entry_price
-                          << " (MV: " << std::fixed << std::setprecision(2) << pos.market_value
-                          << ", UPL: " << pos.unrealized_pnl << ", RPL(Pos): " << pos.realized_pnl << ")"
+                std::cout << "  Symbol: " << std::left << std::setw(30) << pos.symbol() << ": " // Wider field
+                          << std::right << std::setw(12) << std::fixed << std::setprecision(4) << pos.quantity() // More precision
+                          << " @ AvgPx " << std::setw(10) << std::fixed << std::setprecision(4) << pos.average_entry_price()
+                          << " (MV: " << std::fixed << std::setprecision(2) << pos.market_value()
+                          << ", UPL: " << pos.unrealized_pnl() << ", RPL(Pos): " << pos.realized_pnl() << ")"
                           << std::endl;
             }
         }
@@ -228,33 +384,24 @@ namespace Backtester {
      // --- Method to return results struct (Requires StrategyResult struct) ---
      StrategyResult Portfolio::get_results_summary() const {
          StrategyResult res;
-         // ... (Implementation remains the same as the previous answer) ...
-         if (equity_curve_.empty() && num_fills_ == 0) {
-             res.final_equity = get_equity();
-             res.total_return_pct = (initial_capital_ > 1e-9) ? (((res.final_equity / initial_capital_) - 1.0) * 100.0) : 0.0;
-             res.realized_pnl = realized_pnl_;
-             res.total_commission = total_commission_;
-             res.num_fills = num_fills_;
-             res.max_drawdown_pct = 0.0;
-             return res;
-         }
          res.final_equity = get_equity();
          res.total_return_pct = (initial_capital_ > 1e-9) ? (((res.final_equity / initial_capital_) - 1.0) * 100.0) : 0.0;
          res.realized_pnl = realized_pnl_;
          res.total_commission = total_commission_;
          res.num_fills = num_fills_;
-         double peak_equity = initial_capital_;
-         double max_drawdown = 0.0;
-         if (!equity_curve_.empty()) {
-             for (const auto& point : equity_curve_) {
-                 peak_equity = std::max(peak_equity, point.second);
-                 max_drawdown = std::max(max_drawdown, peak_equity - point.second);
-             }
-         } else {
-             peak_equity = std::max(initial_capital_, res.final_equity);
-             max_drawdown = std::max(0.0, peak_equity - res.final_equity);
-         }
-         res.max_drawdown_pct = (peak_equity > 1e-9) ? (max_drawdown / peak_equity) * 100.0 : 0.0;
+         if (metrics_.empty()) return res; // Nothing recorded: no drawdown or risk figures
+         MetricsSnapshot m = metrics_.snapshot();
+         res.max_drawdown_pct = m.max_drawdown_pct;
+         res.max_drawdown_duration_s = m.max_drawdown_duration_s;
+         res.sharpe = m.sharpe;
+         res.sortino = m.sortino;
+         res.calmar = m.calmar;
+         res.turnover = m.turnover;
+         res.exposure_pct = m.exposure_pct;
+         res.hit_rate_pct = m.hit_rate_pct;
+         res.closed_trades = m.closed_trades;
+         res.winning_trades = m.winning_trades;
+         res.round_trips = round_trips_.summary();
          return res;
      }
 
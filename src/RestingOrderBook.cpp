@@ -0,0 +1,202 @@
+#include "../include/backtester/RestingOrderBook.h" // Self header first
+#include "../include/common/Logger.h" // BT_LOG_* macros
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace Backtester {
+
+    void RestingOrderBook::set_participation_rate(double rate) {
+        if (!(rate >= 0.0) || !std::isfinite(rate)) {
+            throw std::invalid_argument("RestingOrderBook: participation rate must be finite and >= 0");
+        }
+        participation_rate_ = rate;
+    }
+
+    bool RestingOrderBook::add(const Common::OrderRequest& order) {
+        const bool buy = order.direction == Common::OrderDirection::BUY;
+        Side side;
+        std::optional<double> price;
+        if (order.order_type == Common::OrderType::LIMIT) {
+            side = buy ? BUY_LIMIT : SELL_LIMIT;
+            price = order.limit_price;
+        } else if (order.order_type == Common::OrderType::STOP) {
+            side = buy ? BUY_STOP : SELL_STOP;
+            price = order.stop_price;
+        } else {
+            throw std::invalid_argument("RestingOrderBook: only LIMIT and STOP orders can rest");
+        }
+        if (!price.has_value() || !std::isfinite(*price) || *price <= 0.0) {
+            BT_LOG_WARN("RestingOrderBook Warning: OrderID {} for {} has no valid price; rejected",
+                        order.order_id, order.symbol);
+            return false;
+        }
+        if (index_.count(order.order_id)) {
+            throw std::invalid_argument("RestingOrderBook: order " + std::to_string(order.order_id) + " is already resting");
+        }
+        insert(symbols_[order.symbol], side, Entry{order.order_id, order.direction, *price, std::abs(order.quantity), std::nullopt});
+        return true;
+    }
+
+    void RestingOrderBook::insert(SymbolOrders& orders, Side side, const Entry& entry) {
+        auto it = orders.ladders[side].emplace(next_key(side, entry.price), entry).first;
+        index_[entry.order_id] = Locator{&orders, side, it};
+    }
+
+    void RestingOrderBook::erase(const Locator& locator) {
+        locator.orders->ladders[locator.side].erase(locator.it);
+    }
+
+    bool RestingOrderBook::cancel(long long order_id) {
+        auto found = index_.find(order_id);
+        if (found == index_.end()) return false;
+        erase(found->second);
+        index_.erase(found);
+        return true;
+    }
+
+    bool RestingOrderBook::replace(long long order_id, double new_price, double new_quantity) {
+        auto found = index_.find(order_id);
+        if (found == index_.end() || found->second.side == TRIGGERED) return false;
+        if (new_quantity <= 1e-9) return cancel(order_id);
+        if (!std::isfinite(new_price) || new_price <= 0.0) {
+            throw std::invalid_argument("RestingOrderBook: replace of order " + std::to_string(order_id) + " with an invalid price");
+        }
+        const Locator locator = found->second;
+        Entry& entry = locator.it->second;
+        if (new_price == entry.price && new_quantity <= entry.remaining) {
+            entry.remaining = new_quantity; // Keeps its place in the queue
+            return true;
+        }
+        Entry updated = entry;
+        updated.price = new_price;
+        updated.remaining = new_quantity;
+        erase(locator);
+        insert(*locator.orders, locator.side, updated);
+        return true;
+    }
+
+    double RestingOrderBook::remaining_quantity(long long order_id) const {
+        auto found = index_.find(order_id);
+        return found != index_.end() ? found->second.it->second.remaining : 0.0;
+    }
+
+    void RestingOrderBook::set_commission(long long order_id, double commission) {
+        auto found = index_.find(order_id);
+        if (found != index_.end()) found->second.it->second.commission = commission;
+    }
+
+    void RestingOrderBook::clear() {
+        index_.clear();
+        symbols_.clear();
+        sequence_ = 0;
+    }
+
+    // --- Matching ---
+    void RestingOrderBook::match(const std::string& symbol, const BarQuote& bar, std::vector<BookExecution>& out) {
+        if (index_.empty()) return;
+        auto found = symbols_.find(symbol);
+        if (found == symbols_.end()) return;
+        SymbolOrders& orders = found->second;
+
+        double budget = (participation_rate_ > 0.0 && bar.has_volume) ? participation_rate_ * bar.volume
+                                                                        : std::numeric_limits<double>::infinity();
+        // Stops that already fired go first, then stops this bar fires, then limits
+        constexpr Side kOrder[] = {TRIGGERED, BUY_STOP, SELL_STOP, BUY_LIMIT, SELL_LIMIT};
+        for (Side side : kOrder) {
+            Ladder& ladder = orders.ladders[side];
+            const bool stop = side == BUY_STOP || side == SELL_STOP;
+            // Keys within reach of this bar: the ladder's prefix up to 'bound'
+            double bound = std::numeric_limits<double>::infinity(); // TRIGGERED: all of them
+            if (side == BUY_STOP || side == SELL_LIMIT) bound = bar.high;
+            else if (side == SELL_STOP || side == BUY_LIMIT) bound = -bar.low;
+
+            while (!ladder.empty() && ladder.begin()->first.first <= bound) {
+                auto it = ladder.begin();
+                Entry& entry = it->second;
+                if (budget <= 1e-9) {
+                    if (!stop) break;
+                    // Fired without volume left: now a market order for the next bars
+                    Entry fired = entry;
+                    ladder.erase(it);
+                    insert(orders, TRIGGERED, fired);
+                    continue;
+                }
+
+                const bool buy = entry.direction == Common::OrderDirection::BUY;
+                double price;
+                if (side == TRIGGERED) price = bar.open;
+                else if (stop) price = buy ? std::max(bar.open, entry.price) : std::min(bar.open, entry.price);
+                else price = buy ? std::min(bar.open, entry.price) : std::max(bar.open, entry.price);
+
+                const double quantity = std::min(entry.remaining, budget);
+                budget -= quantity;
+                out.push_back(BookExecution{entry.order_id, entry.direction, quantity, price, side == TRIGGERED || stop,
+                                            entry.commission});
+
+                if (quantity >= entry.remaining - 1e-9) {
+                    index_.erase(entry.order_id);
+                    ladder.erase(it);
+                } else if (stop) {
+                    // Partially filled stop: the rest is a market order from here on
+                    Entry rest = entry;
+                    rest.remaining -= quantity;
+                    ladder.erase(it);
+                    insert(orders, TRIGGERED, rest);
+                } else {
+                    entry.remaining -= quantity; // Keeps its place; the budget is spent
+                }
+            }
+        }
+    }
+
+    // --- Checkpointing ---
+    void RestingOrderBook::serialize(Common::BinaryWriter& writer) const {
+        writer.write(sequence_);
+        writer.write(static_cast<std::uint64_t>(symbols_.size()));
+        for (const auto& [symbol, orders] : symbols_) {
+            writer.write(symbol);
+            for (const Ladder& ladder : orders.ladders) {
+                writer.write(static_cast<std::uint64_t>(ladder.size()));
+                for (const auto& [key, entry] : ladder) {
+                    writer.write(key.first);
+                    writer.write(key.second);
+                    writer.write(entry.order_id);
+                    writer.write(entry.direction);
+                    writer.write(entry.price);
+                    writer.write(entry.remaining);
+                    writer.write(entry.commission);
+                }
+            }
+        }
+    }
+
+    void RestingOrderBook::deserialize(Common::BinaryReader& reader) {
+        clear();
+        reader.read(sequence_);
+        auto symbol_count = reader.read<std::uint64_t>();
+        for (std::uint64_t s = 0; s < symbol_count; ++s) {
+            SymbolOrders& orders = symbols_[reader.read<std::string>()];
+            for (int side = 0; side < kSides; ++side) {
+                Ladder& ladder = orders.ladders[side];
+                auto count = reader.read<std::uint64_t>();
+                for (std::uint64_t i = 0; i < count; ++i) {
+                    LadderKey key;
+                    Entry entry;
+                    reader.read(key.first);
+                    reader.read(key.second);
+                    reader.read(entry.order_id);
+                    reader.read(entry.direction);
+                    reader.read(entry.price);
+                    reader.read(entry.remaining);
+                    reader.read(entry.commission);
+                    auto it = ladder.emplace_hint(ladder.end(), key, entry); // Saved in key order
+                    index_[entry.order_id] = Locator{&orders, static_cast<Side>(side), it};
+                }
+            }
+        }
+    }
+
+} // namespace Backtester
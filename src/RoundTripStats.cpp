@@ -0,0 +1,185 @@
+#include "../include/backtester/RoundTripStats.h" // Self header first
+
+#include <algorithm>
+#include <cmath>
+
+namespace Backtester {
+
+    namespace {
+        std::int64_t to_ns(std::chrono::system_clock::time_point timestamp) {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(timestamp.time_since_epoch()).count();
+        }
+    } // namespace
+
+    void print_round_trips(std::ostream& out, const RoundTripSummary& s) {
+        out << "Round Trips:         " << s.trades << " (" << s.win_pct << "% winners)" << std::endl;
+        if (s.trades == 0) return;
+        out << "  Avg PnL / StdDev:  " << s.avg_pnl << " / " << s.pnl_stddev << std::endl;
+        out << "  Avg Win / Loss:    " << s.avg_win << " / " << s.avg_loss << "  (best " << s.best_trade << ", worst " << s.worst_trade << ")" << std::endl;
+        out << "  Profit Factor:     " << s.profit_factor << std::endl;
+        out << "  Holding Time:      " << s.avg_holding_s << " s avg, " << s.max_holding_s << " s max" << std::endl;
+        out << "  MAE avg / worst:   " << s.avg_mae << " / " << s.worst_mae << std::endl;
+        out << "  MFE avg / best:    " << s.avg_mfe << " / " << s.best_mfe << std::endl;
+    }
+
+    void RoundTripStats::on_fill(Common::SymbolId id, std::chrono::system_clock::time_point timestamp,
+                                 double previous_quantity, double quantity, double realized_change, double unrealized_pnl) {
+        if (id >= open_.size()) open_.resize(static_cast<size_t>(id) + 1);
+        OpenTrade& trade = open_[id];
+        const bool is_open = std::abs(quantity) > 1e-9;
+        const std::int64_t now_ns = to_ns(timestamp);
+
+        if (!trade.open) {
+            if (is_open) open_trade(id, now_ns, realized_change, unrealized_pnl); // Realized: the opening commission
+            return;
+        }
+
+        // A fill that crosses zero closes the trade and opens the next one; its whole
+        // realized change (commission included) belongs to the trade it closes
+        const bool flipped = is_open && std::abs(previous_quantity) > 1e-9 && (previous_quantity > 0) != (quantity > 0);
+        trade.realized += realized_change;
+        if (is_open && !flipped) {
+            excursion(trade, trade.realized + unrealized_pnl);
+            return;
+        }
+        excursion(trade, trade.realized);
+        close_trade(trade, now_ns);
+        if (flipped) open_trade(id, now_ns, 0.0, unrealized_pnl);
+    }
+
+    void RoundTripStats::open_trade(Common::SymbolId id, std::int64_t entry_ns, double realized, double unrealized_pnl) {
+        OpenTrade& trade = open_[id];
+        trade = OpenTrade{};
+        trade.open = true;
+        trade.entry_ns = entry_ns;
+        trade.realized = realized;
+        excursion(trade, realized + unrealized_pnl);
+    }
+
+    void RoundTripStats::close_trade(OpenTrade& trade, std::int64_t exit_ns) {
+        const double pnl = trade.realized;
+        const double holding_s = static_cast<double>(exit_ns - trade.entry_ns) * 1e-9;
+        trades_++;
+        double delta = pnl - pnl_mean_;
+        pnl_mean_ += delta / static_cast<double>(trades_);
+        pnl_m2_ += delta * (pnl - pnl_mean_);
+        if (pnl > 0.0) { winners_++; gross_wins_ += pnl; }
+        else gross_losses_ += pnl;
+        best_trade_ = trades_ == 1 ? pnl : std::max(best_trade_, pnl);
+        worst_trade_ = trades_ == 1 ? pnl : std::min(worst_trade_, pnl);
+        holding_s_sum_ += holding_s;
+        max_holding_s_ = std::max(max_holding_s_, holding_s);
+        mae_sum_ += trade.mae;
+        worst_mae_ = std::min(worst_mae_, trade.mae);
+        mfe_sum_ += trade.mfe;
+        best_mfe_ = std::max(best_mfe_, trade.mfe);
+        trade.open = false;
+    }
+
+    void RoundTripStats::merge(const RoundTripStats& other) {
+        if (other.trades_ == 0) return;
+        if (trades_ == 0) {
+            best_trade_ = other.best_trade_;
+            worst_trade_ = other.worst_trade_;
+        } else {
+            best_trade_ = std::max(best_trade_, other.best_trade_);
+            worst_trade_ = std::min(worst_trade_, other.worst_trade_);
+        }
+        // Pairwise combination of the running moments (Chan et al.)
+        const double n_a = static_cast<double>(trades_);
+        const double n_b = static_cast<double>(other.trades_);
+        const double delta = other.pnl_mean_ - pnl_mean_;
+        pnl_mean_ += delta * n_b / (n_a + n_b);
+        pnl_m2_ += other.pnl_m2_ + delta * delta * n_a * n_b / (n_a + n_b);
+        trades_ += other.trades_;
+        winners_ += other.winners_;
+        gross_wins_ += other.gross_wins_;
+        gross_losses_ += other.gross_losses_;
+        holding_s_sum_ += other.holding_s_sum_;
+        max_holding_s_ = std::max(max_holding_s_, other.max_holding_s_);
+        mae_sum_ += other.mae_sum_;
+        worst_mae_ = std::min(worst_mae_, other.worst_mae_);
+        mfe_sum_ += other.mfe_sum_;
+        best_mfe_ = std::max(best_mfe_, other.best_mfe_);
+    }
+
+    long RoundTripStats::open_trades() const {
+        return static_cast<long>(std::count_if(open_.begin(), open_.end(), [](const OpenTrade& t) { return t.open; }));
+    }
+
+    RoundTripSummary RoundTripStats::summary() const {
+        RoundTripSummary s;
+        s.trades = trades_;
+        if (trades_ == 0) return s;
+        const double n = static_cast<double>(trades_);
+        const long losers = trades_ - winners_;
+        s.winners = winners_;
+        s.win_pct = 100.0 * static_cast<double>(winners_) / n;
+        s.avg_pnl = pnl_mean_;
+        s.pnl_stddev = trades_ > 1 ? std::sqrt(pnl_m2_ / (n - 1.0)) : 0.0;
+        s.avg_win = winners_ > 0 ? gross_wins_ / static_cast<double>(winners_) : 0.0;
+        s.avg_loss = losers > 0 ? gross_losses_ / static_cast<double>(losers) : 0.0;
+        s.best_trade = best_trade_;
+        s.worst_trade = worst_trade_;
+        s.profit_factor = gross_losses_ < 0.0 ? gross_wins_ / -gross_losses_ : 0.0;
+        s.avg_holding_s = holding_s_sum_ / n;
+        s.max_holding_s = max_holding_s_;
+        s.avg_mae = mae_sum_ / n;
+        s.worst_mae = worst_mae_;
+        s.avg_mfe = mfe_sum_ / n;
+        s.best_mfe = best_mfe_;
+        return s;
+    }
+
+    // --- Checkpointing ---
+    void RoundTripStats::serialize(Common::BinaryWriter& writer) const {
+        writer.write(static_cast<std::uint64_t>(open_.size()));
+        for (const OpenTrade& trade : open_) {
+            writer.write(trade.open);
+            writer.write(trade.entry_ns);
+            writer.write(trade.realized);
+            writer.write(trade.mae);
+            writer.write(trade.mfe);
+        }
+        writer.write(trades_);
+        writer.write(winners_);
+        writer.write(pnl_mean_);
+        writer.write(pnl_m2_);
+        writer.write(gross_wins_);
+        writer.write(gross_losses_);
+        writer.write(best_trade_);
+        writer.write(worst_trade_);
+        writer.write(holding_s_sum_);
+        writer.write(max_holding_s_);
+        writer.write(mae_sum_);
+        writer.write(worst_mae_);
+        writer.write(mfe_sum_);
+        writer.write(best_mfe_);
+    }
+
+    void RoundTripStats::deserialize(Common::BinaryReader& reader) {
+        open_.assign(static_cast<size_t>(reader.read<std::uint64_t>()), OpenTrade{});
+        for (OpenTrade& trade : open_) {
+            reader.read(trade.open);
+            reader.read(trade.entry_ns);
+            reader.read(trade.realized);
+            reader.read(trade.mae);
+            reader.read(trade.mfe);
+        }
+        reader.read(trades_);
+        reader.read(winners_);
+        reader.read(pnl_mean_);
+        reader.read(pnl_m2_);
+        reader.read(gross_wins_);
+        reader.read(gross_losses_);
+        reader.read(best_trade_);
+        reader.read(worst_trade_);
+        reader.read(holding_s_sum_);
+        reader.read(max_holding_s_);
+        reader.read(mae_sum_);
+        reader.read(worst_mae_);
+        reader.read(mfe_sum_);
+        reader.read(best_mfe_);
+    }
+
+} // namespace Backtester
@@ -0,0 +1,213 @@
+#include "../include/backtester/ShardedBacktester.h" // Self header first
+
+// Standard library includes
+#include <iostream>
+#include <iomanip>
+#include <stdexcept>
+#include <thread>
+#include <atomic>
+#include <exception>
+#include <algorithm>
+#include <cmath>
+
+// --- Include FULL definitions needed for implementation ---
+#include "../include/backtester/Backtester.h"
+#include "../include/backtester/ExecutionSimulator.h"
+#include "../include/common/Event.h"
+#include "../include/common/Utils.h"
+#include "../include/common/Logger.h"
+#include "../include/common/Trace.h"
+#include "../include/common/RunArena.h"
+
+namespace Backtester {
+
+    // Constructor implementation
+    ShardedBacktester::ShardedBacktester(DataManager& dataManager, StrategyFactory strategy_factory,
+                                         double initial_capital, unsigned num_threads,
+                                         std::chrono::seconds session_offset)
+        : data_manager_(dataManager), strategy_factory_(std::move(strategy_factory)),
+          initial_capital_(initial_capital), num_threads_(num_threads), session_offset_(session_offset) {
+        if (!strategy_factory_) {
+            throw std::invalid_argument("ShardedBacktester requires a strategy factory");
+        }
+        if (num_threads_ == 0) {
+            num_threads_ = std::max(1u, std::thread::hardware_concurrency());
+        }
+    }
+
+    // Events are already sorted by timestamp, so sessions are contiguous index ranges
+    std::vector<std::pair<size_t, size_t>> ShardedBacktester::split_sessions(
+        const std::vector<Common::MarketEvent>& events) const {
+        std::vector<std::pair<size_t, size_t>> sessions;
+        size_t begin = 0;
+        for (size_t i = 1; i <= events.size(); ++i) {
+            if (i == events.size() ||
+                Utils::session_day(events[i].timestamp, session_offset_) != Utils::session_day(events[begin].timestamp, session_offset_)) {
+                if (begin < i) sessions.emplace_back(begin, i);
+                begin = i;
+            }
+        }
+        return sessions;
+    }
+
+    // Runs one session with fresh components; safe to call concurrently
+    SessionResult ShardedBacktester::run_session(const std::vector<Common::MarketEvent>& events,
+                                                 size_t begin, size_t end) const {
+        Trace::Span session_span("session", "backtest",
+                                 Trace::is_enabled() ? Utils::formatTimestampUTC(events[begin].timestamp).substr(0, 10) : std::string());
+        Common::RunArena arena; // Declared first: outlives every component allocating from it
+        std::unique_ptr<StrategyBase> strategy = strategy_factory_(arena.resource());
+        if (!strategy) {
+            throw std::runtime_error("Strategy factory returned null");
+        }
+        std::unique_ptr<DataManager> session_data = create_slice_data_manager(events, begin, end);
+        Portfolio portfolio(initial_capital_, arena.resource());
+        ExecutionSimulator execution_simulator;
+
+        Backtester backtester(*session_data, *strategy, portfolio, execution_simulator, arena.resource());
+        backtester.set_verbose(false);
+        backtester.set_latency_label(latency_profile_.get_label());
+        backtester.set_order_latency(order_latency_);
+        backtester.set_seed(Common::RunContext::mix_seed(seed_, begin));
+        backtester.set_slice_delivery(slice_delivery_);
+        backtester.run();
+
+        SessionResult session;
+        session.session_start = events[begin].timestamp;
+        session.session_end = events[end - 1].timestamp;
+        session.num_bars = static_cast<long>(end - begin);
+        session.result = portfolio.get_results_summary();
+        session.pnl = session.result.final_equity - initial_capital_;
+        session.metrics = portfolio.get_performance_metrics();
+        session.round_trips = portfolio.get_round_trips();
+        const auto& equity_curve = portfolio.get_equity_curve(); // Copied out of the arena
+        session.equity_curve.assign(equity_curve.begin(), equity_curve.end());
+        session.latency_profile = backtester.get_latency_profile();
+        const Common::PositionBook& positions = portfolio.get_positions();
+        for (Common::SymbolId id = 0; id < positions.size(); ++id) {
+            if (positions.view(id).is_open()) { session.ended_flat = false; break; }
+        }
+        return session;
+    }
+
+    void ShardedBacktester::run() {
+        const std::vector<Common::MarketEvent>& events = data_manager_.get_all_events();
+        std::vector<std::pair<size_t, size_t>> sessions = split_sessions(events);
+        session_results_.assign(sessions.size(), SessionResult{});
+        equity_curve_.clear();
+        summary_ = StrategyResult{};
+        latency_profile_.reset();
+
+        std::cout << "ShardedBacktester: Replaying " << events.size() << " bars as " << sessions.size()
+                  << " independent sessions on " << std::min<size_t>(num_threads_, sessions.size()) << " threads..." << std::endl;
+        auto start_time = std::chrono::high_resolution_clock::now();
+        BT_TRACE_SCOPE("ShardedBacktester::run", "backtest");
+
+        // Simple work queue: each worker claims the next unprocessed session
+        std::atomic<size_t> next_session{0};
+        std::vector<std::exception_ptr> errors(sessions.size());
+        auto worker = [&](size_t worker_index) {
+            if (Trace::is_enabled()) Trace::set_thread_name("shard-worker-" + std::to_string(worker_index));
+            for (size_t i = next_session++; i < sessions.size(); i = next_session++) {
+                try {
+                    session_results_[i] = run_session(events, sessions[i].first, sessions[i].second);
+                } catch (...) {
+                    errors[i] = std::current_exception();
+                }
+            }
+        };
+
+        std::vector<std::thread> workers;
+        size_t thread_count = std::min<size_t>(num_threads_, sessions.size());
+        workers.reserve(thread_count);
+        for (size_t t = 0; t < thread_count; ++t) workers.emplace_back(worker, t);
+        for (auto& thread : workers) thread.join();
+        Log::Logger::instance().flush(); // Session logs first, then our own output
+
+        for (const auto& error : errors) {
+            if (error) std::rethrow_exception(error); // Surface the first failing session
+        }
+
+        {
+            BT_TRACE_SCOPE("stitch_results", "backtest");
+            stitch_results();
+        }
+
+        auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::high_resolution_clock::now() - start_time);
+        std::cout << "ShardedBacktester: Finished in " << duration.count() << " ms" << std::endl;
+    }
+
+    // Chains the sessions back to back: each session's curve is shifted by the P&L of all
+    // earlier sessions, so the stitched curve reads like one continuous account. The stitched
+    // points feed one PerformanceMetrics; fills and exposure are summed from the sessions.
+    void ShardedBacktester::stitch_results() {
+        double cumulative_pnl = 0.0;
+        PerformanceMetrics metrics(initial_capital_);
+        RoundTripStats round_trips;
+
+        for (const auto& session : session_results_) {
+            for (const auto& point : session.equity_curve) {
+                double equity = point.second + cumulative_pnl;
+                equity_curve_.emplace_back(point.first, equity);
+                metrics.record_equity(point.first, equity, false);
+            }
+            metrics.merge_activity(session.metrics);
+            round_trips.merge(session.round_trips);
+            cumulative_pnl += session.pnl;
+            summary_.realized_pnl += session.result.realized_pnl;
+            summary_.total_commission += session.result.total_commission;
+            summary_.num_fills += session.result.num_fills;
+            latency_profile_.merge(session.latency_profile);
+        }
+
+        summary_.final_equity = initial_capital_ + cumulative_pnl;
+        summary_.total_return_pct = (initial_capital_ > 1e-9) ? (((summary_.final_equity / initial_capital_) - 1.0) * 100.0) : 0.0;
+        MetricsSnapshot m = metrics.snapshot();
+        summary_.max_drawdown_pct = m.max_drawdown_pct;
+        summary_.max_drawdown_duration_s = m.max_drawdown_duration_s;
+        summary_.sharpe = m.sharpe;
+        summary_.sortino = m.sortino;
+        summary_.calmar = m.calmar;
+        summary_.turnover = m.turnover;
+        summary_.exposure_pct = m.exposure_pct;
+        summary_.hit_rate_pct = m.hit_rate_pct;
+        summary_.closed_trades = m.closed_trades;
+        summary_.winning_trades = m.winning_trades;
+        summary_.round_trips = round_trips.summary();
+    }
+
+    void ShardedBacktester::print_summary() const {
+        std::cout << "\n--- Sharded Session Summary ---" << std::endl;
+        std::cout << std::fixed << std::setprecision(2);
+        size_t carried_sessions = 0;
+        for (const auto& session : session_results_) {
+            std::cout << "  " << Utils::formatTimestampUTC(session.session_start)
+                      << "  Bars: " << std::setw(7) << session.num_bars
+                      << "  Fills: " << std::setw(5) << session.result.num_fills
+                      << "  PnL: " << std::setw(12) << session.pnl
+                      << (session.ended_flat ? "" : "  (NOT FLAT at session end)") << std::endl;
+            if (!session.ended_flat) carried_sessions++;
+        }
+        if (carried_sessions > 0) {
+            std::cout << "Warning: " << carried_sessions << " session(s) ended with open positions; "
+                      << "their P&L is marked to the last price and the positions are not carried over." << std::endl;
+        }
+        std::cout << "Initial Capital:     " << initial_capital_ << std::endl;
+        std::cout << "Ending Equity:       " << summary_.final_equity << std::endl;
+        std::cout << "Total Return:        " << summary_.total_return_pct << "%" << std::endl;
+        std::cout << "Realized PnL:        " << summary_.realized_pnl << std::endl;
+        std::cout << "Total Commission:    " << summary_.total_commission << std::endl;
+        std::cout << "Total Fills/Trades:  " << summary_.num_fills << std::endl;
+        std::cout << "Max Drawdown:        " << summary_.max_drawdown_pct << "%" << std::endl;
+        std::cout << "Sharpe / Sortino:    " << summary_.sharpe << " / " << summary_.sortino << std::endl;
+        std::cout << "Calmar:              " << summary_.calmar << std::endl;
+        std::cout << "Turnover:            " << summary_.turnover << "x" << std::endl;
+        std::cout << "Exposure:            " << summary_.exposure_pct << "%" << std::endl;
+        std::cout << "Hit Rate:            " << summary_.hit_rate_pct << "%" << std::endl;
+        print_round_trips(std::cout, summary_.round_trips);
+        std::cout << "-------------------------------" << std::endl;
+        latency_profile_.print(std::cout);
+    }
+
+} // namespace Backtester
@@ -0,0 +1,187 @@
+#include "../include/common/SimdKernels.h" // Self header first
+
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+#include <limits>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define BT_SIMD_X86_DISPATCH 1
+#endif
+
+namespace Backtester::Common::Simd {
+
+    // --- Scalar kernels (the reference every level reproduces) ---
+    namespace scalar {
+        double greater_of(double x, double y) { return x > y ? x : y; } // As the vector max instructions pick
+
+        void window_sums(double* sum, double* sum_sq, const double* in, const double* out, size_t n) {
+            for (size_t j = 0; j < n; ++j) {
+                sum[j] += in[j] - out[j];
+                sum_sq[j] += in[j] * in[j] - out[j] * out[j];
+            }
+        }
+
+        void window_cross(double* cross, double a, const double* in, double b, const double* out, size_t n) {
+            for (size_t j = 0; j < n; ++j) cross[j] += a * in[j] - b * out[j];
+        }
+
+        void spread_window_add(double* mean, double* m2, double a, const double* b, double inv_count, size_t n) {
+            for (size_t j = 0; j < n; ++j) {
+                const double x = a - b[j];
+                const double d = x - mean[j];
+                mean[j] += d * inv_count;
+                m2[j] += d * (x - mean[j]);
+            }
+        }
+
+        void spread_window_replace(double* mean, double* m2, double a, const double* b, double a_out,
+                                   const double* b_out, double inv_count, size_t n) {
+            for (size_t j = 0; j < n; ++j) {
+                const double x = a - b[j];
+                const double y = a_out - b_out[j];
+                const double d = x - y;
+                const double old_mean = mean[j];
+                const double new_mean = old_mean + d * inv_count;
+                mean[j] = new_mean;
+                m2[j] = greater_of(m2[j] + d * (x - new_mean + y - old_mean), 0.0);
+            }
+        }
+
+        void zscores(const double* x, const double* mean, const double* m2, double dof, size_t n, double* z) {
+            for (size_t j = 0; j < n; ++j) {
+                const double sd = std::sqrt(m2[j] / dof);
+                z[j] = sd < 1e-9 ? std::numeric_limits<double>::quiet_NaN() : (x[j] - mean[j]) / sd;
+            }
+        }
+
+        void returns(const double* previous, const double* current, size_t n, double* out) {
+            for (size_t j = 0; j < n; ++j) out[j] = std::abs(previous[j]) > 1e-9 ? current[j] / previous[j] - 1.0 : 0.0;
+        }
+
+        void true_range(const double* high, const double* low, const double* previous_close, size_t n, double* out) {
+            for (size_t j = 0; j < n; ++j) {
+                const double up = std::abs(high[j] - previous_close[j]);
+                const double down = std::abs(low[j] - previous_close[j]);
+                out[j] = greater_of(high[j] - low[j], greater_of(up, down));
+            }
+        }
+
+        void typical_prices(const double* high, const double* low, const double* close, const double* volume, size_t n,
+                            double* typical, double* price_volume) {
+            for (size_t j = 0; j < n; ++j) {
+                typical[j] = (high[j] > 1e-9 && low[j] > 1e-9) ? (high[j] + low[j] + close[j]) / 3.0 : close[j];
+                price_volume[j] = typical[j] * volume[j];
+            }
+        }
+    }
+
+    namespace detail {
+        const KernelTable kScalarKernels = {
+            scalar::window_sums, scalar::window_cross, scalar::spread_window_add, scalar::spread_window_replace,
+            scalar::zscores, scalar::returns, scalar::true_range, scalar::typical_prices,
+        };
+    }
+
+    // --- Dispatch ---
+    namespace {
+        const detail::KernelTable* table_for(Level level) {
+            if (level == Level::AVX512) return detail::avx512_kernels();
+            if (level == Level::AVX2) return detail::avx2_kernels();
+            return &detail::kScalarKernels;
+        }
+
+        Level detect() {
+#ifdef BT_SIMD_X86_DISPATCH
+            __builtin_cpu_init(); // May run before the static constructors that would do it
+            if (detail::avx512_kernels() && __builtin_cpu_supports("avx512f")) return Level::AVX512;
+            if (detail::avx2_kernels() && __builtin_cpu_supports("avx2")) return Level::AVX2;
+#endif
+            return Level::SCALAR;
+        }
+
+        // BACKTESTER_SIMD caps the starting level; unknown values are ignored
+        Level initial_level() {
+            Level level = supported_level();
+            if (const char* cap = std::getenv("BACKTESTER_SIMD")) {
+                for (Level candidate : {Level::SCALAR, Level::AVX2, Level::AVX512}) {
+                    if (std::strcmp(cap, level_name(candidate)) == 0 && candidate < level) level = candidate;
+                }
+            }
+            return level;
+        }
+
+        struct Active {
+            std::atomic<Level> level;
+            std::atomic<const detail::KernelTable*> table;
+            Active() : level(initial_level()), table(table_for(level.load())) {}
+        };
+        Active& active() {
+            static Active state;
+            return state;
+        }
+
+        const detail::KernelTable& kernels() { return *active().table.load(std::memory_order_relaxed); }
+    }
+
+    const char* level_name(Level level) {
+        switch (level) {
+            case Level::AVX512: return "avx512";
+            case Level::AVX2: return "avx2";
+            default: return "scalar";
+        }
+    }
+
+    Level supported_level() {
+        static const Level level = detect();
+        return level;
+    }
+
+    Level active_level() { return active().level.load(std::memory_order_relaxed); }
+
+    Level set_level(Level level) {
+        if (level > supported_level()) level = supported_level();
+        Active& state = active();
+        state.table.store(table_for(level), std::memory_order_relaxed);
+        state.level.store(level, std::memory_order_relaxed);
+        return level;
+    }
+
+    // --- Kernels ---
+    void window_sums(double* sum, double* sum_sq, const double* in, const double* out, size_t n) {
+        kernels().window_sums(sum, sum_sq, in, out, n);
+    }
+
+    void window_cross(double* cross, double a, const double* in, double b, const double* out, size_t n) {
+        kernels().window_cross(cross, a, in, b, out, n);
+    }
+
+    void spread_window_add(double* mean, double* m2, double a, const double* b, double inv_count, size_t n) {
+        kernels().spread_window_add(mean, m2, a, b, inv_count, n);
+    }
+
+    void spread_window_replace(double* mean, double* m2, double a, const double* b, double a_out,
+                               const double* b_out, double inv_count, size_t n) {
+        kernels().spread_window_replace(mean, m2, a, b, a_out, b_out, inv_count, n);
+    }
+
+    void zscores(const double* x, const double* mean, const double* m2, double dof, size_t n, double* z) {
+        kernels().zscores(x, mean, m2, dof, n, z);
+    }
+
+    void returns(const double* previous, const double* current, size_t n, double* out) {
+        kernels().returns(previous, current, n, out);
+    }
+
+    void true_range(const double* high, const double* low, const double* previous_close, size_t n, double* out) {
+        kernels().true_range(high, low, previous_close, n, out);
+    }
+
+    void typical_prices(const double* high, const double* low, const double* close, const double* volume, size_t n,
+                        double* typical, double* price_volume) {
+        kernels().typical_prices(high, low, close, volume, n, typical, price_volume);
+    }
+
+} // namespace Backtester::Common::Simd
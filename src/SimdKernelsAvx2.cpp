@@ -0,0 +1,139 @@
+#include "../include/common/SimdKernels.h" // Self header first
+
+// Built with -mavx2 (see CMakeLists.txt) and only called once the CPU reports AVX2; without
+// the flag this translation unit provides no kernels. It includes nothing but the intrinsics:
+// an inline function from another header compiled here could be the copy the linker keeps.
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+namespace Backtester::Common::Simd {
+
+#ifdef __AVX2__
+    // --- AVX2 kernels: 4 lanes per instruction, the tail through the scalar kernels ---
+    namespace avx2 {
+        constexpr size_t kWidth = 4;
+
+        __m256d abs(__m256d x) { return _mm256_andnot_pd(_mm256_set1_pd(-0.0), x); }
+
+        void window_sums(double* sum, double* sum_sq, const double* in, const double* out, size_t n) {
+            size_t j = 0;
+            for (; j + kWidth <= n; j += kWidth) {
+                const __m256d x = _mm256_loadu_pd(in + j);
+                const __m256d y = _mm256_loadu_pd(out + j);
+                _mm256_storeu_pd(sum + j, _mm256_add_pd(_mm256_loadu_pd(sum + j), _mm256_sub_pd(x, y)));
+                const __m256d squares = _mm256_sub_pd(_mm256_mul_pd(x, x), _mm256_mul_pd(y, y));
+                _mm256_storeu_pd(sum_sq + j, _mm256_add_pd(_mm256_loadu_pd(sum_sq + j), squares));
+            }
+            detail::kScalarKernels.window_sums(sum + j, sum_sq + j, in + j, out + j, n - j);
+        }
+
+        void window_cross(double* cross, double a, const double* in, double b, const double* out, size_t n) {
+            const __m256d va = _mm256_set1_pd(a), vb = _mm256_set1_pd(b);
+            size_t j = 0;
+            for (; j + kWidth <= n; j += kWidth) {
+                const __m256d term = _mm256_sub_pd(_mm256_mul_pd(va, _mm256_loadu_pd(in + j)), _mm256_mul_pd(vb, _mm256_loadu_pd(out + j)));
+                _mm256_storeu_pd(cross + j, _mm256_add_pd(_mm256_loadu_pd(cross + j), term));
+            }
+            detail::kScalarKernels.window_cross(cross + j, a, in + j, b, out + j, n - j);
+        }
+
+        void spread_window_add(double* mean, double* m2, double a, const double* b, double inv_count, size_t n) {
+            const __m256d va = _mm256_set1_pd(a), inv = _mm256_set1_pd(inv_count);
+            size_t j = 0;
+            for (; j + kWidth <= n; j += kWidth) {
+                const __m256d x = _mm256_sub_pd(va, _mm256_loadu_pd(b + j));
+                const __m256d d = _mm256_sub_pd(x, _mm256_loadu_pd(mean + j));
+                const __m256d new_mean = _mm256_add_pd(_mm256_loadu_pd(mean + j), _mm256_mul_pd(d, inv));
+                _mm256_storeu_pd(mean + j, new_mean);
+                _mm256_storeu_pd(m2 + j, _mm256_add_pd(_mm256_loadu_pd(m2 + j), _mm256_mul_pd(d, _mm256_sub_pd(x, new_mean))));
+            }
+            detail::kScalarKernels.spread_window_add(mean + j, m2 + j, a, b + j, inv_count, n - j);
+        }
+
+        void spread_window_replace(double* mean, double* m2, double a, const double* b, double a_out,
+                                   const double* b_out, double inv_count, size_t n) {
+            const __m256d va = _mm256_set1_pd(a), va_out = _mm256_set1_pd(a_out), inv = _mm256_set1_pd(inv_count);
+            const __m256d zero = _mm256_setzero_pd();
+            size_t j = 0;
+            for (; j + kWidth <= n; j += kWidth) {
+                const __m256d x = _mm256_sub_pd(va, _mm256_loadu_pd(b + j));
+                const __m256d y = _mm256_sub_pd(va_out, _mm256_loadu_pd(b_out + j));
+                const __m256d d = _mm256_sub_pd(x, y);
+                const __m256d old_mean = _mm256_loadu_pd(mean + j);
+                const __m256d new_mean = _mm256_add_pd(old_mean, _mm256_mul_pd(d, inv));
+                _mm256_storeu_pd(mean + j, new_mean);
+                // x - new_mean + y - old_mean, left to right
+                const __m256d spread = _mm256_sub_pd(_mm256_add_pd(_mm256_sub_pd(x, new_mean), y), old_mean);
+                const __m256d updated = _mm256_add_pd(_mm256_loadu_pd(m2 + j), _mm256_mul_pd(d, spread));
+                _mm256_storeu_pd(m2 + j, _mm256_max_pd(updated, zero));
+            }
+            detail::kScalarKernels.spread_window_replace(mean + j, m2 + j, a, b + j, a_out, b_out + j, inv_count, n - j);
+        }
+
+        void zscores(const double* x, const double* mean, const double* m2, double dof, size_t n, double* z) {
+            const __m256d vdof = _mm256_set1_pd(dof);
+            const __m256d flat = _mm256_set1_pd(1e-9), nan = _mm256_castsi256_pd(_mm256_set1_epi64x(0x7ff8000000000000LL));
+            size_t j = 0;
+            for (; j + kWidth <= n; j += kWidth) {
+                const __m256d sd = _mm256_sqrt_pd(_mm256_div_pd(_mm256_loadu_pd(m2 + j), vdof));
+                const __m256d score = _mm256_div_pd(_mm256_sub_pd(_mm256_loadu_pd(x + j), _mm256_loadu_pd(mean + j)), sd);
+                _mm256_storeu_pd(z + j, _mm256_blendv_pd(score, nan, _mm256_cmp_pd(sd, flat, _CMP_LT_OQ)));
+            }
+            detail::kScalarKernels.zscores(x + j, mean + j, m2 + j, dof, n - j, z + j);
+        }
+
+        void returns(const double* previous, const double* current, size_t n, double* out) {
+            const __m256d one = _mm256_set1_pd(1.0), tiny = _mm256_set1_pd(1e-9), zero = _mm256_setzero_pd();
+            size_t j = 0;
+            for (; j + kWidth <= n; j += kWidth) {
+                const __m256d p = _mm256_loadu_pd(previous + j);
+                const __m256d r = _mm256_sub_pd(_mm256_div_pd(_mm256_loadu_pd(current + j), p), one);
+                _mm256_storeu_pd(out + j, _mm256_blendv_pd(zero, r, _mm256_cmp_pd(abs(p), tiny, _CMP_GT_OQ)));
+            }
+            detail::kScalarKernels.returns(previous + j, current + j, n - j, out + j);
+        }
+
+        void true_range(const double* high, const double* low, const double* previous_close, size_t n, double* out) {
+            size_t j = 0;
+            for (; j + kWidth <= n; j += kWidth) {
+                const __m256d h = _mm256_loadu_pd(high + j), l = _mm256_loadu_pd(low + j);
+                const __m256d c = _mm256_loadu_pd(previous_close + j);
+                const __m256d up = abs(_mm256_sub_pd(h, c)), down = abs(_mm256_sub_pd(l, c));
+                _mm256_storeu_pd(out + j, _mm256_max_pd(_mm256_sub_pd(h, l), _mm256_max_pd(up, down)));
+            }
+            detail::kScalarKernels.true_range(high + j, low + j, previous_close + j, n - j, out + j);
+        }
+
+        void typical_prices(const double* high, const double* low, const double* close, const double* volume, size_t n,
+                            double* typical, double* price_volume) {
+            const __m256d tiny = _mm256_set1_pd(1e-9), three = _mm256_set1_pd(3.0);
+            size_t j = 0;
+            for (; j + kWidth <= n; j += kWidth) {
+                const __m256d h = _mm256_loadu_pd(high + j), l = _mm256_loadu_pd(low + j), c = _mm256_loadu_pd(close + j);
+                const __m256d valid = _mm256_and_pd(_mm256_cmp_pd(h, tiny, _CMP_GT_OQ), _mm256_cmp_pd(l, tiny, _CMP_GT_OQ));
+                const __m256d t = _mm256_blendv_pd(c, _mm256_div_pd(_mm256_add_pd(_mm256_add_pd(h, l), c), three), valid);
+                _mm256_storeu_pd(typical + j, t);
+                _mm256_storeu_pd(price_volume + j, _mm256_mul_pd(t, _mm256_loadu_pd(volume + j)));
+            }
+            detail::kScalarKernels.typical_prices(high + j, low + j, close + j, volume + j, n - j, typical + j, price_volume + j);
+        }
+
+        const detail::KernelTable kKernels = {
+            window_sums, window_cross, spread_window_add, spread_window_replace,
+            zscores, returns, true_range, typical_prices,
+        };
+    }
+#endif
+
+    namespace detail {
+        const KernelTable* avx2_kernels() {
+#ifdef __AVX2__
+            return &avx2::kKernels;
+#else
+            return nullptr;
+#endif
+        }
+    }
+
+} // namespace Backtester::Common::Simd
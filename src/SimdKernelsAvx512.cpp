@@ -0,0 +1,140 @@
+#include "../include/common/SimdKernels.h" // Self header first
+
+// Built with -mavx512f (see CMakeLists.txt) and only called once the CPU reports AVX-512F; without
+// the flag this translation unit provides no kernels. It includes nothing but the intrinsics:
+// an inline function from another header compiled here could be the copy the linker keeps.
+#ifdef __AVX512F__
+#include <immintrin.h>
+#endif
+
+namespace Backtester::Common::Simd {
+
+#ifdef __AVX512F__
+    // --- AVX-512 kernels: 8 lanes per instruction, the tail through the scalar kernels ---
+    namespace avx512 {
+        constexpr size_t kWidth = 8;
+        // Every lane: the unmasked max / sqrt intrinsics start from an "undefined" register
+        // that GCC 12 reports as maybe-uninitialized, the zero-masked forms do not
+        constexpr __mmask8 kAll = 0xff;
+
+        void window_sums(double* sum, double* sum_sq, const double* in, const double* out, size_t n) {
+            size_t j = 0;
+            for (; j + kWidth <= n; j += kWidth) {
+                const __m512d x = _mm512_loadu_pd(in + j);
+                const __m512d y = _mm512_loadu_pd(out + j);
+                _mm512_storeu_pd(sum + j, _mm512_add_pd(_mm512_loadu_pd(sum + j), _mm512_sub_pd(x, y)));
+                const __m512d squares = _mm512_sub_pd(_mm512_mul_pd(x, x), _mm512_mul_pd(y, y));
+                _mm512_storeu_pd(sum_sq + j, _mm512_add_pd(_mm512_loadu_pd(sum_sq + j), squares));
+            }
+            detail::kScalarKernels.window_sums(sum + j, sum_sq + j, in + j, out + j, n - j);
+        }
+
+        void window_cross(double* cross, double a, const double* in, double b, const double* out, size_t n) {
+            const __m512d va = _mm512_set1_pd(a), vb = _mm512_set1_pd(b);
+            size_t j = 0;
+            for (; j + kWidth <= n; j += kWidth) {
+                const __m512d term = _mm512_sub_pd(_mm512_mul_pd(va, _mm512_loadu_pd(in + j)), _mm512_mul_pd(vb, _mm512_loadu_pd(out + j)));
+                _mm512_storeu_pd(cross + j, _mm512_add_pd(_mm512_loadu_pd(cross + j), term));
+            }
+            detail::kScalarKernels.window_cross(cross + j, a, in + j, b, out + j, n - j);
+        }
+
+        void spread_window_add(double* mean, double* m2, double a, const double* b, double inv_count, size_t n) {
+            const __m512d va = _mm512_set1_pd(a), inv = _mm512_set1_pd(inv_count);
+            size_t j = 0;
+            for (; j + kWidth <= n; j += kWidth) {
+                const __m512d x = _mm512_sub_pd(va, _mm512_loadu_pd(b + j));
+                const __m512d d = _mm512_sub_pd(x, _mm512_loadu_pd(mean + j));
+                const __m512d new_mean = _mm512_add_pd(_mm512_loadu_pd(mean + j), _mm512_mul_pd(d, inv));
+                _mm512_storeu_pd(mean + j, new_mean);
+                _mm512_storeu_pd(m2 + j, _mm512_add_pd(_mm512_loadu_pd(m2 + j), _mm512_mul_pd(d, _mm512_sub_pd(x, new_mean))));
+            }
+            detail::kScalarKernels.spread_window_add(mean + j, m2 + j, a, b + j, inv_count, n - j);
+        }
+
+        void spread_window_replace(double* mean, double* m2, double a, const double* b, double a_out,
+                                   const double* b_out, double inv_count, size_t n) {
+            const __m512d va = _mm512_set1_pd(a), va_out = _mm512_set1_pd(a_out), inv = _mm512_set1_pd(inv_count);
+            const __m512d zero = _mm512_setzero_pd();
+            size_t j = 0;
+            for (; j + kWidth <= n; j += kWidth) {
+                const __m512d x = _mm512_sub_pd(va, _mm512_loadu_pd(b + j));
+                const __m512d y = _mm512_sub_pd(va_out, _mm512_loadu_pd(b_out + j));
+                const __m512d d = _mm512_sub_pd(x, y);
+                const __m512d old_mean = _mm512_loadu_pd(mean + j);
+                const __m512d new_mean = _mm512_add_pd(old_mean, _mm512_mul_pd(d, inv));
+                _mm512_storeu_pd(mean + j, new_mean);
+                // x - new_mean + y - old_mean, left to right
+                const __m512d spread = _mm512_sub_pd(_mm512_add_pd(_mm512_sub_pd(x, new_mean), y), old_mean);
+                const __m512d updated = _mm512_add_pd(_mm512_loadu_pd(m2 + j), _mm512_mul_pd(d, spread));
+                _mm512_storeu_pd(m2 + j, _mm512_maskz_max_pd(kAll, updated, zero));
+            }
+            detail::kScalarKernels.spread_window_replace(mean + j, m2 + j, a, b + j, a_out, b_out + j, inv_count, n - j);
+        }
+
+        void zscores(const double* x, const double* mean, const double* m2, double dof, size_t n, double* z) {
+            const __m512d vdof = _mm512_set1_pd(dof);
+            const __m512d flat = _mm512_set1_pd(1e-9), nan = _mm512_castsi512_pd(_mm512_set1_epi64(0x7ff8000000000000LL));
+            size_t j = 0;
+            for (; j + kWidth <= n; j += kWidth) {
+                const __m512d sd = _mm512_maskz_sqrt_pd(kAll, _mm512_div_pd(_mm512_loadu_pd(m2 + j), vdof));
+                const __m512d score = _mm512_div_pd(_mm512_sub_pd(_mm512_loadu_pd(x + j), _mm512_loadu_pd(mean + j)), sd);
+                _mm512_storeu_pd(z + j, _mm512_mask_blend_pd(_mm512_cmp_pd_mask(sd, flat, _CMP_LT_OQ), score, nan));
+            }
+            detail::kScalarKernels.zscores(x + j, mean + j, m2 + j, dof, n - j, z + j);
+        }
+
+        void returns(const double* previous, const double* current, size_t n, double* out) {
+            const __m512d one = _mm512_set1_pd(1.0), tiny = _mm512_set1_pd(1e-9), zero = _mm512_setzero_pd();
+            size_t j = 0;
+            for (; j + kWidth <= n; j += kWidth) {
+                const __m512d p = _mm512_loadu_pd(previous + j);
+                const __m512d r = _mm512_sub_pd(_mm512_div_pd(_mm512_loadu_pd(current + j), p), one);
+                _mm512_storeu_pd(out + j, _mm512_mask_blend_pd(_mm512_cmp_pd_mask(_mm512_abs_pd(p), tiny, _CMP_GT_OQ), zero, r));
+            }
+            detail::kScalarKernels.returns(previous + j, current + j, n - j, out + j);
+        }
+
+        void true_range(const double* high, const double* low, const double* previous_close, size_t n, double* out) {
+            size_t j = 0;
+            for (; j + kWidth <= n; j += kWidth) {
+                const __m512d h = _mm512_loadu_pd(high + j), l = _mm512_loadu_pd(low + j);
+                const __m512d c = _mm512_loadu_pd(previous_close + j);
+                const __m512d up = _mm512_abs_pd(_mm512_sub_pd(h, c)), down = _mm512_abs_pd(_mm512_sub_pd(l, c));
+                _mm512_storeu_pd(out + j, _mm512_maskz_max_pd(kAll, _mm512_sub_pd(h, l), _mm512_maskz_max_pd(kAll, up, down)));
+            }
+            detail::kScalarKernels.true_range(high + j, low + j, previous_close + j, n - j, out + j);
+        }
+
+        void typical_prices(const double* high, const double* low, const double* close, const double* volume, size_t n,
+                            double* typical, double* price_volume) {
+            const __m512d tiny = _mm512_set1_pd(1e-9), three = _mm512_set1_pd(3.0);
+            size_t j = 0;
+            for (; j + kWidth <= n; j += kWidth) {
+                const __m512d h = _mm512_loadu_pd(high + j), l = _mm512_loadu_pd(low + j), c = _mm512_loadu_pd(close + j);
+                const __mmask8 valid = _mm512_cmp_pd_mask(h, tiny, _CMP_GT_OQ) & _mm512_cmp_pd_mask(l, tiny, _CMP_GT_OQ);
+                const __m512d t = _mm512_mask_blend_pd(valid, c, _mm512_div_pd(_mm512_add_pd(_mm512_add_pd(h, l), c), three));
+                _mm512_storeu_pd(typical + j, t);
+                _mm512_storeu_pd(price_volume + j, _mm512_mul_pd(t, _mm512_loadu_pd(volume + j)));
+            }
+            detail::kScalarKernels.typical_prices(high + j, low + j, close + j, volume + j, n - j, typical + j, price_volume + j);
+        }
+
+        const detail::KernelTable kKernels = {
+            window_sums, window_cross, spread_window_add, spread_window_replace,
+            zscores, returns, true_range, typical_prices,
+        };
+    }
+#endif
+
+    namespace detail {
+        const KernelTable* avx512_kernels() {
+#ifdef __AVX512F__
+            return &avx512::kKernels;
+#else
+            return nullptr;
+#endif
+        }
+    }
+
+} // namespace Backtester::Common::Simd
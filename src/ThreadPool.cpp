@@ -0,0 +1,88 @@
+#include "../include/common/ThreadPool.h" // Self header first
+
+#include <algorithm>
+
+namespace Backtester::Common {
+
+    ThreadPool::ThreadPool(unsigned threads) {
+        if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+        workers_.reserve(threads - 1);
+        for (unsigned t = 1; t < threads; ++t) workers_.emplace_back([this] { worker_loop(); });
+    }
+
+    ThreadPool::~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        wake_.notify_all();
+        for (auto& worker : workers_) worker.join();
+    }
+
+    void ThreadPool::run_tasks(const std::function<void(size_t)>& task, size_t count) {
+        for (size_t i = next_.fetch_add(1, std::memory_order_relaxed); i < count;
+             i = next_.fetch_add(1, std::memory_order_relaxed)) {
+            try {
+                task(i);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (!error_) error_ = std::current_exception();
+            }
+        }
+    }
+
+    void ThreadPool::parallel_for(size_t count, const std::function<void(size_t)>& task) {
+        if (count == 0) return;
+        if (workers_.empty() || count == 1) { // Nothing to share
+            std::exception_ptr error;
+            for (size_t i = 0; i < count; ++i) {
+                try {
+                    task(i);
+                } catch (...) {
+                    if (!error) error = std::current_exception();
+                }
+            }
+            if (error) std::rethrow_exception(error);
+            return;
+        }
+        std::lock_guard<std::mutex> call_lock(call_mutex_);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            task_ = &task;
+            count_ = count;
+            next_.store(0, std::memory_order_relaxed);
+            error_ = nullptr;
+            ++generation_;
+        }
+        wake_.notify_all();
+        run_tasks(task, count);
+
+        std::exception_ptr error;
+        {
+            // Workers that never woke for this job see next_ >= count and leave at once
+            std::unique_lock<std::mutex> lock(mutex_);
+            done_.wait(lock, [this] { return active_ == 0; });
+            task_ = nullptr;
+            error = error_;
+        }
+        if (error) std::rethrow_exception(error);
+    }
+
+    void ThreadPool::worker_loop() {
+        std::uint64_t seen = 0;
+        std::unique_lock<std::mutex> lock(mutex_);
+        for (;;) {
+            wake_.wait(lock, [&] { return stopping_ || (task_ && generation_ != seen); });
+            if (stopping_) return;
+            seen = generation_;
+            const auto* task = task_;
+            const size_t count = count_;
+            ++active_;
+            lock.unlock();
+            run_tasks(*task, count);
+            lock.lock();
+            if (--active_ == 0) done_.notify_one();
+        }
+    }
+
+} // namespace Backtester::Common
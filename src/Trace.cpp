@@ -0,0 +1,151 @@
+#include "../include/common/Trace.h" // Self header first
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+namespace Backtester::Trace {
+
+    namespace {
+        struct SpanRecord {
+            const char* name;
+            const char* category;
+            double start_us;
+            double duration_us;
+            std::string detail;
+        };
+
+        // One per thread that ever recorded a span; kept alive by the registry after the
+        // thread exits so worker spans can still be written out
+        struct ThreadBuffer {
+            std::mutex mutex;          // Owner appends, writer reads (uncontended in practice)
+            std::vector<SpanRecord> spans;
+            std::string thread_name;
+            int tid = 0;
+        };
+
+        struct Registry {
+            std::mutex mutex;
+            std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+            int next_tid = 1;
+        };
+
+        Registry& registry() {
+            static Registry instance;
+            return instance;
+        }
+
+        ThreadBuffer& thread_buffer() {
+            thread_local std::shared_ptr<ThreadBuffer> buffer;
+            if (!buffer) {
+                buffer = std::make_shared<ThreadBuffer>();
+                Registry& reg = registry();
+                std::lock_guard<std::mutex> lock(reg.mutex);
+                buffer->tid = reg.next_tid++;
+                reg.buffers.push_back(buffer);
+            }
+            return *buffer;
+        }
+
+        void write_json_string(std::ostream& out, const std::string& text) {
+            out << '"';
+            for (char c : text) {
+                switch (c) {
+                    case '"':  out << "\\\""; break;
+                    case '\\': out << "\\\\"; break;
+                    case '\n': out << "\\n"; break;
+                    case '\t': out << "\\t"; break;
+                    default:
+                        if (static_cast<unsigned char>(c) < 0x20) {
+                            char escaped[8];
+                            std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned>(c));
+                            out << escaped;
+                        } else {
+                            out << c;
+                        }
+                }
+            }
+            out << '"';
+        }
+    } // namespace
+
+    void record(const char* name, const char* category, double start_us, double end_us, std::string detail) {
+        ThreadBuffer& buffer = thread_buffer();
+        std::lock_guard<std::mutex> lock(buffer.mutex);
+        buffer.spans.push_back(SpanRecord{name, category, start_us, std::max(0.0, end_us - start_us), std::move(detail)});
+    }
+
+    void set_thread_name(const std::string& name) {
+        ThreadBuffer& buffer = thread_buffer();
+        std::lock_guard<std::mutex> lock(buffer.mutex);
+        buffer.thread_name = name;
+    }
+
+    void clear() {
+        Registry& reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        for (auto& buffer : reg.buffers) {
+            std::lock_guard<std::mutex> buffer_lock(buffer->mutex);
+            buffer->spans.clear();
+        }
+    }
+
+    void write_chrome_json(const std::string& path) {
+        std::ofstream out(path);
+        if (!out) throw std::runtime_error("Trace: cannot open '" + path + "' for writing");
+
+        std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+        {
+            Registry& reg = registry();
+            std::lock_guard<std::mutex> lock(reg.mutex);
+            buffers = reg.buffers;
+        }
+
+        // Timestamps relative to the earliest span keep the numbers small and readable
+        double origin_us = -1.0;
+        for (const auto& buffer : buffers) {
+            std::lock_guard<std::mutex> lock(buffer->mutex);
+            for (const auto& span : buffer->spans) {
+                if (origin_us < 0.0 || span.start_us < origin_us) origin_us = span.start_us;
+            }
+        }
+        if (origin_us < 0.0) origin_us = 0.0;
+
+        out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+        out.setf(std::ios::fixed);
+        out.precision(3);
+        bool first = true;
+        for (const auto& buffer : buffers) {
+            std::lock_guard<std::mutex> lock(buffer->mutex);
+            if (!buffer->thread_name.empty()) {
+                out << (first ? "" : ",\n") << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":" << buffer->tid
+                    << ",\"args\":{\"name\":";
+                write_json_string(out, buffer->thread_name);
+                out << "}}";
+                first = false;
+            }
+            for (const auto& span : buffer->spans) {
+                out << (first ? "" : ",\n") << "{\"ph\":\"X\",\"name\":";
+                write_json_string(out, span.name);
+                out << ",\"cat\":";
+                write_json_string(out, span.category);
+                out << ",\"ts\":" << (span.start_us - origin_us) << ",\"dur\":" << span.duration_us
+                    << ",\"pid\":1,\"tid\":" << buffer->tid;
+                if (!span.detail.empty()) {
+                    out << ",\"args\":{\"detail\":";
+                    write_json_string(out, span.detail);
+                    out << "}";
+                }
+                out << "}";
+                first = false;
+            }
+        }
+        out << "\n]}\n";
+        if (!out) throw std::runtime_error("Trace: failed writing '" + path + "'");
+    }
+
+} // namespace Backtester::Trace
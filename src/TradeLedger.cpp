@@ -0,0 +1,315 @@
+#include "../include/backtester/TradeLedger.h" // Self header first
+
+#include <cstring>
+#include <iomanip>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+
+#include "../include/common/OrderTypes.h"
+#include "../include/common/Utils.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+// POSIX memory mapping for LedgerReader
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#include <fstream>
+#endif
+
+namespace Backtester {
+
+    namespace {
+        constexpr char kLedgerMagic[8] = {'B', 'T', 'L', 'E', 'D', 'G', 'R', '1'};
+        constexpr char kLedgerEndMagic[8] = {'B', 'T', 'L', 'E', 'D', 'E', 'N', 'D'};
+        constexpr std::uint32_t kLedgerVersion = 1;
+        constexpr size_t kHeaderBytes = 16;
+        constexpr size_t kFooterBytes = 32;
+
+        size_t padded(size_t bytes) { return (bytes + 7) & ~size_t{7}; }
+
+        // Bytes of one block holding 'count' fills (count prefix included)
+        size_t block_bytes(size_t count) {
+            return 8 + padded(count * (10 * 8 + sizeof(Common::SymbolId) + 1));
+        }
+
+#if defined(__unix__) || defined(__APPLE__)
+        // Maps 'path' read-only and sets 'size' to its length
+        void* map_ledger(const std::string& path, size_t& size) {
+            int fd = ::open(path.c_str(), O_RDONLY);
+            if (fd < 0) throw std::runtime_error("LedgerReader: cannot open '" + path + "'");
+            struct stat info;
+            if (::fstat(fd, &info) != 0) {
+                ::close(fd);
+                throw std::runtime_error("LedgerReader: cannot stat '" + path + "'");
+            }
+            size = static_cast<size_t>(info.st_size);
+            if (size < kHeaderBytes + kFooterBytes) {
+                ::close(fd);
+                throw std::runtime_error("LedgerReader: '" + path + "' is too short to be a ledger");
+            }
+            void* mapping = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            ::close(fd); // The mapping keeps the file open
+            if (mapping == MAP_FAILED) throw std::runtime_error("LedgerReader: cannot map '" + path + "'");
+            return mapping;
+        }
+        void unmap_ledger(void* mapping, size_t size) { ::munmap(mapping, size); }
+#else
+        // No mmap (e.g. MSVC): the file is read into an 8-byte aligned buffer instead, so the
+        // columns are still served in place from it
+        void* map_ledger(const std::string& path, size_t& size) {
+            std::ifstream in(path, std::ios::binary | std::ios::ate);
+            if (!in) throw std::runtime_error("LedgerReader: cannot open '" + path + "'");
+            size = static_cast<size_t>(in.tellg());
+            if (size < kHeaderBytes + kFooterBytes) {
+                throw std::runtime_error("LedgerReader: '" + path + "' is too short to be a ledger");
+            }
+            auto* words = new std::uint64_t[(size + 7) / 8];
+            in.seekg(0);
+            if (!in.read(reinterpret_cast<char*>(words), static_cast<std::streamsize>(size))) {
+                delete[] words;
+                throw std::runtime_error("LedgerReader: cannot read '" + path + "'");
+            }
+            return words;
+        }
+        void unmap_ledger(void* mapping, size_t) { delete[] static_cast<std::uint64_t*>(mapping); }
+#endif
+    } // namespace
+
+    // --- CSV export ---
+    void write_ledger_csv(std::ostream& out, const std::vector<LedgerBlock>& blocks, const std::vector<std::string>& symbols) {
+        out << "timestamp,timestamp_ns,fill_id,order_id,symbol,direction,quantity,price,commission,"
+               "position_quantity,average_entry_price,realized_pnl,cash\n";
+        const auto flags = out.flags();
+        const auto precision = out.precision();
+        out << std::defaultfloat << std::setprecision(std::numeric_limits<double>::max_digits10);
+        for (const LedgerBlock& b : blocks) {
+            for (size_t i = 0; i < b.count; ++i) {
+                const std::int64_t ns = b.timestamp_ns[i];
+                std::int64_t seconds = ns / 1000000000;
+                if (ns % 1000000000 < 0) --seconds;
+                char stamp[32];
+                size_t stamp_length = Utils::formatTimestampUTC(stamp, seconds);
+                const Common::SymbolId id = b.symbol_id[i];
+                out.write(stamp, static_cast<std::streamsize>(stamp_length));
+                out << ',' << ns << ',' << b.fill_id[i] << ',' << b.order_id[i] << ','
+                    << (id < symbols.size() ? symbols[id] : std::string()) << ','
+                    << Common::to_string(static_cast<Common::OrderDirection>(b.direction[i])) << ','
+                    << b.quantity[i] << ',' << b.price[i] << ',' << b.commission[i] << ','
+                    << b.position_quantity[i] << ',' << b.average_entry_price[i] << ','
+                    << b.realized_pnl[i] << ',' << b.cash[i] << '\n';
+            }
+        }
+        out.flags(flags);
+        out.precision(precision);
+        if (!out) throw std::runtime_error("write_ledger_csv: write failed");
+    }
+
+    // --- TradeLedger ---
+    TradeLedger::Columns::Columns(size_t capacity)
+        : timestamp_ns(capacity), fill_id(capacity), order_id(capacity),
+          quantity(capacity), price(capacity), commission(capacity), position_quantity(capacity),
+          average_entry_price(capacity), realized_pnl(capacity), cash(capacity),
+          symbol_id(capacity), direction(capacity) {}
+
+    LedgerBlock TradeLedger::Columns::view() const {
+        LedgerBlock b;
+        b.count = count;
+        b.timestamp_ns = timestamp_ns.data();
+        b.fill_id = fill_id.data();
+        b.order_id = order_id.data();
+        b.quantity = quantity.data();
+        b.price = price.data();
+        b.commission = commission.data();
+        b.position_quantity = position_quantity.data();
+        b.average_entry_price = average_entry_price.data();
+        b.realized_pnl = realized_pnl.data();
+        b.cash = cash.data();
+        b.symbol_id = symbol_id.data();
+        b.direction = direction.data();
+        return b;
+    }
+
+    TradeLedger::TradeLedger(size_t block_capacity)
+        : block_capacity_(block_capacity), current_(block_capacity) {
+        if (block_capacity_ == 0) throw std::invalid_argument("TradeLedger: block capacity must be positive");
+    }
+
+    TradeLedger::~TradeLedger() {
+        try { close(); } catch (...) { /* Destructors must not throw; close() explicitly to see errors */ }
+    }
+
+    void TradeLedger::spill_to(const std::string& path) {
+        if (fills_ > 0 || file_.is_open()) throw std::logic_error("TradeLedger: spill_to must be called before the first fill");
+        file_.open(path, std::ios::binary | std::ios::trunc);
+        if (!file_) throw std::runtime_error("TradeLedger: cannot open ledger file '" + path + "'");
+        path_ = path;
+        const std::uint32_t reserved = 0;
+        file_.write(kLedgerMagic, sizeof(kLedgerMagic));
+        file_.write(reinterpret_cast<const char*>(&kLedgerVersion), sizeof(kLedgerVersion));
+        file_.write(reinterpret_cast<const char*>(&reserved), sizeof(reserved));
+        bytes_written_ = kHeaderBytes;
+    }
+
+    void TradeLedger::register_symbol(Common::SymbolId symbol_id, const std::string& symbol) {
+        if (symbol_id >= symbols_.size()) symbols_.resize(static_cast<size_t>(symbol_id) + 1);
+        symbols_[symbol_id] = symbol;
+    }
+
+    void TradeLedger::flush_block() {
+        if (file_.is_open()) {
+            write_block(current_);
+            current_.count = 0;
+        } else {
+            full_blocks_.push_back(std::move(current_));
+            current_ = Columns(block_capacity_);
+        }
+    }
+
+    void TradeLedger::write_block(const Columns& block) {
+        const std::uint64_t count = block.count;
+        auto column = [&](const auto& values) {
+            file_.write(reinterpret_cast<const char*>(values.data()),
+                        static_cast<std::streamsize>(count * sizeof(values[0])));
+        };
+        file_.write(reinterpret_cast<const char*>(&count), sizeof(count));
+        column(block.timestamp_ns);
+        column(block.fill_id);
+        column(block.order_id);
+        column(block.quantity);
+        column(block.price);
+        column(block.commission);
+        column(block.position_quantity);
+        column(block.average_entry_price);
+        column(block.realized_pnl);
+        column(block.cash);
+        column(block.symbol_id);
+        column(block.direction);
+        const size_t bytes = block_bytes(count);
+        const size_t unpadded = 8 + count * (10 * 8 + sizeof(Common::SymbolId) + 1);
+        const char zeros[8] = {};
+        file_.write(zeros, static_cast<std::streamsize>(bytes - unpadded));
+        if (!file_) throw std::runtime_error("TradeLedger: write to '" + path_ + "' failed");
+        bytes_written_ += bytes;
+        blocks_written_++;
+    }
+
+    void TradeLedger::close() {
+        if (!file_.is_open()) return;
+        if (current_.count > 0) {
+            write_block(current_);
+            current_.count = 0;
+        }
+        const std::uint64_t symbols_offset = bytes_written_;
+        const std::uint64_t symbol_count = symbols_.size();
+        file_.write(reinterpret_cast<const char*>(&symbol_count), sizeof(symbol_count));
+        for (const std::string& symbol : symbols_) {
+            const std::uint64_t length = symbol.size();
+            file_.write(reinterpret_cast<const char*>(&length), sizeof(length));
+            file_.write(symbol.data(), static_cast<std::streamsize>(length));
+        }
+        const std::uint64_t fills = fills_;
+        file_.write(reinterpret_cast<const char*>(&symbols_offset), sizeof(symbols_offset));
+        file_.write(reinterpret_cast<const char*>(&fills), sizeof(fills));
+        file_.write(reinterpret_cast<const char*>(&blocks_written_), sizeof(blocks_written_));
+        file_.write(kLedgerEndMagic, sizeof(kLedgerEndMagic));
+        file_.close();
+        if (!file_) throw std::runtime_error("TradeLedger: cannot finish ledger file '" + path_ + "'");
+    }
+
+    std::vector<LedgerBlock> TradeLedger::blocks() const {
+        std::vector<LedgerBlock> views;
+        views.reserve(full_blocks_.size() + 1);
+        for (const Columns& block : full_blocks_) views.push_back(block.view());
+        if (current_.count > 0) views.push_back(current_.view());
+        return views;
+    }
+
+    // --- LedgerReader ---
+    LedgerReader::LedgerReader(const std::string& path) {
+        mapping_ = map_ledger(path, mapping_size_);
+
+        const char* base = static_cast<const char*>(mapping_);
+        auto u64_at = [&](size_t offset) {
+            std::uint64_t value;
+            std::memcpy(&value, base + offset, sizeof(value));
+            return value;
+        };
+        try {
+            const size_t footer = mapping_size_ - kFooterBytes;
+            std::uint32_t version;
+            std::memcpy(&version, base + 8, sizeof(version));
+            if (std::memcmp(base, kLedgerMagic, sizeof(kLedgerMagic)) != 0 || version != kLedgerVersion) {
+                throw std::runtime_error("LedgerReader: '" + path + "' is not a version " + std::to_string(kLedgerVersion) + " ledger");
+            }
+            if (std::memcmp(base + footer + 24, kLedgerEndMagic, sizeof(kLedgerEndMagic)) != 0) {
+                throw std::runtime_error("LedgerReader: '" + path + "' is incomplete (ledger not closed)");
+            }
+            const std::uint64_t symbols_offset = u64_at(footer);
+            fills_ = static_cast<size_t>(u64_at(footer + 8));
+            const std::uint64_t block_count = u64_at(footer + 16);
+            if (symbols_offset < kHeaderBytes || symbols_offset > footer) {
+                throw std::runtime_error("LedgerReader: '" + path + "' has a corrupt footer");
+            }
+
+            // Blocks: columns are used in place
+            size_t offset = kHeaderBytes;
+            size_t total = 0;
+            blocks_.reserve(static_cast<size_t>(block_count));
+            for (std::uint64_t n = 0; n < block_count; ++n) {
+                if (offset + 8 > symbols_offset) throw std::runtime_error("LedgerReader: '" + path + "' is truncated");
+                LedgerBlock b;
+                b.count = static_cast<size_t>(u64_at(offset));
+                if (b.count > (symbols_offset - offset) || offset + block_bytes(b.count) > symbols_offset) {
+                    throw std::runtime_error("LedgerReader: '" + path + "' is truncated");
+                }
+                const char* column = base + offset + 8;
+                auto next = [&](auto*& field) {
+                    using Element = std::remove_const_t<std::remove_pointer_t<std::remove_reference_t<decltype(field)>>>;
+                    field = reinterpret_cast<const Element*>(column);
+                    column += b.count * sizeof(Element);
+                };
+                next(b.timestamp_ns);
+                next(b.fill_id);
+                next(b.order_id);
+                next(b.quantity);
+                next(b.price);
+                next(b.commission);
+                next(b.position_quantity);
+                next(b.average_entry_price);
+                next(b.realized_pnl);
+                next(b.cash);
+                next(b.symbol_id);
+                next(b.direction);
+                blocks_.push_back(b);
+                total += b.count;
+                offset += block_bytes(b.count);
+            }
+            if (total != fills_) throw std::runtime_error("LedgerReader: '" + path + "' fill count does not match its blocks");
+
+            // Symbol table
+            offset = static_cast<size_t>(symbols_offset);
+            const std::uint64_t symbol_count = u64_at(offset);
+            offset += 8;
+            for (std::uint64_t n = 0; n < symbol_count; ++n) {
+                if (offset + 8 > footer) throw std::runtime_error("LedgerReader: '" + path + "' has a corrupt symbol table");
+                const std::uint64_t length = u64_at(offset);
+                offset += 8;
+                if (length > footer - offset) throw std::runtime_error("LedgerReader: '" + path + "' has a corrupt symbol table");
+                symbols_.emplace_back(base + offset, static_cast<size_t>(length));
+                offset += static_cast<size_t>(length);
+            }
+        } catch (...) {
+            unmap_ledger(mapping_, mapping_size_);
+            mapping_ = nullptr;
+            throw;
+        }
+    }
+
+    LedgerReader::~LedgerReader() {
+        if (mapping_) unmap_ledger(mapping_, mapping_size_);
+    }
+
+} // namespace Backtester
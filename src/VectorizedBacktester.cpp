@@ -0,0 +1,637 @@
+#include "../include/backtester/VectorizedBacktester.h" // Self header first
+
+#include "../include/backtester/Backtester.h"
+#include "../include/backtester/DataManager.h"
+#include "../include/backtester/ExecutionSimulator.h"
+#include "../include/backtester/PerformanceMetrics.h"
+#include "../include/backtester/TradeLedger.h"
+#include "../include/common/Position.h"     // apply_fill
+#include "../include/common/RollingStats.h" // CompensatedSum, kResyncWindows, RollingVariance
+#include "../include/common/SimdKernels.h"
+#include "../include/common/Utils.h"        // session_day
+#include "../include/strategies/MomentumIgnition.h"
+#include "../include/strategies/MovingAverageCrossover.h"
+#include "../include/strategies/OpeningRangeBreakout.h"
+#include "../include/strategies/PairsTrading.h"
+#include "../include/strategies/VWAPReversion.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <initializer_list>
+#include <sstream>
+#include <stdexcept>
+#include <type_traits>
+
+namespace Backtester {
+
+    namespace {
+        constexpr double kOrderQuantity = 100.0; // Portfolio::generate_order's fixed size
+        constexpr std::int8_t kLong = 1, kShort = -1, kFlat = 0;
+
+        // A strategy asking for 'direction' on 'symbol' at 'event'; 'row' is the symbol's
+        // latest bar then, the one the order executes against (kNoRow if that event had no
+        // close: the order finds no price and does not fill)
+        struct Signal {
+            std::uint32_t event;
+            std::uint32_t symbol;
+            std::uint32_t row;
+            std::int8_t direction;
+        };
+        using Signals = std::vector<Signal>;
+        using Series = ColumnarData::Series;
+
+        // --- Kernels ---
+        // Trailing window sums, out[k] = x[k-w+1] + ... + x[k] (fewer terms for k < w - 1),
+        // with RollingSum's arithmetic (compensated, resynced every kResyncWindows windows) so
+        // thresholds on them decide exactly as the strategies do
+        void rolling_sum(const double* x, size_t n, size_t w, double* out) {
+            Common::detail::CompensatedSum total;
+            std::uint64_t replacements = 0;
+            for (size_t k = 0; k < n; ++k) {
+                if (k >= w) {
+                    if (++replacements >= w * Common::detail::kResyncWindows) {
+                        replacements = 0;
+                        total.reset();
+                        for (size_t j = k + 1 - w; j <= k; ++j) total.add(x[j]);
+                        out[k] = total.value();
+                        continue;
+                    }
+                    total.add(-x[k - w]);
+                }
+                total.add(x[k]);
+                out[k] = total.value();
+            }
+        }
+
+        // Trailing window sums taken afresh, out[k] = x[k-w+1] + ... + x[k] compensated from
+        // the oldest term (fewer terms for k < w - 1), as MomentumIgnition sums its short
+        // windows: O(n * w)
+        void window_sums(const double* x, size_t n, size_t w, double* out) {
+            for (size_t k = 0; k < n; ++k) {
+                Common::detail::CompensatedSum total;
+                for (size_t j = k + 1 > w ? k + 1 - w : 0; j <= k; ++j) total.add(x[j]);
+                out[k] = total.value();
+            }
+        }
+
+        // Trailing window maximum (less = std::less) or minimum (std::greater) of x[k-w+1..k]:
+        // a monotonic queue of indices, amortized O(1) per element
+        template <class Less>
+        void rolling_extreme(const double* x, size_t n, size_t w, double* out, Less less) {
+            std::vector<size_t> queue(n);
+            size_t head = 0, tail = 0;
+            for (size_t k = 0; k < n; ++k) {
+                while (tail > head && !less(x[k], x[queue[tail - 1]])) --tail; // Dominated by x[k]
+                queue[tail++] = k;
+                if (queue[head] + w <= k) ++head;
+                out[k] = x[queue[head]];
+            }
+        }
+
+        // Rows of 's' with every given column present, and a column gathered over such rows
+        std::vector<std::uint32_t> complete_rows(const Series& s, std::initializer_list<const std::vector<double>*> columns) {
+            std::vector<std::uint32_t> rows;
+            rows.reserve(s.size());
+            for (size_t k = 0; k < s.size(); ++k) {
+                bool complete = true;
+                for (const auto* column : columns) complete = complete && !std::isnan((*column)[k]);
+                if (complete) rows.push_back(static_cast<std::uint32_t>(k));
+            }
+            return rows;
+        }
+        std::vector<double> gather(const std::vector<double>& column, const std::vector<std::uint32_t>& rows) {
+            std::vector<double> out(rows.size());
+            for (size_t j = 0; j < rows.size(); ++j) out[j] = column[rows[j]];
+            return out;
+        }
+
+        // Emits a signal wherever 'desired' (one direction per row from 'first') leaves the
+        // last emitted direction, starting FLAT: the strategies' "signal on change"
+        void emit_changes(const std::int8_t* desired, size_t first, size_t n, const Series& s,
+                          const std::uint32_t* rows, std::uint32_t id, Signals& out) {
+            std::int8_t last = kFlat;
+            for (size_t j = first; j < n; ++j) {
+                if (desired[j] == last) continue;
+                last = desired[j];
+                const std::uint32_t row = rows ? rows[j] : static_cast<std::uint32_t>(j);
+                out.push_back(Signal{s.event[row], id, row, last});
+            }
+        }
+
+        // --- Signal kernels (one symbol each, except pairs) ---
+        // MovingAverageCrossover: LONG / SHORT while the short mean is above / below the long
+        // one (beyond a 1e-9 tolerance), FLAT in between, once both windows are full
+        void ma_crossover(const Series& s, std::uint32_t id, const MACrossoverParams& p, Signals& out) {
+            const size_t n = s.size();
+            if (n < p.long_window) return;
+            std::vector<double> short_sum(n), long_sum(n);
+            rolling_sum(s.close.data(), n, p.short_window, short_sum.data());
+            rolling_sum(s.close.data(), n, p.long_window, long_sum.data());
+            const double short_n = static_cast<double>(p.short_window);
+            const double long_n = static_cast<double>(p.long_window);
+            std::vector<std::int8_t> desired(n, kFlat);
+            for (size_t k = p.long_window - 1; k < n; ++k) {
+                const double short_sma = short_sum[k] / short_n;
+                const double long_sma = long_sum[k] / long_n;
+                desired[k] = static_cast<std::int8_t>((short_sma > long_sma + 1e-9) - (short_sma < long_sma - 1e-9));
+            }
+            emit_changes(desired.data(), p.long_window - 1, n, s, nullptr, id, out);
+        }
+
+        // VWAPReversion: cumulative VWAP over the bars with volume; SHORT above the upper band,
+        // LONG below the lower one, back to FLAT when the close crosses the VWAP
+        void vwap_reversion(const Series& s, std::uint32_t id, const VWAPReversionParams& p, Signals& out) {
+            std::vector<std::uint32_t> rows;
+            rows.reserve(s.size());
+            for (size_t k = 0; k < s.size(); ++k) {
+                if (!std::isnan(s.volume[k]) && s.volume[k] >= 1e-9) rows.push_back(static_cast<std::uint32_t>(k));
+            }
+            const size_t n = rows.size();
+            std::vector<double> close = gather(s.close, rows), high = gather(s.high, rows), low = gather(s.low, rows);
+            std::vector<double> volume = gather(s.volume, rows);
+
+            // Typical prices and their price-volume terms, then the running VWAP (a running sum
+            // in bar order, as the strategy accumulates it)
+            std::vector<double> typical(n), price_volume(n), vwap(n);
+            Common::Simd::typical_prices(high.data(), low.data(), close.data(), volume.data(), n, typical.data(), price_volume.data());
+            double total_price_volume = 0.0, cumulative_volume = 0.0;
+            for (size_t j = 0; j < n; ++j) {
+                total_price_volume += price_volume[j];
+                cumulative_volume += volume[j];
+                vwap[j] = cumulative_volume > 1e-9 ? total_price_volume / cumulative_volume : typical[j];
+            }
+            // Band and VWAP-side flags
+            std::vector<std::int8_t> band(n), side(n);
+            for (size_t j = 0; j < n; ++j) {
+                const double deviation = close[j] * 0.005;
+                const double upper = vwap[j] + p.deviation_multiplier * deviation;
+                const double lower = vwap[j] - p.deviation_multiplier * deviation;
+                band[j] = static_cast<std::int8_t>((close[j] < lower) - (close[j] > upper)); // Entry direction, 0 inside
+                side[j] = static_cast<std::int8_t>((close[j] > vwap[j]) - (close[j] < vwap[j]));
+            }
+            // The entry / exit state machine
+            std::vector<std::int8_t> desired(n);
+            std::int8_t last = kFlat;
+            for (size_t j = 0; j < n; ++j) {
+                if (band[j] != kFlat) last = band[j];
+                else if (last != kFlat && side[j] == last) last = kFlat; // Crossed back over the VWAP
+                desired[j] = last;
+            }
+            emit_changes(desired.data(), 0, n, s, rows.data(), id, out);
+        }
+
+        // OpeningRangeBreakout, per session (calendar day): the high / low of the bars within
+        // the first range_minutes of the session's first bar, then one trade on the first close
+        // outside that range before the session close; FLAT on the first bar at or after the
+        // close, or failing that on the next session's first bar
+        void opening_range_breakout(const Series& s, std::uint32_t id, const OpeningRangeBreakoutParams& p, Signals& out) {
+            const std::vector<std::uint32_t> rows = complete_rows(s, {&s.high, &s.low});
+            const std::int64_t minute_ns = 60'000'000'000LL;
+            auto timestamp = [&](size_t j) {
+                return std::chrono::system_clock::time_point(std::chrono::duration_cast<std::chrono::system_clock::duration>(
+                    std::chrono::nanoseconds(s.time_ns[rows[j]])));
+            };
+            bool open = false;
+            for (size_t begin = 0, end = 0; begin < rows.size(); begin = end) {
+                const long long day = Utils::session_day(timestamp(begin));
+                end = begin + 1;
+                while (end < rows.size() && Utils::session_day(timestamp(end)) == day) ++end;
+                if (open) {
+                    out.push_back(Signal{s.event[rows[begin]], id, rows[begin], kFlat});
+                    open = false;
+                }
+                // Bars before the close, then the first bar at least range_minutes in (whole
+                // minutes, truncated as duration_cast does)
+                size_t close = begin;
+                while (close < end && Utils::session_minute(timestamp(close)) < p.session_close_minutes) ++close;
+                const std::int64_t start = s.time_ns[rows[begin]];
+                size_t established = begin;
+                while (established < close && (s.time_ns[rows[established]] - start) / minute_ns < p.range_minutes) ++established;
+                double range_high = s.high[rows[begin]], range_low = s.low[rows[begin]];
+                for (size_t j = begin; j < established; ++j) {
+                    range_high = std::max(range_high, s.high[rows[j]]);
+                    range_low = std::min(range_low, s.low[rows[j]]);
+                }
+                for (size_t j = established; j < close; ++j) {
+                    const double price = s.close[rows[j]];
+                    const std::int8_t direction = price > range_high ? kLong : price < range_low ? kShort : kFlat;
+                    if (direction == kFlat) continue;
+                    out.push_back(Signal{s.event[rows[j]], id, rows[j], direction});
+                    open = true;
+                    break; // Trades once per session
+                }
+                if (open && close < end) {
+                    out.push_back(Signal{s.event[rows[close]], id, rows[close], kFlat});
+                    open = false;
+                }
+            }
+        }
+
+        // MomentumIgnition: LONG / SHORT on a close beyond the previous price_window bars' range
+        // with volume above volume_multiplier times its previous volume_window mean and the
+        // last return_window returns summing the same way; FLAT otherwise
+        void momentum_ignition(const Series& s, std::uint32_t id, const MomentumIgnitionParams& p, Signals& out) {
+            const std::vector<std::uint32_t> rows = complete_rows(s, {&s.high, &s.low, &s.volume});
+            const size_t n = rows.size();
+            const size_t warm = std::max({p.price_window, p.volume_window, p.return_window}); // First row with enough history
+            if (n <= warm) return;
+            const std::vector<double> close = gather(s.close, rows), high = gather(s.high, rows);
+            const std::vector<double> low = gather(s.low, rows), volume = gather(s.volume, rows);
+
+            // returns[j - 1] is row j's return
+            std::vector<double> returns(n - 1);
+            Common::Simd::returns(close.data(), close.data() + 1, n - 1, returns.data());
+            std::vector<double> recent_high(n), recent_low(n), volume_sum(n), return_sum(n - 1);
+            rolling_extreme(high.data(), n, p.price_window, recent_high.data(), std::less<double>());
+            rolling_extreme(low.data(), n, p.price_window, recent_low.data(), std::greater<double>());
+            window_sums(volume.data(), n, p.volume_window, volume_sum.data());
+            window_sums(returns.data(), n - 1, p.return_window, return_sum.data());
+
+            // Row j against the windows ending at row j - 1 (its own return included)
+            std::vector<std::int8_t> desired(n, kFlat);
+            const double volume_n = static_cast<double>(p.volume_window);
+            for (size_t j = warm; j < n; ++j) {
+                const double average_volume = volume_sum[j - 1] / volume_n;
+                const bool surge = volume[j] > p.volume_multiplier * average_volume && average_volume > 1e-9;
+                const double delta = return_sum[j - 1];
+                const bool up = close[j] > recent_high[j - 1] && surge && delta > 1e-9;
+                const bool down = close[j] < recent_low[j - 1] && surge && delta < -1e-9;
+                desired[j] = up ? kLong : down ? kShort : kFlat;
+            }
+            emit_changes(desired.data(), warm, n, s, rows.data(), id, out);
+        }
+
+        // PairsTrading (ratio mode): the legs' latest closes are paired up in event order as
+        // the strategy buffers them. A ratio that cannot be judged yet (window filling, flat
+        // window, bad price) leaves both legs pending, so the following events -- of any
+        // symbol -- re-evaluate the same prices, as they do in the strategy. The judged ratios'
+        // z-scores are one Simd::zscores pass, then the entry / exit state machine a scan.
+        void pairs_trading(const ColumnarData& data, const PairsTradingParams& p, Signals& out) {
+            const size_t a = data.symbol_id(p.symbol_a), b = data.symbol_id(p.symbol_b);
+            if (a == data.symbols() || b == data.symbols()) return; // A leg never trades
+            const Series& series_a = data.series(a);
+            const Series& series_b = data.series(b);
+            Common::RollingVariance ratio_stats(p.lookback);
+            bool pending_a = false, pending_b = false;
+            double price_a = 0.0, price_b = 0.0;
+            std::uint32_t row_a = 0, row_b = 0; // Latest bars, for the fills
+
+            // The judged ratios, with the window statistics they are scored against
+            struct Judged {
+                std::uint32_t event;
+                std::uint32_t row_a;
+                std::uint32_t row_b;
+            };
+            std::vector<Judged> judged;
+            std::vector<double> ratios, means, m2s;
+            const auto& symbols = data.event_symbols();
+            const auto& rows = data.event_rows();
+            for (size_t e = 0; e < symbols.size(); ++e) {
+                const std::uint32_t symbol = symbols[e];
+                const std::uint32_t row = rows[e];
+                if (symbol == a) row_a = row;
+                if (symbol == b) row_b = row;
+                if (row == ColumnarData::kNoRow) continue; // No close: a leg's order would find no price
+                if (symbol == a) {
+                    price_a = series_a.close[row];
+                    pending_a = true;
+                }
+                if (symbol == b) {
+                    price_b = series_b.close[row];
+                    pending_b = true;
+                }
+                if (!pending_a || !pending_b) continue;
+                if (price_a <= 1e-9 || price_b <= 1e-9) continue;
+
+                const double ratio = p.hedge_ratio == 1.0 ? price_a / price_b : price_a / std::pow(price_b, p.hedge_ratio);
+                ratio_stats.push(ratio);
+                if (!ratio_stats.full()) continue;
+                if (ratio_stats.stddev() < 1e-9) continue;
+                judged.push_back(Judged{static_cast<std::uint32_t>(e), row_a, row_b});
+                ratios.push_back(ratio);
+                means.push_back(ratio_stats.mean());
+                m2s.push_back(ratio_stats.m2());
+                pending_a = pending_b = false;
+            }
+
+            std::vector<double> z(judged.size());
+            Common::Simd::zscores(ratios.data(), means.data(), m2s.data(), static_cast<double>(p.lookback - 1), judged.size(), z.data());
+
+            enum class State : std::uint8_t { FLAT, LONG_A_SHORT_B, SHORT_A_LONG_B };
+            State state = State::FLAT;
+            for (size_t k = 0; k < judged.size(); ++k) {
+                State desired = state;
+                if (state == State::FLAT) {
+                    if (z[k] > p.entry_z) desired = State::SHORT_A_LONG_B;
+                    else if (z[k] < -p.entry_z) desired = State::LONG_A_SHORT_B;
+                } else if (state == State::SHORT_A_LONG_B && z[k] < p.exit_z) {
+                    desired = State::FLAT;
+                } else if (state == State::LONG_A_SHORT_B && z[k] > -p.exit_z) {
+                    desired = State::FLAT;
+                }
+                if (desired != state) {
+                    const std::int8_t leg_a = desired == State::LONG_A_SHORT_B ? kLong : desired == State::SHORT_A_LONG_B ? kShort : kFlat;
+                    out.push_back(Signal{judged[k].event, static_cast<std::uint32_t>(a), judged[k].row_a, leg_a});
+                    out.push_back(Signal{judged[k].event, static_cast<std::uint32_t>(b), judged[k].row_b, static_cast<std::int8_t>(-leg_a)});
+                    state = desired;
+                }
+            }
+        }
+
+        // --- Parameter checks (the strategy constructors') ---
+        void validate(const VectorStrategy& strategy) {
+            if (const auto* p = std::get_if<MACrossoverParams>(&strategy)) {
+                if (p->short_window == 0 || p->long_window <= p->short_window) {
+                    throw std::invalid_argument("Invalid window sizes for MovingAverageCrossover");
+                }
+            } else if (const auto* p = std::get_if<VWAPReversionParams>(&strategy)) {
+                if (p->deviation_multiplier <= 0) throw std::invalid_argument("Deviation multiplier must be positive for VWAPReversion");
+            } else if (const auto* p = std::get_if<OpeningRangeBreakoutParams>(&strategy)) {
+                if (p->range_minutes <= 0) throw std::invalid_argument("Opening range minutes must be positive");
+                if (p->session_close_minutes <= 0 || p->session_close_minutes > OpeningRangeBreakout::kNoSessionClose) {
+                    throw std::invalid_argument("Session close must be within the day");
+                }
+            } else if (const auto* p = std::get_if<MomentumIgnitionParams>(&strategy)) {
+                if (p->price_window == 0 || p->volume_window == 0 || p->volume_multiplier <= 0 || p->return_window == 0) {
+                    throw std::invalid_argument("Invalid parameters for MomentumIgnition");
+                }
+            } else if (const auto* p = std::get_if<PairsTradingParams>(&strategy)) {
+                if (p->lookback == 0) throw std::invalid_argument("Rolling window must be at least 1");
+                if (!std::isfinite(p->hedge_ratio) || p->hedge_ratio <= 0.0) throw std::invalid_argument("PairsTrading: hedge ratio must be positive");
+            }
+        }
+
+        bool close_enough(double x, double y) {
+            return std::abs(x - y) <= 1e-9 * std::max({1.0, std::abs(x), std::abs(y)});
+        }
+    }
+
+    // --- Event-driven counterparts ---
+    std::unique_ptr<StrategyBase> make_event_strategy(const VectorStrategy& strategy, std::pmr::memory_resource* resource) {
+        validate(strategy);
+        if (const auto* p = std::get_if<MACrossoverParams>(&strategy)) {
+            return std::make_unique<MovingAverageCrossover>(p->short_window, p->long_window, resource);
+        }
+        if (const auto* p = std::get_if<VWAPReversionParams>(&strategy)) {
+            return std::make_unique<VWAPReversion>(p->deviation_multiplier, resource);
+        }
+        if (const auto* p = std::get_if<OpeningRangeBreakoutParams>(&strategy)) {
+            return std::make_unique<OpeningRangeBreakout>(p->range_minutes, p->session_close_minutes, resource);
+        }
+        if (const auto* p = std::get_if<MomentumIgnitionParams>(&strategy)) {
+            return std::make_unique<MomentumIgnition>(p->price_window, p->volume_window, p->volume_multiplier, p->return_window, resource);
+        }
+        const auto& p = std::get<PairsTradingParams>(strategy);
+        auto pairs = std::make_unique<PairsTrading>(p.symbol_a, p.symbol_b, p.lookback, p.entry_z, p.exit_z, 10000.0, resource);
+        pairs->set_hedge_ratio(p.hedge_ratio);
+        return pairs;
+    }
+
+    VectorizedBacktester::VectorizedBacktester(const ColumnarData& data, double initial_capital, VectorCostModel costs)
+        : data_(data), initial_capital_(initial_capital), costs_(costs) {}
+
+    VectorRun VectorizedBacktester::run(const VectorStrategy& strategy) const {
+        validate(strategy);
+
+        // --- 1. Signals, in event order ---
+        Signals signals;
+        if (const auto* pairs = std::get_if<PairsTradingParams>(&strategy)) {
+            pairs_trading(data_, *pairs, signals); // Already in event order
+        } else {
+            for (size_t id = 0; id < data_.symbols(); ++id) {
+                const Series& s = data_.series(id);
+                const auto symbol = static_cast<std::uint32_t>(id);
+                std::visit([&](const auto& p) {
+                    using P = std::decay_t<decltype(p)>;
+                    if constexpr (std::is_same_v<P, MACrossoverParams>) ma_crossover(s, symbol, p, signals);
+                    else if constexpr (std::is_same_v<P, VWAPReversionParams>) vwap_reversion(s, symbol, p, signals);
+                    else if constexpr (std::is_same_v<P, OpeningRangeBreakoutParams>) opening_range_breakout(s, symbol, p, signals);
+                    else if constexpr (std::is_same_v<P, MomentumIgnitionParams>) momentum_ignition(s, symbol, p, signals);
+                }, strategy);
+            }
+            std::stable_sort(signals.begin(), signals.end(), [](const Signal& x, const Signal& y) { return x.event < y.event; });
+        }
+
+        // --- 2. Fills: Portfolio sizing, cost model, average-cost positions ---
+        struct Book {
+            double quantity = 0.0;
+            double average_entry_price = 0.0;
+            double realized_pnl = 0.0;
+            std::int64_t last_fill_event = -1;
+            double last_fill_price = 0.0;
+        };
+        struct SymbolFill {
+            std::uint32_t event;
+            double quantity; // Position after the fill
+            double price;
+        };
+        const size_t events = data_.events();
+        std::vector<Book> books(data_.symbols());
+        std::vector<std::vector<SymbolFill>> symbol_fills(data_.symbols());
+        std::vector<double> equity_change(events, 0.0);     // Per event
+        std::vector<std::pair<std::uint32_t, long>> open_after; // Open positions after each fill event
+        PerformanceMetrics metrics(initial_capital_);
+        VectorRun run;
+        double cash = initial_capital_;
+        double realized_pnl = 0.0, total_commission = 0.0;
+        long open_positions = 0;
+
+        for (const Signal& signal : signals) {
+            Book& book = books[signal.symbol];
+            const double current = book.quantity;
+            double quantity = 0.0;
+            Common::OrderDirection direction = Common::OrderDirection::BUY;
+            if (signal.direction == kLong) {
+                if (current < kOrderQuantity - 1e-9) quantity = kOrderQuantity - current;
+            } else if (signal.direction == kShort) {
+                if (current > -kOrderQuantity + 1e-9) {
+                    quantity = std::abs(-kOrderQuantity - current);
+                    direction = Common::OrderDirection::SELL;
+                }
+            } else if (std::abs(current) > 1e-9) {
+                quantity = std::abs(current);
+                direction = current > 0 ? Common::OrderDirection::SELL : Common::OrderDirection::BUY;
+            }
+            if (!(quantity > 1e-9) || signal.row == ColumnarData::kNoRow) continue;
+
+            const Series& s = data_.series(signal.symbol);
+            const BarQuote bar = data_.quote(signal.symbol, signal.row);
+            const double reference = costs_.fill_price(bar);
+            const double slip = costs_.slippage(FillContext{bar, direction, quantity, reference});
+            const bool buy = direction == Common::OrderDirection::BUY;
+            const double price = std::max(0.0, buy ? reference + slip : reference - slip);
+            const double commission = costs_.commission(quantity, price);
+
+            // The position was last marked at its latest bar's close, or a later fill's price
+            const double mark = book.last_fill_event >= static_cast<std::int64_t>(s.event[signal.row]) ? book.last_fill_price : s.close[signal.row];
+            const double previous_realized = book.realized_pnl;
+            Common::FillDetails fill({}, 0, std::string(), direction, quantity, price, commission);
+            Common::apply_fill(book.quantity, book.average_entry_price, book.realized_pnl, fill);
+            const double realized_change = book.realized_pnl - previous_realized;
+
+            cash += (buy ? -quantity : quantity) * price - commission;
+            realized_pnl += realized_change;
+            total_commission += commission;
+            equity_change[signal.event] += current * (price - mark) - commission;
+            const bool was_open = std::abs(current) > 1e-9;
+            const bool is_open = std::abs(book.quantity) > 1e-9;
+            open_positions += static_cast<long>(is_open) - static_cast<long>(was_open);
+            if (!open_after.empty() && open_after.back().first == signal.event) open_after.back().second = open_positions;
+            else open_after.emplace_back(signal.event, open_positions);
+            metrics.record_fill(quantity * price, was_open && (current > 0) != buy, realized_change);
+
+            book.last_fill_event = signal.event;
+            book.last_fill_price = price;
+            symbol_fills[signal.symbol].push_back(SymbolFill{signal.event, book.quantity, price});
+            run.fills.push_back(VectorFill{signal.event, signal.symbol, buy ? quantity : -quantity, price, commission});
+        }
+
+        // --- 3. Mark to market: per symbol, position constant between fills ---
+        std::vector<double> marks;
+        for (size_t id = 0; id < data_.symbols(); ++id) {
+            const auto& fills = symbol_fills[id];
+            if (fills.empty()) continue;
+            const Series& s = data_.series(id);
+            const size_t n = s.size();
+            const std::uint32_t* bar_event = s.event.data();
+            const double* close = s.close.data();
+            marks.resize(n);
+            size_t k = static_cast<size_t>(std::upper_bound(bar_event, bar_event + n, fills[0].event) - bar_event);
+            size_t f = 0;
+            while (k < n) {
+                // Fills before bar k set the position and its mark
+                double held = 0.0, mark = 0.0;
+                while (f < fills.size() && fills[f].event < bar_event[k]) {
+                    held = fills[f].quantity;
+                    mark = fills[f].price;
+                    ++f;
+                }
+                // Bars up to (and including one on) the next fill's event hold it
+                const size_t end = f < fills.size()
+                    ? static_cast<size_t>(std::upper_bound(bar_event + k, bar_event + n, fills[f].event) - bar_event)
+                    : n;
+                if (std::abs(held) > 1e-9) {
+                    marks[k] = held * (close[k] - mark);
+                    for (size_t j = k + 1; j < end; ++j) marks[j] = held * (close[j] - close[j - 1]);
+                    for (size_t j = k; j < end; ++j) equity_change[bar_event[j]] += marks[j];
+                }
+                k = end;
+            }
+        }
+
+        // --- Equity curve -> metrics ---
+        const auto& times = data_.event_times();
+        double equity = initial_capital_;
+        size_t next_open = 0;
+        long open_now = 0;
+        for (size_t e = 0; e < events; ++e) {
+            equity += equity_change[e];
+            if (next_open < open_after.size() && open_after[next_open].first == e) open_now = open_after[next_open++].second;
+            metrics.record_equity(std::chrono::system_clock::time_point(std::chrono::duration_cast<std::chrono::system_clock::duration>(
+                                      std::chrono::nanoseconds(times[e]))), equity, open_now > 0);
+        }
+
+        // Final equity from the positions themselves, as the Portfolio sums it
+        double market_value = 0.0;
+        for (size_t id = 0; id < data_.symbols(); ++id) {
+            const Book& book = books[id];
+            if (book.last_fill_event < 0) continue;
+            const Series& s = data_.series(id);
+            const double last_close = s.close.back();
+            const double mark = book.last_fill_event >= static_cast<std::int64_t>(s.event.back()) ? book.last_fill_price : last_close;
+            market_value += book.quantity * mark;
+        }
+
+        StrategyResult& res = run.result;
+        res.final_equity = cash + market_value;
+        res.total_return_pct = (initial_capital_ > 1e-9) ? (((res.final_equity / initial_capital_) - 1.0) * 100.0) : 0.0;
+        res.realized_pnl = realized_pnl;
+        res.total_commission = total_commission;
+        res.num_fills = static_cast<long>(run.fills.size());
+        if (!metrics.empty()) {
+            const MetricsSnapshot m = metrics.snapshot();
+            res.max_drawdown_pct = m.max_drawdown_pct;
+            res.max_drawdown_duration_s = m.max_drawdown_duration_s;
+            res.sharpe = m.sharpe;
+            res.sortino = m.sortino;
+            res.calmar = m.calmar;
+            res.turnover = m.turnover;
+            res.exposure_pct = m.exposure_pct;
+            res.hit_rate_pct = m.hit_rate_pct;
+            res.closed_trades = m.closed_trades;
+            res.winning_trades = m.winning_trades;
+        }
+        return run;
+    }
+
+    // --- Cross-check ---
+    CrossCheck VectorizedBacktester::cross_check(const VectorStrategy& strategy, const std::vector<Common::MarketEvent>& events) const {
+        if (events.size() != data_.events()) throw std::invalid_argument("VectorizedBacktester: events are not the loaded stream");
+        CrossCheck check;
+        auto start = std::chrono::steady_clock::now();
+        check.vectorized = run(strategy);
+        auto split = std::chrono::steady_clock::now();
+
+        std::unique_ptr<DataManager> replay = create_slice_data_manager(events, 0, events.size());
+        std::unique_ptr<StrategyBase> event_strategy = make_event_strategy(strategy);
+        Portfolio portfolio(initial_capital_);
+        portfolio.set_equity_curve_mode(EquityCurveMode::NONE);
+        TradeLedger ledger;
+        portfolio.set_trade_ledger(&ledger);
+        SweepExecutionSimulator simulator(costs_.fill_price, costs_.slippage, costs_.commission);
+        Backtester backtester(*replay, *event_strategy, portfolio, simulator);
+        backtester.set_verbose(false);
+        backtester.set_latency_profiling(false);
+        backtester.run();
+        check.event_driven = portfolio.get_results_summary();
+        auto end = std::chrono::steady_clock::now();
+        check.vectorized_seconds = std::chrono::duration<double>(split - start).count();
+        check.event_driven_seconds = std::chrono::duration<double>(end - split).count();
+
+        // Fill by fill, then the summary
+        std::ostringstream mismatch;
+        const auto& fills = check.vectorized.fills;
+        size_t i = 0;
+        for (const LedgerBlock& block : ledger.blocks()) {
+            for (size_t r = 0; r < block.count && mismatch.tellp() == 0; ++r, ++i) {
+                if (i == fills.size()) {
+                    mismatch << "event-driven fill " << i << " has no vectorized counterpart";
+                    break;
+                }
+                const VectorFill& fill = fills[i];
+                const double quantity = static_cast<Common::OrderDirection>(block.direction[r]) == Common::OrderDirection::BUY
+                    ? block.quantity[r] : -block.quantity[r];
+                if (ledger.symbols()[block.symbol_id[r]] != data_.symbol(fill.symbol) ||
+                    block.timestamp_ns[r] != data_.event_time_ns(fill.event) || quantity != fill.quantity ||
+                    !close_enough(block.price[r], fill.price) || !close_enough(block.commission[r], fill.commission)) {
+                    mismatch << "fill " << i << ": vectorized " << data_.symbol(fill.symbol) << " " << fill.quantity << " @ "
+                             << fill.price << " (t=" << data_.event_time_ns(fill.event) << "), event-driven "
+                             << ledger.symbols()[block.symbol_id[r]] << " " << quantity << " @ " << block.price[r]
+                             << " (t=" << block.timestamp_ns[r] << ")";
+                }
+            }
+        }
+        if (mismatch.tellp() == 0 && i != fills.size()) {
+            mismatch << "vectorized fill " << i << " has no event-driven counterpart";
+        }
+        const StrategyResult& v = check.vectorized.result;
+        const StrategyResult& d = check.event_driven;
+        if (mismatch.tellp() == 0) {
+            if (v.num_fills != d.num_fills) mismatch << "fills: " << v.num_fills << " vs " << d.num_fills;
+            else if (!close_enough(v.final_equity, d.final_equity)) mismatch << "final equity: " << v.final_equity << " vs " << d.final_equity;
+            else if (!close_enough(v.realized_pnl, d.realized_pnl)) mismatch << "realized P&L: " << v.realized_pnl << " vs " << d.realized_pnl;
+            else if (!close_enough(v.total_commission, d.total_commission)) mismatch << "commission: " << v.total_commission << " vs " << d.total_commission;
+            else if (v.closed_trades != d.closed_trades || v.winning_trades != d.winning_trades) {
+                mismatch << "closing fills: " << v.winning_trades << "/" << v.closed_trades << " vs " << d.winning_trades << "/" << d.closed_trades;
+            } else if (std::abs(v.max_drawdown_pct - d.max_drawdown_pct) > 1e-6) {
+                mismatch << "max drawdown: " << v.max_drawdown_pct << "% vs " << d.max_drawdown_pct << "%";
+            }
+        }
+        check.mismatch = mismatch.str();
+        check.matches = check.mismatch.empty();
+        return check;
+    }
+
+} // namespace Backtester
@@ -1,5 +1,12 @@
 #include "backtester/Backtester.h"
+#include "backtester/ShardedBacktester.h"
 #include "backtester/Strategy.h"
+#include "backtester/TradeLedger.h"
+#include "backtester/PairScreener.h"
+#include "backtester/VectorizedBacktester.h"
+#include "common/Logger.h"
+#include "common/Trace.h"
+#include "common/RunArena.h"
 // --- Include ALL implemented strategy headers ---
 #include "strategies/MovingAverageCrossover.h"
 #include "strategies/VWAPReversion.h"
@@ -17,11 +24,17 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include <memory_resource>
 #include <stdexcept>
 #include <map>
 #include <iomanip>
+#include <chrono>
 #include <functional>
 #include <filesystem>
+#include <fstream>
+#include <cctype>
+#include <cstdint>
+#include <optional>
 
 // --- StrategyResult struct defined in Portfolio.h ---
 #include "backtester/Portfolio.h" // Use core/ path
@@ -39,6 +52,91 @@ int main(int argc, char* argv[]) {
     // --- Configuration ---
     std::string data_base_dir = "../data";
     double initial_cash = 100000.0; // <-- Variable name is initial_cash
+    // --shard-days: replay intraday-flat strategies one session per thread
+    // --latency-json <file>: export every run's stage latency histograms as a JSON array
+    // --trace <file>: record a Chrome Trace Event timeline (open in chrome://tracing or Perfetto)
+    // --equity-curve full|none|<N>: keep the whole equity curve (default), none, or at most N
+    //   downsampled points; the metrics are streamed either way
+    // --ledger-dir <dir>: record every fill of each (non-sharded) run to <dir>/<run>.ledger
+    //   and export it as <dir>/<run>.csv
+    // --order-latency <spec>: delay every order by fixed:DUR, uniform:DUR:DUR or
+    //   lognormal:DUR:SIGMA (e.g. fixed:250us) so it fills against a later bar
+    // --seed <n>: seed of every run's random draws (order latency)
+    // --screen-pairs <n>: screen every pair of each dataset for cointegration and add
+    //   PairsTrading runs for the n best pairs at their OLS hedge ratios
+    // --vectorized: run the strategies the vectorized research mode covers over columnar data
+    //   instead of the event loop (ignores --order-latency for them)
+    // --cross-check: with --vectorized, also replay each of those strategies through the event
+    //   loop and compare the fills (as slow as a plain run; for validating the research mode)
+    // --slices: deliver each timestamp's bars to the strategies as one cross-sectional slice
+    // --pairs-engine: run the fixed Pairs configurations of each dataset on one PairsEngine
+    //   (log spread, universe-wide steps) instead of standalone price-ratio strategies
+    // --leadlag-engine: run the LeadLag configurations of each dataset on one LeadLagEngine
+    //   (universe-wide steps: a symbol missing from a step counts as a zero return)
+    bool shard_by_day = false;
+    std::string latency_json_path;
+    std::string trace_path;
+    Backtester::EquityCurveMode equity_curve_mode = Backtester::EquityCurveMode::FULL;
+    size_t equity_curve_points = 0;
+    std::string ledger_dir;
+    Backtester::OrderLatencyModel order_latency;
+    std::uint64_t seed = 0;
+    size_t screen_pairs = 0;
+    bool vectorized = false;
+    bool slices = false;
+    bool cross_check = false;
+    bool pairs_engine_mode = false;
+    bool leadlag_engine_mode = false;
+    for (int i = 1; i < argc; ++i) {
+        if (std::string(argv[i]) == "--shard-days") shard_by_day = true;
+        else if (std::string(argv[i]) == "--vectorized") vectorized = true;
+        else if (std::string(argv[i]) == "--slices") slices = true;
+        else if (std::string(argv[i]) == "--cross-check") cross_check = true;
+        else if (std::string(argv[i]) == "--pairs-engine") pairs_engine_mode = true;
+        else if (std::string(argv[i]) == "--leadlag-engine") leadlag_engine_mode = true;
+        else if (std::string(argv[i]) == "--latency-json" && i + 1 < argc) latency_json_path = argv[++i];
+        else if (std::string(argv[i]) == "--trace" && i + 1 < argc) trace_path = argv[++i];
+        else if (std::string(argv[i]) == "--ledger-dir" && i + 1 < argc) ledger_dir = argv[++i];
+        else if (std::string(argv[i]) == "--order-latency" && i + 1 < argc) {
+            try { order_latency = Backtester::OrderLatencyModel(Backtester::LatencyDistribution::parse(argv[++i])); }
+            catch (const std::invalid_argument& e) {
+                std::cerr << "ERROR: --order-latency: " << e.what() << std::endl;
+                return 1;
+            }
+        }
+        else if (std::string(argv[i]) == "--seed" && i + 1 < argc) {
+            try { seed = std::stoull(argv[++i]); }
+            catch (const std::exception&) {
+                std::cerr << "ERROR: --seed expects a non-negative integer" << std::endl;
+                return 1;
+            }
+        }
+        else if (std::string(argv[i]) == "--screen-pairs" && i + 1 < argc) {
+            try { screen_pairs = std::stoul(argv[++i]); }
+            catch (const std::exception&) {
+                std::cerr << "ERROR: --screen-pairs expects a non-negative integer" << std::endl;
+                return 1;
+            }
+        }
+        else if (std::string(argv[i]) == "--equity-curve" && i + 1 < argc) {
+            std::string value = argv[++i];
+            if (value == "full") equity_curve_mode = Backtester::EquityCurveMode::FULL;
+            else if (value == "none") equity_curve_mode = Backtester::EquityCurveMode::NONE;
+            else {
+                try { equity_curve_points = std::stoul(value); }
+                catch (const std::exception&) { equity_curve_points = 0; }
+                if (equity_curve_points < 2) {
+                    std::cerr << "ERROR: --equity-curve expects full, none or a point count >= 2" << std::endl;
+                    return 1;
+                }
+                equity_curve_mode = Backtester::EquityCurveMode::DOWNSAMPLED;
+            }
+        }
+    }
+    if (!trace_path.empty()) {
+        Backtester::Trace::set_enabled(true);
+        Backtester::Trace::set_thread_name("main");
+    }
 
     // --- Define Datasets to Test ---
     std::vector<std::string> datasets_to_test = {
@@ -49,6 +147,7 @@ int main(int argc, char* argv[]) {
 
     // --- Map to Store All Results ---
     std::map<std::string, Backtester::StrategyResult> all_results;
+    std::vector<Backtester::LatencyProfile> all_latency_profiles;
 
 
     // --- OUTER LOOP: Iterate Through Datasets ---
@@ -86,39 +185,99 @@ int main(int argc, char* argv[]) {
         // --- Define All Available Strategy Configurations ---
         struct StrategyConfig {
             std::string name;
-            std::function<std::unique_ptr<Backtester::StrategyBase>()> factory;
+            std::function<std::unique_ptr<Backtester::StrategyBase>(std::pmr::memory_resource*)> factory; // State allocates from the given run arena
             std::vector<std::string> required_datasets;
+            bool intraday_flat = false; // Each session is independent -> eligible for --shard-days
+            std::optional<Backtester::VectorStrategy> vectorized{}; // Same strategy for --vectorized, if it has one
         };
         std::vector<StrategyConfig> available_strategies_this_iteration;
 
         // Add standard strategies (Removed size parameter from constructors)
-        available_strategies_this_iteration.push_back({"MACrossover_5_20", [](){ return std::make_unique<Backtester::MovingAverageCrossover>(5, 20); }, {"stocks_april", "2024_only", "2024_2025"}}); // 2 args
-        available_strategies_this_iteration.push_back({"VWAP_2.0", [](){ return std::make_unique<Backtester::VWAPReversion>(2.0); }, {"stocks_april", "2024_only", "2024_2025"}}); // 1 arg
-        available_strategies_this_iteration.push_back({"ORB_30", [](){ return std::make_unique<Backtester::OpeningRangeBreakout>(30); }, {"stocks_april", "2024_only", "2024_2025"}}); // 1 arg
-        available_strategies_this_iteration.push_back({"Momentum_5_10_2_3", [](){ return std::make_unique<Backtester::MomentumIgnition>(5, 10, 2.0, 3); }, {"stocks_april", "2024_only", "2024_2025"}}); // 4 args
+        int orb_session_close = 19 * 60 + 55; // 19:55, before the sessions end at 20:00
+        available_strategies_this_iteration.push_back({"MACrossover_5_20", [](std::pmr::memory_resource* resource){ return std::make_unique<Backtester::MovingAverageCrossover>(5, 20, resource); }, {"stocks_april", "2024_only", "2024_2025"}, false, Backtester::MACrossoverParams{5, 20}}); // 2 args
+        available_strategies_this_iteration.push_back({"VWAP_2.0", [](std::pmr::memory_resource* resource){ return std::make_unique<Backtester::VWAPReversion>(2.0, resource); }, {"stocks_april", "2024_only", "2024_2025"}, false, Backtester::VWAPReversionParams{2.0}}); // 1 arg
+        available_strategies_this_iteration.push_back({"ORB_30", [orb_session_close](std::pmr::memory_resource* resource){ return std::make_unique<Backtester::OpeningRangeBreakout>(30, orb_session_close, resource); }, {"stocks_april", "2024_only", "2024_2025"}, true, Backtester::OpeningRangeBreakoutParams{30, orb_session_close}}); // 2 args; flat from the session close on, so intraday-flat
+        available_strategies_this_iteration.push_back({"Momentum_5_10_2_3", [](std::pmr::memory_resource* resource){ return std::make_unique<Backtester::MomentumIgnition>(5, 10, 2.0, 3, resource); }, {"stocks_april", "2024_only", "2024_2025"}, false, Backtester::MomentumIgnitionParams{5, 10, 2.0, 3}}); // 4 args
 
         // Add Pairs Trading
         double pairs_trade_value = 10000.0; size_t pairs_lookback = 60; double pairs_entry_z = 2.0, pairs_exit_z = 0.5;
         // ... (Pairs configs using [&] capture and Backtester::PairsTrading) ...
-        if (!msft_sym.empty() && !nvda_sym.empty()) available_strategies_this_iteration.push_back({"Pairs_MSFT_NVDA", [&](){ return std::make_unique<Backtester::PairsTrading>(msft_sym, nvda_sym, pairs_lookback, pairs_entry_z, pairs_exit_z, pairs_trade_value); }, {"stocks_april"}});
-        if (!nvda_sym.empty() && !goog_sym.empty()) available_strategies_this_iteration.push_back({"Pairs_NVDA_GOOG", [&](){ return std::make_unique<Backtester::PairsTrading>(nvda_sym, goog_sym, pairs_lookback, pairs_entry_z, pairs_exit_z, pairs_trade_value); }, {"stocks_april"}});
-        if (!msft_sym.empty() && !goog_sym.empty()) available_strategies_this_iteration.push_back({"Pairs_MSFT_GOOG", [&](){ return std::make_unique<Backtester::PairsTrading>(msft_sym, goog_sym, pairs_lookback, pairs_entry_z, pairs_exit_z, pairs_trade_value); }, {"stocks_april"}});
-        if (!btc_sym.empty() && !eth_sym.empty()) available_strategies_this_iteration.push_back({"Pairs_BTC_ETH", [&](){ return std::make_unique<Backtester::PairsTrading>(btc_sym, eth_sym, pairs_lookback, pairs_entry_z, pairs_exit_z, pairs_trade_value); }, {"2024_only", "2024_2025"}});
-        if (!eth_sym.empty() && !sol_sym.empty()) available_strategies_this_iteration.push_back({"Pairs_ETH_SOL", [&](){ return std::make_unique<Backtester::PairsTrading>(eth_sym, sol_sym, pairs_lookback, pairs_entry_z, pairs_exit_z, pairs_trade_value); }, {"2024_only", "2024_2025"}});
-        if (!btc_sym.empty() && !sol_sym.empty()) available_strategies_this_iteration.push_back({"Pairs_BTC_SOL", [&](){ return std::make_unique<Backtester::PairsTrading>(btc_sym, sol_sym, pairs_lookback, pairs_entry_z, pairs_exit_z, pairs_trade_value); }, {"2024_only", "2024_2025"}});
-        if (!eth_sym.empty() && !ada_sym.empty()) available_strategies_this_iteration.push_back({"Pairs_ETH_ADA", [&](){ return std::make_unique<Backtester::PairsTrading>(eth_sym, ada_sym, pairs_lookback, pairs_entry_z, pairs_exit_z, pairs_trade_value); }, {"2024_only", "2024_2025"}});
-        if (!sol_sym.empty() && !ada_sym.empty()) available_strategies_this_iteration.push_back({"Pairs_SOL_ADA", [&](){ return std::make_unique<Backtester::PairsTrading>(sol_sym, ada_sym, pairs_lookback, pairs_entry_z, pairs_exit_z, pairs_trade_value); }, {"2024_only", "2024_2025"}});
-
+        // By default each configuration is a standalone PairsTrading on the price ratio, which
+        // the vectorized research mode reproduces. With --pairs-engine they share one engine
+        // over the dataset's universe instead: its z-score is of the log spread and its steps
+        // span the whole universe, so results differ and there is no vectorized equivalent.
+        // Each factory resets the engine (see the lead-lag configurations below).
+        std::shared_ptr<Backtester::PairsEngine> pairs_engine;
+        if (pairs_engine_mode) pairs_engine = std::make_shared<Backtester::PairsEngine>(drl_symbols, pairs_lookback, pairs_entry_z, pairs_exit_z);
+        auto add_pair = [&](const std::string& name, const std::string& sym_a, const std::string& sym_b, std::vector<std::string> datasets) {
+            if (sym_a.empty() || sym_b.empty()) return;
+            if (pairs_engine) {
+                available_strategies_this_iteration.push_back({name, [&, sym_a, sym_b](std::pmr::memory_resource* resource){ pairs_engine->reset(); return std::make_unique<Backtester::PairsTrading>(pairs_engine, sym_a, sym_b, pairs_trade_value, resource); }, std::move(datasets)});
+                return;
+            }
+            available_strategies_this_iteration.push_back({name, [&, sym_a, sym_b](std::pmr::memory_resource* resource){ return std::make_unique<Backtester::PairsTrading>(sym_a, sym_b, pairs_lookback, pairs_entry_z, pairs_exit_z, pairs_trade_value, resource); }, std::move(datasets), false, Backtester::PairsTradingParams{sym_a, sym_b, pairs_lookback, pairs_entry_z, pairs_exit_z}});
+        };
+        add_pair("Pairs_MSFT_NVDA", msft_sym, nvda_sym, {"stocks_april"});
+        add_pair("Pairs_NVDA_GOOG", nvda_sym, goog_sym, {"stocks_april"});
+        add_pair("Pairs_MSFT_GOOG", msft_sym, goog_sym, {"stocks_april"});
+        add_pair("Pairs_BTC_ETH", btc_sym, eth_sym, {"2024_only", "2024_2025"});
+        add_pair("Pairs_ETH_SOL", eth_sym, sol_sym, {"2024_only", "2024_2025"});
+        add_pair("Pairs_BTC_SOL", btc_sym, sol_sym, {"2024_only", "2024_2025"});
+        add_pair("Pairs_ETH_ADA", eth_sym, ada_sym, {"2024_only", "2024_2025"});
+        add_pair("Pairs_SOL_ADA", sol_sym, ada_sym, {"2024_only", "2024_2025"});
+
+        // Screened pairs, best ADF statistic first (PairsTrading needs a positive hedge ratio)
+        if (screen_pairs > 0) {
+            std::unique_ptr<Backtester::DataManager> screen_data = Backtester::create_csv_data_manager();
+            if (screen_data && screen_data->load_data(data_path)) {
+                try {
+                    Backtester::PairScreener screener;
+                    screener.load(screen_data->get_all_events());
+                    size_t added = 0;
+                    for (const auto& pair : screener.screen()) {
+                        if (added == screen_pairs) break;
+                        if (pair.hedge_ratio <= 0.0) continue;
+                        std::cout << "Screened pair " << pair.symbol_a << " / " << pair.symbol_b << ": hedge ratio " << pair.hedge_ratio
+                                  << ", ADF " << pair.adf_statistic << ", half-life " << pair.half_life << " steps" << std::endl;
+                        available_strategies_this_iteration.push_back({"PairsScreened_" + pair.symbol_a + "_" + pair.symbol_b, [&, pair](std::pmr::memory_resource* resource){
+                            auto strategy = std::make_unique<Backtester::PairsTrading>(pair.symbol_a, pair.symbol_b, pairs_lookback, pairs_entry_z, pairs_exit_z, pairs_trade_value, resource);
+                            strategy->set_hedge_ratio(pair.hedge_ratio);
+                            return strategy;
+                        }, {target_dataset_subdir}, false,
+                           Backtester::PairsTradingParams{pair.symbol_a, pair.symbol_b, pairs_lookback, pairs_entry_z, pairs_exit_z, pair.hedge_ratio}});
+                        ++added;
+                    }
+                } catch (const std::exception& e) {
+                    std::cerr << "ERROR: Pair screening failed: " << e.what() << std::endl;
+                }
+            }
+        }
 
         // Add Lead-Lag Strategies (Removed size parameter)
         size_t leadlag_window = 30; size_t leadlag_lag = 1; double leadlag_corr = 0.5, leadlag_ret = 0.0002;
         // ... (LeadLag configs using [&] capture and Backtester::LeadLagStrategy) ...
-        if (!msft_sym.empty() && !nvda_sym.empty()) available_strategies_this_iteration.push_back({"LeadLag_MSFT->NVDA", [&](){ return std::make_unique<Backtester::LeadLagStrategy>(msft_sym, nvda_sym, leadlag_window, leadlag_lag, leadlag_corr, leadlag_ret); }, {"stocks_april"}});
-        if (!nvda_sym.empty() && !msft_sym.empty()) available_strategies_this_iteration.push_back({"LeadLag_NVDA->MSFT", [&](){ return std::make_unique<Backtester::LeadLagStrategy>(nvda_sym, msft_sym, leadlag_window, leadlag_lag, leadlag_corr, leadlag_ret); }, {"stocks_april"}});
-        if (!btc_sym.empty() && !eth_sym.empty()) available_strategies_this_iteration.push_back({"LeadLag_BTC->ETH", [&](){ return std::make_unique<Backtester::LeadLagStrategy>(btc_sym, eth_sym, leadlag_window, leadlag_lag, leadlag_corr, leadlag_ret); }, {"2024_only", "2024_2025"}});
-        if (!eth_sym.empty() && !btc_sym.empty()) available_strategies_this_iteration.push_back({"LeadLag_ETH->BTC", [&](){ return std::make_unique<Backtester::LeadLagStrategy>(eth_sym, btc_sym, leadlag_window, leadlag_lag, leadlag_corr, leadlag_ret); }, {"2024_only", "2024_2025"}});
-        if (!eth_sym.empty() && !sol_sym.empty()) available_strategies_this_iteration.push_back({"LeadLag_ETH->SOL", [&](){ return std::make_unique<Backtester::LeadLagStrategy>(eth_sym, sol_sym, leadlag_window, leadlag_lag, leadlag_corr, leadlag_ret); }, {"2024_only", "2024_2025"}});
-        if (!sol_sym.empty() && !eth_sym.empty()) available_strategies_this_iteration.push_back({"LeadLag_SOL->ETH", [&](){ return std::make_unique<Backtester::LeadLagStrategy>(sol_sym, eth_sym, leadlag_window, leadlag_lag, leadlag_corr, leadlag_ret); }, {"2024_only", "2024_2025"}});
+        // By default each configuration is a standalone LeadLagStrategy over its two symbols'
+        // own bars. With --leadlag-engine they share one engine over the dataset's universe
+        // instead: its steps span the whole universe and a symbol missing from a step counts as
+        // a zero return, so results differ on gapped data (halts, crypto next to stocks). The
+        // runs replay the same stream one after another, and an engine left at the end of the
+        // last run would ignore every bar as already recorded, so each factory resets it first.
+        std::shared_ptr<Backtester::LeadLagEngine> leadlag_engine;
+        if (leadlag_engine_mode) leadlag_engine = std::make_shared<Backtester::LeadLagEngine>(drl_symbols, leadlag_window, leadlag_lag);
+        auto add_leadlag = [&](const std::string& name, const std::string& leader, const std::string& lagger, std::vector<std::string> datasets) {
+            if (leader.empty() || lagger.empty()) return;
+            if (leadlag_engine) {
+                available_strategies_this_iteration.push_back({name, [&, leader, lagger](std::pmr::memory_resource* resource){ leadlag_engine->reset(); return std::make_unique<Backtester::LeadLagStrategy>(leadlag_engine, leader, lagger, leadlag_lag, leadlag_corr, leadlag_ret, resource); }, std::move(datasets)});
+                return;
+            }
+            available_strategies_this_iteration.push_back({name, [&, leader, lagger](std::pmr::memory_resource* resource){ return std::make_unique<Backtester::LeadLagStrategy>(leader, lagger, leadlag_window, leadlag_lag, leadlag_corr, leadlag_ret, resource); }, std::move(datasets)});
+        };
+        add_leadlag("LeadLag_MSFT->NVDA", msft_sym, nvda_sym, {"stocks_april"});
+        add_leadlag("LeadLag_NVDA->MSFT", nvda_sym, msft_sym, {"stocks_april"});
+        add_leadlag("LeadLag_BTC->ETH", btc_sym, eth_sym, {"2024_only", "2024_2025"});
+        add_leadlag("LeadLag_ETH->BTC", eth_sym, btc_sym, {"2024_only", "2024_2025"});
+        add_leadlag("LeadLag_ETH->SOL", eth_sym, sol_sym, {"2024_only", "2024_2025"});
+        add_leadlag("LeadLag_SOL->ETH", sol_sym, eth_sym, {"2024_only", "2024_2025"});
 
 
         // --- DRL Strategy Stub Config (COMMENTED OUT UNTIL IMPLEMENTED) ---
@@ -135,8 +294,8 @@ int main(int argc, char* argv[]) {
                  available_strategies_this_iteration.push_back({"DRL_Agent_Stub",
                     // Correct capture & instantiation depends on DRLStrategy constructor
                     // Example assumes DRLStrategy takes FeatureCalculator&, DRLInferenceEngine&, vector<string>, double size
-                    [fc_ref = *feature_calculator, engine_ref = *drl_engine, syms = drl_symbols, size = 100.0]() mutable -> std::unique_ptr<Backtester::StrategyBase> {
-                         return std::make_unique<Backtester::DRLStrategy>(fc_ref, engine_ref, syms, size); // Pass refs
+                    [fc_ref = *feature_calculator, engine_ref = *drl_engine, syms = drl_symbols, size = 100.0](std::pmr::memory_resource* resource) mutable -> std::unique_ptr<Backtester::StrategyBase> {
+                         return std::make_unique<Backtester::DRLStrategy>(fc_ref, engine_ref, syms, size, resource); // Pass refs
                     },
                     {"stocks_april", "2024_only", "2024_2025"}
                  });
@@ -158,11 +317,53 @@ int main(int argc, char* argv[]) {
         std::cout << "Preparing to run " << strategies_to_run_this_dataset.size() << " strategies for dataset '" << target_dataset_subdir << "'." << std::endl;
 
 
+        // --- Columnar copy of the dataset for --vectorized (loaded with the first such run) ---
+        std::unique_ptr<Backtester::DataManager> columnar_source;
+        std::unique_ptr<Backtester::ColumnarData> columnar;
+
         // --- INNER LOOP: Iterate Through Applicable Strategies ---
         for (const auto& config : strategies_to_run_this_dataset) {
             std::cout << "\n\n===== Running Strategy: " << config.name << " on Dataset: " << target_dataset_subdir << " =====" << std::endl;
+            Backtester::Trace::Span strategy_span("strategy_run", "backtest", config.name + "_on_" + target_dataset_subdir);
+            // Vectorized runs need no strategy object (nor, without --cross-check, the event loop)
+            if (vectorized && config.vectorized) {
+                try {
+                    if (!columnar) {
+                        columnar_source = Backtester::create_csv_data_manager();
+                        if (!columnar_source || !columnar_source->load_data(data_path)) throw std::runtime_error("Failed to load " + data_path);
+                        columnar = std::make_unique<Backtester::ColumnarData>(columnar_source->get_all_events());
+                    }
+                    Backtester::VectorizedBacktester research(*columnar, initial_cash);
+                    if (cross_check) {
+                        Backtester::CrossCheck check = research.cross_check(*config.vectorized, columnar_source->get_all_events());
+                        std::cout << "Vectorized run: " << check.vectorized.fills.size() << " fills, final equity "
+                                  << std::fixed << std::setprecision(2) << check.vectorized.result.final_equity
+                                  << std::setprecision(4) << " in " << check.vectorized_seconds << "s (event-driven "
+                                  << check.event_driven_seconds << "s)" << std::defaultfloat << std::endl;
+                        if (check.matches) std::cout << "Cross-check against the event-driven run: OK" << std::endl;
+                        else std::cerr << "WARNING: Cross-check against the event-driven run failed: " << check.mismatch << std::endl;
+                        all_results[config.name + "_on_" + target_dataset_subdir] = check.vectorized.result;
+                    } else {
+                        auto start = std::chrono::steady_clock::now();
+                        Backtester::VectorRun run = research.run(*config.vectorized);
+                        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+                        std::cout << "Vectorized run: " << run.fills.size() << " fills, final equity "
+                                  << std::fixed << std::setprecision(2) << run.result.final_equity
+                                  << std::setprecision(4) << " in " << elapsed.count() << "s" << std::defaultfloat << std::endl;
+                        all_results[config.name + "_on_" + target_dataset_subdir] = run.result;
+                    }
+                } catch (const std::exception& e) {
+                    std::cerr << "ERROR: Vectorized run failed for " << config.name << ": " << e.what() << std::endl;
+                }
+                std::cout << "===== Finished Strategy: " << config.name << " on " << target_dataset_subdir << " =====" << std::endl;
+                continue;
+            }
+
+            // Per-run state (strategy maps/histories, positions, equity curve, order queue) comes
+            // from this arena and is freed in one go at the end of the iteration
+            Backtester::Common::RunArena arena;
             std::unique_ptr<Backtester::StrategyBase> strategy = nullptr;
-            try { strategy = config.factory(); }
+            try { strategy = config.factory(arena.resource()); }
             catch (...) { /* ... error handling ... */ continue; }
             if (!strategy) { /* ... error handling ... */ continue; }
 
@@ -170,8 +371,43 @@ int main(int argc, char* argv[]) {
             std::unique_ptr<Backtester::DataManager> data_manager = Backtester::create_csv_data_manager();
             if (!data_manager || !data_manager->load_data(data_path)) { continue; }
 
+            if (shard_by_day && config.intraday_flat) {
+                try {
+                    Backtester::ShardedBacktester sharded(*data_manager, config.factory, initial_cash);
+                    sharded.set_latency_label(config.name + "_on_" + target_dataset_subdir);
+                    sharded.set_order_latency(order_latency);
+                    sharded.set_seed(seed);
+                    sharded.set_slice_delivery(slices);
+                    sharded.run();
+                    sharded.print_summary();
+                    all_results[config.name + "_on_" + target_dataset_subdir] = sharded.get_results_summary();
+                    all_latency_profiles.push_back(sharded.get_latency_profile());
+                } catch (const std::exception& e) {
+                    std::cerr << "ERROR: Sharded run failed for " << config.name << ": " << e.what() << std::endl;
+                }
+                std::cout << "===== Finished Strategy: " << config.name << " on " << target_dataset_subdir << " =====" << std::endl;
+                continue;
+            }
+
             // --- CORRECTED: Use initial_cash variable ---
-            Backtester::Portfolio portfolio(initial_cash);
+            Backtester::Portfolio portfolio(initial_cash, arena.resource());
+            portfolio.set_equity_curve_mode(equity_curve_mode, equity_curve_points);
+            std::unique_ptr<Backtester::TradeLedger> ledger;
+            std::string ledger_path;
+            if (!ledger_dir.empty()) {
+                std::string file_stem = config.name + "_on_" + target_dataset_subdir;
+                for (char& c : file_stem) if (!std::isalnum(static_cast<unsigned char>(c)) && c != '.' && c != '-') c = '_';
+                ledger_path = (std::filesystem::path(ledger_dir) / (file_stem + ".ledger")).string();
+                try {
+                    std::filesystem::create_directories(ledger_dir);
+                    ledger = std::make_unique<Backtester::TradeLedger>();
+                    ledger->spill_to(ledger_path);
+                    portfolio.set_trade_ledger(ledger.get());
+                } catch (const std::exception& e) {
+                    std::cerr << "ERROR: " << e.what() << " (fills will not be recorded)" << std::endl;
+                    ledger.reset();
+                }
+            }
             Backtester::ExecutionSimulator execution_simulator;
             // DRL components needed if running DRL stub
             // Backtester::FeatureCalculator feature_calc_instance;
@@ -179,7 +415,11 @@ int main(int argc, char* argv[]) {
             // --- Needs strategy->set_portfolio if strategy requires it ---
             // strategy->set_portfolio(&portfolio); // Need to add this method to base/derived strategies
 
-            Backtester::Backtester backtester(*data_manager, *strategy, portfolio, execution_simulator);
+            Backtester::Backtester backtester(*data_manager, *strategy, portfolio, execution_simulator, arena.resource());
+            backtester.set_latency_label(config.name + "_on_" + target_dataset_subdir);
+            backtester.set_order_latency(order_latency);
+            backtester.set_seed(seed);
+            backtester.set_slice_delivery(slices);
             Backtester::Portfolio const* result_portfolio = nullptr;
 
             try {
@@ -190,6 +430,21 @@ int main(int argc, char* argv[]) {
             if (result_portfolio) {
                 std::string result_key = config.name + "_on_" + target_dataset_subdir;
                 all_results[result_key] = result_portfolio->get_results_summary();
+                all_latency_profiles.push_back(backtester.get_latency_profile());
+                std::cout << "Run arena: " << arena.bytes_reserved() / 1024 << " KiB in " << arena.heap_blocks() << " heap block(s)" << std::endl;
+                if (ledger) {
+                    try {
+                        ledger->close();
+                        Backtester::LedgerReader reader(ledger_path);
+                        std::string csv_path = std::filesystem::path(ledger_path).replace_extension(".csv").string();
+                        std::ofstream csv_out(csv_path);
+                        if (!csv_out) throw std::runtime_error("cannot write '" + csv_path + "'");
+                        reader.write_csv(csv_out);
+                        std::cout << "Trade ledger: " << reader.size() << " fills -> " << ledger_path << ", " << csv_path << std::endl;
+                    } catch (const std::exception& e) {
+                        std::cerr << "ERROR: Trade ledger: " << e.what() << std::endl;
+                    }
+                }
             } else { /* ... warning ... */ }
             std::cout << "===== Finished Strategy: " << config.name << " on " << target_dataset_subdir << " =====" << std::endl;
         } // End INNER strategy loop
@@ -202,6 +457,32 @@ int main(int argc, char* argv[]) {
     else { /* ... no results ... */ }
 
 
+    // --- Export stage latencies ---
+    if (!latency_json_path.empty()) {
+        std::ofstream latency_out(latency_json_path);
+        if (!latency_out) {
+            std::cerr << "ERROR: Cannot write latency report to '" << latency_json_path << "'" << std::endl;
+        } else {
+            latency_out << "[\n";
+            for (size_t i = 0; i < all_latency_profiles.size(); ++i) {
+                latency_out << "  " << all_latency_profiles[i].to_json() << (i + 1 < all_latency_profiles.size() ? ",\n" : "\n");
+            }
+            latency_out << "]\n";
+            std::cout << "Stage latency report written to " << latency_json_path << std::endl;
+        }
+    }
+
+    // --- Export timeline ---
+    if (!trace_path.empty()) {
+        try {
+            Backtester::Log::Logger::instance().flush();
+            Backtester::Trace::write_chrome_json(trace_path);
+            std::cout << "Trace written to " << trace_path << std::endl;
+        } catch (const std::exception& e) {
+            std::cerr << "ERROR: " << e.what() << std::endl;
+        }
+    }
+
     std::cout << "\n--- Comprehensive Run Invocation Complete ---" << std::endl;
     return 0;
 }
\ No newline at end of file